@@ -0,0 +1,50 @@
+// Cliente del canal push (WebSocket /ws)
+// Uso: PushChannel.on('luces', fn); PushChannel.connect();
+// Mientras no hay conexión, PushChannel.connected es false y las páginas
+// siguen consultando por HTTP como antes.
+var PushChannel = (function() {
+  var handlers = {};
+  var socket = null;
+  var retryDelay = 1000;
+
+  var channel = {
+    connected: false,
+
+    on: function(type, fn) {
+      (handlers[type] = handlers[type] || []).push(fn);
+    },
+
+    connect: function() {
+      var token = localStorage.getItem('authToken') || sessionStorage.getItem('authToken');
+      if (!token || !window.WebSocket) return;
+
+      var scheme = location.protocol === 'https:' ? 'wss://' : 'ws://';
+      socket = new WebSocket(scheme + location.host + '/ws');
+
+      socket.onopen = function() {
+        socket.send(JSON.stringify({ token: token }));
+      };
+
+      socket.onmessage = function(event) {
+        var msg;
+        try { msg = JSON.parse(event.data); } catch (e) { return; }
+        if (msg.type === 'hello') {
+          channel.connected = true;
+          retryDelay = 1000;
+        }
+        (handlers[msg.type] || []).forEach(function(fn) { fn(msg); });
+      };
+
+      socket.onclose = function(event) {
+        channel.connected = false;
+        (handlers['close'] || []).forEach(function(fn) { fn(event); });
+        // 1008: token inválido o sesión expirada, no reintentar
+        if (event.code === 1008) return;
+        setTimeout(channel.connect, retryDelay);
+        retryDelay = Math.min(retryDelay * 2, 30000);
+      };
+    }
+  };
+
+  return channel;
+})();
@@ -0,0 +1,130 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Cola de un productor y un consumidor (SPSC) sin locks.
+//
+// A diferencia de CircularBuffer, no hay un contador compartido: el productor
+// solo escribe head y el consumidor solo escribe tail, así que un Ticker o una
+// ISR pueden encolar mientras loop() desencola. Los índices corren libres
+// (uint32_t) y se enmascaran con S - 1, por eso S debe ser potencia de dos.
+// Llena, push() devuelve false en lugar de pisar el elemento más antiguo.
+//
+// Productor: push, pushN, emplace.
+// Consumidor: pop, popN, peek, discard, clear.
+template <typename T, size_t S>
+class SpscRingBuffer {
+    static_assert(S >= 2 && (S & (S - 1)) == 0, "SpscRingBuffer: la capacidad debe ser potencia de dos");
+    static_assert(S <= 0x80000000UL, "SpscRingBuffer: capacidad demasiado grande");
+
+private:
+    static const uint32_t MASK = S - 1;
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[S];
+    std::atomic<uint32_t> head;  // Próxima posición a escribir (productor)
+    std::atomic<uint32_t> tail;  // Próxima posición a leer (consumidor)
+
+    T* slot(uint32_t index) { return reinterpret_cast<T*>(&storage[index & MASK]); }
+
+public:
+    SpscRingBuffer() : head(0), tail(0) {}
+    ~SpscRingBuffer() { clear(); }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // === PRODUCTOR ===
+
+    bool push(const T& item) {
+        return emplace(item);
+    }
+
+    // Construye el elemento directamente en su lugar del buffer
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == S) return false;
+
+        new (slot(h)) T(std::forward<Args>(args)...);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Encola hasta count elementos con una sola publicación; devuelve cuántos entraron
+    size_t pushN(const T* items, size_t count) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        size_t space = S - (h - tail.load(std::memory_order_acquire));
+        if (count > space) count = space;
+
+        for (size_t i = 0; i < count; i++) {
+            new (slot(h + i)) T(items[i]);
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // === CONSUMIDOR ===
+
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return false;
+
+        T* item = slot(t);
+        out = std::move(*item);
+        item->~T();
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Desencola hasta count elementos; devuelve cuántos se leyeron
+    size_t popN(T* out, size_t count) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        if (count > available) count = available;
+
+        for (size_t i = 0; i < count; i++) {
+            T* item = slot(t + i);
+            out[i] = std::move(*item);
+            item->~T();
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Elemento más antiguo sin sacarlo (nullptr si está vacío); válido hasta discard()
+    T* peek() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return nullptr;
+        return slot(t);
+    }
+
+    // Descarta el elemento devuelto por peek()
+    void discard() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return;
+        slot(t)->~T();
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    void clear() {
+        while (peek()) discard();
+    }
+
+    // === CONSULTA (aproximada si el otro lado está activo) ===
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    bool isFull() const { return size() == S; }
+    size_t capacity() const { return S; }
+};
+
+#endif // SPSC_RING_BUFFER_H
@@ -0,0 +1,259 @@
+# Paso previo de PlatformIO: prepara los archivos web para LittleFS.
+#
+# Toma todo lo que hay en data/, lo minifica (HTML/JS/CSS), lo comprime con
+# gzip y lo escribe en el directorio de datos del build (data_dir de
+# platformio.ini). Además genera /assets.manifest con el hash de contenido
+# de cada archivo, que WebAssets usa como ETag, y agrega ?v=<hash> a las
+# referencias locales para que el navegador pueda cachearlas como inmutables.
+#
+# También se puede ejecutar a mano: python scripts/build_web_assets.py
+# Con --check verifica el minificador sobre casos con literales de varias
+# líneas y sobre data/ (cada template literal queda igual) y termina.
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MINIFY_EXTENSIONS = (".html", ".htm", ".js", ".css")
+MANIFEST_NAME = "assets.manifest"
+HASH_LENGTH = 8
+
+# Bloques cuyo contenido no se toca al minificar
+PRESERVE_RE = re.compile(r"(<(pre|textarea)\b.*?</\2>)", re.IGNORECASE | re.DOTALL)
+HTML_COMMENT_RE = re.compile(r"<!--(?!\[if).*?-->", re.DOTALL)
+CSS_COMMENT_RE = re.compile(r"/\*.*?\*/", re.DOTALL)
+
+
+def literal_line_ends(text):
+    # Para cada línea, True si termina dentro de un literal de JavaScript que
+    # sigue en la línea siguiente: un template literal (`...`) o una cadena
+    # continuada con '\'. Las cadenas comunes y las regex terminan con la
+    # línea, así un apóstrofo suelto en texto HTML no afecta al resto.
+    ends = []
+    stack = []      # "`" template abierto, "{" llave o ${...} abierto
+    quote = None    # ' o " abierta
+    comment = None  # "//" o "/*"
+    prev = ""       # último carácter significativo fuera de literales
+    i, n = 0, len(text)
+    while i < n:
+        c = text[i]
+        nxt = text[i + 1] if i + 1 < n else ""
+        in_template = bool(stack) and stack[-1] == "`"
+
+        if c == "\n":
+            if comment == "//":
+                comment = None
+            quote = None
+            ends.append(in_template)
+        elif comment:
+            if comment == "/*" and c == "*" and nxt == "/":
+                comment = None
+                i += 1
+        elif (quote or in_template) and c == "\\":
+            # Escape: '\' + salto de línea continúa la cadena o el template
+            if nxt == "\n":
+                ends.append(True)
+            i += 1
+        elif quote:
+            if c == quote:
+                quote = None
+        elif in_template:
+            if c == "`":
+                stack.pop()
+            elif c == "$" and nxt == "{":
+                stack.append("{")
+                i += 1
+        elif c in "'\"":
+            quote = c
+        elif c == "`":
+            stack.append("`")
+        elif c == "{":
+            stack.append("{")
+        elif c == "}":
+            if stack:
+                stack.pop()
+        elif c == "/" and nxt in "/*":
+            comment = "/" + nxt
+            i += 1
+        elif c == "/" and (prev == "" or prev in "(,=:[!&|?{};+-*%<>~^"):
+            # Regex literal: hasta la '/' de cierre fuera de [...]
+            in_class = False
+            i += 1
+            while i < n and text[i] != "\n":
+                if text[i] == "\\":
+                    i += 1
+                elif text[i] == "[":
+                    in_class = True
+                elif text[i] == "]":
+                    in_class = False
+                elif text[i] == "/" and not in_class:
+                    break
+                i += 1
+            if i >= n or text[i] == "\n":
+                continue
+        if not comment and not quote and not in_template and not c.isspace():
+            prev = c
+        i += 1
+    return ends
+
+
+def minify_lines(text, js=False):
+    # Conservador: quita indentación y líneas vacías pero respeta los saltos
+    # de línea, así no cambia la inserción automática de ';' en JavaScript.
+    # Con js=True, el contenido de los literales que ocupan varias líneas
+    # (template literals, cadenas con '\' al final) se copia tal cual.
+    lines = text.replace("\r\n", "\n").split("\n")
+    ends = literal_line_ends(text.replace("\r\n", "\n")) if js else []
+    out = []
+    for i, line in enumerate(lines):
+        starts_inside = i > 0 and i - 1 < len(ends) and ends[i - 1]
+        ends_inside = i < len(ends) and ends[i]
+        if starts_inside and ends_inside:
+            out.append(line)
+        elif starts_inside:
+            out.append(line.rstrip())
+        elif ends_inside:
+            out.append(line.lstrip())
+        elif line.strip():
+            out.append(line.strip())
+    return "\n".join(out)
+
+
+def minify(name, text):
+    if name.endswith(".css"):
+        return minify_lines(CSS_COMMENT_RE.sub("", text))
+    if name.endswith(".js"):
+        return minify_lines(text, js=True)
+
+    text = HTML_COMMENT_RE.sub("", text)
+    parts = PRESERVE_RE.split(text)
+    # split() intercala: texto, bloque preservado, nombre de etiqueta, texto...
+    out = []
+    for i in range(0, len(parts), 3):
+        out.append(minify_lines(parts[i], js=True))
+        if i + 1 < len(parts):
+            out.append(parts[i + 1])
+    return "\n".join(p for p in out if p)
+
+
+# (entrada, salida esperada) para --check
+MINIFY_CASES = [
+    ("  const a = `\n    x ${ {k:1}.k } `;\n  foo();", "const a = `\n    x ${ {k:1}.k } `;\nfoo();"),
+    ("  const r = /`/g;\n    const t = `\n  keep  \n`;", "const r = /`/g;\nconst t = `\n  keep  \n`;"),
+    ("  var s = 'a\\\n    b';\n   next();", "var s = 'a\\\n    b';\nnext();"),
+    ("  x = `${ `inner\n   y` }\n  z`;\n   w();", "x = `${ `inner\n   y` }\n  z`;\nw();"),
+    ("  // don't\n    const t = `\n  k`;", "// don't\nconst t = `\n  k`;"),
+    ("<p>l'agua</p>\n   <script>\n  let q = `\n   q`;\n  </script>",
+     "<p>l'agua</p>\n<script>\nlet q = `\n   q`;\n</script>"),
+]
+
+
+def check(source_dir):
+    errors = 0
+    for text, expected in MINIFY_CASES:
+        if minify_lines(text, js=True) != expected:
+            print("build_web_assets: minify incorrecto para %r" % text)
+            errors += 1
+
+    # Los template literals de data/ (sin anidar) deben quedar intactos
+    literals = 0
+    for root, _, names in os.walk(source_dir):
+        for name in sorted(names):
+            if not name.endswith(MINIFY_EXTENSIONS):
+                continue
+            with open(os.path.join(root, name), encoding="utf-8") as f:
+                text = f.read().replace("\r\n", "\n")
+            minified = minify(name, text)
+            for match in re.finditer(r"`[^`]*`", text):
+                literals += 1
+                if match.group(0) not in minified:
+                    print("build_web_assets: %s: literal modificado: %.40r" % (name, match.group(0)))
+                    errors += 1
+
+    print("build_web_assets: %d casos, %d template literals, %d errores" % (len(MINIFY_CASES), literals, errors))
+    return errors == 0
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def add_version_params(text, hashes):
+    # src="/push.js" -> src="/push.js?v=1a2b3c4d" (solo recursos locales)
+    def replace(match):
+        attr, quote, path = match.group(1), match.group(2), match.group(3)
+        if path in hashes and not path.endswith((".html", ".htm")):
+            return "%s=%s%s?v=%s%s" % (attr, quote, path, hashes[path], quote)
+        return match.group(0)
+
+    return re.sub(r"\b(src|href)=([\"'])(/[^\"'?#]+)\2", replace, text)
+
+
+def build(source_dir, output_dir):
+    if not os.path.isdir(source_dir):
+        print("build_web_assets: no existe %s" % source_dir)
+        return
+
+    files = []
+    for root, _, names in os.walk(source_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, source_dir).replace(os.sep, "/")
+            files.append((rel, full))
+
+    # Primero los recursos referenciados (JS/CSS/imágenes), luego el HTML que
+    # los referencia con su hash ya calculado
+    contents = {}
+    hashes = {}
+    for rel, full in files:
+        with open(full, "rb") as f:
+            data = f.read()
+        if rel.endswith(MINIFY_EXTENSIONS):
+            data = minify(rel, data.decode("utf-8")).encode("utf-8")
+        contents[rel] = data
+        if not rel.endswith((".html", ".htm")):
+            hashes[rel] = content_hash(data)
+
+    for rel in contents:
+        if rel.endswith((".html", ".htm")):
+            text = add_version_params(contents[rel].decode("utf-8"), hashes)
+            contents[rel] = text.encode("utf-8")
+            hashes[rel] = content_hash(contents[rel])
+
+    if os.path.isdir(output_dir):
+        shutil.rmtree(output_dir)
+    os.makedirs(output_dir)
+
+    total_in = total_out = 0
+    manifest = []
+    for rel, full in files:
+        target = os.path.join(output_dir, rel.lstrip("/")) + ".gz"
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        # mtime=0: el .gz es idéntico entre builds si el contenido no cambia
+        with open(target, "wb") as raw:
+            with gzip.GzipFile(filename="", mode="wb", fileobj=raw, compresslevel=9, mtime=0) as gz:
+                gz.write(contents[rel])
+        total_in += os.path.getsize(full)
+        total_out += os.path.getsize(target)
+        manifest.append("%s %s" % (rel, hashes[rel]))
+
+    with open(os.path.join(output_dir, MANIFEST_NAME), "w") as f:
+        f.write("\n".join(manifest) + "\n")
+
+    print("build_web_assets: %d archivos, %d -> %d bytes" % (len(files), total_in, total_out))
+
+
+try:
+    Import("env")  # noqa: F821 (definido por PlatformIO)
+    project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+    build(os.path.join(project_dir, "data"), env.subst("$PROJECT_DATA_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        here = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        if sys.argv[1:] == ["--check"]:
+            sys.exit(0 if check(os.path.join(here, "data")) else 1)
+        out = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, ".pio", "data_web")
+        build(os.path.join(here, "data"), out)
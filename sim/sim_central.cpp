@@ -0,0 +1,1207 @@
+// =============================
+// Simulación del Nodo Central - Linux (env:native_sim)
+// Sistema de Control de Alumbrado Público
+// =============================
+//
+// Corre los managers del nodo central (Database, Alerts, Scenes, Scheduler,
+// MQTT, Auth) como un proceso POSIX y los somete a carga con miles de
+// luminarias simuladas. Los mensajes pasan por los mismos handlers que usa
+// el firmware (FixtureEvents.cpp). Los --bench-* miden un componente contra
+// la implementación anterior; las pruebas de cada componente están en test/
+// (pio test -e native).
+//
+// Uso:
+//   pio run -e native_sim
+//   .pio/build/native_sim/program [opciones]
+//
+//   --fixtures N   Luminarias simuladas (default 2000 o MAX_LUCES si es
+//                  menor, máximo MAX_LUCES)
+//   --rate N       Mensajes de estado por segundo (default 1000)
+//   --seconds N    Duración de la prueba (default 30)
+//   --broker HOST  Publicar la carga en un broker MQTT real (p.ej. mosquitto
+//                  en 127.0.0.1) y recibirla por MQTTManager. Sin esta opción
+//                  los mensajes se inyectan directamente en los handlers.
+//   --fs DIR       Directorio que hace de LittleFS (default ./sim_fs)
+//   --bench-log N  En lugar de la prueba de carga, mide N llamadas a
+//                  SystemLogger.info() (llamadas/s y asignaciones de heap
+//                  por llamada) y termina
+//   --bench-registry N En lugar de la prueba de carga, carga N luminarias y
+//                  compara buscar por texto de ID en el vector de antes
+//                  (recorrido lineal comparando String) contra
+//                  LuminariaRegistry::find(parseId()), verifica que los IDs
+//                  no canónicos se rechacen y termina
+//   --bench-auth N En lugar de la prueba de carga, abre MAX_SESSIONS
+//                  sesiones, pasa N encabezados Authorization (con tokens
+//                  desconocidos y sin prefijo Bearer) por Auth.authorize() y
+//                  por el REQUIRE_AUTH anterior sobre un std::map, verifica
+//                  que decidan lo mismo y termina
+//   --bench-router N En lugar de la prueba de carga, registra las rutas
+//                  /api/ de main.cpp en ApiRouteTable, verifica la ruta y los
+//                  parámetros de cada pedido de prueba, pasa N pedidos de una
+//                  mezcla ponderada por el trie y por la lista lineal de
+//                  handlers de AsyncWebServer y termina
+//   --bench-ring N En lugar de la prueba de carga, pasa N elementos por
+//                  SpscRingBuffer entre dos hilos verificando orden e
+//                  integridad, compara su throughput con CircularBuffer
+//                  y termina
+//   --bench-encodings N En lugar de la prueba de carga, carga N luminarias
+//                  y mide por formato (JSON, MessagePack, CBOR) el tamaño de
+//                  /estado-luces y el throughput de RecordStream leyendo de a
+//                  un segmento TCP; termina
+//   --bench-fade N En lugar de la prueba de carga, hace un fade de 0 a 100
+//                  sobre N luminarias con un reloj falso y mide el costo
+//                  por tick de la tabla densa de brillo (TransitionEngine
+//                  sobre Brightness) contra el mismo tick con mapas por
+//                  String como antes; termina
+//   --preview-effect N En lugar de la prueba de carga, compila los efectos
+//                  onda, aleatorio, secuencia, estroboscópico, arcoíris y
+//                  pulsación sobre N luminarias, los reproduce con un reloj falso,
+//                  imprime por efecto su tamaño, el costo por tick, las
+//                  asignaciones durante la reproducción y una vista previa
+//                  de las primeras luminarias (un dígito 0-9 por nivel),
+//                  verifica el nivel final y termina
+
+#include <Arduino.h>
+#include <new>
+#include <thread>
+#include <vector>
+#include <PubSubClient.h>
+#include <ArduinoJson.h>
+#include "hal/Platform.h"
+#include "config.h"
+#include "Logger.h"
+#include "AuthManager.h"
+#include "DatabaseManager.h"
+#include "ScheduleManager.h"
+#include "AlertManager.h"
+#include "MQTTManager.h"
+#include "SceneManager.h"
+#include "LuminariaRegistry.h"
+#include "FixtureEvents.h"
+#include "ApiRouteTable.h"
+#include "DeferredQueue.h"
+#include "RecordStream.h"
+#include "MaintenanceEngine.h"
+#include "TransitionEngine.h"
+#include "DimmingOutput.h"
+#include <CircularBuffer.h>
+#include <SpscRingBuffer.h>
+
+#define SIM_TELEMETRY_EVERY 10  // 1 de cada N mensajes es telemetría
+#define SIM_ALERT_EVERY 500     // 1 de cada N mensajes es una alerta del nodo
+#define SIM_REPORT_INTERVAL 5000
+#define SIM_RING_SIZE 64        // Capacidad de las colas en --bench-ring
+#define SIM_RING_BATCH 16       // Elementos por pushN/popN
+#define SIM_ENCODING_ROUNDS 20  // Repeticiones por formato en --bench-encodings
+#define SIM_STREAM_CHUNK 1436   // Fragmento que pide AsyncWebServer (un segmento TCP)
+
+// Parámetros de la prueba
+uint16_t simFixtures = MAX_LUCES < 2000 ? MAX_LUCES : 2000;
+uint32_t simRate = 1000;
+uint32_t simSeconds = 30;
+const char* simBroker = nullptr;
+uint32_t simBenchLog = 0;
+uint32_t simBenchRegistry = 0;
+uint32_t simBenchAuth = 0;
+uint32_t simBenchRouter = 0;
+uint32_t simBenchRing = 0;
+uint32_t simBenchFade = 0;
+uint32_t simPreviewEffect = 0;
+uint32_t simBenchEncodings = 0;
+
+// Generador de carga por red (solo con --broker)
+WiFiClient generatorClient;
+PubSubClient generator(generatorClient);
+
+// Estadísticas
+uint32_t messagesSent = 0;
+uint32_t messagesHandled = 0;
+uint64_t handlerMicros = 0;
+uint32_t handlerMaxMicros = 0;
+uint32_t loopCount = 0;
+uint64_t loopMicros = 0;
+uint32_t loopMaxMicros = 0;
+
+// Contador de asignaciones de heap del proceso (String usa operator new).
+// Fuera de línea: con el inlining el compilador vería malloc() en un lado y
+// operator delete del otro, o new en un lado y free() del otro
+uint32_t heapAllocations = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+  heapAllocations++;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+// =============================
+// GENERACIÓN DE CARGA
+// =============================
+void buildMessage(uint32_t n, String& topic, String& payload) {
+  uint16_t pos = n % Luminarias.size();
+  String nodeId = LuminariaRegistry::formatId(Luminarias.getId(pos));
+
+  StaticJsonDocument<256> doc;
+  doc["nodeId"] = nodeId;
+
+  if (n % SIM_ALERT_EVERY == SIM_ALERT_EVERY - 1) {
+    topic = "luces/alert/" + nodeId;
+    doc["type"] = "LAMP_FAILURE";
+    doc["message"] = "Falla simulada";
+  } else if (n % SIM_TELEMETRY_EVERY == SIM_TELEMETRY_EVERY - 1) {
+    topic = "luces/telemetry/" + nodeId;
+    doc["power"]["watts"] = 40 + random(0, 30);
+  } else {
+    topic = "luces/status/" + nodeId;
+    doc["online"] = random(0, 100) < 98;
+    doc["light"] = random(0, 2) == 1;
+  }
+
+  payload = "";
+  serializeJson(doc, payload);
+}
+
+void dispatchDirect(const String& topic, const String& payload) {
+  unsigned long start = micros();
+  if (topic.startsWith("luces/status/")) onFixtureStatus(topic, payload);
+  else if (topic.startsWith("luces/telemetry/")) onFixtureTelemetry(topic, payload);
+  else onFixtureAlert(topic, payload);
+  uint32_t elapsed = micros() - start;
+
+  handlerMicros += elapsed;
+  if (elapsed > handlerMaxMicros) handlerMaxMicros = elapsed;
+  messagesHandled++;
+}
+
+void generateLoad(unsigned long elapsedMs) {
+  // Mensajes que deberían haberse enviado hasta ahora según la tasa
+  uint32_t target = (uint64_t)elapsedMs * simRate / 1000;
+  String topic, payload;
+  while (messagesSent < target) {
+    buildMessage(messagesSent, topic, payload);
+    if (simBroker) {
+      if (!generator.publish(topic.c_str(), payload.c_str())) break;
+    } else {
+      dispatchDirect(topic, payload);
+    }
+    messagesSent++;
+  }
+}
+
+// =============================
+// SETUP
+// =============================
+bool parseArgs(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--fixtures") == 0 && hasValue) simFixtures = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--rate") == 0 && hasValue) simRate = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seconds") == 0 && hasValue) simSeconds = atol(argv[++i]);
+    else if (strcmp(argv[i], "--broker") == 0 && hasValue) simBroker = argv[++i];
+    else if (strcmp(argv[i], "--fs") == 0 && hasValue) LittleFS.setRoot(argv[++i]);
+    else if (strcmp(argv[i], "--bench-log") == 0 && hasValue) simBenchLog = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-registry") == 0 && hasValue) simBenchRegistry = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-auth") == 0 && hasValue) simBenchAuth = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-router") == 0 && hasValue) simBenchRouter = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-ring") == 0 && hasValue) simBenchRing = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-fade") == 0 && hasValue) simBenchFade = atol(argv[++i]);
+    else if (strcmp(argv[i], "--preview-effect") == 0 && hasValue) simPreviewEffect = atol(argv[++i]);
+    else if (strcmp(argv[i], "--bench-encodings") == 0 && hasValue) simBenchEncodings = atol(argv[++i]);
+    else {
+      Serial.printf("Opción desconocida: %s\n", argv[i]);
+      return false;
+    }
+  }
+  if (simFixtures == 0 || simFixtures > MAX_LUCES) {
+    Serial.printf("--fixtures debe estar entre 1 y %d\n", MAX_LUCES);
+    return false;
+  }
+  return true;
+}
+
+void setupFixtures() {
+  const char* zonas[] = {"zona_centro", "zona_norte", "zona_sur", "zona_este", "zona_oeste"};
+  for (uint16_t i = 0; i < simFixtures; i++) {
+    uint16_t pos = Luminarias.insert(0x5100000 + i);
+    if (pos == REGISTRY_NOT_FOUND) break;
+    Luminarias.setPosicion(pos, DEFAULT_LAT + (random(-500, 500) / 10000.0),
+                                DEFAULT_LNG + (random(-500, 500) / 10000.0));
+    Luminarias.setEstado(pos, ESTADO_APAGADA);
+    Luminarias.setZona(pos, Luminarias.internZone(zonas[i % 5]));
+    Luminarias.setDimeable(pos, true);
+  }
+  SystemLogger.info("Luminarias simuladas: " + String(Luminarias.size()), "SIM");
+}
+
+bool setupMQTT() {
+  MQTT.setNodeInfo("CENTRAL_SIM_" + String(ESP.getChipId()), NODE_CENTRAL);
+  MQTT.enableAutoDiscovery(false);
+  if (!MQTT.begin(simBroker, MQTT_BROKER_PORT)) {
+    SystemLogger.error("No se pudo conectar al broker " + String(simBroker), "SIM");
+    return false;
+  }
+
+  generator.setServer(simBroker, MQTT_BROKER_PORT);
+  generator.setBufferSize(MQTT_MAX_PACKET_SIZE);
+  String id = "SIM_GEN_" + String(ESP.getChipId());
+  if (!generator.connect(id.c_str())) {
+    SystemLogger.error("El generador no pudo conectar al broker", "SIM");
+    return false;
+  }
+  return true;
+}
+
+// =============================
+// BENCHMARK DEL REGISTRO
+// =============================
+
+// Luminaria como la guardaba main.cpp antes de LuminariaRegistry
+struct LegacyLuminaria {
+  float lat;
+  float lng;
+  String estado;
+  uint32_t ultimaActualizacion;
+  uint8_t intensidad;
+  String id;
+  String zona;
+  bool dimeable;
+};
+
+void benchRegistry() {
+  uint16_t count = min(simBenchRegistry, (uint32_t)MAX_LUCES);
+  Luminarias.clear();
+  std::vector<LegacyLuminaria> legacy;
+  legacy.reserve(count);
+  for (uint16_t i = 0; i < count; i++) {
+    // IDs dispersos, como los que salen del chip ID o de lat ^ lng
+    uint32_t id = (0x5100000 + i) * 2654435761u;
+    if (Luminarias.insert(id) == REGISTRY_NOT_FOUND) break;
+    LegacyLuminaria luz;
+    luz.id = LuminariaRegistry::formatId(id);
+    luz.estado = "apagada";
+    luz.zona = "zona_centro";
+    legacy.push_back(luz);
+  }
+
+  // Mismas consultas para los dos: texto del ID como llega por MQTT/HTTP,
+  // 1 de cada 10 de una luminaria que no existe
+  uint32_t lookups = max(count * 20, 20000);
+  std::vector<String> queries;
+  for (uint32_t i = 0; i < lookups; i++) {
+    bool missing = i % 10 == 9;
+    uint32_t id = missing ? 0xA0000000u + i : Luminarias.getId(random(0, count));
+    queries.push_back(LuminariaRegistry::formatId(id));
+  }
+
+  uint32_t errors = 0;
+  uint32_t legacyFound = 0;
+  unsigned long start = micros();
+  for (const String& query : queries) {
+    for (size_t i = 0; i < legacy.size(); i++) {
+      if (legacy[i].id == query) {
+        legacyFound++;
+        break;
+      }
+    }
+  }
+  uint32_t legacyMicros = micros() - start;
+
+  uint32_t registryFound = 0;
+  uint32_t allocsBefore = heapAllocations;
+  start = micros();
+  for (const String& query : queries) {
+    if (Luminarias.find(LuminariaRegistry::parseId(query)) != REGISTRY_NOT_FOUND) registryFound++;
+  }
+  uint32_t registryMicros = micros() - start;
+  uint32_t registryAllocs = heapAllocations - allocsBefore;
+  if (legacyFound != registryFound) errors++;
+
+  // Cada ID entra y sale como el mismo texto; los no canónicos se rechazan
+  for (uint16_t i = 0; i < count; i++) {
+    if (LuminariaRegistry::parseId(legacy[i].id) != Luminarias.getId(i)) errors++;
+  }
+  const char* nonCanonical[] = {"LUM_1234567", "LUM_12345678_", "LUM_abcdef01", "LUM_ABCDEF0", "lum_ABCDEF01",
+                                "LUM_FFFFFFFF", "", "LUM_"};
+  uint32_t rejected = 0;
+  for (const char* text : nonCanonical) {
+    uint32_t id = LuminariaRegistry::parseId(text);
+    if (id == LUMINARIA_ID_INVALID && Luminarias.insert(id) == REGISTRY_NOT_FOUND) rejected++;
+  }
+  if (rejected != sizeof(nonCanonical) / sizeof(nonCanonical[0])) errors++;
+
+  StaticJsonDocument<512> doc;
+  doc["fixtures"] = count;
+  doc["lookups"] = lookups;
+  doc["found"] = registryFound;
+  doc["legacy_ns_per_lookup"] = (float)legacyMicros * 1000 / lookups;
+  doc["registry_ns_per_lookup"] = (float)registryMicros * 1000 / lookups;
+  doc["speedup"] = registryMicros ? (float)legacyMicros / registryMicros : 0;
+  doc["registry_allocs"] = registryAllocs;
+  doc["registry_bytes"] = Luminarias.getMemoryFootprint();
+  doc["non_canonical_rejected"] = rejected;
+  doc["errors"] = errors;
+  doc["ok"] = errors == 0 && registryAllocs == 0;
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// BENCHMARK DE AUTORIZACIÓN
+// =============================
+
+// Sesión como la guardaba AuthManager antes de la tabla por hash
+struct LegacySession {
+  String username;
+  UserRole role;
+  uint32_t lastActivity;
+  bool valid;
+};
+
+// REQUIRE_AUTH anterior: copia del encabezado, replace() y tres búsquedas
+// en el mapa (count, operator[] del rol, operator[] de la actividad)
+bool legacyAuthorize(std::map<String, LegacySession>& sessions, const String& header, UserRole role) {
+  String token = header;
+  token.replace("Bearer ", "");
+  if (!sessions.count(token)) return false;
+  LegacySession& session = sessions[token];
+  if (millis() - session.lastActivity > SESSION_TIMEOUT || !session.valid) return false;
+  if (session.role < role) return false;
+  if (sessions.count(token)) sessions[token].lastActivity = millis();
+  return true;
+}
+
+void benchAuth() {
+  Auth.begin();
+  const char* users[][2] = {{"admin", "admin123"}, {"operator", "oper123"}, {"viewer", "view123"}};
+  const UserRole roles[] = {ROLE_ADMIN, ROLE_OPERATOR, ROLE_VIEWER};
+  std::vector<String> tokens;
+  std::map<String, LegacySession> legacy;
+  for (uint8_t i = 0; i < MAX_SESSIONS; i++) {
+    String token = Auth.login(users[i % 3][0], users[i % 3][1], "10.0.0." + String(i));
+    if (token.length() == 0) break;
+    tokens.push_back(token);
+    LegacySession& session = legacy[token];
+    session.username = users[i % 3][0];
+    session.role = roles[i % 3];
+    session.lastActivity = millis();
+    session.valid = true;
+  }
+  uint32_t errors = tokens.size() == MAX_SESSIONS ? 0 : 1;
+  if (tokens.empty()) tokens.push_back("sin_sesion");
+
+  // Mezcla de encabezados: "Bearer <token>" con el rol que pide cada ruta,
+  // 1 de cada 10 con un token desconocido y 1 de cada 20 sin el prefijo
+  std::vector<String> headers;
+  std::vector<UserRole> required;
+  for (uint32_t i = 0; i < simBenchAuth; i++) {
+    String token = tokens[random(0, tokens.size())];
+    if (i % 10 == 9) token = token.substring(0, TOKEN_LENGTH) + "_x";
+    headers.push_back(i % 20 == 7 ? token : "Bearer " + token);
+    required.push_back((UserRole)random(ROLE_VIEWER, ROLE_ADMIN + 1));
+  }
+
+  uint32_t legacyAllowed = 0;
+  uint32_t allocsBefore = heapAllocations;
+  unsigned long start = micros();
+  for (uint32_t i = 0; i < simBenchAuth; i++) {
+    if (legacyAuthorize(legacy, headers[i], required[i])) legacyAllowed++;
+  }
+  uint32_t legacyMicros = micros() - start;
+  uint32_t legacyAllocs = heapAllocations - allocsBefore;
+
+  uint32_t allowed = 0;
+  allocsBefore = heapAllocations;
+  start = micros();
+  for (uint32_t i = 0; i < simBenchAuth; i++) {
+    if (Auth.authorize(headers[i].c_str(), required[i])) allowed++;
+  }
+  uint32_t authMicros = micros() - start;
+  uint32_t authAllocs = heapAllocations - allocsBefore;
+
+  // Misma decisión para cada encabezado, y una sesión cerrada ya no autoriza
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < simBenchAuth && i < 10000; i++) {
+    if (Auth.authorize(headers[i].c_str(), required[i]) != legacyAuthorize(legacy, headers[i], required[i])) mismatches++;
+  }
+  if (mismatches || allowed != legacyAllowed) errors++;
+  String closed = "Bearer " + tokens[0];
+  Auth.logout(tokens[0]);
+  if (Auth.authorize(closed.c_str(), ROLE_VIEWER) || Auth.authorize("", ROLE_VIEWER)) errors++;
+
+  StaticJsonDocument<512> doc;
+  doc["sessions"] = tokens.size();
+  doc["requests"] = simBenchAuth;
+  doc["allowed"] = allowed;
+  doc["legacy_ns_per_request"] = simBenchAuth ? (float)legacyMicros * 1000 / simBenchAuth : 0;
+  doc["auth_ns_per_request"] = simBenchAuth ? (float)authMicros * 1000 / simBenchAuth : 0;
+  doc["speedup"] = authMicros ? (float)legacyMicros / authMicros : 0;
+  doc["legacy_allocs_per_request"] = simBenchAuth ? (float)legacyAllocs / simBenchAuth : 0;
+  doc["auth_allocs"] = authAllocs;
+  doc["mismatches"] = mismatches;
+  doc["errors"] = errors;
+  doc["ok"] = errors == 0 && authAllocs == 0;
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// BENCHMARK DEL ENRUTADOR /api/
+// =============================
+
+// Mismos bits que WebRequestMethod de ESPAsyncWebServer
+#define SIM_HTTP_GET 0x01
+#define SIM_HTTP_POST 0x02
+#define SIM_HTTP_DELETE 0x04
+
+struct SimApiRoute {
+  const char* pattern;  // Como se registra en ApiRouter (main.cpp)
+  const char* legacy;   // Como lo resolvía server.on(): :id pasa a ser un prefijo
+  uint8_t method;
+};
+
+// Rutas de main.cpp, en el mismo orden
+const SimApiRoute simApiRoutes[] = {
+  {"/api/auth/login", "/api/auth/login", SIM_HTTP_POST},
+  {"/api/auth/logout", "/api/auth/logout", SIM_HTTP_POST},
+  {"/api/auth/validate", "/api/auth/validate", SIM_HTTP_GET},
+  {"/api/system/info", "/api/system/info", SIM_HTTP_GET},
+  {"/api/system/restart", "/api/system/restart", SIM_HTTP_POST},
+  {"/api/admin/users", "/api/admin/users", SIM_HTTP_GET},
+  {"/api/admin/users/add", "/api/admin/users/add", SIM_HTTP_POST},
+  {"/api/admin/sessions", "/api/admin/sessions", SIM_HTTP_GET},
+  {"/api/admin/security/stats", "/api/admin/security/stats", SIM_HTTP_GET},
+  {"/api/admin/backup", "/api/admin/backup", SIM_HTTP_POST},
+  {"/api/admin/restore", "/api/admin/restore", SIM_HTTP_POST},
+  {"/api/wifi/stats", "/api/wifi/stats", SIM_HTTP_GET},
+  {"/api/memory/stats", "/api/memory/stats", SIM_HTTP_GET},
+  {"/api/logs/recent", "/api/logs/recent", SIM_HTTP_GET},
+  {"/api/logs/query", "/api/logs/query", SIM_HTTP_GET},
+  {"/api/schedules", "/api/schedules", SIM_HTTP_GET},
+  {"/api/schedules/add", "/api/schedules/add", SIM_HTTP_POST},
+  {"/api/schedules/:id/enable", "/api/schedules/*", SIM_HTTP_POST},
+  {"/api/schedules/:id", "/api/schedules/*", SIM_HTTP_DELETE},
+  {"/api/zones", "/api/zones", SIM_HTTP_GET},
+  {"/api/zones/add", "/api/zones/add", SIM_HTTP_POST},
+  {"/api/alerts", "/api/alerts", SIM_HTTP_GET},
+  {"/api/alerts/:id/acknowledge", "/api/alerts/*", SIM_HTTP_POST},
+  {"/api/events", "/api/events", SIM_HTTP_GET},
+  {"/api/consumption/stats", "/api/consumption/stats", SIM_HTTP_GET},
+  {"/api/consumption/history", "/api/consumption/history", SIM_HTTP_GET},
+  {"/api/export/*", "/api/export/*", SIM_HTTP_GET},
+  {"/api/scenes", "/api/scenes", SIM_HTTP_GET},
+  {"/api/scenes/activate", "/api/scenes/activate", SIM_HTTP_POST},
+  {"/api/scenes/preset", "/api/scenes/preset", SIM_HTTP_POST},
+  {"/api/dimming", "/api/dimming", SIM_HTTP_POST},
+  {"/api/zones/control", "/api/zones/control", SIM_HTTP_POST},
+  {"/api/zones/visual", "/api/zones/visual", SIM_HTTP_GET},
+  {"/api/effects", "/api/effects", SIM_HTTP_POST},
+};
+const uint8_t simApiRouteCount = sizeof(simApiRoutes) / sizeof(simApiRoutes[0]);
+
+struct SimApiRequest {
+  const char* url;
+  uint8_t method;
+  uint8_t weight;       // Frecuencia relativa en la mezcla
+  int8_t route;         // Índice en simApiRoutes (-1 = 404)
+  uint32_t id;
+  const char* tail;
+};
+
+// Mezcla de un panel abierto: consultas periódicas, control de luces y
+// algunas rutas con parámetros o inexistentes
+const SimApiRequest simApiRequests[] = {
+  {"/api/system/info", SIM_HTTP_GET, 15, 3, 0, nullptr},
+  {"/api/auth/validate", SIM_HTTP_GET, 10, 2, 0, nullptr},
+  {"/api/zones/visual", SIM_HTTP_GET, 10, 32, 0, nullptr},
+  {"/api/events", SIM_HTTP_GET, 10, 23, 0, nullptr},
+  {"/api/alerts", SIM_HTTP_GET, 10, 21, 0, nullptr},
+  {"/api/dimming", SIM_HTTP_POST, 10, 30, 0, nullptr},
+  {"/api/zones/control", SIM_HTTP_POST, 5, 31, 0, nullptr},
+  {"/api/consumption/stats", SIM_HTTP_GET, 5, 24, 0, nullptr},
+  {"/api/consumption/history", SIM_HTTP_GET, 3, 25, 0, nullptr},
+  {"/api/scenes/activate", SIM_HTTP_POST, 3, 28, 0, nullptr},
+  {"/api/effects", SIM_HTTP_POST, 2, 33, 0, nullptr},
+  {"/api/memory/stats", SIM_HTTP_GET, 3, 12, 0, nullptr},
+  {"/api/wifi/stats", SIM_HTTP_GET, 2, 11, 0, nullptr},
+  {"/api/logs/recent", SIM_HTTP_GET, 2, 13, 0, nullptr},
+  {"/api/export/events.csv", SIM_HTTP_GET, 3, 26, 0, "events.csv"},
+  {"/api/schedules/12/enable", SIM_HTTP_POST, 3, 17, 12, nullptr},
+  {"/api/schedules/4294967295", SIM_HTTP_DELETE, 1, 18, 4294967295UL, nullptr},
+  {"/api/alerts/345/acknowledge", SIM_HTTP_POST, 3, 22, 345, nullptr},
+  {"/api/schedules/add", SIM_HTTP_POST, 1, 16, 0, nullptr},
+  {"/api/nope", SIM_HTTP_GET, 1, -1, 0, nullptr},
+  {"/api/schedules/4294967296", SIM_HTTP_DELETE, 1, -1, 0, nullptr},
+  {"/api/schedules/12/enable", SIM_HTTP_GET, 1, -1, 0, nullptr},
+};
+const uint8_t simApiRequestCount = sizeof(simApiRequests) / sizeof(simApiRequests[0]);
+
+// AsyncCallbackWebHandler::canHandle() de ESPAsyncWebServer: "*" al final
+// es un prefijo; si no, la URL exacta o algo debajo de "uri/"
+bool legacyCanHandle(const String& uri, uint8_t methods, const String& url, uint8_t method) {
+  if (!(methods & method)) return false;
+  if (uri.length() && uri.endsWith("*")) {
+    String uriTemplate = String(uri);
+    uriTemplate = uriTemplate.substring(0, uriTemplate.length() - 1);
+    if (!url.startsWith(uriTemplate)) return false;
+  } else if (uri.length() && (uri != url && !url.startsWith(uri + "/"))) {
+    return false;
+  }
+  return true;
+}
+
+void benchRouter() {
+  ApiRouteTable table;
+  std::vector<String> legacyUris;
+  uint32_t errors = 0;
+  for (uint8_t r = 0; r < simApiRouteCount; r++) {
+    if (table.add(simApiRoutes[r].pattern, simApiRoutes[r].method) != r) errors++;
+    legacyUris.push_back(simApiRoutes[r].legacy);
+  }
+  // Patrones inválidos: fuera de /api/, "*" con segmentos después, vacío
+  if (table.add("/otra/ruta", SIM_HTTP_GET) != API_NONE ||
+      table.add("/api/export/*/x", SIM_HTTP_GET) != API_NONE ||
+      table.add("/api//x", SIM_HTTP_GET) != API_NONE) errors++;
+
+  // Cada pedido resuelve a la ruta esperada con sus parámetros
+  uint32_t mismatches = 0;
+  for (uint8_t i = 0; i < simApiRequestCount; i++) {
+    const SimApiRequest& req = simApiRequests[i];
+    ApiMatch match;
+    bool found = table.match(req.url, req.method, match);
+    bool ok = found ? req.route == match.route && match.id == req.id : req.route < 0;
+    if (ok && found && req.tail) {
+      ok = match.tailLength == strlen(req.tail) && memcmp(req.url + match.tailOffset, req.tail, match.tailLength) == 0;
+    }
+    if (!ok) mismatches++;
+  }
+  if (mismatches) errors++;
+
+  // Mezcla ponderada; url() de AsyncWebServerRequest ya es un String
+  std::vector<String> urls;
+  std::vector<uint8_t> methods;
+  std::vector<int8_t> expected;
+  uint16_t totalWeight = 0;
+  for (uint8_t i = 0; i < simApiRequestCount; i++) totalWeight += simApiRequests[i].weight;
+  for (uint32_t n = 0; n < simBenchRouter; n++) {
+    int32_t pick = random(0, totalWeight);
+    uint8_t i = 0;
+    while (pick >= simApiRequests[i].weight) pick -= simApiRequests[i++].weight;
+    urls.push_back(simApiRequests[i].url);
+    methods.push_back(simApiRequests[i].method);
+    expected.push_back(simApiRequests[i].route);
+  }
+
+  // Lista lineal: primer handler que acepte el pedido, en orden de registro
+  uint32_t legacyFound = 0;
+  uint32_t legacyChecks = 0;
+  uint32_t allocsBefore = heapAllocations;
+  unsigned long start = micros();
+  for (uint32_t n = 0; n < simBenchRouter; n++) {
+    for (uint8_t r = 0; r < simApiRouteCount; r++) {
+      legacyChecks++;
+      if (legacyCanHandle(legacyUris[r], simApiRoutes[r].method, urls[n], methods[n])) {
+        legacyFound++;
+        break;
+      }
+    }
+  }
+  uint32_t legacyMicros = micros() - start;
+  uint32_t legacyAllocs = heapAllocations - allocsBefore;
+
+  uint32_t trieFound = 0;
+  uint32_t trieWrong = 0;
+  allocsBefore = heapAllocations;
+  start = micros();
+  for (uint32_t n = 0; n < simBenchRouter; n++) {
+    ApiMatch match;
+    if (table.match(urls[n].c_str(), methods[n], match)) {
+      trieFound++;
+      if (match.route != expected[n]) trieWrong++;
+    } else if (expected[n] >= 0) {
+      trieWrong++;
+    }
+  }
+  uint32_t trieMicros = micros() - start;
+  uint32_t trieAllocs = heapAllocations - allocsBefore;
+  if (trieWrong) errors++;
+
+  StaticJsonDocument<768> doc;
+  doc["routes"] = table.getRouteCount();
+  doc["nodes"] = table.getNodeCount();
+  doc["table_bytes"] = sizeof(ApiRouteTable);
+  doc["requests"] = simBenchRouter;
+  doc["found"] = trieFound;
+  // La lista lineal acepta pedidos que el trie rechaza (p. ej. GET de
+  // /api/schedules/12/enable cae en GET /api/schedules por el prefijo "uri/")
+  doc["legacy_found"] = legacyFound;
+  doc["legacy_checks_per_request"] = simBenchRouter ? (float)legacyChecks / simBenchRouter : 0;
+  doc["legacy_ns_per_request"] = simBenchRouter ? (float)legacyMicros * 1000 / simBenchRouter : 0;
+  doc["legacy_allocs_per_request"] = simBenchRouter ? (float)legacyAllocs / simBenchRouter : 0;
+  doc["trie_ns_per_request"] = simBenchRouter ? (float)trieMicros * 1000 / simBenchRouter : 0;
+  doc["trie_allocs"] = trieAllocs;
+  doc["speedup"] = trieMicros ? (float)legacyMicros / trieMicros : 0;
+  doc["mismatches"] = mismatches + trieWrong;
+  doc["errors"] = errors;
+  doc["ok"] = errors == 0 && trieAllocs == 0;
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// BENCHMARK DEL LOGGER
+// =============================
+enum BenchLogMode { BENCH_LITERAL, BENCH_STRING, BENCH_FORMAT, BENCH_FILTERED };
+
+uint32_t benchLogVariant(JsonObject out, BenchLogMode mode) {
+  String id = "LUM_0001";
+  String estado = "encendida";
+  // Tandas de medio ring con flush() entre ellas, fuera de la medición (lo
+  // que hace loop()): con el ring lleno log() escribe a disco y abre segmentos
+  uint32_t allocs = 0;
+  unsigned long elapsed = 0;
+  for (uint32_t batch = 0; batch < simBenchLog; batch += MAX_LOG_ENTRIES / 2) {
+    SystemLogger.flush();
+    uint32_t allocsBefore = heapAllocations;
+    unsigned long start = micros();
+    for (uint32_t i = batch; i < min(simBenchLog, batch + MAX_LOG_ENTRIES / 2); i++) {
+      switch (mode) {
+        case BENCH_LITERAL:
+          SystemLogger.info("Luminaria actualizada", "BENCH");
+          break;
+        case BENCH_STRING:
+          // Estilo anterior: el texto se concatena en cada llamada
+          SystemLogger.info("Luminaria actualizada: " + id + " - " + estado, "BENCH");
+          break;
+        case BENCH_FORMAT:
+          LOGF_INFO("BENCH", "Luminaria actualizada: %s - %s (%u)", id.c_str(), estado.c_str(), i);
+          break;
+        case BENCH_FILTERED:
+          LOGF_DEBUG("BENCH", "Luminaria actualizada: %s - %s (%u)", id.c_str(), estado.c_str(), i);
+          break;
+      }
+    }
+    elapsed += micros() - start;
+    allocs += heapAllocations - allocsBefore;
+  }
+
+  out["calls"] = simBenchLog;
+  out["calls_per_s"] = elapsed ? (float)simBenchLog * 1000000 / elapsed : 0;
+  out["allocs_per_call"] = (float)allocs / simBenchLog;
+  return allocs;
+}
+
+void benchLogger() {
+  StaticJsonDocument<1024> doc;
+  // El registro de tamaño fijo no asigna: solo la concatenación de String
+  uint32_t allocs = benchLogVariant(doc.createNestedObject("literal"), BENCH_LITERAL);
+  benchLogVariant(doc.createNestedObject("string_concat"), BENCH_STRING);
+  allocs += benchLogVariant(doc.createNestedObject("logf"), BENCH_FORMAT);
+  allocs += benchLogVariant(doc.createNestedObject("logf_filtered"), BENCH_FILTERED);
+  SystemLogger.flush();
+  doc["ok"] = allocs == 0 && !doc.overflowed();
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// BENCHMARK DE LAS COLAS
+// =============================
+struct BenchRingItem {
+  uint32_t seq;
+  uint32_t check;  // Derivado de seq: detecta lecturas a medio escribir
+
+  BenchRingItem() : seq(0), check(0) {}
+  explicit BenchRingItem(uint32_t n) : seq(n), check(n * 2654435761u) {}
+};
+
+// Un solo hilo, lotes de SIM_RING_BATCH: costo de la cola sin contención
+void benchRingSingle(JsonObject out) {
+  CircularBuffer<BenchRingItem, SIM_RING_SIZE> circular;
+  SpscRingBuffer<BenchRingItem, SIM_RING_SIZE> spsc;
+  BenchRingItem batch[SIM_RING_BATCH];
+  uint32_t sum = 0;
+
+  unsigned long start = micros();
+  for (uint32_t i = 0; i < simBenchRing; i += SIM_RING_BATCH) {
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) circular.push(BenchRingItem(i + j));
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) sum += circular.shift().seq;
+  }
+  unsigned long circularUs = micros() - start;
+
+  start = micros();
+  for (uint32_t i = 0; i < simBenchRing; i += SIM_RING_BATCH) {
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) spsc.emplace(i + j);
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) {
+      spsc.pop(batch[j]);
+      sum += batch[j].seq;
+    }
+  }
+  unsigned long spscUs = micros() - start;
+
+  start = micros();
+  for (uint32_t i = 0; i < simBenchRing; i += SIM_RING_BATCH) {
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) batch[j] = BenchRingItem(i + j);
+    spsc.pushN(batch, SIM_RING_BATCH);
+    spsc.popN(batch, SIM_RING_BATCH);
+    for (uint32_t j = 0; j < SIM_RING_BATCH; j++) sum += batch[j].seq;
+  }
+  unsigned long batchUs = micros() - start;
+
+  out["circular_ops_per_s"] = circularUs ? (float)simBenchRing * 1000000 / circularUs : 0;
+  out["spsc_ops_per_s"] = spscUs ? (float)simBenchRing * 1000000 / spscUs : 0;
+  out["spsc_batch_ops_per_s"] = batchUs ? (float)simBenchRing * 1000000 / batchUs : 0;
+  out["checksum"] = sum;  // Evita que el compilador descarte los bucles
+}
+
+// Productor y consumidor en hilos distintos (como Ticker/ISR y loop());
+// alternan push/emplace/pushN y pop/popN y el consumidor verifica la secuencia
+void benchRingThreads(JsonObject out) {
+  static SpscRingBuffer<BenchRingItem, SIM_RING_SIZE> ring;
+  uint32_t errors = 0;
+  uint32_t received = 0;
+
+  unsigned long start = micros();
+  std::thread producer([]() {
+    BenchRingItem batch[SIM_RING_BATCH];
+    uint32_t n = 0;
+    while (n < simBenchRing) {
+      size_t sent;
+      if (n % 3 == 0) {
+        sent = ring.push(BenchRingItem(n)) ? 1 : 0;
+      } else if (n % 3 == 1) {
+        sent = ring.emplace(n) ? 1 : 0;
+      } else {
+        size_t count = min((uint32_t)SIM_RING_BATCH, simBenchRing - n);
+        for (size_t j = 0; j < count; j++) batch[j] = BenchRingItem(n + j);
+        sent = ring.pushN(batch, count);
+      }
+      if (sent == 0) std::this_thread::yield();
+      n += sent;
+    }
+  });
+
+  BenchRingItem batch[SIM_RING_BATCH];
+  while (received < simBenchRing) {
+    size_t count = (received & 1) ? ring.popN(batch, SIM_RING_BATCH) : (ring.pop(batch[0]) ? 1 : 0);
+    if (count == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t j = 0; j < count; j++) {
+      if (batch[j].seq != received || batch[j].check != received * 2654435761u) errors++;
+      received++;
+    }
+  }
+  producer.join();
+  unsigned long elapsed = micros() - start;
+
+  out["items"] = received;
+  out["errors"] = errors;
+  out["items_per_s"] = elapsed ? (float)received * 1000000 / elapsed : 0;
+  out["ok"] = errors == 0 && ring.isEmpty();
+}
+
+void benchRing() {
+  StaticJsonDocument<512> doc;
+  benchRingSingle(doc.createNestedObject("single_thread"));
+  benchRingThreads(doc.createNestedObject("two_threads"));
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// TAMAÑO Y THROUGHPUT POR FORMATO
+// =============================
+
+// Tamaño y costo de generar /estado-luces en cada formato: bytes totales,
+// por luminaria y relativos a JSON, y el throughput de RecordStream
+void benchEncodings() {
+  simFixtures = min(simBenchEncodings, (uint32_t)MAX_LUCES);
+  setupFixtures();
+  uint16_t count = Luminarias.size();
+  for (uint16_t i = 0; i < count; i++) {
+    Luminarias.setEstado(i, (EstadoLuminaria)(i % 4));
+    Scenes.setLevel(i, i % 101);
+  }
+
+  const StreamFormat formats[] = {STREAM_FORMAT_JSON, STREAM_FORMAT_MSGPACK, STREAM_FORMAT_CBOR};
+  const char* names[] = {"json", "msgpack", "cbor"};
+  StaticJsonDocument<1024> doc;
+  size_t jsonBytes = 0;
+  uint32_t errors = 0;
+  for (uint8_t f = 0; f < 3; f++) {
+    uint8_t chunk[SIM_STREAM_CHUNK];
+    size_t bytes = 0;
+    uint32_t best = UINT32_MAX;
+    uint32_t allocsBefore = heapAllocations;
+    for (uint8_t round = 0; round < SIM_ENCODING_ROUNDS; round++) {
+      RecordStream stream(new LuminariaRecordSource(0), formats[f]);
+      size_t total = 0;
+      unsigned long start = micros();
+      size_t n;
+      while ((n = stream.read(chunk, sizeof(chunk))) > 0) total += n;
+      uint32_t elapsed = micros() - start;
+      if (elapsed < best) best = elapsed;
+      if (stream.getSkippedCount() || (round > 0 && total != bytes)) errors++;
+      bytes = total;
+    }
+    if (formats[f] == STREAM_FORMAT_JSON) jsonBytes = bytes;
+
+    JsonObject result = doc.createNestedObject(names[f]);
+    result["bytes"] = bytes;
+    result["bytes_per_fixture"] = count ? (float)bytes / count : 0;
+    result["vs_json"] = jsonBytes ? (float)bytes / jsonBytes : 0;
+    result["best_us"] = best;
+    result["fixtures_per_s"] = best ? (uint32_t)((uint64_t)count * 1000000 / best) : 0;
+    result["mb_per_s"] = best ? (float)bytes / best : 0;
+    result["allocs_per_stream"] = (float)(heapAllocations - allocsBefore) / SIM_ENCODING_ROUNDS;
+  }
+  doc["fixtures"] = count;
+  doc["rounds"] = SIM_ENCODING_ROUNDS;
+  doc["chunk_bytes"] = SIM_STREAM_CHUNK;
+  doc["errors"] = errors;
+  doc["ok"] = errors == 0;
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// TICK DE FADE SOBRE LA TABLA DENSA
+// =============================
+
+#define SIM_FADE_MS 2000
+
+void benchFade() {
+  simFixtures = min(simBenchFade, (uint32_t)MAX_LUCES);
+  setupFixtures();
+  uint16_t count = Luminarias.size();
+
+  // Tabla densa: fade de 0 a 100 en todas, el promedio como getAverageBrightness()
+  TransitionEngine* engine = new TransitionEngine(Brightness);
+  uint32_t outputs = 0;
+  engine->setOutput([&](uint16_t, uint8_t) { outputs++; });
+  Brightness.fill(count, 0);
+  for (uint16_t i = 0; i < count; i++) engine->start(i, 100, 0, SIM_FADE_MS);
+
+  uint32_t ticks = 0;
+  uint32_t denseMicros = 0;
+  uint32_t denseMax = 0;
+  uint32_t denseAllocs = 0;
+  float average = 0;
+  for (uint32_t t = 0; t <= SIM_FADE_MS; t += TRANSITION_TICK_MS) {
+    uint32_t allocsBefore = heapAllocations;
+    unsigned long start = micros();
+    engine->update(t);
+    average += Brightness.average(count);
+    uint32_t elapsed = micros() - start;
+    denseAllocs += heapAllocations - allocsBefore;
+    denseMicros += elapsed;
+    if (elapsed > denseMax) denseMax = elapsed;
+    ticks++;
+  }
+  uint32_t errors = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (Brightness.getCurrent(i) != 100 || Brightness.getStart(i) != 0 || Brightness.getTarget(i) != 100) errors++;
+  }
+  delete engine;
+
+  // Lo mismo con el estado anterior: mapas por String en SceneManager
+  // (actual, objetivo) y DimmingController (nivel, hora)
+  std::vector<String> ids;
+  std::map<String, uint8_t> currentMap, targetMap, startMap;
+  std::map<String, uint32_t> updateMap;
+  for (uint16_t i = 0; i < count; i++) {
+    String id = LuminariaRegistry::formatId(Luminarias.getId(i));
+    ids.push_back(id);
+    currentMap[id] = 0;
+    startMap[id] = 0;
+    targetMap[id] = 100;
+  }
+  uint32_t mapMicros = 0;
+  uint32_t mapMax = 0;
+  float mapAverage = 0;
+  for (uint32_t t = 0; t <= SIM_FADE_MS; t += TRANSITION_TICK_MS) {
+    unsigned long start = micros();
+    for (const String& id : ids) {
+      int32_t delta = (int32_t)targetMap[id] - startMap[id];
+      uint8_t level = startMap[id] + (int32_t)((int64_t)delta * t / SIM_FADE_MS);
+      if (level != currentMap[id]) {
+        currentMap[id] = level;
+        updateMap[id] = t;
+      }
+    }
+    uint32_t sum = 0;
+    for (const auto& entry : currentMap) sum += entry.second;
+    mapAverage += count ? (float)sum / count : 0;
+    uint32_t elapsed = micros() - start;
+    mapMicros += elapsed;
+    if (elapsed > mapMax) mapMax = elapsed;
+  }
+  for (const String& id : ids) {
+    if (currentMap[id] != 100) errors++;
+  }
+  if (fabs(average - mapAverage) > 0.01f * ticks) errors++;
+
+  StaticJsonDocument<512> doc;
+  doc["fixtures"] = count;
+  doc["ticks"] = ticks;
+  doc["outputs"] = outputs;
+  doc["dense_tick_avg_us"] = ticks ? (float)denseMicros / ticks : 0;
+  doc["dense_tick_max_us"] = denseMax;
+  doc["dense_allocs_per_tick"] = ticks ? (float)denseAllocs / ticks : 0;
+  doc["map_tick_avg_us"] = ticks ? (float)mapMicros / ticks : 0;
+  doc["map_tick_max_us"] = mapMax;
+  doc["table_bytes_per_fixture"] = (float)Brightness.getMemoryFootprint() / Brightness.capacity();
+  doc["errors"] = errors;
+  doc["ok"] = errors == 0 && denseAllocs == 0;
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+// =============================
+// VISTA PREVIA DE EFECTOS
+// =============================
+
+#define SIM_PREVIEW_LIGHTS 16    // Luminarias en la vista previa
+#define SIM_PREVIEW_FRAMES 40    // Cuadros como máximo
+#define SIM_PREVIEW_LEVEL 50     // Nivel de todas antes del efecto
+
+// El mismo timeline se recompila para cada efecto (clear() conserva la capacidad)
+bool previewEffect(JsonObject out, EffectKind kind, uint16_t count, BrightnessTable& table,
+                   TransitionEngine* engine, EffectTimeline& timeline) {
+  engine->clear();
+  table.fill(count, SIM_PREVIEW_LEVEL);
+
+  timeline.clear();
+  for (uint16_t i = 0; i < count; i++) timeline.addFixture(i);
+  uint8_t expected = SIM_PREVIEW_LEVEL;
+  switch (kind) {
+    case EFFECT_WAVE:     EffectCompiler::wave(timeline, 5000); expected = 30; break;
+    case EFFECT_RANDOM:   EffectCompiler::randomLevels(timeline, 5000, 12345); break;
+    case EFFECT_SEQUENCE: EffectCompiler::sequence(timeline, 500); expected = 100; break;
+    case EFFECT_STROBE:   EffectCompiler::strobe(timeline, 2000, 2 * TRANSITION_TICK_MS); break;
+    case EFFECT_RAINBOW:  EffectCompiler::rainbow(timeline, 5000); break;
+    case EFFECT_PULSE:    EffectCompiler::pulse(timeline, 20, 100, 3000); expected = 20; break;
+  }
+
+  uint32_t outputs = 0;
+  engine->setOutput([&](uint16_t, uint8_t) { outputs++; });
+  engine->play(0, &timeline, 0);
+
+  uint16_t shown = min(count, (uint16_t)SIM_PREVIEW_LIGHTS);
+  uint32_t ticks = timeline.duration / TRANSITION_TICK_MS + 1;
+  uint32_t every = ticks / SIM_PREVIEW_FRAMES + 1;
+  JsonArray frames = out.createNestedArray("preview");
+  char frame[SIM_PREVIEW_LIGHTS + 1];
+
+  uint32_t allocs = 0;
+  uint32_t tickMicros = 0;
+  uint32_t tickMax = 0;
+  uint32_t tick = 0;
+  for (uint32_t t = 0; engine->getPlayingCount() && tick < ticks + 10; t += TRANSITION_TICK_MS, tick++) {
+    uint32_t allocsBefore = heapAllocations;
+    unsigned long start = micros();
+    engine->update(t);
+    uint32_t elapsed = micros() - start;
+    allocs += heapAllocations - allocsBefore;
+    tickMicros += elapsed;
+    if (elapsed > tickMax) tickMax = elapsed;
+
+    if (tick % every == 0) {
+      for (uint16_t i = 0; i < shown; i++) frame[i] = '0' + table.getCurrent(i) * 9 / 100;
+      frame[shown] = '\0';
+      frames.add(String(frame));  // Fuera de la medición de asignaciones
+    }
+  }
+
+  uint32_t levelErrors = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (table.getCurrent(i) != expected) levelErrors++;
+  }
+
+  out["fixtures"] = timeline.size();
+  out["duration_ms"] = timeline.duration;
+  out["bytes"] = timeline.getMemoryFootprint();
+  out["ticks"] = tick;
+  out["outputs"] = outputs;
+  out["tick_avg_us"] = tick ? (float)tickMicros / tick : 0;
+  out["tick_max_us"] = tickMax;
+  out["allocs"] = allocs;
+  out["level_errors"] = levelErrors;
+  bool ok = allocs == 0 && levelErrors == 0 && !engine->getPlayingCount();
+  out["ok"] = ok;
+  return ok;
+}
+
+void previewEffects() {
+  uint16_t count = min(simPreviewEffect, (uint32_t)MAX_LUCES);
+  BrightnessTable* table = new BrightnessTable();
+  TransitionEngine* engine = new TransitionEngine(*table);
+  EffectTimeline timeline;
+  const char* names[] = {"wave", "random", "sequence", "strobe", "rainbow", "pulse"};
+  const EffectKind kinds[] = {EFFECT_WAVE, EFFECT_RANDOM, EFFECT_SEQUENCE, EFFECT_STROBE, EFFECT_RAINBOW, EFFECT_PULSE};
+
+  bool ok = true;
+  for (uint8_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+    DynamicJsonDocument doc(4096);
+    doc["effect"] = names[k];
+    ok &= previewEffect(doc.as<JsonObject>(), kinds[k], count, *table, engine, timeline);
+    String out;
+    serializeJson(doc, out);
+    Serial.println(out);
+  }
+  delete engine;
+  delete table;
+
+  StaticJsonDocument<64> doc;
+  doc["ok"] = ok;
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+void printReport(unsigned long elapsedMs) {
+  StaticJsonDocument<512> doc;
+  doc["elapsed_ms"] = elapsedMs;
+  doc["fixtures"] = Luminarias.size();
+  doc["mode"] = simBroker ? "mqtt" : "direct";
+  doc["sent"] = messagesSent;
+  doc["handled"] = simBroker ? MQTT.getMessagesReceived() : messagesHandled;
+  doc["msg_per_s"] = elapsedMs ? (float)doc["handled"].as<uint32_t>() * 1000 / elapsedMs : 0;
+  if (messagesHandled) {
+    doc["handler_avg_us"] = (float)handlerMicros / messagesHandled;
+    doc["handler_max_us"] = handlerMaxMicros;
+  }
+  doc["loop_avg_us"] = loopCount ? (float)loopMicros / loopCount : 0;
+  doc["loop_max_us"] = loopMaxMicros;
+  doc["revision"] = Luminarias.getRevision();
+  doc["alerts"] = Alerts.getActiveAlertCount();
+
+  String out;
+  serializeJson(doc, out);
+  Serial.println(out);
+}
+
+int main(int argc, char** argv) {
+  if (!parseArgs(argc, argv)) return 2;
+
+  LittleFS.begin();
+  SystemLogger.begin();
+  if (simBenchLog) {
+    benchLogger();
+    return 0;
+  }
+  if (simBenchRegistry) {
+    benchRegistry();
+    return 0;
+  }
+  if (simBenchAuth) {
+    benchAuth();
+    return 0;
+  }
+  if (simBenchRouter) {
+    benchRouter();
+    return 0;
+  }
+  if (simBenchRing) {
+    benchRing();
+    return 0;
+  }
+  if (simBenchFade) {
+    benchFade();
+    return 0;
+  }
+  if (simBenchEncodings) {
+    benchEncodings();
+    return 0;
+  }
+  if (simPreviewEffect) {
+    previewEffects();
+    return 0;
+  }
+  SystemLogger.info("=== SIMULACIÓN NODO CENTRAL v" + String(FIRMWARE_VERSION) + " (" PLATFORM_NAME ") ===", "SIM");
+
+  Auth.begin();
+  Database.begin();
+  Maintenance.begin();
+  Time.begin();
+  Scheduler.begin();
+  registerFixtureHandlers();
+  Scheduler.createDefaultSchedules();
+  Alerts.begin();
+  Scenes.begin();
+  setupFixtures();
+
+  if (simBroker && !setupMQTT()) return 1;
+  SystemLogger.flush();  // Como al final de setup() del firmware
+
+  // Bucle principal: mismo orden que loop() del firmware
+  unsigned long start = millis();
+  unsigned long lastReport = start;
+  unsigned long lastHealthCheck = start;
+  while (millis() - start < simSeconds * 1000UL) {
+    unsigned long iterationStart = micros();
+
+    generateLoad(millis() - start);
+    if (simBroker) {
+      generator.loop();
+      MQTT.loop();
+    }
+    Scenes.loop();
+    DimmingOut.flush();
+    Deferred.run();
+    SystemLogger.loop();
+    Maintenance.loop();
+
+    if (millis() - lastHealthCheck > 30000) {
+      lastHealthCheck = millis();
+      Alerts.checkSystemHealth();
+    }
+
+    uint32_t elapsed = micros() - iterationStart;
+    loopMicros += elapsed;
+    if (elapsed > loopMaxMicros) loopMaxMicros = elapsed;
+    loopCount++;
+
+    if (millis() - lastReport > SIM_REPORT_INTERVAL) {
+      lastReport = millis();
+      printReport(millis() - start);
+    }
+
+    yield();
+  }
+
+  // Dejar que el broker entregue lo que quedó en vuelo
+  if (simBroker) {
+    unsigned long drain = millis();
+    while (millis() - drain < 1000) {
+      MQTT.loop();
+      delay(1);
+    }
+  }
+
+  SystemLogger.flush();
+  printReport(millis() - start);
+  Serial.println(Database.getDatabaseStats());
+  Serial.println(Database.getConsumptionStats());
+  Serial.println(Database.getConsumptionJson(1));
+  Serial.println(Alerts.getAlertStats());
+  Serial.flush();
+  return 0;
+}
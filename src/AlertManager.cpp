@@ -1,5 +1,5 @@
 #include "AlertManager.h"
-#include <ESP8266HTTPClient.h>
+#include "hal/Platform.h"
 
 AlertManager Alerts;
 NotificationManager Notifications;
@@ -26,13 +26,13 @@ bool AlertManager::begin() {
     // Agregar condiciones predefinidas
     addCondition("Alto Consumo", ALERT_CONSUMPTION_HIGH,
                 [this](String id) { 
-                    float consumption = Database.getConsumptionByLuminaria(id, 1);
+                    float consumption = Database.getAveragePower(id, 1);
                     return consumption > consumptionHighThreshold;
                 });
     
     addCondition("Bajo Consumo", ALERT_CONSUMPTION_LOW,
                 [this](String id) {
-                    float consumption = Database.getConsumptionByLuminaria(id, 1);
+                    float consumption = Database.getAveragePower(id, 1);
                     return consumption < consumptionLowThreshold && consumption > 0;
                 });
     
@@ -132,7 +132,7 @@ void AlertManager::addCondition(const String& name, AlertType type,
     condition.lastTriggered = 0;
     
     conditions.push_back(condition);
-    SystemLogger.debug("Condición de alerta agregada: " + name, "ALERT");
+    LOGF_DEBUG("ALERT", "Condición de alerta agregada: %s", name.c_str());
 }
 
 void AlertManager::checkConditions() {
@@ -217,6 +217,10 @@ std::vector<Alert> AlertManager::getAlertsBySeverity(AlertSeverity severity) {
     return filtered;
 }
 
+uint32_t AlertManager::getActiveAlertCount() {
+    return activeAlerts.size();
+}
+
 uint32_t AlertManager::getUnacknowledgedCount() {
     uint32_t count = 0;
     for (const auto& alert : activeAlerts) {
@@ -366,7 +370,7 @@ void NotificationManager::configureWebhook(const String& url, const String& toke
     SystemLogger.info("Webhook configurado: " + url, "NOTIFY");
 }
 
-bool NotificationManager::sendEmail(const String& subject, const String& body) {
+bool NotificationManager::sendEmail(const String& subject, const String& /* body */) {
     if (!emailEnabled || emailServer.length() == 0) return false;
     
     // En un ESP8266 real, usar librería de email
@@ -0,0 +1,151 @@
+#include "ApiRouteTable.h"
+
+static_assert(API_MAX_NODES < API_NONE, "API_MAX_NODES excede el rango de índices");
+static_assert(API_MAX_ROUTES < API_NONE, "API_MAX_ROUTES excede el rango de índices");
+
+ApiRouteTable::ApiRouteTable() {
+    // Nodo 0: raíz, corresponde a API_PREFIX
+    nodes[0].label = "";
+    nodes[0].labelLength = 0;
+    nodes[0].type = API_SEGMENT_LITERAL;
+    nodes[0].firstChild = API_NONE;
+    nodes[0].nextSibling = API_NONE;
+    nodes[0].firstRoute = API_NONE;
+    nodeCount = 1;
+    routeCount = 0;
+}
+
+// === REGISTRO ===
+
+uint8_t ApiRouteTable::addNode(uint8_t parent, const char* label, uint8_t length) {
+    ApiSegmentType type = API_SEGMENT_LITERAL;
+    if (length > 0 && label[0] == ':') type = API_SEGMENT_ID;
+    else if (length == 1 && label[0] == '*') type = API_SEGMENT_TAIL;
+
+    // Reutilizar el nodo si otra ruta ya registró el mismo segmento
+    for (uint8_t c = nodes[parent].firstChild; c != API_NONE; c = nodes[c].nextSibling) {
+        if (nodes[c].type != type) continue;
+        if (type != API_SEGMENT_LITERAL) return c;
+        if (nodes[c].labelLength == length && memcmp(nodes[c].label, label, length) == 0) return c;
+    }
+
+    if (nodeCount >= API_MAX_NODES) return API_NONE;
+
+    uint8_t node = nodeCount++;
+    nodes[node].label = label;
+    nodes[node].labelLength = length;
+    nodes[node].type = type;
+    nodes[node].firstChild = API_NONE;
+    nodes[node].firstRoute = API_NONE;
+    nodes[node].nextSibling = nodes[parent].firstChild;
+    nodes[parent].firstChild = node;
+    return node;
+}
+
+uint8_t ApiRouteTable::add(const char* pattern, uint8_t methods) {
+    const size_t prefixLength = sizeof(API_PREFIX) - 1;
+    if (strncmp(pattern, API_PREFIX, prefixLength) != 0) return API_NONE;
+
+    uint8_t node = 0;
+    uint8_t depth = 0;
+    const char* p = pattern + prefixLength;
+    while (*p) {
+        const char* end = strchr(p, '/');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        if (length == 0 || length > 255 || ++depth > API_MAX_DEPTH) return API_NONE;
+
+        node = addNode(node, p, length);
+        if (node == API_NONE) return API_NONE;
+
+        // "*" consume el resto del path: no puede tener segmentos después
+        if (nodes[node].type == API_SEGMENT_TAIL && end) return API_NONE;
+
+        p += length;
+        if (*p == '/') p++;
+    }
+
+    if (routeCount >= API_MAX_ROUTES) return API_NONE;
+
+    ApiRoute& route = routes[routeCount];
+    route.methods = methods;
+    route.nextRoute = nodes[node].firstRoute;
+    nodes[node].firstRoute = routeCount;
+    return routeCount++;
+}
+
+// === BÚSQUEDA ===
+
+bool ApiRouteTable::parseId(const char* segment, uint8_t length, uint32_t& out) {
+    if (length == 0 || length > 10) return false;
+
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        char c = segment[i];
+        if (c < '0' || c > '9') return false;
+        uint32_t next = value * 10 + (c - '0');
+        if (next / 10 != value) return false;  // Desborde
+        value = next;
+    }
+    out = value;
+    return true;
+}
+
+bool ApiRouteTable::matchNode(uint8_t node, const char* path, const char* url,
+                              uint8_t method, ApiMatch& match) const {
+    // Fin del path: buscar una ruta del nodo que acepte el método
+    if (*path == '\0') {
+        for (uint8_t r = nodes[node].firstRoute; r != API_NONE; r = routes[r].nextRoute) {
+            if (routes[r].methods & method) {
+                match.route = r;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* end = path;
+    while (*end && *end != '/') end++;
+    size_t length = end - path;
+    const char* next = (*end == '/') ? end + 1 : end;
+
+    // Prioridad: literal, luego :id, luego *
+    for (uint8_t c = nodes[node].firstChild; c != API_NONE; c = nodes[c].nextSibling) {
+        const ApiNode& child = nodes[c];
+        if (child.type == API_SEGMENT_LITERAL && child.labelLength == length &&
+            memcmp(child.label, path, length) == 0 &&
+            matchNode(c, next, url, method, match)) {
+            return true;
+        }
+    }
+
+    uint32_t id;
+    for (uint8_t c = nodes[node].firstChild; c != API_NONE; c = nodes[c].nextSibling) {
+        if (nodes[c].type == API_SEGMENT_ID && length <= 255 && parseId(path, length, id)) {
+            uint32_t previous = match.id;
+            match.id = id;
+            if (matchNode(c, next, url, method, match)) return true;
+            match.id = previous;
+        }
+    }
+
+    for (uint8_t c = nodes[node].firstChild; c != API_NONE; c = nodes[c].nextSibling) {
+        if (nodes[c].type == API_SEGMENT_TAIL) {
+            match.tailOffset = path - url;
+            match.tailLength = strlen(path);
+            return matchNode(c, "", url, method, match);
+        }
+    }
+
+    return false;
+}
+
+bool ApiRouteTable::match(const char* url, uint8_t method, ApiMatch& match) const {
+    const size_t prefixLength = sizeof(API_PREFIX) - 1;
+    if (strncmp(url, API_PREFIX, prefixLength) != 0) return false;
+
+    match.route = API_NONE;
+    match.id = 0;
+    match.tailOffset = 0;
+    match.tailLength = 0;
+    return matchNode(0, url + prefixLength, url, method, match);
+}
@@ -0,0 +1,73 @@
+#ifndef API_ROUTE_TABLE_H
+#define API_ROUTE_TABLE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Configuración del enrutador
+#define API_PREFIX "/api/"
+#define API_MAX_NODES 64    // Segmentos distintos entre todas las rutas
+#define API_MAX_ROUTES 48   // Combinaciones ruta + método
+#define API_MAX_DEPTH 8     // Segmentos por ruta
+#define API_NONE 0xFF
+
+// Tipo de segmento en el patrón de la ruta
+enum ApiSegmentType : uint8_t {
+    API_SEGMENT_LITERAL,  // "schedules"
+    API_SEGMENT_ID,       // ":id" -> número decimal de 32 bits
+    API_SEGMENT_TAIL      // "*"   -> resto del path como texto
+};
+
+// Nodo del trie: un segmento del path
+struct ApiNode {
+    const char* label;    // Apunta al patrón registrado (literal estático)
+    uint8_t labelLength;
+    ApiSegmentType type;
+    uint8_t firstChild;
+    uint8_t nextSibling;
+    uint8_t firstRoute;   // Rutas (una por método) que terminan en este nodo
+};
+
+// Ruta registrada; los handlers los guarda ApiRouter con el mismo índice
+struct ApiRoute {
+    uint8_t methods;      // Máscara de WebRequestMethod (HTTP_GET, HTTP_POST...)
+    uint8_t nextRoute;    // Siguiente ruta en el mismo nodo
+};
+
+// Resultado de la búsqueda
+struct ApiMatch {
+    uint8_t route;
+    uint32_t id;          // Valor del segmento :id
+    uint16_t tailOffset;  // Posición del segmento * dentro de la URL
+    uint16_t tailLength;
+};
+
+// Trie de segmentos de las rutas /api/*, sin dependencias del servidor web
+// (native_sim lo compila para medirlo). La búsqueda recorre la URL una vez,
+// sin String temporales.
+class ApiRouteTable {
+private:
+    ApiNode nodes[API_MAX_NODES];
+    ApiRoute routes[API_MAX_ROUTES];
+    uint8_t nodeCount;
+    uint8_t routeCount;
+
+    uint8_t addNode(uint8_t parent, const char* label, uint8_t length);
+    bool matchNode(uint8_t node, const char* path, const char* url, uint8_t method, ApiMatch& match) const;
+    static bool parseId(const char* segment, uint8_t length, uint32_t& out);
+
+public:
+    ApiRouteTable();
+
+    // Registra un patrón ("/api/schedules/:id/enable", "/api/export/*");
+    // devuelve el índice de la ruta o API_NONE si no es válido o no hay lugar
+    uint8_t add(const char* pattern, uint8_t methods);
+
+    // Busca la ruta de la URL completa (con API_PREFIX) para el método
+    bool match(const char* url, uint8_t method, ApiMatch& match) const;
+
+    uint8_t getRouteCount() const { return routeCount; }
+    uint8_t getNodeCount() const { return nodeCount; }
+};
+
+#endif // API_ROUTE_TABLE_H
@@ -0,0 +1,77 @@
+#include "ApiRouter.h"
+
+ApiRouter Api;
+
+ApiRouter::ApiRouter() {
+    dispatched = 0;
+}
+
+bool ApiRouter::on(const char* pattern, WebRequestMethodComposite method,
+                   ApiRequestHandler onRequest,
+                   ApiUploadHandler onUpload,
+                   ApiBodyHandler onBody) {
+    uint8_t route = table.add(pattern, method);
+    if (route == API_NONE) return false;
+
+    handlers[route].onRequest = onRequest;
+    handlers[route].onUpload = onUpload;
+    handlers[route].onBody = onBody;
+    return true;
+}
+
+// === ASYNCWEBHANDLER ===
+
+bool ApiRouter::canHandle(AsyncWebServerRequest* request) {
+    ApiMatch match;
+    if (!table.match(request->url().c_str(), request->method(), match)) return false;
+
+    ApiMatch* stored = (ApiMatch*)malloc(sizeof(ApiMatch));
+    if (!stored) return false;
+    *stored = match;
+    request->_tempObject = stored;
+
+    // Conservar todos los encabezados (Authorization, If-None-Match, Accept)
+    request->addInterestingHeader("ANY");
+    return true;
+}
+
+ApiMatch* ApiRouter::getMatch(AsyncWebServerRequest* request) {
+    return (ApiMatch*)request->_tempObject;
+}
+
+void ApiRouter::handleRequest(AsyncWebServerRequest* request) {
+    ApiMatch* match = getMatch(request);
+    if (!match || !handlers[match->route].onRequest) {
+        request->send(500);
+        return;
+    }
+    dispatched++;
+    handlers[match->route].onRequest(request);
+}
+
+void ApiRouter::handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
+    ApiMatch* match = getMatch(request);
+    if (match && handlers[match->route].onUpload) {
+        handlers[match->route].onUpload(request, filename, index, data, len, final);
+    }
+}
+
+void ApiRouter::handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+    ApiMatch* match = getMatch(request);
+    if (match && handlers[match->route].onBody) {
+        handlers[match->route].onBody(request, data, len, index, total);
+    }
+}
+
+// === PARÁMETROS ===
+
+uint32_t ApiRouter::paramId(AsyncWebServerRequest* request) {
+    ApiMatch* match = getMatch(request);
+    return match ? match->id : 0;
+}
+
+String ApiRouter::paramTail(AsyncWebServerRequest* request) {
+    ApiMatch* match = getMatch(request);
+    if (!match) return String();
+    return request->url().substring(match->tailOffset, match->tailOffset + match->tailLength);
+}
@@ -0,0 +1,66 @@
+#ifndef API_ROUTER_H
+#define API_ROUTER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "config.h"
+#include "ApiRouteTable.h"
+
+// Handlers de una ruta: lambdas sin captura, guardadas como punteros de
+// función (4 bytes cada uno en lugar de los 16 de std::function)
+typedef void (*ApiRequestHandler)(AsyncWebServerRequest* request);
+typedef void (*ApiUploadHandler)(AsyncWebServerRequest* request, const String& filename, size_t index,
+                                 uint8_t* data, size_t len, bool final);
+typedef void (*ApiBodyHandler)(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total);
+
+// Handlers de una ruta de ApiRouteTable (mismo índice)
+struct ApiHandlers {
+    ApiRequestHandler onRequest;
+    ApiUploadHandler onUpload;
+    ApiBodyHandler onBody;
+};
+
+// Despachador único para /api/*. Las rutas se compilan en un trie de
+// segmentos con parámetros tipados (ApiRouteTable); la búsqueda recorre la
+// URL una vez (sin String temporales) en lugar de la lista lineal de
+// AsyncWebServer. El ApiMatch encontrado se guarda en request->_tempObject
+// (lo libera AsyncWebServerRequest al destruirse).
+class ApiRouter : public AsyncWebHandler {
+private:
+    ApiRouteTable table;
+    ApiHandlers handlers[API_MAX_ROUTES];
+
+    // Estadísticas
+    uint32_t dispatched;
+
+    static ApiMatch* getMatch(AsyncWebServerRequest* request);
+
+public:
+    ApiRouter();
+
+    // Registra una ruta. Patrón: "/api/schedules/:id/enable", "/api/export/*"
+    bool on(const char* pattern, WebRequestMethodComposite method,
+            ApiRequestHandler onRequest,
+            ApiUploadHandler onUpload = nullptr,
+            ApiBodyHandler onBody = nullptr);
+
+    // AsyncWebHandler
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) override;
+    void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override;
+    bool isRequestHandlerTrivial() override { return false; }
+
+    // Parámetros de la ruta encontrada
+    static uint32_t paramId(AsyncWebServerRequest* request);
+    static String paramTail(AsyncWebServerRequest* request);
+
+    uint8_t getRouteCount() const { return table.getRouteCount(); }
+    uint8_t getNodeCount() const { return table.getNodeCount(); }
+    uint32_t getDispatchedCount() const { return dispatched; }
+};
+
+// Instancia global
+extern ApiRouter Api;
+
+#endif // API_ROUTER_H
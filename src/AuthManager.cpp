@@ -1,9 +1,17 @@
 #include "AuthManager.h"
-#include <LittleFS.h>
 
 AuthManager Auth;
 
-AuthManager::AuthManager() {}
+static_assert((SESSION_SLOTS & (SESSION_SLOTS - 1)) == 0, "SESSION_SLOTS debe ser potencia de 2");
+// Ocupación máxima 2/3: crear la última sesión regenera el token ~3 veces en promedio
+static_assert(MAX_SESSIONS * 3 <= SESSION_SLOTS * 2, "SESSION_SLOTS debe ser al menos 1.5 * MAX_SESSIONS");
+
+AuthManager::AuthManager() {
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        sessions[i].valid = false;
+        sessions[i].tokenLength = 0;
+    }
+}
 
 bool AuthManager::begin() {
     SystemLogger.info("Iniciando AuthManager", "AUTH");
@@ -56,38 +64,73 @@ String AuthManager::generateToken() {
     return token + "_" + String(millis());
 }
 
-bool AuthManager::isSessionValid(const String& token) {
-    if (!sessions.count(token)) return false;
+uint32_t AuthManager::hashToken(const char* token, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)token[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+const char* AuthManager::parseBearer(const char* text, size_t& len) {
+    // Acepta "Bearer <token>" o el token solo, sin copiar
+    if (strncmp(text, "Bearer ", 7) == 0) text += 7;
+    len = 0;
+    while (text[len] && text[len] != ' ') len++;
+    return text;
+}
+
+Session* AuthManager::findSession(const char* text) {
+    size_t len;
+    const char* token = parseBearer(text, len);
+    if (len == 0 || len > SESSION_TOKEN_MAX) return nullptr;
     
-    Session& session = sessions[token];
-    uint32_t now = millis();
+    uint32_t hash = hashToken(token, len);
+    Session& session = sessions[hash & (SESSION_SLOTS - 1)];
+    if (session.tokenLength != len || session.tokenHash != hash) return nullptr;
+    if (memcmp(session.token, token, len) != 0) return nullptr;
+    return &session;
+}
+
+void AuthManager::removeSession(Session& session) {
+    if (session.tokenLength == 0) return;
+    session.valid = false;
+    session.tokenLength = 0;
+    session.username = "";
+    session.ip = "";
+    sessionCount--;
+}
+
+bool AuthManager::isSessionValid(Session* session) {
+    if (!session || !session->valid) return false;
     
     // Verificar timeout
-    if (now - session.lastActivity > SESSION_TIMEOUT) {
-        session.valid = false;
-        SystemLogger.info("Sesión expirada para: " + session.username, "AUTH");
+    if (millis() - session->lastActivity > SESSION_TIMEOUT) {
+        session->valid = false;
+        SystemLogger.info("Sesión expirada para: " + session->username, "AUTH");
         return false;
     }
     
-    return session.valid;
+    return true;
 }
 
 void AuthManager::cleanExpiredSessions() {
     uint32_t now = millis();
-    std::vector<String> toRemove;
-    
-    for (auto& pair : sessions) {
-        if (!pair.second.valid || (now - pair.second.lastActivity > SESSION_TIMEOUT)) {
-            toRemove.push_back(pair.first);
+    uint8_t removed = 0;
+    
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        Session& session = sessions[i];
+        if (session.tokenLength == 0) continue;
+        if (!session.valid || (now - session.lastActivity > SESSION_TIMEOUT)) {
+            removeSession(session);
+            removed++;
         }
     }
     
-    for (const String& token : toRemove) {
-        sessions.erase(token);
-    }
-    
-    if (toRemove.size() > 0) {
-        SystemLogger.debug("Limpiadas " + String(toRemove.size()) + " sesiones expiradas", "AUTH");
+    if (removed > 0) {
+        LOGF_DEBUG("AUTH", "Limpiadas %d sesiones expiradas", (int)removed);
     }
 }
 
@@ -260,26 +303,35 @@ String AuthManager::login(const String& username, const String& password, const
     }
     
     // Verificar límite de sesiones
-    if (sessions.size() >= MAX_SESSIONS) {
+    if (sessionCount >= MAX_SESSIONS) {
         cleanExpiredSessions();
-        if (sessions.size() >= MAX_SESSIONS) {
+        if (sessionCount >= MAX_SESSIONS) {
             SystemLogger.error("Límite de sesiones alcanzado", "AUTH");
             return "";
         }
     }
     
-    // Crear nueva sesión
-    String token = generateToken();
-    Session newSession;
-    newSession.token = token;
+    // Crear nueva sesión: regenerar el token hasta que su slot esté libre
+    // (con la tabla a lo sumo 2/3 llena siempre hay lugar y pocos intentos)
+    String token;
+    uint32_t hash;
+    do {
+        token = generateToken();
+        hash = hashToken(token.c_str(), token.length());
+    } while (sessions[hash & (SESSION_SLOTS - 1)].tokenLength != 0);
+    
+    Session& newSession = sessions[hash & (SESSION_SLOTS - 1)];
+    strncpy(newSession.token, token.c_str(), SESSION_TOKEN_MAX);
+    newSession.token[SESSION_TOKEN_MAX] = '\0';
+    newSession.tokenHash = hash;
+    newSession.tokenLength = token.length();
     newSession.username = username;
     newSession.ip = ip;
     newSession.role = user.role;
     newSession.createdAt = millis();
     newSession.lastActivity = millis();
     newSession.valid = true;
-    
-    sessions[token] = newSession;
+    sessionCount++;
     
     // Actualizar usuario
     user.lastLogin = millis();
@@ -290,22 +342,32 @@ String AuthManager::login(const String& username, const String& password, const
 }
 
 bool AuthManager::logout(const String& token) {
-    if (!sessions.count(token)) return false;
+    Session* session = findSession(token.c_str());
+    if (!session) return false;
     
-    String username = sessions[token].username;
-    sessions.erase(token);
+    String username = session->username;
+    removeSession(*session);
     
     SystemLogger.info("Logout: " + username, "AUTH");
     return true;
 }
 
 bool AuthManager::validateToken(const String& token) {
-    return isSessionValid(token);
+    return isSessionValid(findSession(token.c_str()));
+}
+
+bool AuthManager::authorize(const char* authorization, UserRole requiredRole) {
+    Session* session = findSession(authorization);
+    if (!isSessionValid(session) || session->role < requiredRole) return false;
+    
+    session->lastActivity = millis();
+    return true;
 }
 
 UserRole AuthManager::getUserRole(const String& token) {
-    if (!isSessionValid(token)) return ROLE_NONE;
-    return sessions[token].role;
+    Session* session = findSession(token.c_str());
+    if (!isSessionValid(session)) return ROLE_NONE;
+    return session->role;
 }
 
 bool AuthManager::hasPermission(const String& token, UserRole requiredRole) {
@@ -314,25 +376,28 @@ bool AuthManager::hasPermission(const String& token, UserRole requiredRole) {
 }
 
 String AuthManager::getCurrentUser(const String& token) {
-    if (!isSessionValid(token)) return "";
-    return sessions[token].username;
+    Session* session = findSession(token.c_str());
+    if (!isSessionValid(session)) return "";
+    return session->username;
 }
 
 void AuthManager::updateSessionActivity(const String& token) {
-    if (sessions.count(token)) {
-        sessions[token].lastActivity = millis();
+    Session* session = findSession(token.c_str());
+    if (session) {
+        session->lastActivity = millis();
     }
 }
 
 uint32_t AuthManager::getActiveSessionCount() {
     cleanExpiredSessions();
-    return sessions.size();
+    return sessionCount;
 }
 
 String AuthManager::getSessionInfo(const String& token) {
-    if (!sessions.count(token)) return "{}";
+    Session* found = findSession(token.c_str());
+    if (!found) return "{}";
     
-    Session& session = sessions[token];
+    Session& session = *found;
     StaticJsonDocument<256> doc;
     doc["username"] = session.username;
     doc["role"] = session.role;
@@ -352,10 +417,11 @@ String AuthManager::getAllSessions() {
     StaticJsonDocument<1024> doc;
     JsonArray sessionsArray = doc.createNestedArray("sessions");
     
-    for (const auto& pair : sessions) {
-        const Session& session = pair.second;
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        const Session& session = sessions[i];
+        if (session.tokenLength == 0) continue;
         JsonObject sessionObj = sessionsArray.createNestedObject();
-        sessionObj["token"] = pair.first.substring(0, 8) + "...";  // Mostrar solo parte del token
+        sessionObj["token"] = String(session.token).substring(0, 8) + "...";  // Mostrar solo parte del token
         sessionObj["username"] = session.username;
         sessionObj["role"] = session.role;
         sessionObj["ip"] = session.ip;
@@ -363,7 +429,7 @@ String AuthManager::getAllSessions() {
         sessionObj["lastActivity"] = session.lastActivity;
     }
     
-    doc["count"] = sessions.size();
+    doc["count"] = sessionCount;
     doc["max"] = MAX_SESSIONS;
     
     String result;
@@ -372,25 +438,24 @@ String AuthManager::getAllSessions() {
 }
 
 void AuthManager::invalidateAllSessions() {
-    sessions.clear();
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        removeSession(sessions[i]);
+    }
     SystemLogger.warning("Todas las sesiones invalidadas", "AUTH");
 }
 
 void AuthManager::invalidateUserSessions(const String& username) {
-    std::vector<String> toRemove;
+    uint8_t removed = 0;
     
-    for (const auto& pair : sessions) {
-        if (pair.second.username == username) {
-            toRemove.push_back(pair.first);
+    for (uint8_t i = 0; i < SESSION_SLOTS; i++) {
+        if (sessions[i].tokenLength != 0 && sessions[i].username == username) {
+            removeSession(sessions[i]);
+            removed++;
         }
     }
     
-    for (const String& token : toRemove) {
-        sessions.erase(token);
-    }
-    
-    if (toRemove.size() > 0) {
-        SystemLogger.info("Invalidadas " + String(toRemove.size()) + " sesiones de " + username, "AUTH");
+    if (removed > 0) {
+        SystemLogger.info("Invalidadas " + String(removed) + " sesiones de " + username, "AUTH");
     }
 }
 
@@ -456,7 +521,7 @@ String AuthManager::getAuthStats() {
     StaticJsonDocument<512> doc;
     
     doc["users"] = users.size();
-    doc["sessions"] = sessions.size();
+    doc["sessions"] = sessionCount;
     doc["max_sessions"] = MAX_SESSIONS;
     doc["session_timeout"] = SESSION_TIMEOUT;
     
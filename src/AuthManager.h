@@ -2,7 +2,7 @@
 #define AUTH_MANAGER_H
 
 #include <Arduino.h>
-#include <ESP8266WiFi.h>
+#include "hal/Platform.h"
 #include <ArduinoJson.h>
 #include <Crypto.h>
 #include <SHA256.h>
@@ -16,6 +16,8 @@
 #define MAX_LOGIN_ATTEMPTS 5
 #define LOGIN_BLOCK_TIME 300000  // 5 minutos de bloqueo
 #define TOKEN_LENGTH 32
+#define SESSION_TOKEN_MAX 48  // TOKEN_LENGTH + "_" + millis()
+#define SESSION_SLOTS 16      // Tabla de sesiones; potencia de 2 y al menos 1.5 * MAX_SESSIONS
 
 // Niveles de acceso
 enum UserRole {
@@ -38,7 +40,9 @@ struct User {
 
 // Estructura de sesión
 struct Session {
-    String token;
+    char token[SESSION_TOKEN_MAX + 1];
+    uint32_t tokenHash;   // Hash FNV-1a del token; determina el slot
+    uint8_t tokenLength;
     String username;
     String ip;
     UserRole role;
@@ -50,13 +54,21 @@ struct Session {
 class AuthManager {
 private:
     std::map<String, User> users;
-    std::map<String, Session> sessions;
+    // Cada token ocupa el slot que indica su hash: al crear la sesión se
+    // regenera el token hasta caer en un slot libre, así la búsqueda es un
+    // único acceso sin sondeo
+    Session sessions[SESSION_SLOTS];
+    uint8_t sessionCount = 0;
     uint32_t sessionCounter = 0;
     
     // Funciones internas
     String hashPassword(const String& password);
     String generateToken();
-    bool isSessionValid(const String& token);
+    static uint32_t hashToken(const char* token, size_t len);
+    static const char* parseBearer(const char* text, size_t& len);
+    Session* findSession(const char* text);
+    void removeSession(Session& session);
+    bool isSessionValid(Session* session);
     void cleanExpiredSessions();
     void loadUsersFromFile();
     void saveUsersToFile();
@@ -80,6 +92,9 @@ public:
     bool validateToken(const String& token);
     
     // Autorización
+    // Ruta rápida de REQUIRE_AUTH: toma el encabezado Authorization tal cual
+    // ("Bearer <token>" o solo el token), verifica el rol y actualiza la actividad
+    bool authorize(const char* authorization, UserRole requiredRole);
     UserRole getUserRole(const String& token);
     bool hasPermission(const String& token, UserRole requiredRole);
     String getCurrentUser(const String& token);
@@ -111,17 +126,15 @@ extern AuthManager Auth;
 // Middleware para proteger rutas
 #define REQUIRE_AUTH(request, role) \
     { \
-        if (!request->hasHeader("Authorization")) { \
+        AsyncWebHeader* authHeader = request->getHeader("Authorization"); \
+        if (!authHeader) { \
             request->send(401, "application/json", "{\"error\":\"No autorizado\"}"); \
             return; \
         } \
-        String token = request->header("Authorization"); \
-        token.replace("Bearer ", ""); \
-        if (!Auth.hasPermission(token, role)) { \
+        if (!Auth.authorize(authHeader->value().c_str(), role)) { \
             request->send(403, "application/json", "{\"error\":\"Permisos insuficientes\"}"); \
             return; \
         } \
-        Auth.updateSessionActivity(token); \
     }
 
 #endif // AUTH_MANAGER_H
\ No newline at end of file
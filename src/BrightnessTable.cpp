@@ -0,0 +1,59 @@
+#include "BrightnessTable.h"
+
+BrightnessTable Brightness;
+
+BrightnessTable::BrightnessTable() {
+    clear();
+}
+
+void BrightnessTable::clear() {
+    memset(current, 0, sizeof(current));
+    memset(targets, 0, sizeof(targets));
+    memset(starts, 0, sizeof(starts));
+    used = 0;
+}
+
+void BrightnessTable::setLevel(uint16_t pos, uint8_t level) {
+    if (pos >= MAX_LUCES) return;
+    current[pos] = level;
+    targets[pos] = level;
+    starts[pos] = level;
+    touch(pos);
+}
+
+void BrightnessTable::setCurrent(uint16_t pos, uint8_t level) {
+    if (pos >= MAX_LUCES) return;
+    current[pos] = level;
+    touch(pos);
+}
+
+void BrightnessTable::beginTransition(uint16_t pos, uint8_t to) {
+    if (pos >= MAX_LUCES) return;
+    starts[pos] = current[pos];
+    targets[pos] = to;
+    touch(pos);
+}
+
+uint32_t BrightnessTable::sum(uint16_t count) const {
+    if (count > MAX_LUCES) count = MAX_LUCES;
+    // Acumulador de 32 bits sin ramas: se vectoriza
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        total += current[i];
+    }
+    return total;
+}
+
+float BrightnessTable::average(uint16_t count) const {
+    if (count > MAX_LUCES) count = MAX_LUCES;
+    return count ? (float)sum(count) / count : 0;
+}
+
+void BrightnessTable::fill(uint16_t count, uint8_t level) {
+    if (count > MAX_LUCES) count = MAX_LUCES;
+    if (count == 0) return;
+    memset(current, level, count);
+    memset(targets, level, count);
+    memset(starts, level, count);
+    touch(count - 1);
+}
@@ -0,0 +1,55 @@
+#ifndef BRIGHTNESS_TABLE_H
+#define BRIGHTNESS_TABLE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Estado de brillo por luminaria, indexado por su posición en el registro
+// (Luminarias.find()). Una sola tabla para SceneManager, DimmingController y
+// el registro (la intensidad de /estado-luces se lee de aquí): un fade de
+// cualquiera arranca desde el nivel que dejó el otro.
+//
+// Cada campo es un array denso de MAX_LUCES sin asignaciones; los recorridos
+// (sum, average, fill) son bucles planos sobre uint8_t que el compilador
+// vectoriza. 'used' marca hasta dónde se escribió para no recorrer de más.
+class BrightnessTable {
+private:
+    uint8_t current[MAX_LUCES];   // Último nivel aplicado (0-100%)
+    uint8_t targets[MAX_LUCES];   // Nivel final de la transición en curso
+    uint8_t starts[MAX_LUCES];    // Nivel desde el que arrancó
+    uint16_t used;                // Posiciones escritas: [0, used)
+
+    void touch(uint16_t pos) { if (pos >= used) used = pos + 1; }
+
+public:
+    BrightnessTable();
+
+    void clear();
+
+    // Lectura por posición (0 fuera de rango)
+    uint8_t getCurrent(uint16_t pos) const { return pos < MAX_LUCES ? current[pos] : 0; }
+    uint8_t getTarget(uint16_t pos) const { return pos < MAX_LUCES ? targets[pos] : 0; }
+    uint8_t getStart(uint16_t pos) const { return pos < MAX_LUCES ? starts[pos] : 0; }
+
+    // Nivel fijo: current, target y start quedan iguales
+    void setLevel(uint16_t pos, uint8_t level);
+    // Paso intermedio de una transición (target y start no cambian)
+    void setCurrent(uint16_t pos, uint8_t level);
+    // Una transición toma la luminaria desde su nivel actual hacia 'to'
+    void beginTransition(uint16_t pos, uint8_t to);
+
+    // Recorridos densos sobre [0, count)
+    uint32_t sum(uint16_t count) const;
+    float average(uint16_t count) const;
+    void fill(uint16_t count, uint8_t level);
+    const uint8_t* levels() const { return current; }
+
+    uint16_t size() const { return used; }
+    uint16_t capacity() const { return MAX_LUCES; }
+    size_t getMemoryFootprint() const { return sizeof(BrightnessTable); }
+};
+
+// Instancia global
+extern BrightnessTable Brightness;
+
+#endif // BRIGHTNESS_TABLE_H
@@ -0,0 +1,205 @@
+#include "ConsumptionStore.h"
+
+static_assert(CONSUMPTION_SERIES_DEPTH >= 2 && CONSUMPTION_SERIES_DEPTH <= 255, "CONSUMPTION_SERIES_DEPTH fuera de rango");
+
+// === BUCKETS ===
+
+void ConsumptionBucket::reset(uint32_t bucketStart) {
+    start = bucketStart;
+    count = 0;
+    sum = 0;
+    minDeciwatts = 0;
+    maxDeciwatts = 0;
+    energy = 0;
+}
+
+void ConsumptionBucket::add(uint16_t deciwatts, float energyWh) {
+    if (count == 0 || deciwatts < minDeciwatts) minDeciwatts = deciwatts;
+    if (count == 0 || deciwatts > maxDeciwatts) maxDeciwatts = deciwatts;
+    sum += deciwatts / 10.0f;
+    energy += energyWh;
+    count++;
+}
+
+void ConsumptionBucket::merge(const ConsumptionBucket& other) {
+    if (other.count == 0) return;
+    if (count == 0 || other.minDeciwatts < minDeciwatts) minDeciwatts = other.minDeciwatts;
+    if (count == 0 || other.maxDeciwatts > maxDeciwatts) maxDeciwatts = other.maxDeciwatts;
+    sum += other.sum;
+    energy += other.energy;
+    count += other.count;
+}
+
+// === STORE ===
+
+ConsumptionStore::ConsumptionStore() {
+    clear();
+}
+
+void ConsumptionStore::clear() {
+    memset(counts, 0, sizeof(counts));
+    memset(heads, 0, sizeof(heads));
+    for (uint16_t i = 0; i < CONSUMPTION_MINUTE_BUCKETS; i++) minutes[i].reset(0);
+    for (uint16_t i = 0; i < CONSUMPTION_HOUR_BUCKETS; i++) hours[i].reset(0);
+    for (uint16_t i = 0; i < CONSUMPTION_DAY_BUCKETS; i++) days[i].reset(0);
+    totalPower = 0;
+    totalEnergy = 0;
+    totalSamples = 0;
+    retainedSamples = 0;
+    reportingFixtures = 0;
+}
+
+uint32_t ConsumptionStore::bucketWidth(ConsumptionResolution resolution) {
+    switch (resolution) {
+        case CONSUMPTION_MINUTE: return 60;
+        case CONSUMPTION_HOUR: return 3600;
+        default: return 86400;
+    }
+}
+
+uint32_t ConsumptionStore::bucketStart(ConsumptionResolution resolution, uint32_t timestamp) {
+    return timestamp - timestamp % bucketWidth(resolution);
+}
+
+void ConsumptionStore::bucketsFor(ConsumptionResolution resolution, const ConsumptionBucket*& buckets,
+                                  uint16_t& length, uint32_t& width) const {
+    width = bucketWidth(resolution);
+    switch (resolution) {
+        case CONSUMPTION_MINUTE: buckets = minutes; length = CONSUMPTION_MINUTE_BUCKETS; break;
+        case CONSUMPTION_HOUR: buckets = hours; length = CONSUMPTION_HOUR_BUCKETS; break;
+        default: buckets = days; length = CONSUMPTION_DAY_BUCKETS; break;
+    }
+}
+
+void ConsumptionStore::addToRollups(uint32_t timestamp, uint16_t deciwatts, float energyWh) {
+    ConsumptionBucket* levels[] = {minutes, hours, days};
+    const uint16_t lengths[] = {CONSUMPTION_MINUTE_BUCKETS, CONSUMPTION_HOUR_BUCKETS, CONSUMPTION_DAY_BUCKETS};
+
+    for (uint8_t level = 0; level < 3; level++) {
+        uint32_t width = bucketWidth((ConsumptionResolution)level);
+        ConsumptionBucket& b = levels[level][(timestamp / width) % lengths[level]];
+        uint32_t start = timestamp - timestamp % width;
+        if (b.count && start < b.start) continue;  // Más vieja que lo que guarda el anillo
+        if (b.count == 0 || b.start != start) b.reset(start);
+        b.add(deciwatts, energyWh);
+    }
+}
+
+void ConsumptionStore::add(uint16_t pos, uint32_t timestamp, float power, float voltage) {
+    if (pos >= MAX_LUCES) return;
+
+    if (power < 0) power = 0;
+    if (power > CONSUMPTION_MAX_VALUE) power = CONSUMPTION_MAX_VALUE;
+    if (voltage < 0) voltage = 0;
+    if (voltage > CONSUMPTION_MAX_VALUE) voltage = CONSUMPTION_MAX_VALUE;
+    uint16_t deciwatts = (uint16_t)(power * 10 + 0.5f);
+    float energyWh = 0;
+
+    if (counts[pos] == 0) {
+        reportingFixtures++;
+    } else {
+        uint32_t dt = timestamp - lastTimestamps[pos];
+        int32_t delta = (int32_t)deciwatts - lastPowers[pos];
+        float previous = lastPowers[pos] / 10.0f;
+
+        // Energía del intervalo: la potencia anterior se mantuvo hasta esta muestra
+        if (dt <= CONSUMPTION_MAX_GAP) energyWh = previous * dt / 3600.0f;
+        totalPower -= previous;
+
+        if (dt > 0xFFFF || delta < INT16_MIN || delta > INT16_MAX) {
+            // El delta no entra en el anillo: la serie empieza de nuevo
+            retainedSamples -= counts[pos];
+            counts[pos] = 0;
+        } else {
+            uint8_t head = (heads[pos] + 1) % CONSUMPTION_SERIES_DEPTH;
+            sampleDts[pos][head] = (uint16_t)dt;
+            sampleDeltas[pos][head] = (int16_t)delta;
+            heads[pos] = head;
+            if (counts[pos] < CONSUMPTION_SERIES_DEPTH) {
+                counts[pos]++;
+                retainedSamples++;
+            }
+        }
+    }
+
+    if (counts[pos] == 0) {
+        heads[pos] = 0;
+        sampleDts[pos][0] = 0;
+        sampleDeltas[pos][0] = 0;
+        counts[pos] = 1;
+        retainedSamples++;
+    }
+
+    lastTimestamps[pos] = timestamp;
+    lastPowers[pos] = deciwatts;
+    lastVoltages[pos] = (uint16_t)(voltage * 10 + 0.5f);
+
+    power = deciwatts / 10.0f;
+    totalPower += power;
+    totalEnergy += energyWh;
+    totalSamples++;
+    addToRollups(timestamp, deciwatts, energyWh);
+}
+
+uint8_t ConsumptionStore::getSamples(uint16_t pos, ConsumptionSample* out, uint8_t max) const {
+    if (pos >= MAX_LUCES) return 0;
+
+    // Reconstrucción hacia atrás desde la muestra más nueva
+    uint32_t timestamp = lastTimestamps[pos];
+    int32_t deciwatts = lastPowers[pos];
+    float voltage = lastVoltages[pos] / 10.0f;
+    uint8_t index = heads[pos];
+    uint8_t n = 0;
+
+    while (n < counts[pos] && n < max) {
+        out[n].timestamp = timestamp;
+        out[n].power = deciwatts / 10.0f;
+        out[n].voltage = voltage;
+        n++;
+
+        timestamp -= sampleDts[pos][index];
+        deciwatts -= sampleDeltas[pos][index];
+        index = (index + CONSUMPTION_SERIES_DEPTH - 1) % CONSUMPTION_SERIES_DEPTH;
+    }
+    return n;
+}
+
+float ConsumptionStore::getEnergy(uint16_t pos, uint32_t since) const {
+    ConsumptionSample samples[CONSUMPTION_SERIES_DEPTH];
+    uint8_t n = getSamples(pos, samples, CONSUMPTION_SERIES_DEPTH);
+
+    float energy = 0;
+    for (uint8_t i = 1; i < n; i++) {
+        const ConsumptionSample& newer = samples[i - 1];
+        const ConsumptionSample& older = samples[i];
+        if (newer.timestamp <= since) break;
+        if (newer.timestamp - older.timestamp > CONSUMPTION_MAX_GAP) continue;
+
+        uint32_t from = older.timestamp > since ? older.timestamp : since;
+        energy += older.power * (newer.timestamp - from) / 3600.0f;
+    }
+    return energy;
+}
+
+float ConsumptionStore::getAveragePower(uint16_t pos, uint32_t since) const {
+    ConsumptionSample samples[CONSUMPTION_SERIES_DEPTH];
+    uint8_t n = getSamples(pos, samples, CONSUMPTION_SERIES_DEPTH);
+
+    float sum = 0;
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < n && samples[i].timestamp >= since; i++) {
+        sum += samples[i].power;
+        used++;
+    }
+    return used ? sum / used : 0;
+}
+
+ConsumptionBucket ConsumptionStore::summarize(ConsumptionResolution resolution, uint32_t since) const {
+    ConsumptionBucket total;
+    total.reset(since);
+    forEachBucket(resolution, since, [&total](const ConsumptionBucket& b) {
+        total.merge(b);
+        return true;
+    });
+    return total;
+}
@@ -0,0 +1,143 @@
+#ifndef CONSUMPTION_STORE_H
+#define CONSUMPTION_STORE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Configuración de las series de consumo
+#ifndef CONSUMPTION_SERIES_DEPTH
+#define CONSUMPTION_SERIES_DEPTH 2      // Muestras crudas por luminaria
+#endif
+#define CONSUMPTION_MAX_GAP 3600        // Más de 1 h sin muestras: no se integra energía
+#define CONSUMPTION_MAX_VALUE 6553.5f   // Máximo en décimas de W o V (uint16)
+#define CONSUMPTION_MINUTE_BUCKETS 60   // Última hora en buckets de 1 minuto
+#define CONSUMPTION_HOUR_BUCKETS 48     // Últimos 2 días en buckets de 1 hora
+#define CONSUMPTION_DAY_BUCKETS 31      // Último mes en buckets de 1 día
+
+enum ConsumptionResolution : uint8_t {
+    CONSUMPTION_MINUTE = 0,
+    CONSUMPTION_HOUR = 1,
+    CONSUMPTION_DAY = 2
+};
+
+// Agregado de un intervalo: estadísticas de las muestras (W) y energía (Wh).
+// Mínimo y máximo en deciwatts, como las muestras de la serie
+struct ConsumptionBucket {
+    uint32_t start;   // Inicio del intervalo (segundos de uptime)
+    uint32_t count;   // Muestras
+    float sum;        // Suma de potencias, para el promedio
+    uint16_t minDeciwatts;
+    uint16_t maxDeciwatts;
+    float energy;     // Wh integrados de todas las luminarias
+
+    void reset(uint32_t bucketStart);
+    void add(uint16_t deciwatts, float energyWh);
+    void merge(const ConsumptionBucket& other);
+    float average() const { return count ? sum / count : 0; }
+    float minPower() const { return minDeciwatts / 10.0f; }
+    float maxPower() const { return maxDeciwatts / 10.0f; }
+};
+
+struct ConsumptionSample {
+    uint32_t timestamp;
+    float power;    // W
+    float voltage;  // V (último valor informado por la luminaria)
+};
+
+// Serie temporal de consumo.
+//
+// Cada luminaria (por posición en LuminariaRegistry) tiene un anillo de ancho
+// fijo con sus últimas CONSUMPTION_SERIES_DEPTH muestras, guardadas como delta
+// respecto de la anterior: 2 bytes de segundos transcurridos y 2 de diferencia
+// de potencia en deciwatts. Se conserva la muestra más nueva completa y las
+// anteriores se reconstruyen hacia atrás. Si un delta no entra en 16 bits la
+// serie de esa luminaria vuelve a empezar.
+//
+// Cada muestra se acumula además en tres niveles de rollup globales (1 minuto,
+// 1 hora, 1 día) con suma, mínimo, máximo, cantidad y energía, así que las
+// consultas por período recorren buckets y no muestras.
+class ConsumptionStore {
+private:
+    // Serie por luminaria (struct-of-arrays, como LuminariaRegistry)
+    uint32_t lastTimestamps[MAX_LUCES];
+    uint16_t lastPowers[MAX_LUCES];    // Deciwatts
+    uint16_t lastVoltages[MAX_LUCES];  // Decivoltios
+    uint16_t sampleDts[MAX_LUCES][CONSUMPTION_SERIES_DEPTH];
+    int16_t sampleDeltas[MAX_LUCES][CONSUMPTION_SERIES_DEPTH];
+    uint8_t heads[MAX_LUCES];          // Posición de la muestra más nueva
+    uint8_t counts[MAX_LUCES];         // 0 = sin muestras
+
+    ConsumptionBucket minutes[CONSUMPTION_MINUTE_BUCKETS];
+    ConsumptionBucket hours[CONSUMPTION_HOUR_BUCKETS];
+    ConsumptionBucket days[CONSUMPTION_DAY_BUCKETS];
+
+    float totalPower;          // Suma de la última potencia de cada luminaria
+    float totalEnergy;         // Wh desde el arranque
+    uint32_t totalSamples;
+    uint32_t retainedSamples;  // Muestras crudas en los anillos
+    uint16_t reportingFixtures;
+
+    void addToRollups(uint32_t timestamp, uint16_t deciwatts, float energyWh);
+    void bucketsFor(ConsumptionResolution resolution, const ConsumptionBucket*& buckets, uint16_t& length, uint32_t& width) const;
+
+public:
+    ConsumptionStore();
+
+    void clear();
+
+    // Registra una muestra de la luminaria en la posición pos
+    void add(uint16_t pos, uint32_t timestamp, float power, float voltage);
+
+    // Muestras crudas de una luminaria, de la más nueva a la más vieja
+    uint8_t getSamples(uint16_t pos, ConsumptionSample* out, uint8_t max) const;
+    uint8_t getSampleCount(uint16_t pos) const { return pos < MAX_LUCES ? counts[pos] : 0; }
+    float getLastPower(uint16_t pos) const { return counts[pos] ? lastPowers[pos] / 10.0f : 0; }
+
+    // Energía (Wh) y potencia promedio (W) de una luminaria desde 'since',
+    // hasta donde alcanza su anillo de muestras
+    float getEnergy(uint16_t pos, uint32_t since) const;
+    float getAveragePower(uint16_t pos, uint32_t since) const;
+
+    // Agregado de los buckets de una resolución que empiezan en 'since' o después
+    ConsumptionBucket summarize(ConsumptionResolution resolution, uint32_t since) const;
+
+    // Recorre los buckets con datos desde 'since', del más viejo al más nuevo
+    // (el callback devuelve false para cortar)
+    template <typename F>
+    void forEachBucket(ConsumptionResolution resolution, uint32_t since, F callback) const;
+
+    // Inicio del bucket que contiene 'timestamp'
+    static uint32_t bucketStart(ConsumptionResolution resolution, uint32_t timestamp);
+    static uint32_t bucketWidth(ConsumptionResolution resolution);
+
+    float getTotalPower() const { return totalPower; }
+    float getTotalEnergy() const { return totalEnergy; }
+    uint32_t getTotalSamples() const { return totalSamples; }
+    uint32_t getRetainedSamples() const { return retainedSamples; }
+    uint16_t getReportingFixtures() const { return reportingFixtures; }
+    size_t getMemoryFootprint() const { return sizeof(ConsumptionStore); }
+};
+
+template <typename F>
+void ConsumptionStore::forEachBucket(ConsumptionResolution resolution, uint32_t since, F callback) const {
+    const ConsumptionBucket* buckets;
+    uint16_t length;
+    uint32_t width;
+    bucketsFor(resolution, buckets, length, width);
+
+    // El anillo se indexa por (start / width) % length: empezando después del
+    // bucket más nuevo se recorre en orden cronológico
+    uint32_t newest = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        if (buckets[i].count && buckets[i].start >= newest) newest = buckets[i].start;
+    }
+    uint16_t first = (uint16_t)((newest / width + 1) % length);
+    for (uint16_t i = 0; i < length; i++) {
+        const ConsumptionBucket& b = buckets[(first + i) % length];
+        // Buckets de una vuelta anterior del anillo que nadie reutilizó
+        if (!b.count || b.start < since || newest - b.start >= length * width) continue;
+        if (!callback(b)) return;
+    }
+}
+
+#endif // CONSUMPTION_STORE_H
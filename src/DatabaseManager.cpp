@@ -1,9 +1,11 @@
 #include "DatabaseManager.h"
+#include "LuminariaRegistry.h"
+#include "MaintenanceEngine.h"
+#include <algorithm>
 
 DatabaseManager Database;
 
 DatabaseManager::DatabaseManager() {
-    nextEventId = 1;
     nextScheduleId = 1;
     nextZoneId = 1;
 }
@@ -17,11 +19,12 @@ bool DatabaseManager::begin() {
     }
     
     // Cargar datos existentes
-    loadEventsFromFile();
+    eventLog.begin();
+    migrateLegacyEvents();
     loadSchedulesFromFile();
     loadZonesFromFile();
     
-    SystemLogger.info("Base de datos iniciada - Eventos: " + String(recentEvents.size()) + 
+    SystemLogger.info("Base de datos iniciada - Eventos: " + String(eventLog.getRecordCount()) + 
                      ", Schedules: " + String(schedules.size()) + 
                      ", Zonas: " + String(zones.size()), "DB");
     return true;
@@ -55,61 +58,95 @@ void DatabaseManager::rotateDatabase(const String& filename) {
 
 // === EVENTOS ===
 
-uint32_t DatabaseManager::logEvent(const String& luminariaId, EventType type, 
-                                   const String& description, const String& user) {
+static Event toEvent(const EventEntry& entry) {
     Event event;
-    event.id = nextEventId++;
-    event.timestamp = millis() / 1000;
-    event.luminariaId = luminariaId;
-    event.type = type;
-    event.description = description;
-    event.user = user;
+    event.id = entry.id;
+    event.timestamp = entry.timestamp;
+    event.luminariaId = entry.luminaria;
+    event.type = (EventType)entry.type;
+    event.description = entry.description;
+    event.user = entry.user;
     event.value = 0;
+    return event;
+}
+
+uint32_t DatabaseManager::logEvent(const String& luminariaId, EventType type, 
+                                   const String& description, const String& user) {
+    EventEntry entry;
+    entry.id = 0;
+    entry.timestamp = millis() / 1000;
+    entry.type = type;
+    EventLog::copyText(entry.luminaria, sizeof(entry.luminaria), luminariaId.c_str());
+    EventLog::copyText(entry.description, sizeof(entry.description), description.c_str());
+    EventLog::copyText(entry.user, sizeof(entry.user), user.c_str());
     
-    recentEvents.push_back(event);
-    
-    // Limitar tamaño del cache
-    if (recentEvents.size() > MAX_RECORDS) {
-        recentEvents.erase(recentEvents.begin());
-    }
-    
-    // Guardar periódicamente
-    if (recentEvents.size() % 10 == 0) {
-        saveEventsToFile();
-    }
+    // Un registro agregado al final del segmento actual
+    eventLog.append(entry);
     
-    SystemLogger.debug("Evento registrado: " + description, "DB");
-    return event.id;
+    LOGF_DEBUG("DB", "Evento registrado: %s", entry.description);
+    return entry.id;
 }
 
 std::vector<Event> DatabaseManager::getEvents(uint32_t limit, uint32_t offset) {
     std::vector<Event> result;
+    size_t recent = eventLog.recentCount();
     
-    if (offset >= recentEvents.size()) return result;
+    // Caso común: los más nuevos están en el ring
+    if (offset + limit <= recent) {
+        for (size_t i = recent - offset; i > recent - offset - limit; i--) {
+            result.push_back(toEvent(eventLog.recent(i - 1)));
+        }
+        return result;
+    }
     
-    uint32_t start = recentEvents.size() > offset ? recentEvents.size() - offset - 1 : 0;
-    uint32_t count = 0;
+    // Páginas más viejas: se leen de flash los registros de la ventana pedida
+    uint32_t total = eventLog.getRecordCount();
+    if (offset >= total) return result;
+    uint32_t end = total - offset;
+    uint32_t start = end > limit ? end - limit : 0;
     
-    for (int i = start; i >= 0 && count < limit; i--) {
-        result.push_back(recentEvents[i]);
-        count++;
+    EventCursor cursor;
+    EventEntry entry;
+    for (uint32_t i = 0; i < end && eventLog.next(cursor, entry); i++) {
+        if (i >= start) result.push_back(toEvent(entry));
     }
-    
+    std::reverse(result.begin(), result.end());
     return result;
 }
 
 std::vector<Event> DatabaseManager::getEventsByLuminaria(const String& luminariaId, uint32_t limit) {
+    EventQuery query;
+    query.luminaria = luminariaId.c_str();
+    return queryEvents(query, limit);
+}
+
+std::vector<Event> DatabaseManager::getEventsByType(EventType type, uint32_t limit) {
+    EventQuery query;
+    query.type = type;
+    return queryEvents(query, limit);
+}
+
+std::vector<Event> DatabaseManager::queryEvents(EventQuery& query, uint32_t limit) {
     std::vector<Event> result;
+    EventEntry entry;
     
-    for (int i = recentEvents.size() - 1; i >= 0 && result.size() < limit; i--) {
-        if (recentEvents[i].luminariaId == luminariaId) {
-            result.push_back(recentEvents[i]);
-        }
+    // Recorre solo la lista de posteo que corresponde al filtro
+    while (result.size() < limit && eventLog.next(query, entry)) {
+        result.push_back(toEvent(entry));
     }
-    
     return result;
 }
 
+bool DatabaseManager::clearOldEvents(uint32_t daysToKeep) {
+    uint32_t now = millis() / 1000;
+    uint32_t maxAge = daysToKeep * 86400UL;
+    if (now <= maxAge) return false;
+    
+    // Se decide por el rango de tiempo de cada segmento, sin leer eventos;
+    // los eventos viejos del segmento actual quedan hasta que rote
+    return eventLog.dropSegmentsBefore(now - maxAge) > 0;
+}
+
 String DatabaseManager::getEventsJson(uint32_t limit) {
     StaticJsonDocument<4096> doc;
     JsonArray arr = doc.to<JsonArray>();
@@ -130,33 +167,43 @@ String DatabaseManager::getEventsJson(uint32_t limit) {
     return result;
 }
 
-bool DatabaseManager::saveEventsToFile() {
-    rotateDatabase(DB_EVENTS_FILE);
+String DatabaseManager::queryEventsJson(EventQuery& query, uint8_t limit) {
+    DynamicJsonDocument doc(EVENT_QUERY_DOC_SIZE);
+    JsonArray results = doc.createNestedArray("events");
     
-    File file = LittleFS.open(DB_EVENTS_FILE, "w");
-    if (!file) return false;
+    limit = constrain(limit, 1, EVENT_QUERY_MAX_RESULTS);
+    uint32_t cursor = query.cursor;
+    bool more = false;
+    EventEntry entry;
     
-    StaticJsonDocument<8192> doc;
-    JsonArray arr = doc.to<JsonArray>();
-    
-    // Guardar últimos 100 eventos
-    uint32_t start = recentEvents.size() > 100 ? recentEvents.size() - 100 : 0;
-    for (uint32_t i = start; i < recentEvents.size(); i++) {
-        JsonObject obj = arr.createNestedObject();
-        obj["id"] = recentEvents[i].id;
-        obj["ts"] = recentEvents[i].timestamp;
-        obj["lum"] = recentEvents[i].luminariaId;
-        obj["type"] = recentEvents[i].type;
-        obj["desc"] = recentEvents[i].description;
-        obj["user"] = recentEvents[i].user;
+    // Cada evento se agrega solo si queda lugar; si no, la página termina ahí
+    while (eventLog.next(query, entry)) {
+        if (results.size() >= limit || doc.memoryUsage() + sizeof(EventEntry) + 128 > EVENT_QUERY_DOC_SIZE) {
+            more = true;
+            break;
+        }
+        // Los char[] de entry se copian al documento
+        JsonObject obj = results.createNestedObject();
+        obj["id"] = entry.id;
+        obj["timestamp"] = entry.timestamp;
+        obj["luminaria"] = entry.luminaria;
+        obj["type"] = entry.type;
+        obj["description"] = entry.description;
+        obj["user"] = entry.user;
+        cursor = entry.position;
     }
     
-    serializeJson(doc, file);
-    file.close();
-    return true;
+    doc["next_cursor"] = cursor;
+    doc["more"] = more;
+    doc["total"] = eventLog.getRecordCount();
+    
+    String result;
+    serializeJson(doc, result);
+    return result;
 }
 
-bool DatabaseManager::loadEventsFromFile() {
+bool DatabaseManager::migrateLegacyEvents() {
+    // Versiones anteriores reescribían /db/events.db como un único JSON
     if (!LittleFS.exists(DB_EVENTS_FILE)) return false;
     
     File file = LittleFS.open(DB_EVENTS_FILE, "r");
@@ -166,26 +213,22 @@ bool DatabaseManager::loadEventsFromFile() {
     DeserializationError error = deserializeJson(doc, file);
     file.close();
     
-    if (error) return false;
-    
-    recentEvents.clear();
-    JsonArray arr = doc.as<JsonArray>();
-    
-    for (JsonObject obj : arr) {
-        Event event;
-        event.id = obj["id"];
-        event.timestamp = obj["ts"];
-        event.luminariaId = obj["lum"].as<String>();
-        event.type = (EventType)obj["type"].as<int>();
-        event.description = obj["desc"].as<String>();
-        event.user = obj["user"].as<String>();
-        recentEvents.push_back(event);
-        
-        if (event.id >= nextEventId) {
-            nextEventId = event.id + 1;
+    if (!error && eventLog.getRecordCount() == 0) {
+        for (JsonObject obj : doc.as<JsonArray>()) {
+            EventEntry entry;
+            entry.id = obj["id"];
+            entry.timestamp = obj["ts"];
+            entry.type = obj["type"].as<int>();
+            EventLog::copyText(entry.luminaria, sizeof(entry.luminaria), obj["lum"] | "");
+            EventLog::copyText(entry.description, sizeof(entry.description), obj["desc"] | "");
+            EventLog::copyText(entry.user, sizeof(entry.user), obj["user"] | "");
+            eventLog.append(entry);
         }
+        SystemLogger.info("Eventos migrados al log binario: " + String(eventLog.getRecordCount()), "DB");
     }
     
+    LittleFS.remove(DB_EVENTS_FILE);
+    LittleFS.remove(String(DB_EVENTS_FILE) + ".old");
     return true;
 }
 
@@ -244,6 +287,10 @@ bool DatabaseManager::enableSchedule(uint32_t id, bool enabled) {
     return false;
 }
 
+std::vector<Schedule> DatabaseManager::getAllSchedules() {
+    return schedules;
+}
+
 std::vector<Schedule> DatabaseManager::getActiveSchedules() {
     std::vector<Schedule> active;
     for (const auto& s : schedules) {
@@ -392,6 +439,11 @@ bool DatabaseManager::removeLuminariaFromZone(uint32_t zoneId, const String& lum
     return true;
 }
 
+Zone DatabaseManager::getZone(uint32_t id) {
+    if (zones.find(id) == zones.end()) return Zone();
+    return zones[id];
+}
+
 std::vector<String> DatabaseManager::getLuminariasInZone(uint32_t zoneId) {
     if (zones.find(zoneId) == zones.end()) return {};
     return zones[zoneId].luminarias;
@@ -483,51 +535,135 @@ bool DatabaseManager::loadZonesFromFile() {
 
 // === CONSUMO ===
 
-void DatabaseManager::logConsumption(const String& luminariaId, float power, float voltage, float current) {
-    ConsumptionRecord record;
-    record.timestamp = millis() / 1000;
-    record.luminariaId = luminariaId;
-    record.power = power;
-    record.voltage = voltage;
-    record.current = current;
-    record.energy = (power * 1.0) / 1000.0;  // kWh por hora
-    
-    consumptionCache.push_back(record);
+// Inicio de una ventana de 'hours' horas hacia atrás (los timestamps son uptime)
+static uint32_t windowStart(uint32_t now, uint32_t hours) {
+    uint32_t span = hours * 3600;
+    return now > span ? now - span : 0;
+}
+
+// Inicio del más viejo de los últimos 'buckets' buckets, contando el actual
+static uint32_t firstBucket(ConsumptionResolution resolution, uint32_t now, uint32_t buckets) {
+    uint32_t newest = ConsumptionStore::bucketStart(resolution, now);
+    uint32_t span = (buckets - 1) * ConsumptionStore::bucketWidth(resolution);
+    return newest > span ? newest - span : 0;
+}
+
+void DatabaseManager::logConsumption(const String& luminariaId, float power, float voltage, float /* current */) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(luminariaId));
+    if (pos == REGISTRY_NOT_FOUND) return;
     
-    // Limitar cache
-    if (consumptionCache.size() > 1000) {
-        consumptionCache.erase(consumptionCache.begin());
-    }
+    // La corriente no se guarda: se deriva de potencia y tensión
+    consumption.add(pos, millis() / 1000, power, voltage);
 }
 
 float DatabaseManager::getTotalConsumption() {
-    float total = 0;
-    for (const auto& record : consumptionCache) {
-        total += record.power;
-    }
-    return total;
+    return consumption.getTotalPower();
 }
 
 float DatabaseManager::getConsumptionByLuminaria(const String& luminariaId, uint32_t hours) {
-    float total = 0;
-    uint32_t cutoff = (millis() / 1000) - (hours * 3600);
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(luminariaId));
+    if (pos == REGISTRY_NOT_FOUND) return 0;
+    return consumption.getEnergy(pos, windowStart(millis() / 1000, hours)) / 1000.0;
+}
+
+float DatabaseManager::getAveragePower(const String& luminariaId, uint32_t hours) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(luminariaId));
+    if (pos == REGISTRY_NOT_FOUND) return 0;
+    return consumption.getAveragePower(pos, windowStart(millis() / 1000, hours));
+}
+
+float DatabaseManager::getConsumptionByZone(uint32_t zoneId, uint32_t hours) {
+    auto it = zones.find(zoneId);
+    if (it == zones.end()) return 0;
     
-    for (const auto& record : consumptionCache) {
-        if (record.luminariaId == luminariaId && record.timestamp > cutoff) {
-            total += record.energy;
-        }
+    float total = 0;
+    for (const auto& id : it->second.luminarias) {
+        total += getConsumptionByLuminaria(id, hours);
     }
     return total;
 }
 
+uint8_t DatabaseManager::getConsumptionHistory(const String& luminariaId, ConsumptionSample* out, uint8_t max) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(luminariaId));
+    if (pos == REGISTRY_NOT_FOUND) return 0;
+    return consumption.getSamples(pos, out, max);
+}
+
 String DatabaseManager::getConsumptionStats() {
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<768> doc;
+    uint32_t now = millis() / 1000;
+    
+    // Cada período se responde desde el nivel de rollup que lo cubre
+    ConsumptionBucket lastHour = consumption.summarize(CONSUMPTION_MINUTE, firstBucket(CONSUMPTION_MINUTE, now, 60));
+    ConsumptionBucket lastDay = consumption.summarize(CONSUMPTION_HOUR, firstBucket(CONSUMPTION_HOUR, now, 24));
+    ConsumptionBucket lastMonth = consumption.summarize(CONSUMPTION_DAY, firstBucket(CONSUMPTION_DAY, now, 30));
+    
+    uint16_t encendidas = 0;
+    uint16_t apagadas = 0;
+    uint16_t fallas = 0;
+    for (uint16_t i = 0; i < Luminarias.size(); i++) {
+        switch (Luminarias.getEstado(i)) {
+            case ESTADO_ENCENDIDA: encendidas++; break;
+            case ESTADO_APAGADA: apagadas++; break;
+            case ESTADO_FALLA: fallas++; break;
+            default: break;
+        }
+    }
+    
+    doc["total_power"] = consumption.getTotalPower();
+    doc["total_energy_1h"] = lastHour.energy / 1000;    // kWh
+    doc["total_energy_24h"] = lastDay.energy / 1000;    // kWh
+    doc["total_energy_30d"] = lastMonth.energy / 1000;  // kWh
+    doc["avg_power_24h"] = lastDay.average();
+    doc["min_power_24h"] = lastDay.minPower();
+    doc["max_power_24h"] = lastDay.maxPower();
+    doc["samples_24h"] = lastDay.count;
+    doc["samples_total"] = consumption.getTotalSamples();
+    doc["samples_retained"] = consumption.getRetainedSamples();
+    doc["fixtures_reporting"] = consumption.getReportingFixtures();
+    doc["luminarias_on"] = encendidas;
+    doc["luminarias_off"] = apagadas;
+    doc["luminarias_fault"] = fallas;
+    doc["memory_bytes"] = consumption.getMemoryFootprint();
+    
+    String result;
+    serializeJson(doc, result);
+    return result;
+}
+
+String DatabaseManager::getConsumptionJson(uint32_t hours) {
+    if (hours == 0) hours = 1;
+    uint32_t now = millis() / 1000;
     
-    float totalPower = getTotalConsumption();
-    doc["total_power"] = totalPower;
-    doc["total_energy_24h"] = totalPower * 24 / 1000;  // kWh
-    doc["records"] = consumptionCache.size();
-    doc["avg_voltage"] = 220;  // Valor ejemplo
+    ConsumptionResolution resolution;
+    uint32_t buckets;
+    if (hours <= 1) {
+        resolution = CONSUMPTION_MINUTE;
+        buckets = CONSUMPTION_MINUTE_BUCKETS;
+    } else if (hours <= CONSUMPTION_HOUR_BUCKETS) {
+        resolution = CONSUMPTION_HOUR;
+        buckets = hours;
+    } else {
+        resolution = CONSUMPTION_DAY;
+        buckets = min((hours + 23) / 24, (uint32_t)CONSUMPTION_DAY_BUCKETS);
+    }
+    uint32_t since = firstBucket(resolution, now, buckets);
+    
+    DynamicJsonDocument doc(CONSUMPTION_JSON_DOC_SIZE);
+    doc["hours"] = hours;
+    doc["resolution"] = ConsumptionStore::bucketWidth(resolution);
+    JsonArray array = doc.createNestedArray("buckets");
+    
+    consumption.forEachBucket(resolution, since, [&array](const ConsumptionBucket& b) {
+        JsonObject obj = array.createNestedObject();
+        obj["start"] = b.start;
+        obj["count"] = b.count;
+        obj["avg"] = b.average();
+        obj["min"] = b.minPower();
+        obj["max"] = b.maxPower();
+        obj["energy"] = b.energy;  // Wh
+        return true;
+    });
     
     String result;
     serializeJson(doc, result);
@@ -536,33 +672,184 @@ String DatabaseManager::getConsumptionStats() {
 
 // === EXPORTACIÓN ===
 
-String DatabaseManager::exportToCSV(const String& dataType) {
-    String csv = "";
-    
-    if (dataType == "events") {
-        csv = "ID,Timestamp,Luminaria,Type,Description,User\n";
-        for (const auto& e : recentEvents) {
-            csv += String(e.id) + "," + String(e.timestamp) + "," + e.luminariaId + "," +
-                   String(e.type) + "," + e.description + "," + e.user + "\n";
-        }
-    } else if (dataType == "schedules") {
-        csv = "ID,Name,Enabled,OnTime,OffTime,Days\n";
-        for (const auto& s : schedules) {
-            csv += String(s.id) + "," + s.name + "," + String(s.enabled) + "," +
-                   String(s.hourOn) + ":" + String(s.minuteOn) + "," +
-                   String(s.hourOff) + ":" + String(s.minuteOff) + "," +
-                   String(s.daysOfWeek) + "\n";
+// === EXPORTACIÓN ===
+
+// Cursores de exportación: recorren los datos registro a registro para
+// RecordStream, en JSON, MessagePack, CBOR o CSV (los eventos se leen de
+// flash con un EventCursor). Los textos se asignan por referencia, lo que es
+// válido porque cada registro se serializa antes del siguiente next().
+
+class EventExportSource : public RecordSource {
+private:
+    EventLog& log;
+    EventCursor cursor;
+    EventEntry entry;
+    uint32_t remaining;  // Fijado al crear: lo que se agregue durante la exportación no entra
+
+public:
+    explicit EventExportSource(EventLog& log) : log(log), remaining(log.getRecordCount()) {}
+
+    bool next(JsonObject obj) override {
+        if (remaining == 0 || !log.next(cursor, entry)) return false;
+        remaining--;
+        obj["id"] = entry.id;
+        obj["timestamp"] = entry.timestamp;
+        obj["luminaria"] = (const char*)entry.luminaria;
+        obj["type"] = entry.type;
+        obj["description"] = (const char*)entry.description;
+        obj["user"] = (const char*)entry.user;
+        return true;
+    }
+
+    size_t count() override { return remaining; }
+    const char* csvHeader() override { return "ID,Timestamp,Luminaria,Type,Description,User"; }
+};
+
+class ScheduleExportSource : public RecordSource {
+private:
+    const std::vector<Schedule>& schedules;
+    size_t pos;
+    char onTime[8];
+    char offTime[8];
+
+public:
+    explicit ScheduleExportSource(const std::vector<Schedule>& schedules) : schedules(schedules), pos(0) {}
+
+    bool next(JsonObject obj) override {
+        if (pos >= schedules.size()) return false;
+        const Schedule& s = schedules[pos++];
+        obj["id"] = s.id;
+        obj["name"] = s.name.c_str();
+        obj["enabled"] = s.enabled;
+        obj["hourOn"] = s.hourOn;
+        obj["minuteOn"] = s.minuteOn;
+        obj["hourOff"] = s.hourOff;
+        obj["minuteOff"] = s.minuteOff;
+        obj["daysOfWeek"] = s.daysOfWeek;
+        obj["zones"] = s.zones.c_str();
+        return true;
+    }
+
+    size_t count() override { return schedules.size() - pos; }
+    const char* csvHeader() override { return "ID,Name,Enabled,OnTime,OffTime,Days"; }
+
+    bool nextCsv(JsonObject obj) override {
+        if (pos >= schedules.size()) return false;
+        const Schedule& s = schedules[pos++];
+        snprintf(onTime, sizeof(onTime), "%u:%u", s.hourOn, s.minuteOn);
+        snprintf(offTime, sizeof(offTime), "%u:%u", s.hourOff, s.minuteOff);
+        obj["id"] = s.id;
+        obj["name"] = s.name.c_str();
+        obj["enabled"] = s.enabled;
+        obj["onTime"] = (const char*)onTime;
+        obj["offTime"] = (const char*)offTime;
+        obj["days"] = s.daysOfWeek;
+        return true;
+    }
+};
+
+class ZoneExportSource : public RecordSource {
+private:
+    const std::map<uint32_t, Zone>& zones;
+    uint32_t lastId;
+    bool started;
+
+public:
+    // Se avanza por clave y no por iterador: el mapa puede cambiar entre fragmentos
+    const Zone* advance() {
+        auto it = started ? zones.upper_bound(lastId) : zones.begin();
+        if (it == zones.end()) return nullptr;
+        lastId = it->first;
+        started = true;
+        return &it->second;
+    }
+
+public:
+    explicit ZoneExportSource(const std::map<uint32_t, Zone>& zones) : zones(zones), lastId(0), started(false) {}
+
+    bool next(JsonObject obj) override {
+        const Zone* zone = advance();
+        if (!zone) return false;
+        const Zone& z = *zone;
+
+        obj["id"] = z.id;
+        obj["name"] = z.name.c_str();
+        obj["description"] = z.description.c_str();
+        obj["luminarias"] = z.luminarias.size();
+        obj["consumption"] = z.avgConsumption;
+        obj["active"] = z.active;
+        return true;
+    }
+
+    size_t count() override {
+        return started ? std::distance(zones.upper_bound(lastId), zones.end()) : zones.size();
+    }
+
+    const char* csvHeader() override { return "ID,Name,Description,Luminarias,Active"; }
+
+    bool nextCsv(JsonObject obj) override {
+        const Zone* zone = advance();
+        if (!zone) return false;
+        obj["id"] = zone->id;
+        obj["name"] = zone->name.c_str();
+        obj["description"] = zone->description.c_str();
+        obj["luminarias"] = zone->luminarias.size();
+        obj["active"] = zone->active;
+        return true;
+    }
+};
+
+class ConsumptionExportSource : public RecordSource {
+private:
+    const ConsumptionStore& store;
+    uint16_t pos;       // Luminaria actual
+    uint8_t sample;     // Próxima muestra de la luminaria actual
+    uint8_t sampleCount;
+    ConsumptionSample samples[CONSUMPTION_SERIES_DEPTH];
+    char id[16];
+
+    void load() {
+        sample = 0;
+        sampleCount = pos < Luminarias.size() ? store.getSamples(pos, samples, CONSUMPTION_SERIES_DEPTH) : 0;
+        if (sampleCount) LuminariaRegistry::formatId(Luminarias.getId(pos), id, sizeof(id));
+    }
+
+public:
+    explicit ConsumptionExportSource(const ConsumptionStore& store) : store(store), pos(0) { load(); }
+
+    bool next(JsonObject obj) override {
+        // Muestras crudas de cada luminaria, de la más vieja a la más nueva
+        while (sample >= sampleCount) {
+            if (pos >= Luminarias.size()) return false;
+            pos++;
+            load();
         }
-    } else if (dataType == "zones") {
-        csv = "ID,Name,Description,Luminarias,Active\n";
-        for (const auto& pair : zones) {
-            const Zone& z = pair.second;
-            csv += String(z.id) + "," + z.name + "," + z.description + "," +
-                   String(z.luminarias.size()) + "," + String(z.active) + "\n";
+        const ConsumptionSample& r = samples[sampleCount - 1 - sample++];
+        obj["timestamp"] = r.timestamp;
+        obj["luminaria"] = (const char*)id;
+        obj["power"] = r.power;
+        obj["voltage"] = r.voltage;
+        obj["current"] = r.voltage > 0 ? r.power / r.voltage : 0;
+        return true;
+    }
+
+    size_t count() override {
+        size_t remaining = sampleCount - sample;
+        for (uint16_t i = pos + 1; i < Luminarias.size(); i++) {
+            remaining += store.getSampleCount(i);
         }
+        return remaining;
     }
-    
-    return csv;
+
+    const char* csvHeader() override { return "Timestamp,Luminaria,Power,Voltage,Current"; }
+};
+
+RecordSource* DatabaseManager::createExportSource(const String& dataType) {
+    if (dataType == "events") return new EventExportSource(eventLog);
+    if (dataType == "schedules") return new ScheduleExportSource(schedules);
+    if (dataType == "zones") return new ZoneExportSource(zones);
+    if (dataType == "consumption") return new ConsumptionExportSource(consumption);
+    return nullptr;
 }
 
 // === ESTADÍSTICAS ===
@@ -570,12 +857,16 @@ String DatabaseManager::exportToCSV(const String& dataType) {
 String DatabaseManager::getDatabaseStats() {
     StaticJsonDocument<512> doc;
     
-    doc["events"] = recentEvents.size();
+    doc["events"] = eventLog.getRecordCount();
+    doc["events_recovered_bytes"] = eventLog.getRecoveredBytes();
+    doc["events_write_errors"] = eventLog.getWriteErrors();
+    doc["events_index_bytes"] = eventLog.getIndexFootprint();
+    doc["events_time_buckets"] = eventLog.getTimeBucketCount();
     doc["schedules"] = schedules.size();
     doc["zones"] = zones.size();
-    doc["consumption_records"] = consumptionCache.size();
+    doc["consumption_records"] = consumption.getRetainedSamples();
     doc["db_size"] = getDatabaseSize();
-    doc["next_event_id"] = nextEventId;
+    doc["next_event_id"] = eventLog.getNextId();
     doc["next_schedule_id"] = nextScheduleId;
     doc["next_zone_id"] = nextZoneId;
     
@@ -585,15 +876,7 @@ String DatabaseManager::getDatabaseStats() {
 }
 
 size_t DatabaseManager::getDatabaseSize() {
-    size_t total = 0;
-    
-    if (LittleFS.exists(DB_EVENTS_FILE)) {
-        File f = LittleFS.open(DB_EVENTS_FILE, "r");
-        if (f) {
-            total += f.size();
-            f.close();
-        }
-    }
+    size_t total = eventLog.getFlashBytes();
     
     if (LittleFS.exists(DB_SCHEDULE_FILE)) {
         File f = LittleFS.open(DB_SCHEDULE_FILE, "r");
@@ -615,13 +898,65 @@ size_t DatabaseManager::getDatabaseSize() {
 }
 
 void DatabaseManager::performMaintenance() {
-    // Guardar todos los cambios pendientes
-    saveEventsToFile();
+    // Guardar todos los cambios pendientes (los eventos ya están en flash)
     saveSchedulesToFile();
     saveZonesToFile();
     
-    // Limpiar eventos antiguos
-    clearOldEvents(30);
+    // Retención, compactación y backup corren por pasos en segundo plano
+    Maintenance.request(MAINTENANCE_RETENTION);
+    Maintenance.request(MAINTENANCE_COMPACTION);
+    Maintenance.request(MAINTENANCE_BACKUP);
+    
+    SystemLogger.info("Mantenimiento de base de datos encolado", "DB");
+}
+
+bool DatabaseManager::compactDatabase() {
+    return Maintenance.request(MAINTENANCE_COMPACTION);
+}
+
+bool DatabaseManager::backupDatabase() {
+    return Maintenance.request(MAINTENANCE_BACKUP);
+}
+
+bool DatabaseManager::expireEventSegment(uint32_t daysToKeep) {
+    uint32_t now = millis() / 1000;
+    uint32_t maxAge = daysToKeep * 86400UL;
+    if (now <= maxAge) return false;
+    return eventLog.dropOldestSegmentBefore(now - maxAge);
+}
+
+bool DatabaseManager::rotateEventsAhead() {
+    // Margen para un par de eventos: la rotación (y el borrado del segmento
+    // más viejo) se hace acá y no dentro de logEvent()
+    return eventLog.rotateAhead(EVENT_RECORD_MAX * 2);
+}
+
+bool DatabaseManager::isStaleFile(const char* dir, const char* name) {
+    const char* slash = strrchr(name, '/');
+    const char* base = slash ? slash + 1 : name;
+    
+    if (strcmp(dir, EVENT_DIR) == 0) {
+        return !eventLog.isLiveFile(base);
+    }
     
-    SystemLogger.info("Mantenimiento de base de datos completado", "DB");
-}
\ No newline at end of file
+    // Consumo anterior a ConsumptionStore (ya no se escribe) y copias a medio hacer
+    size_t len = strlen(base);
+    return strcmp(base, strrchr(DB_CONSUMPTION_FILE, '/') + 1) == 0 ||
+           (len > 4 && strcmp(base + len - 4, ".tmp") == 0);
+}
+
+bool DatabaseManager::getBackupSource(uint32_t index, char* path, size_t size, bool& immutable) {
+    immutable = false;
+    switch (index) {
+        case 0: EventLog::copyText(path, size, DB_SCHEDULE_FILE); return true;
+        case 1: EventLog::copyText(path, size, DB_ZONES_FILE); return true;
+        case 2: EventLog::copyText(path, size, EVENT_MANIFEST_FILE); return true;
+    }
+    
+    // Segmentos del log: los cerrados ya no cambian
+    uint32_t segment = eventLog.getFirstSegment() + (index - 3);
+    if (segment > eventLog.getLastSegment()) return false;
+    EventLog::segmentPath(segment, path, size);
+    immutable = segment < eventLog.getLastSegment();
+    return true;
+}
@@ -2,21 +2,27 @@
 #define DATABASE_MANAGER_H
 
 #include <Arduino.h>
-#include <LittleFS.h>
+#include "hal/Platform.h"
 #include <ArduinoJson.h>
 #include "config.h"
 #include "Logger.h"
+#include "RecordStream.h"
+#include "ConsumptionStore.h"
+#include "EventLog.h"
 #include <vector>
 #include <map>
 
 // Configuración de base de datos
 #define DB_PATH "/db/"
-#define DB_EVENTS_FILE "/db/events.db"
+#define DB_EVENTS_FILE "/db/events.db"  // Formato JSON anterior; se migra a EventLog al arrancar
 #define DB_SCHEDULE_FILE "/db/schedule.db"
 #define DB_ZONES_FILE "/db/zones.db"
 #define DB_CONSUMPTION_FILE "/db/consumption.db"
-#define MAX_RECORDS 1000
 #define DB_ROTATION_SIZE 50000  // 50KB máximo por archivo
+#define EVENT_QUERY_MAX_RESULTS 50
+#define EVENT_QUERY_DOC_SIZE 6144
+#define CONSUMPTION_JSON_DOC_SIZE (JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(CONSUMPTION_MINUTE_BUCKETS) + \
+                                   CONSUMPTION_MINUTE_BUCKETS * JSON_OBJECT_SIZE(6))
 
 // Tipos de eventos
 enum EventType {
@@ -26,7 +32,8 @@ enum EventType {
     EVENT_REPAIR,
     EVENT_SCHEDULE,
     EVENT_MANUAL,
-    EVENT_SENSOR
+    EVENT_SENSOR,
+    EVENT_STATE_CHANGE  // Alta de nodo / estado inicial
 };
 
 // Estructura de evento
@@ -63,33 +70,21 @@ struct Zone {
     bool active;
 };
 
-// Estructura de consumo
-struct ConsumptionRecord {
-    uint32_t timestamp;
-    String luminariaId;
-    float power;  // Watts
-    float voltage;  // Voltios
-    float current;  // Amperios
-    float energy;  // kWh acumulado
-};
-
 class DatabaseManager {
 private:
-    uint32_t nextEventId;
     uint32_t nextScheduleId;
     uint32_t nextZoneId;
     
     // Cache en memoria
-    std::vector<Event> recentEvents;
+    EventLog eventLog;  // Eventos en segmentos binarios + ring de recientes
     std::vector<Schedule> schedules;
     std::map<uint32_t, Zone> zones;
-    std::vector<ConsumptionRecord> consumptionCache;
+    ConsumptionStore consumption;  // Series por luminaria y rollups 1m/1h/1d
     
     // Funciones internas
     bool ensureDatabase();
     void rotateDatabase(const String& filename);
-    bool saveEventsToFile();
-    bool loadEventsFromFile();
+    bool migrateLegacyEvents();
     bool saveSchedulesToFile();
     bool loadSchedulesFromFile();
     bool saveZonesToFile();
@@ -107,7 +102,9 @@ public:
     std::vector<Event> getEvents(uint32_t limit = 50, uint32_t offset = 0);
     std::vector<Event> getEventsByLuminaria(const String& luminariaId, uint32_t limit = 20);
     std::vector<Event> getEventsByType(EventType type, uint32_t limit = 20);
+    std::vector<Event> queryEvents(EventQuery& query, uint32_t limit);
     String getEventsJson(uint32_t limit = 50);
+    String queryEventsJson(EventQuery& query, uint8_t limit = EVENT_QUERY_MAX_RESULTS);
     bool clearOldEvents(uint32_t daysToKeep = 30);
     
     // === PROGRAMACIÓN HORARIA ===
@@ -135,18 +132,22 @@ public:
     String getZonesJson();
     
     // === CONSUMO ENERGÉTICO ===
+    // Las luminarias se identifican por su posición en LuminariaRegistry;
+    // las muestras de IDs que no están en el registro se descartan
     void logConsumption(const String& luminariaId, float power, float voltage, float current);
-    float getTotalConsumption();
-    float getConsumptionByLuminaria(const String& luminariaId, uint32_t hours = 24);
-    float getConsumptionByZone(uint32_t zoneId, uint32_t hours = 24);
-    std::vector<ConsumptionRecord> getConsumptionHistory(const String& luminariaId, uint32_t limit = 100);
+    float getTotalConsumption();  // W: suma de la última potencia de cada luminaria
+    float getConsumptionByLuminaria(const String& luminariaId, uint32_t hours = 24);  // kWh
+    float getAveragePower(const String& luminariaId, uint32_t hours = 1);             // W
+    float getConsumptionByZone(uint32_t zoneId, uint32_t hours = 24);                 // kWh
+    uint8_t getConsumptionHistory(const String& luminariaId, ConsumptionSample* out, uint8_t max);
     String getConsumptionStats();
-    String getConsumptionJson(uint32_t hours = 24);
+    String getConsumptionJson(uint32_t hours = 24);  // Buckets de 1 min (<= 1 h), 1 h (<= 48 h) o 1 día
     
     // === EXPORTACIÓN ===
-    String exportToCSV(const String& dataType);  // events, schedules, zones, consumption
-    String exportToJSON(const String& dataType);
     bool importFromJSON(const String& dataType, const String& jsonData);
+    // Cursor de exportación para RecordStream (JSON, MessagePack, CBOR o CSV):
+    // events, schedules, zones, consumption; nullptr si el tipo no existe
+    RecordSource* createExportSource(const String& dataType);
     
     // === ESTADÍSTICAS ===
     String getDatabaseStats();
@@ -156,10 +157,18 @@ public:
     size_t getDatabaseSize();
     
     // === MANTENIMIENTO ===
+    // compactDatabase/backupDatabase/performMaintenance encolan el trabajo en
+    // MaintenanceEngine, que lo hace por pasos desde loop()
     bool compactDatabase();
     bool backupDatabase();
     bool restoreDatabase();
     void performMaintenance();
+    
+    // Pasos acotados para MaintenanceEngine
+    bool expireEventSegment(uint32_t daysToKeep);  // true si borró un segmento
+    bool rotateEventsAhead();                      // true si rotó
+    bool isStaleFile(const char* dir, const char* name);
+    bool getBackupSource(uint32_t index, char* path, size_t size, bool& immutable);
 };
 
 // Instancia global
@@ -0,0 +1,26 @@
+#include "DeferredQueue.h"
+
+DeferredQueue Deferred;
+
+DeferredQueue::DeferredQueue() : posted(0), dropped(0), executed(0) {}
+
+bool DeferredQueue::post(DeferredTask task) {
+    if (!queue.push(task)) {
+        dropped++;
+        return false;
+    }
+    posted++;
+    return true;
+}
+
+void DeferredQueue::run() {
+    // Lo que encolen las tareas mientras corren queda para la próxima iteración
+    DeferredTask tasks[DEFERRED_QUEUE_SIZE];
+    size_t count = queue.popN(tasks, DEFERRED_QUEUE_SIZE);
+
+    for (size_t i = 0; i < count; i++) {
+        tasks[i]();
+    }
+    executed += count;
+}
+
@@ -0,0 +1,44 @@
+#ifndef DEFERRED_QUEUE_H
+#define DEFERRED_QUEUE_H
+
+#include <Arduino.h>
+#include <SpscRingBuffer.h>
+#include "hal/Platform.h"
+#include "config.h"
+
+#define DEFERRED_QUEUE_SIZE 16  // Potencia de dos (SpscRingBuffer)
+
+typedef void (*DeferredTask)();
+
+// Trabajo diferido de los Ticker a loop().
+//
+// En el ESP8266 los callbacks de Ticker corren en el contexto del SDK: no
+// deben escribir en LittleFS, bloquear ni asignar memoria. Los callbacks solo
+// encolan la tarea (post) y loop() la ejecuta (run). Todos los Ticker corren
+// en el mismo contexto, así que son un único productor y loop() el único
+// consumidor de la cola SPSC.
+class DeferredQueue {
+private:
+    SpscRingBuffer<DeferredTask, DEFERRED_QUEUE_SIZE> queue;
+    volatile uint32_t posted;    // Escrito solo por el productor
+    volatile uint32_t dropped;   // Escrito solo por el productor
+    uint32_t executed;           // Escrito solo por el consumidor
+
+public:
+    DeferredQueue();
+
+    // Desde Ticker/ISR: no bloquea; false si la cola está llena
+    bool post(DeferredTask task);
+
+    // Desde loop(): ejecuta las tareas encoladas hasta este momento
+    void run();
+
+    size_t getPending() const { return queue.size(); }
+    uint32_t getPosted() const { return posted; }
+    uint32_t getDropped() const { return dropped; }
+    uint32_t getExecuted() const { return executed; }
+};
+
+extern DeferredQueue Deferred;
+
+#endif // DEFERRED_QUEUE_H
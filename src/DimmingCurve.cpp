@@ -0,0 +1,65 @@
+#include "DimmingCurve.h"
+
+using dimming_curve::Table;
+using dimming_curve::build;
+using dimming_curve::valid;
+
+// Extremos y monotonía verificados en compilación para cada curva y tamaño
+static_assert(valid(DIMMING_CURVE_CIE1931, DIMMING_CURVE_STEPS), "Curva CIE 1931 (8 bits) inválida");
+static_assert(valid(DIMMING_CURVE_GAMMA22, DIMMING_CURVE_STEPS), "Curva gamma 2.2 (8 bits) inválida");
+static_assert(valid(DIMMING_CURVE_LINEAR, DIMMING_CURVE_STEPS), "Curva lineal (8 bits) inválida");
+static_assert(valid(DIMMING_CURVE_CIE1931, DIMMING_CURVE_FINE_STEPS), "Curva CIE 1931 (10 bits) inválida");
+static_assert(valid(DIMMING_CURVE_GAMMA22, DIMMING_CURVE_FINE_STEPS), "Curva gamma 2.2 (10 bits) inválida");
+static_assert(valid(DIMMING_CURVE_LINEAR, DIMMING_CURVE_FINE_STEPS), "Curva lineal (10 bits) inválida");
+
+// Tablas en flash, en el orden de DimmingCurveType
+static const Table<DIMMING_CURVE_STEPS> CURVES[DIMMING_CURVE_COUNT] PROGMEM = {
+    build<DIMMING_CURVE_STEPS>(DIMMING_CURVE_CIE1931),
+    build<DIMMING_CURVE_STEPS>(DIMMING_CURVE_GAMMA22),
+    build<DIMMING_CURVE_STEPS>(DIMMING_CURVE_LINEAR)
+};
+
+static const Table<DIMMING_CURVE_FINE_STEPS> FINE_CURVES[DIMMING_CURVE_COUNT] PROGMEM = {
+    build<DIMMING_CURVE_FINE_STEPS>(DIMMING_CURVE_CIE1931),
+    build<DIMMING_CURVE_FINE_STEPS>(DIMMING_CURVE_GAMMA22),
+    build<DIMMING_CURVE_FINE_STEPS>(DIMMING_CURVE_LINEAR)
+};
+
+static const char* const CURVE_NAMES[DIMMING_CURVE_COUNT] = {"cie1931", "gamma22", "linear"};
+
+uint16_t dimmingDuty(DimmingCurveType curve, uint8_t percent) {
+    if (curve >= DIMMING_CURVE_COUNT) curve = DIMMING_CURVE_CIE1931;
+    if (percent == 0) return 0;
+    if (percent > 100) percent = 100;
+
+    uint8_t index = ((uint16_t)percent * (DIMMING_CURVE_STEPS - 1) + 50) / 100;
+    uint16_t duty = pgm_read_word(&CURVES[curve].duty[index]);
+    return duty ? duty : 1;
+}
+
+uint16_t dimmingDutyFine(DimmingCurveType curve, uint16_t level) {
+    if (curve >= DIMMING_CURVE_COUNT) curve = DIMMING_CURVE_CIE1931;
+    if (level >= DIMMING_CURVE_FINE_STEPS) level = DIMMING_CURVE_FINE_STEPS - 1;
+    return pgm_read_word(&FINE_CURVES[curve].duty[level]);
+}
+
+uint8_t dimmingLinearPercent(DimmingCurveType curve, uint8_t percent) {
+    if (percent == 0) return 0;
+    uint8_t linear = ((uint32_t)dimmingDuty(curve, percent) * 100 + DIMMING_PWM_MAX / 2) / DIMMING_PWM_MAX;
+    return linear ? linear : 1;
+}
+
+const char* dimmingCurveName(DimmingCurveType curve) {
+    return curve < DIMMING_CURVE_COUNT ? CURVE_NAMES[curve] : "unknown";
+}
+
+bool parseDimmingCurve(const char* text, DimmingCurveType& out) {
+    if (!text) return false;
+    for (uint8_t i = 0; i < DIMMING_CURVE_COUNT; i++) {
+        if (strcmp(text, CURVE_NAMES[i]) == 0) {
+            out = (DimmingCurveType)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,119 @@
+#ifndef DIMMING_CURVE_H
+#define DIMMING_CURVE_H
+
+#include <Arduino.h>
+
+// Curvas de dimming perceptuales.
+//
+// Los niveles de escenas, fades y frames (0-100%) son brillo percibido: un
+// paso de 1% se ve igual de grande en cualquier punto del recorrido. La
+// curva de cada tipo de luminaria lo traduce al duty de PWM (10 bits):
+//
+//   CIE 1931   L* -> luminancia relativa: lineal por debajo de L* = 8 y
+//              cúbica arriba; la recomendada para LED
+//   Gamma 2.2  duty = nivel^2.2
+//   Lineal     duty = nivel (drivers que ya corrigen por su cuenta)
+//
+// Las tablas se generan en compilación (constexpr) y viven en flash: 256
+// entradas para niveles de 8 bits y 1024 para el PWM de 10 bits del nodo.
+
+#define DIMMING_PWM_MAX 1023             // Duty máximo (analogWriteRange del nodo)
+#define DIMMING_CURVE_STEPS 256          // Entradas de la tabla de 8 bits
+#define DIMMING_CURVE_FINE_STEPS 1024    // Entradas de la tabla de 10 bits
+#define DIMMING_CURVE_NEWTON_STEPS 40    // Iteraciones de la raíz quinta de gamma 2.2
+
+// El valor 0 es el de las luminarias sin configurar
+enum DimmingCurveType : uint8_t {
+    DIMMING_CURVE_CIE1931 = 0,
+    DIMMING_CURVE_GAMMA22 = 1,
+    DIMMING_CURVE_LINEAR = 2,
+    DIMMING_CURVE_COUNT
+};
+
+// === GENERACIÓN EN COMPILACIÓN (C++11: una sola expresión por función) ===
+
+namespace dimming_curve {
+
+constexpr double cube(double x) { return x * x * x; }
+
+// L* en [0, 100] -> luminancia relativa en [0, 1]
+constexpr double cie1931(double x) {
+    return x * 100 <= 8 ? x * 100 / 903.3 : cube((x * 100 + 16) / 116);
+}
+
+// Newton para y^5 = x desde y = 1 (converge por arriba para x en (0, 1])
+constexpr double root5(double x, double y, int steps) {
+    return steps == 0 ? y : root5(x, (4 * y + x / (y * y * y * y)) / 5, steps - 1);
+}
+
+constexpr double gamma22(double x) {
+    return x <= 0 ? 0 : x * x * root5(x, 1.0, DIMMING_CURVE_NEWTON_STEPS);
+}
+
+constexpr double relative(uint8_t curve, double x) {
+    return curve == DIMMING_CURVE_CIE1931 ? cie1931(x) :
+           curve == DIMMING_CURVE_GAMMA22 ? gamma22(x) : x;
+}
+
+// Entrada i de una tabla de n entradas
+constexpr uint16_t value(uint8_t curve, uint16_t i, uint16_t n) {
+    return (uint16_t)(relative(curve, (double)i / (n - 1)) * DIMMING_PWM_MAX + 0.5);
+}
+
+// Chequeos por mitades (profundidad log n, dentro del límite de constexpr)
+constexpr bool monotonic(uint8_t curve, uint16_t n, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? value(curve, from, n) <= value(curve, to, n)
+                          : monotonic(curve, n, from, (from + to) / 2) && monotonic(curve, n, (from + to) / 2, to);
+}
+
+constexpr bool valid(uint8_t curve, uint16_t n) {
+    return value(curve, 0, n) == 0 && value(curve, n - 1, n) == DIMMING_PWM_MAX && monotonic(curve, n, 0, n - 1);
+}
+
+// Secuencia de índices 0..N-1 armada por mitades, para no pasar el
+// límite de profundidad de templates con 1024 entradas
+template<uint16_t... I> struct Indices {};
+
+template<class A, class B> struct Concat;
+template<uint16_t... A, uint16_t... B>
+struct Concat<Indices<A...>, Indices<B...> > {
+    typedef Indices<A..., (uint16_t)(sizeof...(A) + B)...> type;
+};
+
+template<uint16_t N> struct MakeIndices {
+    typedef typename Concat<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type>::type type;
+};
+template<> struct MakeIndices<0> { typedef Indices<> type; };
+template<> struct MakeIndices<1> { typedef Indices<0> type; };
+
+template<uint16_t N> struct Table {
+    uint16_t duty[N];
+};
+
+template<uint16_t... I>
+constexpr Table<sizeof...(I)> build(uint8_t curve, Indices<I...>) {
+    return Table<sizeof...(I)>{{ value(curve, I, sizeof...(I))... }};
+}
+
+template<uint16_t N>
+constexpr Table<N> build(uint8_t curve) {
+    return build(curve, typename MakeIndices<N>::type());
+}
+
+} // namespace dimming_curve
+
+// === CONSULTA ===
+
+// Duty para un nivel percibido 0-100% (tabla de 8 bits); un nivel encendido nunca da duty 0
+uint16_t dimmingDuty(DimmingCurveType curve, uint8_t percent);
+// Duty para un nivel de 10 bits (0-1023, tabla de 1024 entradas)
+uint16_t dimmingDutyFine(DimmingCurveType curve, uint16_t level);
+
+// Nivel percibido llevado a porcentaje de duty, para luminarias que ponen el
+// porcentaje directo en el PWM
+uint8_t dimmingLinearPercent(DimmingCurveType curve, uint8_t percent);
+
+const char* dimmingCurveName(DimmingCurveType curve);
+bool parseDimmingCurve(const char* text, DimmingCurveType& out);
+
+#endif // DIMMING_CURVE_H
@@ -0,0 +1,118 @@
+#include "DimmingOutput.h"
+#include <algorithm>
+
+DimmingOutput DimmingOut;
+
+static const char FRAME_HEAD[] = "{\"command\":\"" DIMMING_COMMAND "\",\"levels\":[";
+#define FRAME_ID_SIZE 8          // ID en hexadecimal
+#define FRAME_GROUP_SIZE 9       // "\"],[100,\"" como máximo
+#define FRAME_CLOSE_SIZE 4       // "\"]]}"
+
+static_assert(DIMMING_FRAME_SIZE >= sizeof(FRAME_HEAD) + FRAME_GROUP_SIZE + FRAME_ID_SIZE + FRAME_CLOSE_SIZE,
+              "DIMMING_FRAME_SIZE no alcanza para un ID");
+
+DimmingOutput::DimmingOutput() {
+    clear();
+    changes = 0;
+    coalesced = 0;
+    frames = 0;
+    bytes = 0;
+}
+
+void DimmingOutput::clear() {
+    memset(dirtyBits, 0, sizeof(dirtyBits));
+    dirtyCount = 0;
+    frameLength = 0;
+}
+
+void DimmingOutput::set(uint16_t pos, uint8_t level) {
+    if (pos >= MAX_LUCES) return;
+
+    uint8_t mask = 1 << (pos & 7);
+    if (dirtyBits[pos >> 3] & mask) {
+        coalesced++;
+    } else {
+        dirtyBits[pos >> 3] |= mask;
+        dirty[dirtyCount++] = pos;
+    }
+    // Las luminarias que ponen el porcentaje directo en el PWM reciben el
+    // nivel ya corregido; las demás aplican su curva en el nodo
+    if (Luminarias.getCurva(pos) == DIMMING_CURVE_LINEAR) {
+        level = dimmingLinearPercent(DIMMING_CURVE_CIE1931, level);
+    }
+    levels[pos] = level;
+    changes++;
+}
+
+void DimmingOutput::append(const char* text) {
+    size_t len = strlen(text);
+    memcpy(frame + frameLength, text, len);
+    frameLength += len;
+}
+
+void DimmingOutput::beginFrame() {
+    frameLength = 0;
+    append(FRAME_HEAD);
+}
+
+void DimmingOutput::endFrame(uint8_t zone, bool groupOpen) {
+    if (groupOpen) append("\"]");
+    append("]}");
+    frame[frameLength] = '\0';
+
+    frames++;
+    bytes += frameLength;
+    if (sink) sink(zone == ZONA_NINGUNA ? nullptr : Luminarias.getZoneName(zone), frame);
+}
+
+void DimmingOutput::flush() {
+    if (dirtyCount == 0) return;
+
+    // Orden por zona y nivel: cada zona es una corrida y cada nivel un grupo
+    std::sort(dirty, dirty + dirtyCount, [this](uint16_t a, uint16_t b) {
+        uint16_t keyA = (uint16_t)Luminarias.getZona(a) << 8 | levels[a];
+        uint16_t keyB = (uint16_t)Luminarias.getZona(b) << 8 | levels[b];
+        return keyA < keyB;
+    });
+
+    uint16_t i = 0;
+    while (i < dirtyCount) {
+        uint8_t zone = Luminarias.getZona(dirty[i]);
+        int16_t groupLevel = -1;
+        beginFrame();
+
+        for (; i < dirtyCount && Luminarias.getZona(dirty[i]) == zone; i++) {
+            uint16_t pos = dirty[i];
+            uint8_t level = levels[pos];
+
+            // Si el ID (y el grupo nuevo) no entra, se cierra el frame
+            size_t need = FRAME_ID_SIZE + FRAME_CLOSE_SIZE + (level != groupLevel ? FRAME_GROUP_SIZE : 0);
+            if (groupLevel >= 0 && frameLength + need > DIMMING_FRAME_SIZE) {
+                endFrame(zone, true);
+                beginFrame();
+                groupLevel = -1;
+            }
+
+            char text[16];
+            if (level != groupLevel) {
+                snprintf(text, sizeof(text), "%s[%u,\"", groupLevel >= 0 ? "\"]," : "", (unsigned)level);
+                append(text);
+                groupLevel = level;
+            }
+            snprintf(text, sizeof(text), "%08lX", (unsigned long)Luminarias.getId(pos));
+            append(text);
+
+            dirtyBits[pos >> 3] &= ~(1 << (pos & 7));
+        }
+        endFrame(zone, groupLevel >= 0);
+    }
+    dirtyCount = 0;
+}
+
+void DimmingOutput::getStatus(JsonObject obj) const {
+    obj["changes"] = changes;
+    obj["coalesced"] = coalesced;
+    obj["frames"] = frames;
+    obj["bytes"] = bytes;
+    obj["pending"] = dirtyCount;
+}
@@ -0,0 +1,74 @@
+#ifndef DIMMING_OUTPUT_H
+#define DIMMING_OUTPUT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <functional>
+#include "config.h"
+#include "LuminariaRegistry.h"
+
+// Configuración de los frames de dimming
+#define DIMMING_FRAME_SIZE 400   // Payload máximo por frame (con el topic entra en MQTT_MAX_PACKET_SIZE)
+#define DIMMING_COMMAND "set_levels"
+
+// Publicación de un frame: 'zone' es el nombre de la zona o nullptr para
+// las luminarias sin zona (se envían a todos)
+typedef std::function<void(const char* zone, const char* payload)> DimmingFrameSink;
+
+// Etapa de salida del dimming.
+//
+// Los cambios de brillo de un tick (fades, escenas, efectos) se acumulan por
+// posición en el registro; si una luminaria cambia dos veces antes de
+// flush() solo sale el último nivel. flush() agrupa los pendientes por zona
+// y nivel y publica un frame por zona en lugar de un mensaje por luminaria:
+//
+//   {"command":"set_levels","levels":[[40,"0510000005100005"],[41,"05100001"]]}
+//
+// Cada grupo es un nivel y los IDs numéricos de sus luminarias, 8 dígitos
+// hexadecimales cada uno sin separador. Los niveles son brillo percibido
+// (DimmingCurve.h), salvo para las luminarias de curva lineal, que reciben
+// el porcentaje de duty ya corregido con CIE 1931. Si una zona no entra en
+// DIMMING_FRAME_SIZE se parte en varios frames.
+class DimmingOutput {
+private:
+    uint8_t levels[MAX_LUCES];
+    uint16_t dirty[MAX_LUCES];               // Posiciones pendientes, sin repetir
+    uint8_t dirtyBits[(MAX_LUCES + 7) / 8];
+    uint16_t dirtyCount;
+
+    char frame[DIMMING_FRAME_SIZE + 1];
+    size_t frameLength;
+    DimmingFrameSink sink;
+
+    uint32_t changes;
+    uint32_t coalesced;   // Cambios pisados por otro antes de flush()
+    uint32_t frames;
+    uint32_t bytes;
+
+    void beginFrame();
+    void endFrame(uint8_t zone, bool groupOpen);
+    void append(const char* text);
+
+public:
+    DimmingOutput();
+
+    void setSink(DimmingFrameSink callback) { sink = callback; }
+    void clear();
+
+    // Nivel nuevo de la luminaria en 'pos' (se envía en el próximo flush())
+    void set(uint16_t pos, uint8_t level);
+
+    // Publica los cambios pendientes; una vez por iteración de loop()
+    void flush();
+
+    uint16_t getPending() const { return dirtyCount; }
+    uint32_t getChanges() const { return changes; }
+    uint32_t getCoalesced() const { return coalesced; }
+    uint32_t getFrames() const { return frames; }
+    uint32_t getBytes() const { return bytes; }
+    void getStatus(JsonObject obj) const;
+};
+
+extern DimmingOutput DimmingOut;
+
+#endif // DIMMING_OUTPUT_H
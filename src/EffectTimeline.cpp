@@ -0,0 +1,185 @@
+#include "EffectTimeline.h"
+
+// === TIMELINE ===
+
+EffectTimeline::EffectTimeline() {
+    clear();
+}
+
+void EffectTimeline::clear() {
+    kind = EFFECT_WAVE;
+    memset(curve, 0, sizeof(curve));
+    points = 1;
+    stepped = false;
+    period = 1;
+    cycles = 1;
+    duration = 0;
+    finalLevel = EFFECT_RESTORE;
+    slots.clear();   // Conserva la capacidad
+    phases.clear();
+}
+
+void EffectTimeline::setPhase(uint16_t i, uint32_t ms) {
+    if (i >= phases.size()) return;
+    uint32_t units = ms / EFFECT_PHASE_UNIT_MS;
+    phases[i] = units > 0xFFFF ? 0xFFFF : units;
+}
+
+uint8_t EffectTimeline::levelAt(uint16_t i, uint32_t elapsed, uint8_t current) const {
+    uint32_t phase = (uint32_t)phases[i] * EFFECT_PHASE_UNIT_MS;
+    uint32_t local;
+    if (cycles == 0) {
+        // Efecto en bucle: el desfasaje es un corrimiento dentro de la curva
+        local = (elapsed + phase) % period;
+    } else {
+        // Efecto con principio y fin: el desfasaje retrasa el arranque
+        if (elapsed < phase) return current;
+        local = elapsed - phase;
+        if (local >= period * cycles) {
+            return finalLevel == EFFECT_RESTORE ? current : finalLevel;
+        }
+        local %= period;
+    }
+
+    uint32_t scaled = local * points;
+    uint8_t index = scaled / period;
+    uint8_t a = curve[index];
+    if (stepped) return a;
+
+    // El último tramo de un efecto en bucle vuelve al primer punto
+    uint8_t b = index + 1 < points ? curve[index + 1] : (cycles == 0 ? curve[0] : a);
+    int32_t frac = scaled % period;
+    return a + ((int32_t)b - a) * frac / (int32_t)period;
+}
+
+size_t EffectTimeline::getMemoryFootprint() const {
+    return sizeof(EffectTimeline) + slots.capacity() * sizeof(uint16_t) + phases.capacity() * sizeof(uint16_t);
+}
+
+// === COMPILADOR ===
+
+void EffectCompiler::sampleKeyframes(EffectTimeline& timeline, const EffectKeyframe* keys, uint8_t count,
+                                     uint32_t period, uint8_t points) {
+    if (points == 0 || points > EFFECT_CURVE_POINTS) points = EFFECT_CURVE_POINTS;
+    timeline.points = points;
+    timeline.period = period ? period : 1;
+
+    uint8_t segment = 0;
+    for (uint8_t k = 0; k < points; k++) {
+        uint32_t t = (uint64_t)timeline.period * k / points;
+        while (segment + 1 < count && keys[segment + 1].at <= t) segment++;
+
+        if (segment + 1 >= count || t <= keys[segment].at) {
+            timeline.curve[k] = keys[segment].level;
+        } else {
+            const EffectKeyframe& from = keys[segment];
+            const EffectKeyframe& to = keys[segment + 1];
+            int32_t delta = (int32_t)to.level - from.level;
+            timeline.curve[k] = from.level + delta * (int32_t)(t - from.at) / (int32_t)(to.at - from.at);
+        }
+    }
+}
+
+void EffectCompiler::wave(EffectTimeline& timeline, uint32_t duration) {
+    uint16_t count = timeline.size();
+    if (count == 0) return;
+    uint32_t delayPerLight = duration / count;
+
+    // Sube al 100% en 500 ms, espera su turno y vuelve al 30% en 500 ms
+    const EffectKeyframe keys[] = {
+        {0, 30}, {500, 100}, {500 + delayPerLight, 100}, {1000 + delayPerLight, 30}
+    };
+    timeline.kind = EFFECT_WAVE;
+    timeline.stepped = false;
+    timeline.cycles = 1;
+    timeline.finalLevel = 30;
+    sampleKeyframes(timeline, keys, 4, 1000 + delayPerLight);
+
+    for (uint16_t i = 0; i < count; i++) timeline.setPhase(i, i * delayPerLight);
+    timeline.duration = (count - 1) * delayPerLight + timeline.period;
+}
+
+void EffectCompiler::randomLevels(EffectTimeline& timeline, uint32_t duration, uint32_t seed) {
+    // xorshift32: el mismo 'seed' compila siempre el mismo efecto
+    uint32_t state = seed ? seed : 0x9E3779B9UL;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    timeline.kind = EFFECT_RANDOM;
+    timeline.stepped = false;
+    timeline.cycles = 0;
+    timeline.finalLevel = EFFECT_RESTORE;
+    timeline.points = EFFECT_CURVE_POINTS;
+    timeline.period = (uint32_t)EFFECT_CURVE_POINTS * EFFECT_RANDOM_STEP_MS;
+    for (uint8_t k = 0; k < EFFECT_CURVE_POINTS; k++) {
+        timeline.curve[k] = 20 + next() % 80;
+    }
+
+    // Cada luminaria arranca en otro punto de la misma curva
+    for (uint16_t i = 0; i < timeline.size(); i++) {
+        timeline.setPhase(i, next() % timeline.period);
+    }
+    timeline.duration = duration;
+}
+
+void EffectCompiler::sequence(EffectTimeline& timeline, uint32_t interval) {
+    uint16_t count = timeline.size();
+    if (count == 0) return;
+
+    const EffectKeyframe keys[] = {{0, 0}, {interval, 100}};
+    timeline.kind = EFFECT_SEQUENCE;
+    timeline.stepped = false;
+    timeline.cycles = 1;
+    timeline.finalLevel = 100;
+    sampleKeyframes(timeline, keys, 2, interval);
+
+    for (uint16_t i = 0; i < count; i++) timeline.setPhase(i, i * interval);
+    timeline.duration = (uint32_t)count * timeline.period;
+}
+
+void EffectCompiler::strobe(EffectTimeline& timeline, uint32_t duration, uint32_t frequency) {
+    timeline.kind = EFFECT_STROBE;
+    timeline.stepped = true;
+    timeline.cycles = 0;
+    timeline.finalLevel = EFFECT_RESTORE;
+    timeline.points = 2;
+    timeline.period = frequency ? frequency : 1;
+    timeline.curve[0] = 100;
+    timeline.curve[1] = 0;
+    timeline.duration = duration;
+}
+
+void EffectCompiler::rainbow(EffectTimeline& timeline, uint32_t duration) {
+    uint16_t count = timeline.size();
+
+    // Senoide entre 20 y 100%; el desfasaje reparte un ciclo a lo largo de la zona
+    timeline.kind = EFFECT_RAINBOW;
+    timeline.stepped = false;
+    timeline.cycles = 0;
+    timeline.finalLevel = EFFECT_RESTORE;
+    timeline.points = EFFECT_CURVE_POINTS;
+    timeline.period = EFFECT_RAINBOW_PERIOD_MS;
+    for (uint8_t k = 0; k < EFFECT_CURVE_POINTS; k++) {
+        timeline.curve[k] = 60 + (int8_t)lround(40 * sin(2 * PI * k / EFFECT_CURVE_POINTS));
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        timeline.setPhase(i, (uint32_t)EFFECT_RAINBOW_PERIOD_MS * i / count);
+    }
+    timeline.duration = duration;
+}
+
+void EffectCompiler::pulse(EffectTimeline& timeline, uint8_t minLevel, uint8_t maxLevel, uint32_t period) {
+    if (period == 0) period = 1;
+    const EffectKeyframe keys[] = {{0, minLevel}, {period / 2, maxLevel}, {period, minLevel}};
+    timeline.kind = EFFECT_PULSE;
+    timeline.stepped = false;
+    timeline.cycles = 1;
+    timeline.finalLevel = minLevel;
+    sampleKeyframes(timeline, keys, 3, period);
+    timeline.duration = period;
+}
@@ -0,0 +1,89 @@
+#ifndef EFFECT_TIMELINE_H
+#define EFFECT_TIMELINE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+
+// Configuración de los efectos precompilados
+#define EFFECT_CURVE_POINTS 64        // Muestras de la curva compartida
+#define EFFECT_MAX_ACTIVE 4           // Efectos reproduciéndose a la vez
+#define EFFECT_PHASE_UNIT_MS 10       // Resolución de los desfasajes (uint16: hasta ~655 s)
+#define EFFECT_RESTORE 0xFF           // finalLevel: volver al nivel previo al efecto
+#define EFFECT_RANDOM_STEP_MS 500     // Duración de cada nivel del efecto aleatorio
+#define EFFECT_RAINBOW_PERIOD_MS 2000 // Ciclo del barrido del arcoíris
+
+enum EffectKind : uint8_t {
+    EFFECT_WAVE,
+    EFFECT_RANDOM,
+    EFFECT_SEQUENCE,
+    EFFECT_STROBE,
+    EFFECT_RAINBOW,
+    EFFECT_PULSE
+};
+
+// Punto de control de una curva: nivel en 'at' ms dentro del período
+struct EffectKeyframe {
+    uint32_t at;
+    uint8_t level;
+};
+
+// Efecto compilado: una curva de brillo compartida por todas las luminarias
+// y, por luminaria, su posición en el registro y su desfasaje.
+//
+// La luminaria i recorre la curva desde phases[i] (en unidades de
+// EFFECT_PHASE_UNIT_MS); antes conserva su nivel y después de 'cycles'
+// ciclos queda en finalLevel. levelAt() es aritmética sobre la tabla, sin
+// asignaciones: los vectores se llenan una vez al compilar y clear()
+// conserva su capacidad para el próximo efecto. Con 500 luminarias ocupa
+// unos 2 KB.
+class EffectTimeline {
+public:
+    EffectKind kind;
+    uint8_t curve[EFFECT_CURVE_POINTS];
+    uint8_t points;        // Muestras usadas de 'curve'
+    bool stepped;          // true: niveles de golpe (estroboscópico); false: interpolados
+    uint32_t period;       // ms de un ciclo de la curva
+    uint16_t cycles;       // Ciclos por luminaria; 0 = repetir hasta 'duration'
+    uint32_t duration;     // ms desde el inicio hasta el final del efecto
+    uint8_t finalLevel;    // Nivel al terminar o EFFECT_RESTORE
+
+    std::vector<uint16_t> slots;   // Posiciones en el registro
+    std::vector<uint16_t> phases;  // Desfasaje de cada una
+
+    EffectTimeline();
+
+    void clear();
+    void addFixture(uint16_t pos) { slots.push_back(pos); phases.push_back(0); }
+    void setPhase(uint16_t i, uint32_t ms);
+    uint16_t size() const { return slots.size(); }
+
+    // Nivel de la luminaria i a 'elapsed' ms del inicio ('current' si todavía no le toca)
+    uint8_t levelAt(uint16_t i, uint32_t elapsed, uint8_t current) const;
+
+    size_t getMemoryFootprint() const;
+};
+
+// Compila cada efecto sobre las luminarias ya agregadas al timeline:
+// arma la curva y los desfasajes y calcula la duración total
+class EffectCompiler {
+public:
+    // Muestrea una curva lineal por tramos en 'points' puntos a lo largo de 'period'
+    static void sampleKeyframes(EffectTimeline& timeline, const EffectKeyframe* keys, uint8_t count,
+                                uint32_t period, uint8_t points = EFFECT_CURVE_POINTS);
+
+    // Sube al 100% y vuelve al 30%, cada luminaria desfasada de la anterior
+    static void wave(EffectTimeline& timeline, uint32_t duration);
+    // Niveles entre 20 y 100% cada EFFECT_RANDOM_STEP_MS, con fase aleatoria por luminaria
+    static void randomLevels(EffectTimeline& timeline, uint32_t duration, uint32_t seed);
+    // Enciende las luminarias una detrás de otra, cada 'interval' ms
+    static void sequence(EffectTimeline& timeline, uint32_t interval);
+    // Encendido/apagado con período 'frequency' ms, todas en fase
+    static void strobe(EffectTimeline& timeline, uint32_t duration, uint32_t frequency);
+    // Barrido senoidal de brillo recorriendo la zona (sin color por ahora)
+    static void rainbow(EffectTimeline& timeline, uint32_t duration);
+    // Un ciclo de 'minLevel' a 'maxLevel' y de vuelta en 'period' ms, todas en fase
+    static void pulse(EffectTimeline& timeline, uint8_t minLevel, uint8_t maxLevel, uint32_t period);
+};
+
+#endif // EFFECT_TIMELINE_H
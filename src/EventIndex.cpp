@@ -0,0 +1,136 @@
+#include "EventIndex.h"
+
+static_assert(EVENT_INDEX_SIZE <= 0xFFFF, "Los enlaces del índice son de 16 bits");
+static_assert((EVENT_INDEX_KEYS & (EVENT_INDEX_KEYS - 1)) == 0, "EVENT_INDEX_KEYS debe ser potencia de dos");
+
+EventIndex::EventIndex() {
+    clear();
+}
+
+void EventIndex::clear() {
+    for (uint16_t i = 0; i < EVENT_INDEX_KEYS; i++) luminariaHeads[i] = EVENT_INDEX_NONE;
+    for (uint8_t i = 0; i < EVENT_INDEX_TYPES; i++) typeHeads[i] = EVENT_INDEX_NONE;
+    buckets.clear();
+    firstSeq = 0;
+    endSeq = 0;
+}
+
+uint32_t EventIndex::hash(const char* luminaria) {
+    // FNV-1a: los bits bajos eligen la lista y los altos son el tag
+    uint32_t h = 2166136261UL;
+    while (*luminaria) {
+        h ^= (uint8_t)*luminaria++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+// Distancia desde 'seq' hasta 'previous', 0 si no hay anterior o quedó fuera del índice
+static uint16_t linkTo(uint32_t seq, uint32_t previous, uint32_t firstSeq) {
+    if (previous == EVENT_INDEX_NONE || previous < firstSeq) return 0;
+    return (uint16_t)(seq - previous);
+}
+
+uint32_t EventIndex::add(uint32_t position, uint8_t type, uint32_t luminariaHash, uint32_t timestamp) {
+    // El log libera segmentos antes de llegar acá; por si acaso se pisa el más viejo
+    if (size() == EVENT_INDEX_SIZE) dropBefore(firstSeq + 1);
+
+    uint32_t seq = endSeq++;
+    uint16_t slot = seq % EVENT_INDEX_SIZE;
+    positionLows[slot] = (uint16_t)position;
+    positionHighs[slot] = (uint8_t)(position >> 16);
+    tags[slot] = (uint16_t)(luminariaHash >> 16);
+
+    uint32_t& luminariaHead = luminariaHeads[luminariaHash & (EVENT_INDEX_KEYS - 1)];
+    luminariaLinks[slot] = linkTo(seq, luminariaHead, firstSeq);
+    luminariaHead = seq;
+
+    uint8_t typeKey = type % EVENT_INDEX_TYPES;
+    typeLinks[slot] = linkTo(seq, typeHeads[typeKey], firstSeq);
+    typeHeads[typeKey] = seq;
+
+    // Bucket nuevo al pasar EVENT_TIME_BUCKET segundos o si el tiempo retrocede
+    if (buckets.isEmpty() ||
+        timestamp < buckets[buckets.size() - 1].minTimestamp ||
+        timestamp - buckets[buckets.size() - 1].minTimestamp >= EVENT_TIME_BUCKET) {
+        if (buckets.isFull()) {
+            // Se fusionan los dos más viejos: el rango queda más ancho pero sigue cubriendo todo
+            EventTimeBucket oldest = buckets.shift();
+            EventTimeBucket& merged = buckets[0];
+            merged.firstSeq = oldest.firstSeq;
+            if (oldest.minTimestamp < merged.minTimestamp) merged.minTimestamp = oldest.minTimestamp;
+            if (oldest.maxTimestamp > merged.maxTimestamp) merged.maxTimestamp = oldest.maxTimestamp;
+        }
+        EventTimeBucket bucket = {seq, timestamp, timestamp};
+        buckets.push(bucket);
+    } else {
+        EventTimeBucket& bucket = buckets[buckets.size() - 1];
+        if (timestamp > bucket.maxTimestamp) bucket.maxTimestamp = timestamp;
+    }
+    return seq;
+}
+
+void EventIndex::dropBefore(uint32_t seq) {
+    if (seq <= firstSeq) return;
+    if (seq > endSeq) seq = endSeq;
+    firstSeq = seq;
+
+    while (buckets.size() > 1 && buckets[1].firstSeq <= seq) buckets.shift();
+    if (!buckets.isEmpty()) {
+        if (firstSeq == endSeq) buckets.clear();
+        else if (buckets[0].firstSeq < seq) buckets[0].firstSeq = seq;
+    }
+}
+
+uint32_t EventIndex::position(uint32_t seq, uint32_t endPosition) const {
+    // Los registros vivos están a menos de 16 MB del final: 24 bits alcanzan
+    uint16_t slot = seq % EVENT_INDEX_SIZE;
+    uint32_t low = (uint32_t)positionHighs[slot] << 16 | positionLows[slot];
+    return endPosition - ((endPosition - low) & 0xFFFFFF);
+}
+
+uint32_t EventIndex::seek(uint32_t target, uint32_t endPosition) const {
+    // Las posiciones crecen con la secuencia: búsqueda binaria
+    uint32_t low = firstSeq;
+    uint32_t high = endSeq;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (position(mid, endPosition) < target) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+uint32_t EventIndex::luminariaHead(uint32_t luminariaHash) const {
+    uint32_t seq = luminariaHeads[luminariaHash & (EVENT_INDEX_KEYS - 1)];
+    return (seq != EVENT_INDEX_NONE && seq >= firstSeq && seq < endSeq) ? seq : EVENT_INDEX_NONE;
+}
+
+uint32_t EventIndex::typeHead(uint8_t type) const {
+    uint32_t seq = typeHeads[type % EVENT_INDEX_TYPES];
+    return (seq != EVENT_INDEX_NONE && seq >= firstSeq && seq < endSeq) ? seq : EVENT_INDEX_NONE;
+}
+
+uint32_t EventIndex::follow(uint32_t seq, const uint16_t* links) const {
+    if (seq == EVENT_INDEX_NONE || seq < firstSeq || seq >= endSeq) return EVENT_INDEX_NONE;
+    uint16_t distance = links[seq % EVENT_INDEX_SIZE];
+    if (distance == 0 || seq - firstSeq < distance) return EVENT_INDEX_NONE;
+    return seq - distance;
+}
+
+uint32_t EventIndex::previous(uint32_t seq) const {
+    if (seq == EVENT_INDEX_NONE || seq <= firstSeq || seq > endSeq) return EVENT_INDEX_NONE;
+    return seq - 1;
+}
+
+bool EventIndex::mayContain(uint32_t seq, uint32_t from, uint32_t to, uint32_t& bucketStart) const {
+    bucketStart = firstSeq;
+    for (size_t i = buckets.size(); i > 0; i--) {
+        const EventTimeBucket& bucket = buckets[i - 1];
+        if (bucket.firstSeq <= seq) {
+            bucketStart = bucket.firstSeq;
+            return bucket.maxTimestamp >= from && bucket.minTimestamp <= to;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef EVENT_INDEX_H
+#define EVENT_INDEX_H
+
+#include <Arduino.h>
+#include <CircularBuffer.h>
+
+// Configuración de los índices del log de eventos
+// Registros indexados: el log no conserva más que esto. ~10 bytes por
+// registro contando las cabezas de lista, dentro de STATIC_RAM_BUDGET
+#ifndef EVENT_INDEX_SIZE
+#define EVENT_INDEX_SIZE 256
+#endif
+#define EVENT_INDEX_KEYS (EVENT_INDEX_SIZE / 4)  // Listas por luminaria (por hash del ID)
+#define EVENT_INDEX_TYPES 16      // Listas por tipo de evento
+#define EVENT_TIME_BUCKET 3600    // Segundos que abarca como mínimo un bucket de tiempo
+#define EVENT_TIME_BUCKETS 32
+#define EVENT_INDEX_NONE 0xFFFFFFFFUL
+
+// Rango de secuencias [firstSeq, siguiente bucket) y sus timestamps extremos
+struct EventTimeBucket {
+    uint32_t firstSeq;
+    uint32_t minTimestamp;
+    uint32_t maxTimestamp;
+};
+
+// Índices secundarios del log de eventos (solo RAM, se rearman al arrancar).
+//
+// Cada registro vivo recibe un número de secuencia y su slot
+// (seq % EVENT_INDEX_SIZE) guarda dónde está en flash (24 bits de posición)
+// y dos enlaces: al registro anterior de la misma luminaria y al anterior del
+// mismo tipo. Así cada luminaria y cada tipo tienen su lista de posteo, del
+// más nuevo al más viejo, y una consulta recorre solo esa lista.
+//
+// Las cabezas por luminaria se eligen por hash del ID, así que una lista
+// puede mezclar luminarias distintas; el tag de 16 bits guardado en cada slot
+// descarta casi todas las ajenas sin leer flash.
+//
+// Los buckets de tiempo agrupan secuencias consecutivas con su timestamp
+// mínimo y máximo. No se asume orden: después de un reinicio el uptime vuelve
+// a empezar y se abre otro bucket.
+class EventIndex {
+private:
+    uint16_t positionLows[EVENT_INDEX_SIZE];    // Bits 0-15 de la posición en el log
+    uint8_t positionHighs[EVENT_INDEX_SIZE];    // Bits 16-23
+    uint16_t tags[EVENT_INDEX_SIZE];            // 16 bits altos del hash de la luminaria
+    uint16_t luminariaLinks[EVENT_INDEX_SIZE];  // Distancia al anterior de la lista (0 = ninguno)
+    uint16_t typeLinks[EVENT_INDEX_SIZE];
+
+    uint32_t luminariaHeads[EVENT_INDEX_KEYS];  // Seq más nuevo de cada lista
+    uint32_t typeHeads[EVENT_INDEX_TYPES];
+
+    CircularBuffer<EventTimeBucket, EVENT_TIME_BUCKETS> buckets;
+
+    uint32_t firstSeq;  // Más viejo indexado
+    uint32_t endSeq;    // Próximo a asignar
+
+    uint32_t follow(uint32_t seq, const uint16_t* links) const;
+
+public:
+    EventIndex();
+
+    void clear();
+
+    // Indexa un registro recién escrito; devuelve su secuencia
+    uint32_t add(uint32_t position, uint8_t type, uint32_t luminariaHash, uint32_t timestamp);
+
+    // Olvida las secuencias anteriores a 'seq' (segmentos borrados)
+    void dropBefore(uint32_t seq);
+
+    // Posición absoluta en el log, resuelta contra el final actual del log
+    uint32_t position(uint32_t seq, uint32_t endPosition) const;
+
+    // Primera secuencia cuya posición es >= target
+    uint32_t seek(uint32_t target, uint32_t endPosition) const;
+
+    // Cabezas y enlaces de las listas (EVENT_INDEX_NONE al terminar)
+    uint32_t luminariaHead(uint32_t luminariaHash) const;
+    uint32_t typeHead(uint8_t type) const;
+    uint32_t previousLuminaria(uint32_t seq) const { return follow(seq, luminariaLinks); }
+    uint32_t previousType(uint32_t seq) const { return follow(seq, typeLinks); }
+    uint32_t previous(uint32_t seq) const;
+    uint32_t newest() const { return endSeq > firstSeq ? endSeq - 1 : EVENT_INDEX_NONE; }
+
+    bool tagMatches(uint32_t seq, uint32_t luminariaHash) const {
+        return tags[seq % EVENT_INDEX_SIZE] == (uint16_t)(luminariaHash >> 16);
+    }
+
+    // false si el bucket de 'seq' no tiene eventos en [from, to]; bucketStart
+    // queda en la primera secuencia de ese bucket para poder saltarlo
+    bool mayContain(uint32_t seq, uint32_t from, uint32_t to, uint32_t& bucketStart) const;
+
+    uint32_t size() const { return endSeq - firstSeq; }
+    uint32_t getFirstSeq() const { return firstSeq; }
+    uint32_t getEndSeq() const { return endSeq; }
+    size_t getBucketCount() const { return buckets.size(); }
+
+    static uint32_t hash(const char* luminaria);
+};
+
+#endif // EVENT_INDEX_H
@@ -0,0 +1,506 @@
+#include "EventLog.h"
+#include "Logger.h"
+
+static_assert(EVENT_PAYLOAD_MAX <= 255, "El largo del payload se guarda en un byte");
+static_assert(EVENT_RECORD_MAX <= EVENT_SEGMENT_SIZE, "Un registro debe entrar en un segmento");
+
+// === CODIFICACIÓN ===
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    while (length--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static uint8_t* putVarint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static bool getVarint(const uint8_t*& in, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && in < end; shift += 7) {
+        uint8_t b = *in++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint8_t* putText(uint8_t* out, const char* text, size_t size) {
+    size_t len = strnlen(text, size - 1);
+    out = putVarint(out, len);
+    memcpy(out, text, len);
+    return out + len;
+}
+
+static bool getText(const uint8_t*& in, const uint8_t* end, char* out, size_t size) {
+    uint32_t len;
+    if (!getVarint(in, end, len) || len >= size || len > (uint32_t)(end - in)) return false;
+    memcpy(out, in, len);
+    out[len] = '\0';
+    in += len;
+    return true;
+}
+
+void EventLog::copyText(char* out, size_t size, const char* text) {
+    strncpy(out, text ? text : "", size - 1);
+    out[size - 1] = '\0';
+}
+
+size_t EventLog::encode(const EventEntry& entry, uint8_t* out) {
+    uint8_t* payload = out + EVENT_HEADER_SIZE;
+    uint8_t* p = payload;
+    p = putVarint(p, entry.id);
+    p = putVarint(p, entry.timestamp);
+    p = putText(p, entry.luminaria, sizeof(entry.luminaria));
+    p = putText(p, entry.description, sizeof(entry.description));
+    p = putText(p, entry.user, sizeof(entry.user));
+    size_t payloadLength = p - payload;
+
+    out[0] = EVENT_RECORD_MAGIC;
+    out[1] = entry.type;
+    out[2] = (uint8_t)payloadLength;
+    out[3] = 0;
+    uint32_t crc = crc32Update(crc32Update(0, out, 4), payload, payloadLength);
+    out[4] = crc;
+    out[5] = crc >> 8;
+    out[6] = crc >> 16;
+    out[7] = crc >> 24;
+    return EVENT_HEADER_SIZE + payloadLength;
+}
+
+bool EventLog::readRecord(File& file, EventEntry& out, size_t& length) {
+    uint8_t header[EVENT_HEADER_SIZE];
+    if (file.read(header, EVENT_HEADER_SIZE) != EVENT_HEADER_SIZE) return false;
+    if (header[0] != EVENT_RECORD_MAGIC || header[2] > EVENT_PAYLOAD_MAX) return false;
+
+    uint8_t payload[EVENT_PAYLOAD_MAX];
+    size_t payloadLength = header[2];
+    if (file.read(payload, payloadLength) != payloadLength) return false;
+
+    uint32_t crc = (uint32_t)header[4] | ((uint32_t)header[5] << 8) |
+                   ((uint32_t)header[6] << 16) | ((uint32_t)header[7] << 24);
+    if (crc32Update(crc32Update(0, header, 4), payload, payloadLength) != crc) return false;
+
+    const uint8_t* in = payload;
+    const uint8_t* end = payload + payloadLength;
+    out.type = header[1];
+    if (!getVarint(in, end, out.id) || !getVarint(in, end, out.timestamp) ||
+        !getText(in, end, out.luminaria, sizeof(out.luminaria)) ||
+        !getText(in, end, out.description, sizeof(out.description)) ||
+        !getText(in, end, out.user, sizeof(out.user))) {
+        return false;
+    }
+    length = EVENT_HEADER_SIZE + payloadLength;
+    return true;
+}
+
+// === SEGMENTOS ===
+
+EventLog::EventLog() : firstSegment(0), lastSegment(0), segmentBytes(0),
+                       nextId(1), recordCount(0), recoveredBytes(0), writeErrors(0) {}
+
+void EventLog::segmentPath(uint32_t segment, char* out, size_t size) {
+    snprintf(out, size, EVENT_SEGMENT_PREFIX "%lu.bin", (unsigned long)segment);
+}
+
+void EventLog::loadManifest() {
+    firstSegment = 0;
+    lastSegment = 0;
+
+    File f = LittleFS.open(EVENT_MANIFEST_FILE, "r");
+    if (!f) return;
+
+    char text[40];
+    size_t len = f.readBytes(text, sizeof(text) - 1);
+    text[len] = '\0';
+    f.close();
+
+    // El próximo id se guarda para no repetir ids si se borran todos los
+    // segmentos que los tenían (manifiestos viejos no lo traen)
+    unsigned long first, last, id;
+    int fields = sscanf(text, "%lu %lu %lu", &first, &last, &id);
+    if (fields >= 2 && first <= last && last - first < EVENT_SEGMENT_COUNT) {
+        firstSegment = first;
+        lastSegment = last;
+        if (fields == 3 && id > nextId) nextId = id;
+    }
+}
+
+void EventLog::saveManifest() {
+    File f = LittleFS.open(EVENT_MANIFEST_FILE, "w");
+    if (!f) return;
+    f.printf("%lu %lu %lu\n", (unsigned long)firstSegment, (unsigned long)lastSegment, (unsigned long)nextId);
+    f.close();
+}
+
+bool EventLog::openSegment() {
+    char path[32];
+    segmentPath(lastSegment, path, sizeof(path));
+    logFile = LittleFS.open(path, "a");
+    if (!logFile) return false;
+    segmentBytes = logFile.size();
+    return true;
+}
+
+void EventLog::resetSegmentInfo(uint32_t segment) {
+    EventSegmentInfo& info = segments[segment % EVENT_SEGMENT_COUNT];
+    info.segment = segment;
+    info.records = 0;
+    info.firstSeq = 0;
+    info.minTimestamp = 0;
+    info.maxTimestamp = 0;
+}
+
+void EventLog::rotateSegment() {
+    if (logFile) logFile.close();
+    lastSegment++;
+
+    while (lastSegment - firstSegment >= EVENT_SEGMENT_COUNT) {
+        dropFirstSegment();
+    }
+    saveManifest();
+    resetSegmentInfo(lastSegment);
+    openSegment();
+}
+
+void EventLog::dropFirstSegment() {
+    char path[32];
+    segmentPath(firstSegment, path, sizeof(path));
+    LittleFS.remove(path);
+    recordCount -= segments[firstSegment % EVENT_SEGMENT_COUNT].records;
+    firstSegment++;
+
+    // El índice y el ring olvidan lo que estaba en el segmento borrado
+    const EventSegmentInfo& next = segments[firstSegment % EVENT_SEGMENT_COUNT];
+    index.dropBefore(next.records ? next.firstSeq : index.getEndSeq());
+    while (!ring.isEmpty() && ring[0].position < getFirstPosition()) {
+        ring.shift();
+    }
+}
+
+void EventLog::noteRecord(const EventEntry& entry) {
+    uint32_t seq = index.add(entry.position, entry.type, EventIndex::hash(entry.luminaria), entry.timestamp);
+    EventSegmentInfo& info = segments[(entry.position / EVENT_SEGMENT_SIZE) % EVENT_SEGMENT_COUNT];
+    if (info.records == 0) info.firstSeq = seq;
+    if (info.records == 0 || entry.timestamp < info.minTimestamp) info.minTimestamp = entry.timestamp;
+    if (info.records == 0 || entry.timestamp > info.maxTimestamp) info.maxTimestamp = entry.timestamp;
+    info.records++;
+    recordCount++;
+}
+
+uint32_t EventLog::recoverSegment(uint32_t segment, bool truncateTail) {
+    char path[32];
+    segmentPath(segment, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    if (!f) return 0;
+
+    EventEntry entry;
+    size_t offset = 0;
+    size_t length;
+    while (readRecord(f, entry, length)) {
+        entry.position = segment * EVENT_SEGMENT_SIZE + offset;
+        noteRecord(entry);
+        ring.push(entry);
+        if (entry.id >= nextId) nextId = entry.id + 1;
+        offset += length;
+    }
+    size_t size = f.size();
+    f.close();
+
+    // Lo que sigue al último registro válido es una escritura interrumpida
+    uint32_t discarded = size - offset;
+    if (discarded && truncateTail) {
+        f = LittleFS.open(path, "a");
+        if (f) {
+            f.truncate(offset);
+            f.close();
+        }
+    }
+    return discarded;
+}
+
+// === API ===
+
+bool EventLog::begin() {
+    if (!LittleFS.exists(EVENT_DIR)) {
+        LittleFS.mkdir(EVENT_DIR);
+    }
+    loadManifest();
+
+    recordCount = 0;
+    recoveredBytes = 0;
+    ring.clear();
+    index.clear();
+    for (uint32_t segment = firstSegment; segment <= lastSegment; segment++) {
+        resetSegmentInfo(segment);
+        recoveredBytes += recoverSegment(segment, segment == lastSegment);
+    }
+
+    // Más registros de los que entran en el índice (EVENT_INDEX_SIZE menor que antes)
+    if (recordCount > EVENT_INDEX_SIZE) {
+        while (recordCount > EVENT_INDEX_SIZE && firstSegment < lastSegment) {
+            dropFirstSegment();
+        }
+        saveManifest();
+    }
+    if (recoveredBytes) {
+        LOGF_WARNING("DB", "Log de eventos recuperado: %lu bytes incompletos descartados",
+                     (unsigned long)recoveredBytes);
+    }
+
+    if (!openSegment()) {
+        SystemLogger.error("No se pudo abrir el log de eventos", "DB");
+        return false;
+    }
+    return true;
+}
+
+void EventLog::clear() {
+    if (logFile) logFile.close();
+
+    char path[32];
+    for (uint32_t segment = firstSegment; segment <= lastSegment; segment++) {
+        segmentPath(segment, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+
+    // Las posiciones siguen creciendo: los cursores viejos no apuntan a datos nuevos
+    firstSegment = lastSegment = lastSegment + 1;
+    saveManifest();
+    resetSegmentInfo(lastSegment);
+    recordCount = 0;
+    ring.clear();
+    index.clear();
+    openSegment();
+}
+
+uint32_t EventLog::append(EventEntry& entry) {
+    if (entry.id == 0) entry.id = nextId;
+    if (entry.id >= nextId) nextId = entry.id + 1;
+
+    uint8_t record[EVENT_RECORD_MAX];
+    size_t length = encode(entry, record);
+
+    if (segmentBytes + length > EVENT_SEGMENT_SIZE) rotateSegment();
+
+    // Todo registro vivo tiene que estar indexado: con el índice lleno se
+    // libera el segmento más viejo (si hay uno solo, primero se rota)
+    if (recordCount >= EVENT_INDEX_SIZE) {
+        if (firstSegment == lastSegment) rotateSegment();
+        while (recordCount >= EVENT_INDEX_SIZE && firstSegment < lastSegment) {
+            dropFirstSegment();
+        }
+        saveManifest();
+    }
+    entry.position = lastSegment * EVENT_SEGMENT_SIZE + segmentBytes;
+
+    // Una sola escritura del tamaño del registro; flush para que un reinicio
+    // pierda como mucho el registro en curso
+    size_t written = logFile ? logFile.write(record, length) : 0;
+    if (logFile) logFile.flush();
+
+    if (written == length) {
+        segmentBytes += length;
+        noteRecord(entry);
+    } else {
+        // Se descarta el registro parcial para no cortar el log en este punto
+        writeErrors++;
+        if (logFile) logFile.truncate(segmentBytes);
+    }
+    ring.push(entry);
+    return entry.id;
+}
+
+bool EventLog::next(EventCursor& cursor, EventEntry& out) {
+    if (cursor.position < getFirstPosition()) {
+        cursor.position = getFirstPosition();
+        cursor.file.close();
+    }
+
+    while (true) {
+        uint32_t segment = cursor.position / EVENT_SEGMENT_SIZE;
+        if (segment > lastSegment) return false;
+
+        if (!cursor.file || cursor.segment != segment) {
+            char path[32];
+            segmentPath(segment, path, sizeof(path));
+            cursor.file = LittleFS.open(path, "r");
+            cursor.segment = segment;
+            if (cursor.file) cursor.file.seek(cursor.position % EVENT_SEGMENT_SIZE);
+        }
+
+        size_t length;
+        if (cursor.file && readRecord(cursor.file, out, length)) {
+            out.position = cursor.position;
+            cursor.position += length;
+            return true;
+        }
+
+        // Final del último segmento: se cierra para releer lo que se agregue después
+        cursor.file.close();
+        if (segment == lastSegment) return false;
+        cursor.position = (segment + 1) * EVENT_SEGMENT_SIZE;
+    }
+}
+
+bool EventLog::readInto(EventCursor& cursor, uint32_t position, EventEntry& out) {
+    if (position < getFirstPosition() || position >= getEndPosition()) return false;
+
+    // Los recientes salen del ring sin tocar flash
+    if (!ring.isEmpty() && position >= ring[0].position) {
+        for (size_t i = ring.size(); i > 0 && ring[i - 1].position >= position; i--) {
+            if (ring[i - 1].position == position) {
+                out = ring[i - 1];
+                return true;
+            }
+        }
+    }
+
+    // Mismo segmento que la lectura anterior: se reutiliza el archivo abierto
+    if (cursor.file && cursor.segment == position / EVENT_SEGMENT_SIZE) {
+        cursor.file.seek(position % EVENT_SEGMENT_SIZE);
+    } else {
+        cursor.file.close();
+    }
+    cursor.position = position;
+    return next(cursor, out) && out.position == position;
+}
+
+bool EventLog::readAt(uint32_t position, EventEntry& out) {
+    EventCursor cursor(position);
+    return readInto(cursor, position, out);
+}
+
+uint32_t EventLog::previousCandidate(const EventQuery& query, uint32_t luminariaHash, uint32_t seq) const {
+    if (seq == EVENT_INDEX_NONE) return EVENT_INDEX_NONE;
+
+    // Con luminaria se recorre su lista (suele ser la más corta), si no la del tipo
+    if (query.luminaria) {
+        do {
+            seq = index.previousLuminaria(seq);
+        } while (seq != EVENT_INDEX_NONE && !index.tagMatches(seq, luminariaHash));
+        return seq;
+    }
+    if (query.type >= 0) return index.previousType(seq);
+    return index.previous(seq);
+}
+
+bool EventLog::next(EventQuery& query, EventEntry& out) {
+    uint32_t luminariaHash = query.luminaria ? EventIndex::hash(query.luminaria) : 0;
+    uint32_t end = getEndPosition();
+    uint32_t seq;
+
+    if (!query.started) {
+        query.started = true;
+        if (query.luminaria) {
+            seq = index.luminariaHead(luminariaHash);
+            if (seq != EVENT_INDEX_NONE && !index.tagMatches(seq, luminariaHash)) {
+                seq = previousCandidate(query, luminariaHash, seq);
+            }
+        } else if (query.type >= 0) {
+            seq = index.typeHead(query.type);
+        } else {
+            seq = index.newest();
+        }
+
+        // Paginación: lo que está en el cursor o después se saltea por los
+        // enlaces en RAM, sin leer flash
+        if (query.cursor) {
+            uint32_t limit = index.seek(query.cursor, end);
+            while (seq != EVENT_INDEX_NONE && seq >= limit) {
+                seq = previousCandidate(query, luminariaHash, seq);
+            }
+        }
+    } else {
+        seq = previousCandidate(query, luminariaHash, query.seq);
+    }
+
+    while (seq != EVENT_INDEX_NONE) {
+        uint32_t bucketStart;
+        if (!index.mayContain(seq, query.from, query.to, bucketStart)) {
+            // Sin lista que seguir, el bucket fuera de rango se saltea entero
+            if (!query.luminaria && query.type < 0) {
+                seq = bucketStart > index.getFirstSeq() ? bucketStart - 1 : EVENT_INDEX_NONE;
+            } else {
+                seq = previousCandidate(query, luminariaHash, seq);
+            }
+            continue;
+        }
+
+        if (readInto(query.reader, index.position(seq, end), out) &&
+            (!query.luminaria || strcmp(out.luminaria, query.luminaria) == 0) &&
+            (query.type < 0 || out.type == query.type) &&
+            out.timestamp >= query.from && out.timestamp <= query.to) {
+            query.seq = seq;
+            return true;
+        }
+        seq = previousCandidate(query, luminariaHash, seq);
+    }
+
+    query.seq = EVENT_INDEX_NONE;
+    query.reader.file.close();
+    return false;
+}
+
+bool EventLog::dropOldestSegmentBefore(uint32_t timestamp) {
+    // Solo se mira el resumen del segmento; el actual nunca se borra
+    if (firstSegment >= lastSegment) return false;
+    const EventSegmentInfo& info = segments[firstSegment % EVENT_SEGMENT_COUNT];
+    if (info.records && info.maxTimestamp >= timestamp) return false;
+
+    dropFirstSegment();
+    saveManifest();
+    return true;
+}
+
+uint32_t EventLog::dropSegmentsBefore(uint32_t timestamp) {
+    uint32_t before = recordCount;
+    while (dropOldestSegmentBefore(timestamp)) {}
+    return before - recordCount;
+}
+
+bool EventLog::rotateAhead(size_t minFree) {
+    if (segmentBytes == 0 || EVENT_SEGMENT_SIZE - segmentBytes >= minFree) return false;
+    rotateSegment();
+    return true;
+}
+
+bool EventLog::isLiveFile(const char* name) const {
+    // Dir::fileName() puede venir con o sin el directorio
+    const char* slash = strrchr(name, '/');
+    if (slash) name = slash + 1;
+    if (strcmp(name, strrchr(EVENT_MANIFEST_FILE, '/') + 1) == 0) return true;
+
+    unsigned long segment;
+    char suffix[8];
+    const char* prefix = strrchr(EVENT_SEGMENT_PREFIX, '/') + 1;
+    size_t prefixLength = strlen(prefix);
+    if (strncmp(name, prefix, prefixLength) != 0) return false;
+    if (sscanf(name + prefixLength, "%lu%7s", &segment, suffix) != 2 || strcmp(suffix, ".bin") != 0) return false;
+    return segment >= firstSegment && segment <= lastSegment;
+}
+
+size_t EventLog::getFlashBytes() const {
+    size_t total = segmentBytes;
+    char path[32];
+    for (uint32_t segment = firstSegment; segment < lastSegment; segment++) {
+        segmentPath(segment, path, sizeof(path));
+        File f = LittleFS.open(path, "r");
+        if (f) {
+            total += f.size();
+            f.close();
+        }
+    }
+    return total;
+}
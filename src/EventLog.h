@@ -0,0 +1,172 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include <CircularBuffer.h>
+#include "hal/Platform.h"
+#include "config.h"
+#include "EventIndex.h"
+
+// Configuración del log de eventos
+#define EVENT_DIR "/db/events"
+#define EVENT_MANIFEST_FILE "/db/events/manifest"
+#define EVENT_SEGMENT_PREFIX "/db/events/seg_"
+// Segmentos chicos frente a EVENT_INDEX_SIZE: con el índice lleno se borra
+// el segmento más viejo, y así cada rotación pierde solo una parte del log
+#define EVENT_SEGMENT_COUNT 6        // Segmentos conservados (el más viejo se borra al rotar)
+#define EVENT_SEGMENT_SIZE 4096      // Bytes por segmento (~55 eventos)
+#define EVENT_RING_SIZE 16           // Eventos recientes en RAM (caché de lectura; el resto va a flash)
+#define EVENT_LUMINARIA_SIZE 24
+#define EVENT_DESCRIPTION_SIZE 64
+#define EVENT_USER_SIZE 16
+
+// Formato de registro en flash:
+//   cabecera fija de 8 bytes: magic, tipo, largo del payload, reservado, CRC32
+//   payload: id, timestamp (varint) y luminaria, descripción, usuario
+//            (largo varint + bytes)
+// El CRC cubre los 4 primeros bytes de la cabecera y el payload.
+#define EVENT_RECORD_MAGIC 0xE5
+#define EVENT_HEADER_SIZE 8
+#define EVENT_PAYLOAD_MAX (5 + 5 + 3 + EVENT_LUMINARIA_SIZE + EVENT_DESCRIPTION_SIZE + EVENT_USER_SIZE)
+#define EVENT_RECORD_MAX (EVENT_HEADER_SIZE + EVENT_PAYLOAD_MAX)
+
+// Evento de tamaño fijo (textos truncados a su límite)
+struct EventEntry {
+    uint32_t id;
+    uint32_t timestamp;
+    uint32_t position;  // Posición absoluta: segmento * EVENT_SEGMENT_SIZE + offset
+    uint8_t type;
+    char luminaria[EVENT_LUMINARIA_SIZE];
+    char description[EVENT_DESCRIPTION_SIZE];
+    char user[EVENT_USER_SIZE];
+};
+
+// Resumen de un segmento vivo, armado al arrancar y al agregar
+struct EventSegmentInfo {
+    uint32_t segment;
+    uint32_t records;
+    uint32_t firstSeq;  // Secuencia en EventIndex de su primer registro
+    uint32_t minTimestamp;
+    uint32_t maxTimestamp;
+};
+
+// Lectura secuencial del log. No mover 'position' a mano entre llamadas
+// a next(): el archivo abierto sigue la posición.
+struct EventCursor {
+    uint32_t position;
+    uint32_t segment;
+    File file;
+
+    EventCursor(uint32_t from = 0) : position(from), segment(0) {}
+};
+
+// Consulta filtrada por los índices, del evento más nuevo al más viejo.
+// 'cursor' es una posición del log: solo se devuelven eventos anteriores a
+// ella (para paginar se pasa la posición del último evento recibido).
+struct EventQuery {
+    const char* luminaria = nullptr;  // nullptr = todas
+    int16_t type = -1;                // -1 = todos
+    uint32_t from = 0;
+    uint32_t to = 0xFFFFFFFF;
+    uint32_t cursor = 0;              // 0 = desde el más nuevo
+
+    // Estado de la recorrida, lo maneja EventLog::next()
+    uint32_t seq = EVENT_INDEX_NONE;
+    bool started = false;
+    EventCursor reader;
+};
+
+// Log de eventos binario de solo agregado.
+//
+// Cada evento se codifica en un registro con CRC y se agrega al final del
+// segmento actual (una escritura del tamaño del registro). Al llenarse un
+// segmento se pasa al siguiente y se borra el más viejo; el manifiesto solo
+// cambia al rotar. Los últimos EVENT_RING_SIZE eventos quedan además en un
+// ring en RAM para las consultas frecuentes.
+//
+// Al arrancar se recorren los segmentos: un corte de energía a mitad de una
+// escritura deja un registro incompleto o con CRC inválido al final del
+// último segmento, que se trunca para seguir agregando detrás del último
+// registro válido.
+//
+// Todos los registros vivos están en EventIndex; si el índice se llena se
+// libera el segmento más viejo aunque quede espacio.
+class EventLog {
+private:
+    File logFile;
+    uint32_t firstSegment;
+    uint32_t lastSegment;
+    size_t segmentBytes;
+    EventSegmentInfo segments[EVENT_SEGMENT_COUNT];  // Por segmento % EVENT_SEGMENT_COUNT
+
+    CircularBuffer<EventEntry, EVENT_RING_SIZE> ring;
+    EventIndex index;
+
+    uint32_t nextId;
+    uint32_t recordCount;     // Registros en los segmentos vivos
+    uint32_t recoveredBytes;  // Bytes descartados por recuperación al arrancar
+    uint32_t writeErrors;
+
+    void loadManifest();
+    void saveManifest();
+    bool openSegment();
+    void rotateSegment();
+    void dropFirstSegment();
+    void resetSegmentInfo(uint32_t segment);
+    void noteRecord(const EventEntry& entry);
+    uint32_t recoverSegment(uint32_t segment, bool truncateTail);
+    bool readInto(EventCursor& cursor, uint32_t position, EventEntry& out);
+    uint32_t previousCandidate(const EventQuery& query, uint32_t luminariaHash, uint32_t seq) const;
+
+    static size_t encode(const EventEntry& entry, uint8_t* out);
+    static bool readRecord(File& file, EventEntry& out, size_t& length);
+
+public:
+    EventLog();
+
+    bool begin();
+    void clear();  // Borra todos los segmentos
+
+    // Agrega el evento; asigna id (si es 0) y position. Devuelve el id.
+    uint32_t append(EventEntry& entry);
+
+    // Eventos recientes en RAM (0 = el más viejo del ring)
+    size_t recentCount() const { return ring.size(); }
+    const EventEntry& recent(size_t index) const { return ring[index]; }
+
+    // Lectura secuencial desde cursor.position; false al llegar al final
+    bool next(EventCursor& cursor, EventEntry& out);
+    bool readAt(uint32_t position, EventEntry& out);
+
+    // Próximo evento que cumple la consulta; false al terminar
+    bool next(EventQuery& query, EventEntry& out);
+
+    // Borra los segmentos cerrados cuyo evento más nuevo es anterior a 'timestamp'
+    uint32_t dropSegmentsBefore(uint32_t timestamp);
+    // Lo mismo, de a un segmento (para mantenimiento incremental); false si no había
+    bool dropOldestSegmentBefore(uint32_t timestamp);
+
+    // Rota si al segmento actual le quedan menos de minFree bytes, para que
+    // la rotación no caiga dentro de append()
+    bool rotateAhead(size_t minFree);
+
+    // true para el manifiesto y los segmentos vivos de EVENT_DIR
+    bool isLiveFile(const char* name) const;
+
+    uint32_t getRecordCount() const { return recordCount; }
+    uint32_t getNextId() const { return nextId; }
+    uint32_t getFirstSegment() const { return firstSegment; }
+    uint32_t getLastSegment() const { return lastSegment; }
+    uint32_t getFirstPosition() const { return firstSegment * EVENT_SEGMENT_SIZE; }
+    uint32_t getEndPosition() const { return lastSegment * EVENT_SEGMENT_SIZE + segmentBytes; }
+    uint32_t getRecoveredBytes() const { return recoveredBytes; }
+    uint32_t getWriteErrors() const { return writeErrors; }
+    size_t getTimeBucketCount() const { return index.getBucketCount(); }
+    size_t getIndexFootprint() const { return sizeof(EventIndex); }
+    size_t getFlashBytes() const;
+
+    static void copyText(char* out, size_t size, const char* text);
+    static void segmentPath(uint32_t segment, char* out, size_t size);
+};
+
+#endif // EVENT_LOG_H
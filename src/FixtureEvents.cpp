@@ -0,0 +1,133 @@
+#include "FixtureEvents.h"
+#include "LuminariaRegistry.h"
+#include "DatabaseManager.h"
+#include "AlertManager.h"
+#include "SceneManager.h"
+
+// Se llama con cada nodo nuevo y cuando uno conocido cambia de zona o de
+// capacidades (MQTTManager descarta los discovery repetidos)
+void onNodeDiscovered(const NodeInfo& node) {
+    LOGF_INFO("MQTT", "Nodo descubierto: %s (%s)", node.nodeId.c_str(), node.ip.c_str());
+
+    // Agregar nodo a la base de datos
+    Database.logEvent(node.nodeId, EVENT_STATE_CHANGE, "Nodo descubierto", "DISCOVERY");
+
+    // Si es una luminaria, agregarla al sistema
+    if (node.type != NODE_LUMINARIA) return;
+
+    // Crear luminaria virtual para el nodo
+    uint32_t id = LuminariaRegistry::parseId(node.nodeId);
+    if (id == LUMINARIA_ID_INVALID) {
+        // El nodo migra su ID al arrancar (loadConfig); hasta entonces no se
+        // puede direccionar en los frames de dimming
+        LOGF_WARNING("MQTT", "ID de nodo no canónico, se espera " LUMINARIA_ID_PREFIX "XXXXXXXX: %s",
+                     node.nodeId.c_str());
+        return;
+    }
+    uint16_t pos = Luminarias.find(id);
+    if (pos == REGISTRY_NOT_FOUND) {
+        pos = Luminarias.insert(id);
+        if (pos == REGISTRY_NOT_FOUND) {
+            LOGF_WARNING("MQTT", "Registro de luminarias lleno, nodo ignorado: %s", node.nodeId.c_str());
+            return;
+        }
+        // Posición aleatoria cerca del centro
+        Luminarias.setPosicion(pos, DEFAULT_LAT + (random(-100, 100) / 10000.0),
+                                    DEFAULT_LNG + (random(-100, 100) / 10000.0));
+
+        LOGF_INFO("MQTT", "Luminaria MQTT agregada: %s", node.nodeId.c_str());
+    }
+
+    // Zona en la que escucha el nodo: DimmingOutput publica sus frames en
+    // luces/zone/<zona>. Sin zona (o con un nombre que no entra en el
+    // registro) los frames van por luces/cmd/all, que escuchan todos
+    uint8_t zona = node.zone.length() ? Luminarias.internZone(node.zone.c_str()) : ZONA_NINGUNA;
+    if (zona == ZONA_NINGUNA && node.zone.length()) {
+        LOGF_WARNING("MQTT", "Zona %s no registrada, %s recibe por luces/cmd/all", node.zone.c_str(),
+                     node.nodeId.c_str());
+    }
+    Luminarias.setZona(pos, zona);
+
+    // Capacidades: dimming y curva que aplica el nodo a su PWM
+    Luminarias.setDimeable(pos, node.dimming);
+    Luminarias.setCurva(pos, node.curve);
+}
+
+void onFixtureStatus(const String& /* topic */, const String& payload) {
+    StaticJsonDocument<256> doc;
+    DeserializationError error = deserializeJson(doc, payload);
+    if (error) return;
+
+    String nodeId = doc["nodeId"].as<String>();
+    bool online = doc["online"];
+    bool lightOn = doc["light"];
+
+    // Actualizar estado de luminaria
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(nodeId));
+    if (pos != REGISTRY_NOT_FOUND) {
+        Luminarias.setEstado(pos, online ? (lightOn ? ESTADO_ENCENDIDA : ESTADO_APAGADA) : ESTADO_OFFLINE);
+        Luminarias.touch(pos);
+    }
+}
+
+void onFixtureTelemetry(const String& /* topic */, const String& payload) {
+    StaticJsonDocument<512> doc;
+    DeserializationError error = deserializeJson(doc, payload);
+    if (error) return;
+
+    String nodeId = doc["nodeId"].as<String>();
+    float power = doc["power"]["watts"];
+    float current = doc["power"]["current"];
+    float voltage = current > 0 ? power / current : NOMINAL_VOLTAGE;
+
+    // Registrar consumo
+    Database.logConsumption(nodeId, power, voltage, current);
+
+    // Verificar alertas de consumo
+    Alerts.checkConsumption(nodeId, power);
+}
+
+void onFixtureAlert(const String& /* topic */, const String& payload) {
+    StaticJsonDocument<256> doc;
+    DeserializationError error = deserializeJson(doc, payload);
+    if (error) return;
+
+    String nodeId = doc["nodeId"].as<String>();
+    String type = doc["type"].as<String>();
+    String message = doc["message"].as<String>();
+
+    // Crear alerta en el sistema
+    Alerts.createAlert(ALERT_FAILURE, SEVERITY_WARNING, nodeId, message, type);
+}
+
+void onScheduleAction(ScheduleAction action, String target, int value) {
+    LOGF_INFO("SCHEDULE", "Acción programada: %d en %s", (int)action, target.c_str());
+
+    // Ejecutar acción sobre luminarias
+    if (action != ACTION_TURN_ON && action != ACTION_TURN_OFF) return;
+
+    // Por Scenes, como cualquier otro nivel: corta el fade en curso, queda
+    // en Brightness y sale en el frame de dimming de la zona
+    EstadoLuminaria estado = (action == ACTION_TURN_ON) ? ESTADO_ENCENDIDA : ESTADO_APAGADA;
+    uint8_t intensidad = (action == ACTION_TURN_ON) ? constrain(value, 0, 100) : 0;
+    if (target == "all") {
+        for (uint16_t i = 0; i < Luminarias.size(); i++) {
+            Luminarias.setEstado(i, estado);
+            Scenes.setLevel(i, intensidad);
+        }
+    } else {
+        uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(target));
+        if (pos != REGISTRY_NOT_FOUND) {
+            Luminarias.setEstado(pos, estado);
+            Scenes.setLevel(pos, intensidad);
+        }
+    }
+}
+
+void registerFixtureHandlers() {
+    Scheduler.setCallback(onScheduleAction);
+    MQTT.onNodeDiscovered(onNodeDiscovered);
+    MQTT.onMessage("luces/status/+", onFixtureStatus);
+    MQTT.onMessage("luces/telemetry/+", onFixtureTelemetry);
+    MQTT.onMessage("luces/alert/+", onFixtureAlert);
+}
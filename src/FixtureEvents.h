@@ -0,0 +1,22 @@
+#ifndef FIXTURE_EVENTS_H
+#define FIXTURE_EVENTS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "MQTTManager.h"
+#include "ScheduleManager.h"
+
+// Handlers de los mensajes que llegan de las luminarias y de las acciones
+// programadas. Los registra el firmware (main.cpp) y también la simulación
+// nativa (sim/sim_central.cpp), así la prueba de carga ejercita el mismo código.
+
+void onNodeDiscovered(const NodeInfo& node);
+void onFixtureStatus(const String& topic, const String& payload);     // luces/status/+
+void onFixtureTelemetry(const String& topic, const String& payload);  // luces/telemetry/+
+void onFixtureAlert(const String& topic, const String& payload);      // luces/alert/+
+void onScheduleAction(ScheduleAction action, String target, int value);
+
+// Registra los handlers anteriores en MQTT y Scheduler
+void registerFixtureHandlers();
+
+#endif // FIXTURE_EVENTS_H
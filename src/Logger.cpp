@@ -1,8 +1,17 @@
 #include "Logger.h"
 
+// /api/logs/recent pide los últimos LOG_QUERY_MAX_RESULTS registros al ring
+static_assert(MAX_LOG_ENTRIES >= LOG_QUERY_MAX_RESULTS, "MAX_LOG_ENTRIES no alcanza para /api/logs/recent");
+
 Logger SystemLogger;
 
-Logger::Logger() {}
+Logger::Logger() {
+    // El módulo 0 es el genérico; también recibe los módulos que no entran en la tabla
+    internModule("SYSTEM");
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        resetSegmentIndex(segmentIndex[i], 0xFFFFFFFF, false);
+    }
+}
 
 Logger::~Logger() {
     flush();
@@ -12,187 +21,692 @@ Logger::~Logger() {
 }
 
 bool Logger::begin() {
-    if (!LittleFS.exists("/logs")) {
-        LittleFS.mkdir("/logs");
-    }
-    
-    // Verificar tamaño del archivo actual
-    if (LittleFS.exists(LOG_FILE)) {
-        File f = LittleFS.open(LOG_FILE, "r");
-        if (f && f.size() > MAX_LOG_SIZE) {
-            f.close();
-            rotateLogFile();
-        } else if (f) {
-            f.close();
+    if (!LittleFS.exists(LOG_DIR)) {
+        LittleFS.mkdir(LOG_DIR);
+    }
+    loadManifest();
+    
+    // Se sigue escribiendo en el último segmento; sus líneas anteriores no
+    // están indexadas, así que las consultas lo recorren entero
+    if (openSegment()) {
+        stagedEnd = lastSegment * LOG_SEGMENT_SIZE + min(segmentBytes, (size_t)LOG_SEGMENT_SIZE);
+        if (segmentBytes > 0) {
+            resetSegmentIndex(segmentIndex[lastSegment % LOG_SEGMENT_COUNT], lastSegment, false);
         }
     }
+    started = true;
     
     info("Sistema de logs iniciado", "LOGGER");
     return true;
 }
 
-String Logger::formatLogEntry(const LogEntry& entry) {
-    char buffer[256];
-    snprintf(buffer, sizeof(buffer), "[%lu] [%s] [%s] %s\n",
-             entry.timestamp,
-             entry.level.c_str(),
-             entry.module.c_str(),
-             entry.message.c_str());
-    return String(buffer);
+const char* Logger::levelName(uint8_t level) {
+    switch (level) {
+        case LOG_LEVEL_ERROR: return "ERROR";
+        case LOG_LEVEL_WARNING: return "WARN";
+        case LOG_LEVEL_INFO: return "INFO";
+        case LOG_LEVEL_DEBUG: return "DEBUG";
+        default: return "?";
+    }
 }
 
-void Logger::rotateLogFile() {
-    // Eliminar backup anterior si existe
-    if (LittleFS.exists(LOG_BACKUP_FILE)) {
-        LittleFS.remove(LOG_BACKUP_FILE);
+uint8_t Logger::internModule(const char* module) {
+    for (uint8_t i = 0; i < moduleCount; i++) {
+        if (strncmp(moduleNames[i], module, LOG_MODULE_NAME_SIZE - 1) == 0) return i;
     }
+    if (moduleCount >= LOG_MAX_MODULES) return 0;
+    
+    strncpy(moduleNames[moduleCount], module, LOG_MODULE_NAME_SIZE - 1);
+    moduleNames[moduleCount][LOG_MODULE_NAME_SIZE - 1] = '\0';
+    return moduleCount++;
+}
+
+const char* Logger::moduleName(uint8_t id) const {
+    return id < moduleCount ? moduleNames[id] : moduleNames[0];
+}
+
+// === CODIFICACIÓN DE ARGUMENTOS ===
+
+void Logger::appendArg(LogRecord& record, char type, const void* value) {
+    // Valores de 4 bytes; si no entran, el argumento se pierde y sale como "?"
+    if (record.argsLength + 5 > LOG_ARGS_SIZE) return;
+    record.args[record.argsLength++] = type;
+    memcpy(record.args + record.argsLength, value, 4);
+    record.argsLength += 4;
+}
+
+void Logger::appendString(LogRecord& record, const char* text) {
+    if (record.argsLength + 2 > LOG_ARGS_SIZE) return;
+    if (!text) text = "(null)";
+    size_t len = strnlen(text, LOG_ARGS_SIZE - record.argsLength - 2);
+    record.args[record.argsLength++] = LOG_ARG_STR;
+    record.args[record.argsLength++] = len;
+    memcpy(record.args + record.argsLength, text, len);
+    record.argsLength += len;
+}
+
+// === FORMATEO ===
+
+// Formatea un argumento guardado con la especificación del formato (sin
+// modificadores de longitud). Si el tipo guardado no coincide con la
+// conversión pedida se usa la conversión por defecto del tipo.
+static int formatArg(const uint8_t* args, uint8_t argsLength, uint8_t& argPos,
+                     char* spec, size_t specLen, char conv, char* out, size_t size) {
+    if (argPos >= argsLength) return snprintf(out, size, "?");
     
-    // Renombrar archivo actual como backup
-    if (LittleFS.exists(LOG_FILE)) {
-        LittleFS.rename(LOG_FILE, LOG_BACKUP_FILE);
+    char type = args[argPos++];
+    if (type == LOG_ARG_STR) {
+        char text[LOG_ARGS_SIZE];
+        uint8_t len = args[argPos++];
+        memcpy(text, args + argPos, len);
+        text[len] = '\0';
+        argPos += len;
+        if (conv != 's') specLen = 1;
+        spec[specLen] = 's';
+        spec[specLen + 1] = '\0';
+        return snprintf(out, size, spec, text);
     }
     
-    info("Archivo de log rotado", "LOGGER");
+    uint8_t raw[4];
+    memcpy(raw, args + argPos, 4);
+    argPos += 4;
+    
+    if (type == LOG_ARG_FLOAT) {
+        float value;
+        memcpy(&value, raw, 4);
+        if (!strchr("fFeEgG", conv)) { specLen = 1; conv = 'g'; }
+        spec[specLen] = conv;
+        spec[specLen + 1] = '\0';
+        return snprintf(out, size, spec, (double)value);
+    }
+    
+    if (conv == 'c') {
+        int32_t value;
+        memcpy(&value, raw, 4);
+        spec[specLen] = 'c';
+        spec[specLen + 1] = '\0';
+        return snprintf(out, size, spec, (int)value);
+    }
+    
+    if (!strchr("diouxX", conv)) { specLen = 1; conv = (type == LOG_ARG_INT) ? 'd' : 'u'; }
+    spec[specLen] = 'l';
+    spec[specLen + 1] = conv;
+    spec[specLen + 2] = '\0';
+    if (type == LOG_ARG_INT) {
+        int32_t value;
+        memcpy(&value, raw, 4);
+        return snprintf(out, size, spec, (long)value);
+    }
+    uint32_t value;
+    memcpy(&value, raw, 4);
+    return snprintf(out, size, spec, (unsigned long)value);
 }
 
-void Logger::log(LogLevel level, const String& message, const String& module) {
-    if (level > CURRENT_LOG_LEVEL) return;
+size_t Logger::formatMessage(const LogRecord& record, char* out, size_t size) {
+    const char* f = record.format;
+    size_t pos = 0;
+    uint8_t argPos = 0;
     
-    LogEntry entry;
-    entry.timestamp = millis() / 1000;
-    entry.message = message;
-    entry.module = module;
+    while (*f && pos + 1 < size) {
+        if (*f != '%') {
+            out[pos++] = *f++;
+            continue;
+        }
+        if (f[1] == '%') {
+            out[pos++] = '%';
+            f += 2;
+            continue;
+        }
+        
+        // Flags, ancho y precisión se conservan; los modificadores de
+        // longitud se descartan porque los valores guardados son de 32 bits
+        char spec[16];
+        size_t specLen = 0;
+        spec[specLen++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && specLen < sizeof(spec) - 3) {
+            spec[specLen++] = *f++;
+        }
+        while (*f && strchr("hlLjzt", *f)) f++;
+        char conv = *f ? *f++ : 's';
+        
+        int written = formatArg(record.args, record.argsLength, argPos, spec, specLen, conv,
+                                out + pos, size - pos);
+        if (written > 0) pos += min((size_t)written, size - pos - 1);
+    }
     
-    switch(level) {
-        case LOG_LEVEL_ERROR:
-            entry.level = "ERROR";
-            Serial.print("[ERROR] ");
-            break;
-        case LOG_LEVEL_WARNING:
-            entry.level = "WARN";
-            Serial.print("[WARN] ");
-            break;
-        case LOG_LEVEL_INFO:
-            entry.level = "INFO";
-            Serial.print("[INFO] ");
-            break;
-        case LOG_LEVEL_DEBUG:
-            entry.level = "DEBUG";
-            Serial.print("[DEBUG] ");
-            break;
+    out[pos] = '\0';
+    return pos;
+}
+
+size_t Logger::formatRecord(const LogRecord& record, char* out, size_t size) {
+    int len = snprintf(out, size, "[%lu] [%s] [%s] ",
+                       (unsigned long)record.timestamp,
+                       levelName(record.level),
+                       moduleName(record.module));
+    if (len < 0) return 0;
+    size_t pos = min((size_t)len, size - 1);
+    pos += formatMessage(record, out + pos, size - pos - 1);
+    out[pos++] = '\n';
+    out[pos] = '\0';
+    return pos;
+}
+
+void Logger::beginRecord(LogRecord& record, LogLevel level, const char* module, const char* format) {
+    record.timestamp = millis() / 1000;
+    record.level = level;
+    record.module = internModule(module);
+    record.argsLength = 0;
+    record.format = format;
+}
+
+void Logger::commitRecord(const LogRecord& record, const char* message) {
+    Serial.print('[');
+    Serial.print(levelName(record.level));
+    Serial.print("] [");
+    Serial.print(moduleName(record.module));
+    Serial.print("] ");
+    if (message) {
+        Serial.println(message);
+    } else {
+        char line[LOG_LINE_SIZE];
+        formatMessage(record, line, sizeof(line));
+        Serial.println(line);
+    }
+    
+    // Ring lleno de registros sin escribir (loop() todavía no corrió): el más
+    // antiguo pasa a disco ahora. Solo se pierde antes de begin() o si falla
+    // la escritura
+    if (buffer.isFull() && unflushed == buffer.size() && started) {
+        stageOldest();
     }
+    if (buffer.isFull()) {
+        ringLevelCounts[buffer[0].level]--;
+    }
+    if (buffer.isFull() && unflushed == buffer.size()) {
+        droppedRecords++;
+    } else {
+        unflushed++;
+    }
+    buffer.push(record);
+    ringLevelCounts[record.level]++;
+    levelTotals[record.level]++;
+}
+
+void Logger::log(LogLevel level, const char* message, const char* module) {
+    if (level > CURRENT_LOG_LEVEL) return;
     
-    Serial.print("[" + module + "] ");
-    Serial.println(message);
+    // Mensaje ya armado: se guarda como único argumento de "%s" (truncado a
+    // LOG_ARGS_SIZE en el ring; Serial lo muestra completo)
+    LogRecord record;
+    beginRecord(record, level, module, "%s");
+    appendString(record, message);
+    commitRecord(record, message);
+}
+
+// === ESCRITURA EN SEGMENTOS ===
+
+void Logger::segmentPath(uint32_t segment, char* out, size_t size) const {
+    snprintf(out, size, LOG_SEGMENT_PREFIX "%lu.log", (unsigned long)segment);
+}
+
+void Logger::loadManifest() {
+    firstSegment = 0;
+    lastSegment = 0;
+    
+    File f = LittleFS.open(LOG_MANIFEST_FILE, "r");
+    if (!f) return;
     
-    buffer.push(entry);
+    char text[24];
+    size_t len = f.readBytes(text, sizeof(text) - 1);
+    text[len] = '\0';
+    f.close();
     
-    // Auto-flush si ha pasado suficiente tiempo
-    if (millis() - lastFlush > FLUSH_INTERVAL) {
-        flush();
+    unsigned long first, last;
+    if (sscanf(text, "%lu %lu", &first, &last) == 2 && first <= last &&
+        last - first < LOG_SEGMENT_COUNT) {
+        firstSegment = first;
+        lastSegment = last;
     }
 }
 
-void Logger::error(const String& message, const String& module) {
-    log(LOG_LEVEL_ERROR, message, module);
+void Logger::saveManifest() {
+    // Solo cambia al rotar, una vez cada LOG_SEGMENT_SIZE bytes de log
+    File f = LittleFS.open(LOG_MANIFEST_FILE, "w");
+    if (!f) return;
+    f.printf("%lu %lu\n", (unsigned long)firstSegment, (unsigned long)lastSegment);
+    f.close();
 }
 
-void Logger::warning(const String& message, const String& module) {
-    log(LOG_LEVEL_WARNING, message, module);
+bool Logger::openSegment() {
+    char path[32];
+    segmentPath(lastSegment, path, sizeof(path));
+    logFile = LittleFS.open(path, "a");
+    if (!logFile) {
+        Serial.println("[ERROR] No se pudo abrir archivo de log");
+        return false;
+    }
+    segmentBytes = logFile.size();
+    return true;
 }
 
-void Logger::info(const String& message, const String& module) {
-    log(LOG_LEVEL_INFO, message, module);
+void Logger::rotateSegment() {
+    if (logFile) logFile.close();
+    lastSegment++;
+    
+    char path[32];
+    while (lastSegment - firstSegment >= LOG_SEGMENT_COUNT) {
+        segmentPath(firstSegment, path, sizeof(path));
+        LittleFS.remove(path);
+        firstSegment++;
+    }
+    saveManifest();
+    segmentBytes = 0;
 }
 
-void Logger::debug(const String& message, const String& module) {
-    log(LOG_LEVEL_DEBUG, message, module);
+uint32_t Logger::placeLine(uint32_t position, size_t length) {
+    // Las líneas no se parten entre segmentos: si no entra, va al siguiente
+    if (position % LOG_SEGMENT_SIZE + length > LOG_SEGMENT_SIZE) {
+        return (position / LOG_SEGMENT_SIZE + 1) * LOG_SEGMENT_SIZE;
+    }
+    return position;
 }
 
-void Logger::flush() {
-    if (buffer.isEmpty()) return;
-    
-    // Verificar tamaño antes de escribir
-    if (LittleFS.exists(LOG_FILE)) {
-        File f = LittleFS.open(LOG_FILE, "r");
-        if (f && f.size() > MAX_LOG_SIZE) {
-            f.close();
-            rotateLogFile();
-        } else if (f) {
-            f.close();
+void Logger::stageRecord() {
+    // Hay lugar garantizado: pending tiene LOG_LINE_SIZE de margen sobre el lote
+    const LogRecord& record = buffer[buffer.size() - unflushed];
+    size_t length = formatRecord(record, pending + pendingLength, sizeof(pending) - pendingLength);
+    uint32_t position = placeLine(stagedEnd, length);
+    if (position / LOG_SEGMENT_SIZE != lastSegment && !segmentFull) {
+        segmentFull = true;
+        segmentEnd = pendingLength;
+    }
+    indexLine(record, position);
+    
+    stagedEnd = position + length;
+    pendingLength += length;
+    unflushed--;
+}
+
+// Escritura sincrónica: completa los lotes que haga falta para que el
+// registro sin escribir más antiguo entre en pending
+void Logger::stageOldest() {
+    while (pendingLength >= nextBatchSize()) {
+        if (!writeBatch(nextBatchSize())) return;
+    }
+    stageRecord();
+    syncStaged++;
+}
+
+size_t Logger::nextBatchSize() const {
+    // Con el segmento lleno solo falta escribir su cierre
+    if (segmentFull) return segmentEnd;
+    
+    // Lo que falta para el próximo múltiplo de LOG_WRITE_BATCH: si un lote
+    // incompleto desalineó el segmento, el siguiente lo vuelve a alinear
+    return LOG_WRITE_BATCH - (segmentBytes % LOG_WRITE_BATCH);
+}
+
+bool Logger::writeBatch(size_t length) {
+    if (!logFile && !openSegment()) return false;
+    
+    if (length > 0) {
+        logFile.write((const uint8_t*)pending, length);
+        logFile.flush();
+        segmentBytes += length;
+        batchesWritten++;
+        
+        pendingLength -= length;
+        memmove(pending, pending + length, pendingLength);
+    }
+    lastFlush = millis();
+    
+    if (segmentFull) {
+        segmentEnd -= length;
+        if (segmentEnd == 0) {
+            segmentFull = false;
+            rotateSegment();
+            return openSegment();
         }
     }
+    return true;
+}
+
+void Logger::loop() {
+    unsigned long start = micros();
     
-    logFile = LittleFS.open(LOG_FILE, "a");
-    if (!logFile) {
-        Serial.println("[ERROR] No se pudo abrir archivo de log");
-        return;
+    // Formatear registros hasta completar el lote o agotar el presupuesto
+    while (unflushed > 0 && pendingLength < nextBatchSize() && micros() - start < LOG_FLUSH_BUDGET_US) {
+        stageRecord();
     }
     
-    while (!buffer.isEmpty()) {
-        LogEntry entry = buffer.shift();
-        logFile.print(formatLogEntry(entry));
+    // Como máximo una escritura por iteración
+    size_t batch = nextBatchSize();
+    if (pendingLength >= batch) {
+        writeBatch(batch);
+    } else if (pendingLength > 0 && millis() - lastFlush > FLUSH_INTERVAL) {
+        writeBatch(pendingLength);
+    }
+}
+
+void Logger::flush() {
+    while (unflushed > 0 || pendingLength > 0 || segmentFull) {
+        while (unflushed > 0 && pendingLength < nextBatchSize()) {
+            stageRecord();
+        }
+        if (!writeBatch(min(pendingLength, nextBatchSize()))) break;
+    }
+}
+
+// === ÍNDICE Y CONSULTAS ===
+
+void Logger::resetSegmentIndex(LogSegmentIndex& index, uint32_t segment, bool complete) {
+    index.segment = segment;
+    index.complete = complete;
+    index.minTimestamp = 0xFFFFFFFF;
+    index.maxTimestamp = 0;
+    index.moduleMask = 0;
+    index.lines = 0;
+    memset(index.levelCounts, 0, sizeof(index.levelCounts));
+    index.entryCount = 0;
+}
+
+void Logger::indexLine(const LogRecord& record, uint32_t position) {
+    uint32_t segment = position / LOG_SEGMENT_SIZE;
+    LogSegmentIndex& index = segmentIndex[segment % LOG_SEGMENT_COUNT];
+    if (index.segment != segment) {
+        resetSegmentIndex(index, segment, true);
     }
     
-    logFile.close();
-    lastFlush = millis();
+    if (index.lines % LOG_INDEX_INTERVAL == 0 && index.entryCount < LOG_INDEX_ENTRIES) {
+        index.entries[index.entryCount].timestamp = record.timestamp;
+        index.entries[index.entryCount].offset = position % LOG_SEGMENT_SIZE;
+        index.entryCount++;
+    }
+    index.lines++;
+    index.minTimestamp = min(index.minTimestamp, record.timestamp);
+    index.maxTimestamp = max(index.maxTimestamp, record.timestamp);
+    index.levelCounts[record.level]++;
+    index.moduleMask |= 1UL << record.module;
 }
 
-String Logger::getRecentLogs(int count) {
-    StaticJsonDocument<4096> doc;
-    JsonArray logs = doc.to<JsonArray>();
+const LogSegmentIndex* Logger::findSegmentIndex(uint32_t segment) const {
+    const LogSegmentIndex& index = segmentIndex[segment % LOG_SEGMENT_COUNT];
+    return (index.segment == segment && index.complete) ? &index : nullptr;
+}
+
+int16_t Logger::findModule(const char* module) const {
+    for (uint8_t i = 0; i < moduleCount; i++) {
+        if (strncmp(moduleNames[i], module, LOG_MODULE_NAME_SIZE - 1) == 0) return i;
+    }
+    return -1;
+}
+
+uint8_t Logger::parseLevel(const char* text) {
+    if (text[0] >= '1' && text[0] <= '4' && text[1] == '\0') return text[0] - '0';
+    if (strcasecmp(text, "error") == 0) return LOG_LEVEL_ERROR;
+    if (strcasecmp(text, "warning") == 0 || strcasecmp(text, "warn") == 0) return LOG_LEVEL_WARNING;
+    if (strcasecmp(text, "info") == 0) return LOG_LEVEL_INFO;
+    if (strcasecmp(text, "debug") == 0) return LOG_LEVEL_DEBUG;
+    return 0;
+}
+
+bool Logger::queryLine(const LogQuery& query, char* line, uint32_t position, JsonArray results) {
+    // Formato de formatRecord(): "[timestamp] [NIVEL] [MODULO] mensaje"
+    if (line[0] != '[') return false;
+    char* p;
+    uint32_t timestamp = strtoul(line + 1, &p, 10);
+    if (strncmp(p, "] [", 3) != 0) return false;
     
-    int startIdx = buffer.size() > count ? buffer.size() - count : 0;
+    char* levelText = p + 3;
+    char* levelEnd = strchr(levelText, ']');
+    if (!levelEnd || strncmp(levelEnd, "] [", 3) != 0) return false;
+    *levelEnd = '\0';
     
-    for (int i = startIdx; i < buffer.size(); i++) {
-        JsonObject logObj = logs.createNestedObject();
-        logObj["timestamp"] = buffer[i].timestamp;
-        logObj["level"] = buffer[i].level;
-        logObj["module"] = buffer[i].module;
-        logObj["message"] = buffer[i].message;
+    char* moduleText = levelEnd + 3;
+    char* moduleEnd = strchr(moduleText, ']');
+    if (!moduleEnd) return false;
+    *moduleEnd = '\0';
+    char* message = moduleEnd[1] == ' ' ? moduleEnd + 2 : moduleEnd + 1;
+    
+    uint8_t level = parseLevel(levelText);
+    if (level == 0 || level > query.level) return false;
+    if (timestamp < query.from || timestamp > query.to) return false;
+    if (query.module && strncmp(moduleText, query.module, LOG_MODULE_NAME_SIZE - 1) != 0) return false;
+    
+    JsonObject obj = results.createNestedObject();
+    obj["pos"] = position;
+    obj["timestamp"] = timestamp;
+    obj["level"] = levelName(level);
+    obj["module"] = moduleText;
+    obj["message"] = message;
+    return true;
+}
+
+String Logger::queryLogs(const LogQuery& query) {
+    DynamicJsonDocument doc(LOG_QUERY_DOC_SIZE);
+    JsonArray results = doc.createNestedArray("logs");
+    
+    uint8_t limit = constrain(query.limit, 1, LOG_QUERY_MAX_RESULTS);
+    int16_t moduleId = query.module ? findModule(query.module) : -1;
+    uint32_t writtenEnd = lastSegment * LOG_SEGMENT_SIZE + segmentBytes;
+    uint32_t position = max(query.cursor, firstSegment * LOG_SEGMENT_SIZE);
+    uint32_t scanned = 0;
+    size_t pendingSkip = 0;  // Bytes de pending que completan la última línea en flash
+    bool more = false;
+    char line[LOG_LINE_SIZE];
+    
+    // Cada línea se agrega solo si queda lugar para ella (objeto de 5 campos y
+    // sus textos) y para el cierre (next_cursor, more, scanned, truncated y
+    // counts); si no, la página termina ahí
+    const size_t lineCost = JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(5) + LOG_LINE_SIZE;
+    const size_t closeCost = JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(4);
+    auto pageFull = [&]() {
+        return results.size() >= limit || doc.memoryUsage() + lineCost + closeCost > LOG_QUERY_DOC_SIZE;
+    };
+    
+    // 1) Segmentos en flash
+    while (!more && position < writtenEnd) {
+        uint32_t segment = position / LOG_SEGMENT_SIZE;
+        uint32_t nextSegment = (segment + 1) * LOG_SEGMENT_SIZE;
+        uint32_t offset = position % LOG_SEGMENT_SIZE;
+        
+        const LogSegmentIndex* index = findSegmentIndex(segment);
+        if (index) {
+            bool levelPresent = false;
+            for (uint8_t level = LOG_LEVEL_ERROR; level <= query.level && level <= LOG_LEVEL_DEBUG; level++) {
+                if (index->levelCounts[level]) levelPresent = true;
+            }
+            bool modulePresent = !query.module || (moduleId >= 0 && (index->moduleMask & (1UL << moduleId)));
+            if (!levelPresent || !modulePresent || index->lines == 0 ||
+                index->maxTimestamp < query.from || index->minTimestamp > query.to) {
+                position = (segment == lastSegment) ? writtenEnd : nextSegment;
+                continue;
+            }
+            
+            // Saltar a la última entrada del índice anterior a "from"
+            for (uint8_t i = 0; i < index->entryCount && index->entries[i].timestamp < query.from; i++) {
+                offset = max(offset, (uint32_t)index->entries[i].offset);
+            }
+        }
+        
+        char path[32];
+        segmentPath(segment, path, sizeof(path));
+        File f = LittleFS.open(path, "r");
+        if (!f) {
+            position = nextSegment;
+            continue;
+        }
+        size_t end = (segment == lastSegment) ? segmentBytes : f.size();
+        f.seek(offset);
+        
+        while (f.position() < end) {
+            size_t lineOffset = f.position();
+            uint32_t lineStart = segment * LOG_SEGMENT_SIZE + lineOffset;
+            if (pageFull()) {
+                position = lineStart;
+                more = true;
+                break;
+            }
+            size_t len = f.readBytesUntil('\n', line, sizeof(line) - 1);
+            
+            // Los lotes cortan líneas: el final de la última sigue en pending
+            if (segment == lastSegment && f.position() - lineOffset == len) {
+                const char* newline = (const char*)memchr(pending, '\n', pendingLength);
+                size_t rest = newline ? newline - pending : pendingLength;
+                memcpy(line + len, pending, min(rest, sizeof(line) - 1 - len));
+                len += min(rest, sizeof(line) - 1 - len);
+                pendingSkip = rest + 1;
+            }
+            line[len] = '\0';
+            scanned++;
+            queryLine(query, line, lineStart, results);
+        }
+        f.close();
+        if (!more) position = (segment == lastSegment) ? writtenEnd : nextSegment;
     }
     
+    // 2) Líneas formateadas que esperan en pending
+    size_t offset = pendingSkip;
+    while (!more && offset < pendingLength) {
+        const char* newline = (const char*)memchr(pending + offset, '\n', pendingLength - offset);
+        size_t len = newline ? newline - (pending + offset) : pendingLength - offset;
+        uint32_t lineStart = (segmentFull && offset >= segmentEnd)
+            ? (lastSegment + 1) * LOG_SEGMENT_SIZE + (offset - segmentEnd)
+            : writtenEnd + offset;
+        
+        if (lineStart >= position) {
+            if (pageFull()) {
+                position = lineStart;
+                more = true;
+                break;
+            }
+            memcpy(line, pending + offset, len);
+            line[len] = '\0';
+            scanned++;
+            queryLine(query, line, lineStart, results);
+            position = lineStart + len + 1;
+        }
+        offset += len + 1;
+    }
+    
+    // 3) Registros del ring que todavía no se formatearon: su posición es la
+    // que les va a dar stageRecord()
+    uint32_t next = stagedEnd;
+    for (uint16_t i = buffer.size() - unflushed; !more && i < buffer.size(); i++) {
+        size_t len = formatRecord(buffer[i], line, sizeof(line));
+        uint32_t lineStart = placeLine(next, len);
+        next = lineStart + len;
+        if (lineStart < position) continue;
+        
+        if (pageFull()) {
+            position = lineStart;
+            more = true;
+            break;
+        }
+        if (len > 0 && line[len - 1] == '\n') line[len - 1] = '\0';
+        scanned++;
+        queryLine(query, line, lineStart, results);
+        position = next;
+    }
+    
+    doc["next_cursor"] = position;
+    doc["more"] = more;
+    doc["scanned"] = scanned;
+    if (query.cursor > 0 && query.cursor < firstSegment * LOG_SEGMENT_SIZE) {
+        doc["truncated"] = true;  // Parte de lo pedido ya se rotó
+    }
+    JsonObject counts = doc.createNestedObject("counts");
+    counts["error"] = levelTotals[LOG_LEVEL_ERROR];
+    counts["warning"] = levelTotals[LOG_LEVEL_WARNING];
+    counts["info"] = levelTotals[LOG_LEVEL_INFO];
+    counts["debug"] = levelTotals[LOG_LEVEL_DEBUG];
+    
     String result;
     serializeJson(doc, result);
     return result;
 }
 
+String Logger::getRecentLogs(int count) {
+    size_t wanted = count > 0 ? min((size_t)count, buffer.size()) : 0;
+    size_t startIdx = buffer.size() - wanted;
+    
+    // Un registro a la vez, como RecordStream: el documento no crece con
+    // 'count' y el mensaje se enlaza sin copiarlo
+    String result;
+    result.reserve(2 + wanted * 96);
+    result = "[";
+    char message[LOG_LINE_SIZE];
+    char entry[2 * LOG_LINE_SIZE + 96];  // Con el mensaje escapado
+    for (size_t i = startIdx; i < buffer.size(); i++) {
+        StaticJsonDocument<JSON_OBJECT_SIZE(4)> doc;
+        doc["timestamp"] = buffer[i].timestamp;
+        doc["level"] = levelName(buffer[i].level);
+        doc["module"] = moduleName(buffer[i].module);
+        formatMessage(buffer[i], message, sizeof(message));
+        doc["message"] = (const char*)message;
+        serializeJson(doc, entry, sizeof(entry));
+        if (i > startIdx) result += ',';
+        result += entry;
+    }
+    result += ']';
+    return result;
+}
+
 void Logger::clearLogs() {
     buffer.clear();
-    if (LittleFS.exists(LOG_FILE)) {
-        LittleFS.remove(LOG_FILE);
+    unflushed = 0;
+    pendingLength = 0;
+    segmentFull = false;
+    segmentEnd = 0;
+    stagedEnd = 0;
+    memset(ringLevelCounts, 0, sizeof(ringLevelCounts));
+    for (uint8_t i = 0; i < LOG_SEGMENT_COUNT; i++) {
+        resetSegmentIndex(segmentIndex[i], 0xFFFFFFFF, false);
+    }
+    if (logFile) logFile.close();
+    
+    char path[32];
+    for (uint32_t segment = firstSegment; segment <= lastSegment; segment++) {
+        segmentPath(segment, path, sizeof(path));
+        LittleFS.remove(path);
     }
-    if (LittleFS.exists(LOG_BACKUP_FILE)) {
-        LittleFS.remove(LOG_BACKUP_FILE);
+    firstSegment = 0;
+    lastSegment = 0;
+    segmentBytes = 0;
+    LittleFS.remove(LOG_MANIFEST_FILE);
+    
+    if (LittleFS.exists(LOG_LEGACY_FILE)) {
+        LittleFS.remove(LOG_LEGACY_FILE);
+    }
+    if (LittleFS.exists(LOG_LEGACY_BACKUP)) {
+        LittleFS.remove(LOG_LEGACY_BACKUP);
     }
     info("Logs limpiados", "LOGGER");
 }
 
 size_t Logger::getLogFileSize() {
-    if (!LittleFS.exists(LOG_FILE)) return 0;
-    
-    File f = LittleFS.open(LOG_FILE, "r");
-    if (!f) return 0;
-    
-    size_t size = f.size();
-    f.close();
-    return size;
+    size_t total = 0;
+    char path[32];
+    for (uint32_t segment = firstSegment; segment <= lastSegment; segment++) {
+        if (segment == lastSegment && logFile) {
+            total += segmentBytes;
+            continue;
+        }
+        segmentPath(segment, path, sizeof(path));
+        File f = LittleFS.open(path, "r");
+        if (!f) continue;
+        total += f.size();
+        f.close();
+    }
+    return total;
 }
 
 int Logger::getErrorCount() {
-    int count = 0;
-    for (int i = 0; i < buffer.size(); i++) {
-        if (buffer[i].level == "ERROR") count++;
-    }
-    return count;
+    return ringLevelCounts[LOG_LEVEL_ERROR];
 }
 
 int Logger::getWarningCount() {
-    int count = 0;
-    for (int i = 0; i < buffer.size(); i++) {
-        if (buffer[i].level == "WARN") count++;
-    }
-    return count;
+    return ringLevelCounts[LOG_LEVEL_WARNING];
 }
 
 String Logger::getLogStats() {
@@ -201,8 +715,14 @@ String Logger::getLogStats() {
     doc["errors"] = getErrorCount();
     doc["warnings"] = getWarningCount();
     doc["file_size"] = getLogFileSize();
-    doc["max_file_size"] = MAX_LOG_SIZE;
+    doc["max_file_size"] = LOG_SEGMENT_SIZE * LOG_SEGMENT_COUNT;
+    doc["segments"] = lastSegment - firstSegment + 1;
     doc["buffer_usage"] = (buffer.size() * 100) / MAX_LOG_ENTRIES;
+    doc["unflushed"] = unflushed;
+    doc["pending_bytes"] = pendingLength;
+    doc["dropped"] = droppedRecords;
+    doc["sync_staged"] = syncStaged;
+    doc["batches_written"] = batchesWritten;
     
     String result;
     serializeJson(doc, result);
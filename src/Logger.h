@@ -2,58 +2,207 @@
 #define LOGGER_H
 
 #include <Arduino.h>
-#include <LittleFS.h>
+#include "hal/Platform.h"
 #include <CircularBuffer.h>
 #include <ArduinoJson.h>
+#include <type_traits>
 #include "config.h"
 
-#define LOG_FILE "/logs/system.log"
-#define LOG_BACKUP_FILE "/logs/system.old"
-#define MAX_LOG_SIZE 10240  // 10KB máximo por archivo
-#define MAX_LOG_ENTRIES 100 // Máximo de entradas en memoria
+#define LOG_DIR "/logs"
+#define LOG_MANIFEST_FILE "/logs/manifest"   // "<primer segmento> <último segmento>"
+#define LOG_SEGMENT_PREFIX "/logs/seg_"      // Segmentos: /logs/seg_<n>.log
+#define LOG_LEGACY_FILE "/logs/system.log"   // Formato anterior (se borra en clearLogs)
+#define LOG_LEGACY_BACKUP "/logs/system.old"
+#define LOG_SEGMENT_COUNT 4        // Segmentos que se conservan
+#define LOG_SEGMENT_SIZE 8192      // Bytes por segmento (un bloque de LittleFS)
+#define LOG_WRITE_BATCH 512        // Bytes por escritura (múltiplo de la página de LittleFS)
+#define LOG_FLUSH_BUDGET_US 2000   // Tiempo máximo por llamada a loop()
+#define MAX_LOG_ENTRIES 64  // Registros en el ring de memoria
+#define LOG_ARGS_SIZE 72    // Bytes de argumentos por registro (el texto se trunca)
+#define LOG_LINE_SIZE 160   // Línea formateada (Serial, archivo, JSON)
+#define LOG_MAX_MODULES 24  // Módulos distintos que se pueden internar
+#define LOG_MODULE_NAME_SIZE 12
+#define LOG_INDEX_INTERVAL 16      // Una entrada del índice cada N líneas escritas
+#define LOG_INDEX_ENTRIES 16       // Entradas por segmento
+#define LOG_QUERY_MAX_RESULTS 50
+#define LOG_QUERY_DOC_SIZE 6144
 
-enum LogLevel {
-    LOG_LEVEL_ERROR = 1,
-    LOG_LEVEL_WARNING = 2,
-    LOG_LEVEL_INFO = 3,
-    LOG_LEVEL_DEBUG = 4
+// Niveles LOG_LEVEL_* definidos en config.h (un enum con los mismos
+// nombres choca con esas macros)
+typedef uint8_t LogLevel;
+
+// Tipos de argumento dentro de LogRecord::args
+#define LOG_ARG_INT 'i'
+#define LOG_ARG_UINT 'u'
+#define LOG_ARG_FLOAT 'f'
+#define LOG_ARG_STR 's'
+
+// Registro de tamaño fijo: el ring se reserva una sola vez y log() no
+// toca el heap. El módulo se guarda como índice en la tabla de módulos.
+// El mensaje no se formatea al registrarlo: se guarda el puntero al formato
+// (un literal) y los argumentos en crudo, y el texto se arma recién al
+// escribir a LittleFS o al servir /api/logs/recent.
+struct LogRecord {
+    uint32_t timestamp;
+    uint8_t level;
+    uint8_t module;
+    uint8_t argsLength;
+    const char* format;
+    uint8_t args[LOG_ARGS_SIZE];  // [tipo][valor]..., texto como [tipo][largo][bytes]
+};
+
+// Índice disperso de un segmento: resumen completo (rango de tiempo,
+// contadores por nivel, módulos presentes) más la posición de una de cada
+// LOG_INDEX_INTERVAL líneas. Solo existe para los segmentos escritos desde el
+// arranque; los de arranques anteriores se recorren enteros.
+struct LogIndexEntry {
+    uint32_t timestamp;
+    uint16_t offset;
+};
+
+struct LogSegmentIndex {
+    uint32_t segment;
+    bool complete;  // false: el segmento ya tenía datos al arrancar
+    uint32_t minTimestamp;
+    uint32_t maxTimestamp;
+    uint32_t moduleMask;  // Bit por id de módulo
+    uint16_t lines;
+    uint16_t levelCounts[LOG_LEVEL_DEBUG + 1];
+    uint8_t entryCount;
+    LogIndexEntry entries[LOG_INDEX_ENTRIES];
 };
 
-struct LogEntry {
-    unsigned long timestamp;
-    String level;
-    String message;
-    String module;
+// Filtros de /api/logs/query. La posición (cursor) es absoluta en el log:
+// segmento * LOG_SEGMENT_SIZE + offset, y se mantiene válida entre páginas
+// aunque las líneas pendientes lleguen a flash en el medio.
+struct LogQuery {
+    uint8_t level = LOG_LEVEL_DEBUG;  // Este nivel y los más graves
+    const char* module = nullptr;
+    uint32_t from = 0;
+    uint32_t to = 0xFFFFFFFF;
+    uint32_t cursor = 0;
+    uint8_t limit = LOG_QUERY_MAX_RESULTS;
 };
 
 class Logger {
 private:
-    CircularBuffer<LogEntry, MAX_LOG_ENTRIES> buffer;
+    CircularBuffer<LogRecord, MAX_LOG_ENTRIES> buffer;
+    char moduleNames[LOG_MAX_MODULES][LOG_MODULE_NAME_SIZE];
+    uint8_t moduleCount = 0;
+    uint16_t unflushed = 0;  // Registros al final del ring que aún no pasaron a disco
+    uint32_t droppedRecords = 0;
+    uint32_t syncStaged = 0;  // Registros escritos desde log() con el ring lleno
+    bool started = false;     // begin() ya ubicó el segmento: se puede escribir
+    uint32_t levelTotals[LOG_LEVEL_DEBUG + 1] = {};     // Desde el arranque
+    uint16_t ringLevelCounts[LOG_LEVEL_DEBUG + 1] = {};  // Registros en el ring
+    
+    // Escritura por lotes: las líneas formateadas se juntan en pending y se
+    // escriben en bloques de LOG_WRITE_BATCH alineados dentro del segmento
+    char pending[LOG_WRITE_BATCH + LOG_LINE_SIZE];
+    size_t pendingLength = 0;
     File logFile;
-    bool sdAvailable = false;
+    uint32_t firstSegment = 0;
+    uint32_t lastSegment = 0;
+    size_t segmentBytes = 0;
+    uint32_t stagedEnd = 0;    // Posición absoluta tras la última línea en pending
+    bool segmentFull = false;  // pending contiene el cierre del segmento actual
+    size_t segmentEnd = 0;     // Bytes de pending que van al segmento actual
+    LogSegmentIndex segmentIndex[LOG_SEGMENT_COUNT];
+    uint32_t batchesWritten = 0;
     unsigned long lastFlush = 0;
-    const unsigned long FLUSH_INTERVAL = 30000; // Flush cada 30 segundos
+    const unsigned long FLUSH_INTERVAL = 30000; // Lote incompleto: se escribe a los 30 segundos
+    
+    uint8_t internModule(const char* module);
+    void beginRecord(LogRecord& record, LogLevel level, const char* module, const char* format);
+    void commitRecord(const LogRecord& record, const char* message);
+    size_t formatMessage(const LogRecord& record, char* out, size_t size);
+    size_t formatRecord(const LogRecord& record, char* out, size_t size);
+    
+    // Codificación de argumentos de logf()
+    static void appendArg(LogRecord& record, char type, const void* value);
+    static void appendString(LogRecord& record, const char* text);
+    
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value || (std::is_integral<T>::value && std::is_signed<T>::value)>::type
+    encodeArg(LogRecord& record, T value) { int32_t v = value; appendArg(record, LOG_ARG_INT, &v); }
+    
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    encodeArg(LogRecord& record, T value) { uint32_t v = value; appendArg(record, LOG_ARG_UINT, &v); }
+    
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    encodeArg(LogRecord& record, T value) { float v = value; appendArg(record, LOG_ARG_FLOAT, &v); }
     
-    String formatLogEntry(const LogEntry& entry);
-    void rotateLogFile();
-    bool ensureLogDirectory();
+    static void encodeArg(LogRecord& record, const char* text) { appendString(record, text); }
+    
+    static void encodeArgs(LogRecord&) {}
+    
+    template <typename T, typename... Rest>
+    static void encodeArgs(LogRecord& record, T first, Rest... rest) {
+        encodeArg(record, first);
+        encodeArgs(record, rest...);
+    }
+    static uint32_t placeLine(uint32_t position, size_t length);
+    void stageRecord();
+    void stageOldest();
+    void indexLine(const LogRecord& record, uint32_t position);
+    void resetSegmentIndex(LogSegmentIndex& index, uint32_t segment, bool complete);
+    const LogSegmentIndex* findSegmentIndex(uint32_t segment) const;
+    int16_t findModule(const char* module) const;
+    bool queryLine(const LogQuery& query, char* line, uint32_t position, JsonArray results);
+    size_t nextBatchSize() const;
+    bool writeBatch(size_t length);
+    bool openSegment();
+    void rotateSegment();
+    void segmentPath(uint32_t segment, char* out, size_t size) const;
+    void loadManifest();
+    void saveManifest();
     
 public:
     Logger();
     ~Logger();
     
     bool begin();
-    void log(LogLevel level, const String& message, const String& module = "SYSTEM");
-    void error(const String& message, const String& module = "SYSTEM");
-    void warning(const String& message, const String& module = "SYSTEM");
-    void info(const String& message, const String& module = "SYSTEM");
-    void debug(const String& message, const String& module = "SYSTEM");
+    void log(LogLevel level, const char* message, const char* module = "SYSTEM");
+    void log(LogLevel level, const String& message, const char* module = "SYSTEM") { log(level, message.c_str(), module); }
+    
+    void error(const char* message, const char* module = "SYSTEM") { log(LOG_LEVEL_ERROR, message, module); }
+    void error(const String& message, const char* module = "SYSTEM") { log(LOG_LEVEL_ERROR, message.c_str(), module); }
+    void warning(const char* message, const char* module = "SYSTEM") { log(LOG_LEVEL_WARNING, message, module); }
+    void warning(const String& message, const char* module = "SYSTEM") { log(LOG_LEVEL_WARNING, message.c_str(), module); }
+    void info(const char* message, const char* module = "SYSTEM") { log(LOG_LEVEL_INFO, message, module); }
+    void info(const String& message, const char* module = "SYSTEM") { log(LOG_LEVEL_INFO, message.c_str(), module); }
+    void debug(const char* message, const char* module = "SYSTEM") { log(LOG_LEVEL_DEBUG, message, module); }
+    void debug(const String& message, const char* module = "SYSTEM") { log(LOG_LEVEL_DEBUG, message.c_str(), module); }
     
-    void flush();  // Guardar logs pendientes a archivo
+    // Formato estilo printf con argumentos numéricos o const char*; conviene
+    // usarlo a través de las macros LOGF_* (ver abajo)
+    template <typename... Args>
+    void logf(LogLevel level, const char* module, const char* format, Args... args) {
+        if (level > CURRENT_LOG_LEVEL) return;
+        LogRecord record;
+        beginRecord(record, level, module, format);
+        encodeArgs(record, args...);
+        commitRecord(record, nullptr);
+    }
+    
+    static const char* levelName(uint8_t level);
+    const char* moduleName(uint8_t id) const;
+    
+    // Escritura en segundo plano, acotada a LOG_FLUSH_BUDGET_US. Si el ring se
+    // llena antes (setup(), ráfagas) log() escribe el registro más antiguo en
+    // el momento en lugar de perderlo
+    void loop();
+    void flush();  // Guardar todos los logs pendientes (sin límite de tiempo)
     String getRecentLogs(int count = 50);  // Obtener logs recientes en JSON
     void clearLogs();  // Limpiar todos los logs
     size_t getLogFileSize();
     
+    // Consulta paginada sobre los segmentos y las líneas aún en memoria
+    String queryLogs(const LogQuery& query);
+    static uint8_t parseLevel(const char* text);
+    
     // Métodos para análisis
     int getErrorCount();
     int getWarningCount();
@@ -69,4 +218,41 @@ extern Logger SystemLogger;
 #define SLOG_INFO(msg) SystemLogger.info(msg, __func__)
 #define SLOG_DEBUG(msg) SystemLogger.debug(msg, __func__)
 
+// Logging con formato diferido. Los niveles por encima de CURRENT_LOG_LEVEL
+// no generan código ni evalúan sus argumentos; logFormatCheck() solo sirve
+// para que el compilador verifique el formato contra los argumentos.
+//   LOGF_INFO("LUCES", "Luminaria %08X - %s", id, estado.c_str());
+static inline void logFormatCheck(const char*, ...) __attribute__((format(printf, 1, 2)));
+static inline void logFormatCheck(const char*, ...) {}
+
+#define LOGF_DISABLED(fmt, ...) do { if (0) logFormatCheck(fmt, ##__VA_ARGS__); } while (0)
+#define LOGF(level, module, fmt, ...) do { \
+    if (0) logFormatCheck(fmt, ##__VA_ARGS__); \
+    SystemLogger.logf(level, module, fmt, ##__VA_ARGS__); \
+} while (0)
+
+#if CURRENT_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOGF_ERROR(module, fmt, ...) LOGF(LOG_LEVEL_ERROR, module, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_ERROR(module, fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if CURRENT_LOG_LEVEL >= LOG_LEVEL_WARNING
+#define LOGF_WARNING(module, fmt, ...) LOGF(LOG_LEVEL_WARNING, module, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_WARNING(module, fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if CURRENT_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOGF_INFO(module, fmt, ...) LOGF(LOG_LEVEL_INFO, module, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_INFO(module, fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if CURRENT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGF_DEBUG(module, fmt, ...) LOGF(LOG_LEVEL_DEBUG, module, fmt, ##__VA_ARGS__)
+#else
+#define LOGF_DEBUG(module, fmt, ...) LOGF_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
 #endif // LOGGER_H
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "LuminariaRegistry.h"
+
+LuminariaRegistry Luminarias;
+
+static_assert(REGISTRY_INDEX_SIZE >= 2 * MAX_LUCES, "REGISTRY_INDEX_SIZE debe ser al menos 2 * MAX_LUCES");
+static_assert(MAX_LUCES < REGISTRY_NOT_FOUND, "MAX_LUCES excede el rango del índice");
+static_assert(REGISTRY_MAX_ZONES < ZONA_NINGUNA, "REGISTRY_MAX_ZONES excede el rango de zona");
+
+LuminariaRegistry::LuminariaRegistry() {
+    clear();
+}
+
+void LuminariaRegistry::clear() {
+    count = 0;
+    zoneCount = 0;
+    revision = 0;
+    for (uint16_t i = 0; i < REGISTRY_INDEX_SIZE; i++) {
+        index[i] = REGISTRY_NOT_FOUND;
+    }
+}
+
+uint16_t LuminariaRegistry::hashSlot(uint32_t id) {
+    // Hash multiplicativo de Knuth: distribuye bien IDs consecutivos o con patrones
+    return (uint16_t)((uint32_t)(id * 2654435761UL) >> (32 - REGISTRY_INDEX_BITS));
+}
+
+uint16_t LuminariaRegistry::find(uint32_t id) const {
+    if (id == LUMINARIA_ID_INVALID) return REGISTRY_NOT_FOUND;
+    uint16_t slot = hashSlot(id);
+
+    // Sondeo lineal: con factor de carga <= 0.5 la búsqueda termina en pocas posiciones
+    for (uint16_t probe = 0; probe < REGISTRY_INDEX_SIZE; probe++) {
+        uint16_t pos = index[slot];
+        if (pos == REGISTRY_NOT_FOUND) return REGISTRY_NOT_FOUND;
+        if (ids[pos] == id) return pos;
+        slot = (slot + 1) & (REGISTRY_INDEX_SIZE - 1);
+    }
+    return REGISTRY_NOT_FOUND;
+}
+
+uint16_t LuminariaRegistry::insert(uint32_t id) {
+    if (id == LUMINARIA_ID_INVALID) return REGISTRY_NOT_FOUND;
+    uint16_t slot = hashSlot(id);
+
+    for (uint16_t probe = 0; probe < REGISTRY_INDEX_SIZE; probe++) {
+        uint16_t pos = index[slot];
+        if (pos == REGISTRY_NOT_FOUND) break;
+        if (ids[pos] == id) return pos;
+        slot = (slot + 1) & (REGISTRY_INDEX_SIZE - 1);
+    }
+
+    if (isFull()) return REGISTRY_NOT_FOUND;
+
+    uint16_t pos = count++;
+    ids[pos] = id;
+    lats[pos] = 0;
+    lngs[pos] = 0;
+    ultimaActualizacion[pos] = millis();
+    Brightness.setLevel(pos, 100);
+    estados[pos] = ESTADO_APAGADA;
+    zonas[pos] = ZONA_NINGUNA;
+    flags[pos] = 0;
+    markChanged(pos);
+
+    index[slot] = pos;
+    return pos;
+}
+
+// Los setters solo avanzan la revisión si el valor cambia, para que los
+// sondeos periódicos de los dashboards reciban 304 en una red tranquila
+
+void LuminariaRegistry::setPosicion(uint16_t pos, float lat, float lng) {
+    if (lats[pos] == lat && lngs[pos] == lng) return;
+    lats[pos] = lat;
+    lngs[pos] = lng;
+    markChanged(pos);
+}
+
+void LuminariaRegistry::setEstado(uint16_t pos, EstadoLuminaria estado) {
+    if (estados[pos] == estado) return;
+    estados[pos] = estado;
+    markChanged(pos);
+}
+
+void LuminariaRegistry::notifyIntensidad(uint16_t pos) {
+    markChanged(pos);
+}
+
+void LuminariaRegistry::setZona(uint16_t pos, uint8_t zona) {
+    if (zonas[pos] == zona) return;
+    zonas[pos] = zona;
+    markChanged(pos);
+}
+
+void LuminariaRegistry::setDimeable(uint16_t pos, bool dimeable) {
+    uint8_t nuevo = dimeable ? (flags[pos] | LUMINARIA_FLAG_DIMEABLE)
+                             : (flags[pos] & ~LUMINARIA_FLAG_DIMEABLE);
+    if (flags[pos] == nuevo) return;
+    flags[pos] = nuevo;
+    markChanged(pos);
+}
+
+void LuminariaRegistry::setCurva(uint16_t pos, DimmingCurveType curva) {
+    if (curva >= DIMMING_CURVE_COUNT) return;
+    uint8_t nuevo = (flags[pos] & ~LUMINARIA_CURVE_MASK) | (curva << LUMINARIA_CURVE_SHIFT);
+    if (flags[pos] == nuevo) return;
+    flags[pos] = nuevo;
+    markChanged(pos);
+}
+
+void LuminariaRegistry::touch(uint16_t pos) {
+    // Solo vivacidad: cada heartbeat y cada paso de fade pasan por aquí, y
+    // con una revisión nueva el ETag casi nunca coincidiría. El registro
+    // lleva ultima_actualizacion tal como estaba en su última revisión; los
+    // cambios de estado que reporta el nodo los marca setEstado()
+    ultimaActualizacion[pos] = millis();
+}
+
+// === ZONAS ===
+
+uint8_t LuminariaRegistry::findZone(const char* name) const {
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        if (strncmp(zoneNames[i], name, REGISTRY_ZONE_NAME_MAX) == 0) return i;
+    }
+    return ZONA_NINGUNA;
+}
+
+uint8_t LuminariaRegistry::internZone(const char* name) {
+    // Un nombre recortado no coincidiría con el topic al que se suscribe el nodo
+    if (!name[0] || strlen(name) >= REGISTRY_ZONE_NAME_MAX) return ZONA_NINGUNA;
+    uint8_t zona = findZone(name);
+    if (zona != ZONA_NINGUNA) return zona;
+    if (zoneCount >= REGISTRY_MAX_ZONES) return ZONA_NINGUNA;
+
+    strncpy(zoneNames[zoneCount], name, REGISTRY_ZONE_NAME_MAX - 1);
+    zoneNames[zoneCount][REGISTRY_ZONE_NAME_MAX - 1] = '\0';
+    return zoneCount++;
+}
+
+const char* LuminariaRegistry::getZoneName(uint8_t zona) const {
+    if (zona >= zoneCount) return "";
+    return zoneNames[zona];
+}
+
+// === CONVERSIONES ===
+
+const char* LuminariaRegistry::estadoToString(EstadoLuminaria estado) {
+    switch (estado) {
+        case ESTADO_ENCENDIDA: return "encendida";
+        case ESTADO_APAGADA: return "apagada";
+        case ESTADO_FALLA: return "falla";
+        default: return "offline";
+    }
+}
+
+bool LuminariaRegistry::parseEstado(const char* text, EstadoLuminaria& out) {
+    if (strcmp(text, "encendida") == 0) out = ESTADO_ENCENDIDA;
+    else if (strcmp(text, "apagada") == 0) out = ESTADO_APAGADA;
+    else if (strcmp(text, "falla") == 0) out = ESTADO_FALLA;
+    else if (strcmp(text, "offline") == 0) out = ESTADO_OFFLINE;
+    else return false;
+    return true;
+}
+
+uint32_t LuminariaRegistry::parseId(const char* text) {
+    // Formato canónico: "LUM_" + 8 dígitos hexadecimales en mayúscula.
+    // Otros textos (p.ej. "LUM_1234567" de los nodos que usaban el chip ID
+    // en decimal) no se reducen a un hash: dos IDs distintos podrían
+    // terminar en la misma clave y el texto ya no coincidiría con el nodo
+    const size_t prefixLen = sizeof(LUMINARIA_ID_PREFIX) - 1;
+    if (strncmp(text, LUMINARIA_ID_PREFIX, prefixLen) != 0) return LUMINARIA_ID_INVALID;
+
+    const char* p = text + prefixLen;
+    uint32_t value = 0;
+    for (uint8_t digits = 0; digits < 8; digits++) {
+        char c = p[digits];
+        uint8_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else return LUMINARIA_ID_INVALID;
+        value = (value << 4) | nibble;
+    }
+    return p[8] == '\0' ? value : LUMINARIA_ID_INVALID;
+}
+
+void LuminariaRegistry::formatId(uint32_t id, char* out, size_t len) {
+    snprintf(out, len, LUMINARIA_ID_PREFIX "%08X", id);
+}
+
+String LuminariaRegistry::formatId(uint32_t id) {
+    char buf[16];
+    formatId(id, buf, sizeof(buf));
+    return String(buf);
+}
+
+// === SERIALIZACIÓN ===
+
+bool LuminariaRecordSource::next(JsonObject obj) {
+    while (pos < end && Luminarias.getRevisionOf(pos) <= since) {
+        pos++;
+    }
+    if (pos >= end) return false;
+
+    LuminariaRegistry::formatId(Luminarias.getId(pos), idBuffer, sizeof(idBuffer));
+    obj["id"] = (const char*)idBuffer;
+    obj["lat"] = Luminarias.getLat(pos);
+    obj["lng"] = Luminarias.getLng(pos);
+    obj["estado"] = LuminariaRegistry::estadoToString(Luminarias.getEstado(pos));
+    obj["intensidad"] = Luminarias.getIntensidad(pos);
+    obj["zona"] = Luminarias.getZoneName(Luminarias.getZona(pos));
+    obj["dimeable"] = Luminarias.isDimeable(pos);
+    obj["curva"] = dimmingCurveName(Luminarias.getCurva(pos));
+    obj["ultima_actualizacion"] = Luminarias.getUltimaActualizacion(pos);
+    pos++;
+    return true;
+}
+
+size_t LuminariaRecordSource::count() {
+    // Las revisiones solo crecen: una luminaria contada no deja de cumplir el filtro
+    size_t total = 0;
+    for (uint16_t i = pos; i < end; i++) {
+        if (Luminarias.getRevisionOf(i) > since) total++;
+    }
+    return total;
+}
@@ -0,0 +1,148 @@
+#ifndef LUMINARIA_REGISTRY_H
+#define LUMINARIA_REGISTRY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "RecordStream.h"
+#include "DimmingCurve.h"
+#include "BrightnessTable.h"
+
+// Configuración del registro
+// El índice usa direccionamiento abierto con sondeo lineal; su tamaño debe ser
+// potencia de 2 y al menos el doble de MAX_LUCES para mantener factor de carga <= 0.5
+#ifndef REGISTRY_INDEX_BITS
+#define REGISTRY_INDEX_BITS 9
+#endif
+#define REGISTRY_INDEX_SIZE (1 << REGISTRY_INDEX_BITS)
+#define REGISTRY_NOT_FOUND 0xFFFF
+#define LUMINARIA_ID_PREFIX "LUM_"
+#define LUMINARIA_ID_INVALID 0xFFFFFFFF  // parseId() de un texto no canónico; nunca se inserta
+
+// Zonas internadas: cada luminaria guarda solo el índice de su zona
+#define REGISTRY_MAX_ZONES 16
+#define REGISTRY_ZONE_NAME_MAX 24
+#define ZONA_NINGUNA 0xFF
+
+// Flags por luminaria
+#define LUMINARIA_FLAG_DIMEABLE 0x01
+#define LUMINARIA_CURVE_SHIFT 1        // Bits 1-2: curva que aplica el nodo (DimmingCurveType)
+#define LUMINARIA_CURVE_MASK 0x06
+
+// Estado de luminaria (1 byte)
+enum EstadoLuminaria : uint8_t {
+    ESTADO_APAGADA = 0,
+    ESTADO_ENCENDIDA = 1,
+    ESTADO_FALLA = 2,
+    ESTADO_OFFLINE = 3
+};
+
+// Tabla de luminarias en formato struct-of-arrays de capacidad fija.
+// Cada luminaria ocupa BYTES_PER_FIXTURE bytes sin asignaciones en el heap;
+// se accede por posición (slot), que es estable durante toda la ejecución.
+// La intensidad no se guarda aquí: es el nivel de Brightness en la misma
+// posición, así el registro informa lo que aplicaron escenas y fades.
+class LuminariaRegistry {
+private:
+    uint32_t ids[MAX_LUCES];
+    float lats[MAX_LUCES];
+    float lngs[MAX_LUCES];
+    uint32_t ultimaActualizacion[MAX_LUCES];
+    uint32_t revisiones[MAX_LUCES];   // Revisión de la última modificación
+    uint8_t estados[MAX_LUCES];       // EstadoLuminaria
+    uint8_t zonas[MAX_LUCES];         // Índice en zoneNames o ZONA_NINGUNA
+    uint8_t flags[MAX_LUCES];
+    uint16_t count;
+    uint32_t revision;  // Crece con cada cambio; nunca retrocede
+
+    uint16_t index[REGISTRY_INDEX_SIZE];  // Posición o REGISTRY_NOT_FOUND
+
+    char zoneNames[REGISTRY_MAX_ZONES][REGISTRY_ZONE_NAME_MAX];
+    uint8_t zoneCount;
+
+    static uint16_t hashSlot(uint32_t id);
+    void markChanged(uint16_t pos) { revisiones[pos] = ++revision; }
+
+public:
+    static const size_t BYTES_PER_FIXTURE = 3 * sizeof(uint32_t) + 2 * sizeof(float) + 3 * sizeof(uint8_t);
+
+    LuminariaRegistry();
+
+    void clear();
+
+    // Búsqueda e inserción O(1)
+    uint16_t find(uint32_t id) const;  // Posición o REGISTRY_NOT_FOUND
+    uint16_t insert(uint32_t id);      // Posición existente o nueva; REGISTRY_NOT_FOUND si está lleno o el ID es inválido
+
+    // Lectura por posición
+    uint32_t getId(uint16_t pos) const { return ids[pos]; }
+    float getLat(uint16_t pos) const { return lats[pos]; }
+    float getLng(uint16_t pos) const { return lngs[pos]; }
+    uint32_t getUltimaActualizacion(uint16_t pos) const { return ultimaActualizacion[pos]; }
+    uint8_t getIntensidad(uint16_t pos) const { return Brightness.getCurrent(pos); }
+    EstadoLuminaria getEstado(uint16_t pos) const { return (EstadoLuminaria)estados[pos]; }
+    uint8_t getZona(uint16_t pos) const { return zonas[pos]; }
+    bool isDimeable(uint16_t pos) const { return flags[pos] & LUMINARIA_FLAG_DIMEABLE; }
+    DimmingCurveType getCurva(uint16_t pos) const {
+        return (DimmingCurveType)((flags[pos] & LUMINARIA_CURVE_MASK) >> LUMINARIA_CURVE_SHIFT);
+    }
+    uint32_t getRevisionOf(uint16_t pos) const { return revisiones[pos]; }
+
+    // Escritura por posición (cada cambio efectivo incrementa la revisión)
+    void setPosicion(uint16_t pos, float lat, float lng);
+    void setEstado(uint16_t pos, EstadoLuminaria estado);
+    void notifyIntensidad(uint16_t pos);  // Cambió Brightness en pos: nueva revisión
+    void setZona(uint16_t pos, uint8_t zona);
+    void setDimeable(uint16_t pos, bool dimeable);
+    void setCurva(uint16_t pos, DimmingCurveType curva);
+    void touch(uint16_t pos);  // Marca actualización con millis(); no cambia la revisión
+
+    uint16_t size() const { return count; }
+    uint16_t capacity() const { return MAX_LUCES; }
+    bool isFull() const { return count >= MAX_LUCES; }
+    
+    // Revisión global: permite a los clientes pedir solo lo modificado
+    uint32_t getRevision() const { return revision; }
+
+    // Zonas internadas
+    uint8_t internZone(const char* name);  // Índice existente o nuevo; ZONA_NINGUNA si no hay lugar o no entra el nombre
+    uint8_t findZone(const char* name) const;
+    const char* getZoneName(uint8_t zona) const;
+    uint8_t getZoneCount() const { return zoneCount; }
+
+    // Conversión de estados texto <-> enum
+    static const char* estadoToString(EstadoLuminaria estado);
+    static bool parseEstado(const char* text, EstadoLuminaria& out);
+
+    // Conversión de IDs texto <-> numérico. parseId() solo acepta el formato
+    // de formatId() ("LUM_" + 8 dígitos hex en mayúscula), así formatId()
+    // devuelve el mismo texto; cualquier otro da LUMINARIA_ID_INVALID
+    static uint32_t parseId(const char* text);
+    static uint32_t parseId(const String& text) { return parseId(text.c_str()); }
+    static void formatId(uint32_t id, char* out, size_t len);
+    static String formatId(uint32_t id);
+
+    // Estadísticas de memoria (huella exacta de la tabla completa)
+    size_t getMemoryFootprint() const { return sizeof(LuminariaRegistry); }
+};
+
+// Instancia global
+extern LuminariaRegistry Luminarias;
+
+// Recorre el registro emitiendo un objeto JSON por luminaria
+// (solo las modificadas después de la revisión 'since', si se indica)
+// El rango de posiciones se fija al crearla, así count() coincide con lo
+// que entrega next() aunque se agreguen luminarias durante el envío.
+class LuminariaRecordSource : public RecordSource {
+private:
+    uint16_t pos;
+    uint16_t end;
+    uint32_t since;
+    char idBuffer[16];
+
+public:
+    explicit LuminariaRecordSource(uint32_t since = 0) : pos(0), end(Luminarias.size()), since(since) {}
+    bool next(JsonObject obj) override;
+    size_t count() override;
+};
+
+#endif // LUMINARIA_REGISTRY_H
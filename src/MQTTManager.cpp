@@ -4,13 +4,16 @@ MQTTManager MQTT;
 
 // Constructor
 MQTTManager::MQTTManager() : mqttClient(wifiClient) {
-    state = MQTT_DISCONNECTED;
+    state = MQTT_STATE_DISCONNECTED;
     nodeType = NODE_CENTRAL;
     autoDiscovery = true;
     brokerPort = 1883;
     lastReconnectAttempt = 0;
     lastDiscoveryBroadcast = 0;
     lastHeartbeat = 0;
+    messagesSent = 0;
+    messagesReceived = 0;
+    bytesTransferred = 0;
 }
 
 // === INICIALIZACIÓN ===
@@ -25,9 +28,10 @@ bool MQTTManager::begin(const String& broker, uint16_t port) {
     mqttClient.setServer(brokerIP.c_str(), brokerPort);
     mqttClient.setBufferSize(MQTT_MAX_PACKET_SIZE);
     
-    // Configurar callback principal
-    mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
-        this->handleMessage(topic, payload, length);
+    // Configurar callback principal. Sin capturas: fuera del ESP8266,
+    // PubSubClient solo acepta un puntero a función
+    mqttClient.setCallback([](char* topic, byte* payload, unsigned int length) {
+        MQTT.handleMessage(topic, payload, length);
     });
     
     // Generar ID único
@@ -73,11 +77,11 @@ bool MQTTManager::connect() {
 bool MQTTManager::connect(const String& id) {
     if (WiFi.status() != WL_CONNECTED) {
         SystemLogger.error("WiFi no conectado, no se puede conectar a MQTT", "MQTT");
-        state = MQTT_ERROR;
+        state = MQTT_STATE_ERROR;
         return false;
     }
     
-    state = MQTT_CONNECTING;
+    state = MQTT_STATE_CONNECTING;
     SystemLogger.info("Conectando a MQTT broker...", "MQTT");
     
     bool connected = false;
@@ -94,7 +98,7 @@ bool MQTTManager::connect(const String& id) {
     }
     
     if (connected) {
-        state = MQTT_CONNECTED;
+        state = MQTT_STATE_CONNECTED;
         SystemLogger.info("Conectado a MQTT broker", "MQTT");
         
         // Publicar estado online
@@ -117,7 +121,7 @@ bool MQTTManager::connect(const String& id) {
         
         return true;
     } else {
-        state = MQTT_ERROR;
+        state = MQTT_STATE_ERROR;
         SystemLogger.error("Fallo al conectar a MQTT. Estado: " + String(mqttClient.state()), "MQTT");
         
         // Notificar callbacks
@@ -134,7 +138,7 @@ void MQTTManager::disconnect() {
         publishStatus("offline");
         mqttClient.disconnect();
     }
-    state = MQTT_DISCONNECTED;
+    state = MQTT_STATE_DISCONNECTED;
     SystemLogger.info("Desconectado de MQTT", "MQTT");
 }
 
@@ -174,7 +178,9 @@ bool MQTTManager::publish(const String& topic, const String& payload, bool retai
     bool result = mqttClient.publish(topic.c_str(), payload.c_str(), retained);
     
     if (result) {
-        SystemLogger.debug("Publicado: " + topic + " = " + payload.substring(0, 50), "MQTT");
+        messagesSent++;
+        bytesTransferred += topic.length() + payload.length();
+        LOGF_DEBUG("MQTT", "Publicado: %s = %.50s", topic.c_str(), payload.c_str());
     } else {
         SystemLogger.error("Error al publicar: " + topic, "MQTT");
     }
@@ -279,8 +285,10 @@ void MQTTManager::handleMessage(char* topic, byte* payload, unsigned int length)
     delete[] buffer;
     
     String topicStr = String(topic);
+    messagesReceived++;
+    bytesTransferred += topicStr.length() + length;
     
-    SystemLogger.debug("Mensaje recibido: " + topicStr + " = " + payloadStr.substring(0, 100), "MQTT");
+    LOGF_DEBUG("MQTT", "Mensaje recibido: %s = %.100s", topicStr.c_str(), payloadStr.c_str());
     
     // Agregar a cola de entrada
     MQTTMessage msg;
@@ -337,8 +345,15 @@ void MQTTManager::broadcastDiscovery() {
     SystemLogger.info("Discovery broadcast enviado", "MQTT");
 }
 
+// Lo que le importa a los callbacks: el tipo, la zona y las capacidades.
+// Un nodo repite el discovery al conectar y cada 5 minutos sin cambios
+static bool nodeChanged(const NodeInfo& before, const NodeInfo& after) {
+    return before.type != after.type || before.zone != after.zone ||
+           before.dimming != after.dimming || before.curve != after.curve;
+}
+
 void MQTTManager::processDiscoveryMessage(const String& payload) {
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<DISCOVERY_DOC_SIZE> doc;
     DeserializationError error = deserializeJson(doc, payload);
     
     if (error) {
@@ -360,23 +375,35 @@ void MQTTManager::processDiscoveryMessage(const String& payload) {
     node.ip = doc["ip"].as<String>();
     node.mac = doc["mac"].as<String>();
     node.version = doc["version"].as<String>();
+    node.zone = doc["zone"] | "";
     node.lastSeen = millis();
     node.online = true;
-    node.metadata = doc["capabilities"];
+    
+    // Un nodo que no informa curva pone el porcentaje directo en el PWM (lineal)
+    JsonObject capabilities = doc["capabilities"];
+    node.dimming = capabilities["dimming"] | false;
+    node.curve = DIMMING_CURVE_LINEAR;
+    parseDimmingCurve(capabilities["curve"] | "", node.curve);
     
     // Guardar en mapa
-    bool isNew = (discoveredNodes.find(discoveredNodeId) == discoveredNodes.end());
+    auto known = discoveredNodes.find(discoveredNodeId);
+    bool isNew = known == discoveredNodes.end();
+    bool changed = isNew || nodeChanged(known->second, node);
     discoveredNodes[discoveredNodeId] = node;
     
     if (isNew) {
         SystemLogger.info("Nuevo nodo descubierto: " + discoveredNodeId + " (" + node.ip + ")", "MQTT");
-        
-        // Notificar callbacks
+    } else if (changed) {
+        LOGF_INFO("MQTT", "Nodo actualizado: %s (zona %s)", discoveredNodeId.c_str(), node.zone.c_str());
+    } else {
+        LOGF_DEBUG("MQTT", "Nodo sin cambios: %s", discoveredNodeId.c_str());
+    }
+    
+    // Notificar callbacks
+    if (changed) {
         for (auto& callback : discoveryCallbacks) {
             callback(node);
         }
-    } else {
-        SystemLogger.debug("Nodo actualizado: " + discoveredNodeId, "MQTT");
     }
 }
 
@@ -525,6 +552,18 @@ void MQTTManager::processIncomingQueue() {
 
 // === ESTADÍSTICAS ===
 
+uint32_t MQTTManager::getMessagesSent() {
+    return messagesSent;
+}
+
+uint32_t MQTTManager::getMessagesReceived() {
+    return messagesReceived;
+}
+
+uint32_t MQTTManager::getBytesTransferred() {
+    return bytesTransferred;
+}
+
 String MQTTManager::getStatistics() {
     StaticJsonDocument<512> doc;
     doc["connected"] = mqttClient.connected();
@@ -536,6 +575,9 @@ String MQTTManager::getStatistics() {
     doc["subscribedTopics"] = subscribedTopics.size();
     doc["outgoingQueue"] = outgoingQueue.size();
     doc["incomingQueue"] = incomingQueue.size();
+    doc["messagesSent"] = messagesSent;
+    doc["messagesReceived"] = messagesReceived;
+    doc["bytesTransferred"] = bytesTransferred;
     
     String result;
     serializeJson(doc, result);
@@ -3,13 +3,14 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
-#include <ESP8266WiFi.h>
+#include "hal/Platform.h"
 #include <ArduinoJson.h>
 #include <functional>
 #include <vector>
 #include <map>
 #include "config.h"
 #include "Logger.h"
+#include "DimmingCurve.h"
 
 // Configuración MQTT
 #define MQTT_MAX_PACKET_SIZE 512
@@ -19,6 +20,10 @@
 #define MQTT_QOS_1 1
 #define MQTT_QOS_2 2
 
+// Discovery de node_luminaria.cpp: 8 campos, 5 capacidades y sus textos
+// (la zona hasta 32 caracteres)
+#define DISCOVERY_DOC_SIZE (JSON_OBJECT_SIZE(10) + JSON_OBJECT_SIZE(8) + 384)
+
 // Topics base
 #define MQTT_BASE_TOPIC "luces"
 #define MQTT_DISCOVERY_TOPIC "luces/discovery"
@@ -38,10 +43,10 @@ enum NodeType {
 
 // Estados de conexión
 enum MQTTState {
-    MQTT_DISCONNECTED,
-    MQTT_CONNECTING,
-    MQTT_CONNECTED,
-    MQTT_ERROR
+    MQTT_STATE_DISCONNECTED,
+    MQTT_STATE_CONNECTING,
+    MQTT_STATE_CONNECTED,
+    MQTT_STATE_ERROR
 };
 
 // Estructura de mensaje MQTT
@@ -60,9 +65,12 @@ struct NodeInfo {
     String ip;
     String mac;
     String version;
+    String zone;       // Zona MQTT: el nodo escucha luces/zone/<zone>/#
     uint32_t lastSeen;
     bool online;
-    JsonDocument metadata;
+    // Capacidades del discovery que usa el nodo central
+    bool dimming;            // capabilities.dimming
+    DimmingCurveType curve;  // capabilities.curve; lineal si no la informa
 };
 
 // Callbacks
@@ -108,9 +116,13 @@ private:
     std::vector<MQTTMessage> outgoingQueue;
     std::vector<MQTTMessage> incomingQueue;
     
+    // Contadores
+    uint32_t messagesSent;
+    uint32_t messagesReceived;
+    uint32_t bytesTransferred;
+    
     // Métodos privados
     void handleMessage(char* topic, byte* payload, unsigned int length);
-    void processDiscoveryMessage(const String& payload);
     void broadcastDiscovery();
     void sendHeartbeat();
     bool reconnect();
@@ -150,6 +162,10 @@ public:
     
     // Discovery
     void onNodeDiscovered(DiscoveryCallback callback);
+    // Mensaje de luces/discovery (lo llama handleMessage; público para la
+    // simulación). Los callbacks se llaman con cada nodo nuevo y cuando un
+    // nodo conocido cambia de zona o de capacidades
+    void processDiscoveryMessage(const String& payload);
     std::vector<NodeInfo> getDiscoveredNodes();
     NodeInfo getNodeInfo(const String& nodeId);
     bool pingNode(const String& nodeId);
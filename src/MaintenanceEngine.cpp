@@ -0,0 +1,331 @@
+#include "MaintenanceEngine.h"
+#include "DatabaseManager.h"
+#include "EventLog.h"
+#include "Logger.h"
+
+#define MAINTENANCE_COPY_FILE MAINTENANCE_BACKUP_DIR "/copy.tmp"  // Se renombra al terminar cada archivo
+
+MaintenanceEngine Maintenance;
+
+static const unsigned long taskIntervals[MAINTENANCE_TASK_COUNT] = {
+    MAINTENANCE_RETENTION_INTERVAL,
+    MAINTENANCE_COMPACTION_INTERVAL,
+    MAINTENANCE_ROTATION_INTERVAL,
+    MAINTENANCE_BACKUP_INTERVAL
+};
+
+MaintenanceEngine::MaintenanceEngine()
+    : task(MAINTENANCE_IDLE), phase(0), item(0), offset(0), pending(0), units(0),
+      dirOpen(false), steps(0), overruns(0), maxStepUs(0), unsavedSteps(0) {
+    memset(lastRun, 0, sizeof(lastRun));
+    memset(completed, 0, sizeof(completed));
+}
+
+const char* MaintenanceEngine::taskName(uint8_t which) {
+    switch (which) {
+        case MAINTENANCE_RETENTION: return "retention";
+        case MAINTENANCE_COMPACTION: return "compaction";
+        case MAINTENANCE_ROTATION: return "rotation";
+        case MAINTENANCE_BACKUP: return "backup";
+        default: return "idle";
+    }
+}
+
+void MaintenanceEngine::begin() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < MAINTENANCE_TASK_COUNT; i++) lastRun[i] = now;
+
+    loadState();
+    if (task != MAINTENANCE_IDLE) {
+        SystemLogger.info("Mantenimiento retomado", "MAINT");
+    }
+}
+
+// === ESTADO PERSISTENTE ===
+
+void MaintenanceEngine::loadState() {
+    File f = LittleFS.open(MAINTENANCE_STATE_FILE, "r");
+    if (!f) return;
+
+    char text[48];
+    size_t len = f.readBytes(text, sizeof(text) - 1);
+    text[len] = '\0';
+    f.close();
+
+    unsigned int savedTask, savedPhase, savedPending;
+    unsigned long savedItem, savedOffset;
+    if (sscanf(text, "%u %u %lu %lu %u", &savedTask, &savedPhase, &savedItem, &savedOffset, &savedPending) != 5) {
+        return;
+    }
+
+    pending = savedPending & ((1 << MAINTENANCE_TASK_COUNT) - 1);
+    if (savedTask < MAINTENANCE_TASK_COUNT) {
+        task = savedTask;
+        phase = savedPhase;
+        item = savedItem;
+        offset = savedOffset;
+    }
+}
+
+void MaintenanceEngine::saveState() {
+    unsavedSteps = 0;
+    File f = LittleFS.open(MAINTENANCE_STATE_FILE, "w");
+    if (!f) return;
+    f.printf("%u %u %lu %lu %u\n", (unsigned int)task, (unsigned int)phase,
+             (unsigned long)item, (unsigned long)offset, (unsigned int)pending);
+    f.close();
+}
+
+// === PLANIFICACIÓN ===
+
+bool MaintenanceEngine::request(MaintenanceTask which) {
+    if (which >= MAINTENANCE_TASK_COUNT) return false;
+    pending |= 1 << which;
+    return true;
+}
+
+uint8_t MaintenanceEngine::getBacklog() const {
+    uint8_t count = 0;
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < MAINTENANCE_TASK_COUNT; i++) {
+        if ((pending & (1 << i)) || now - lastRun[i] >= taskIntervals[i]) count++;
+    }
+    return count;
+}
+
+void MaintenanceEngine::getStatus(JsonObject obj) const {
+    obj["task"] = taskName(task);
+    obj["phase"] = phase;
+    obj["item"] = item;
+    obj["offset"] = offset;
+    obj["units"] = units;
+    obj["backlog"] = getBacklog();
+    obj["steps"] = steps;
+    obj["overruns"] = overruns;
+    obj["max_step_us"] = maxStepUs;
+
+    JsonObject runs = obj.createNestedObject("completed");
+    for (uint8_t i = 0; i < MAINTENANCE_TASK_COUNT; i++) {
+        runs[taskName(i)] = completed[i];
+    }
+}
+
+void MaintenanceEngine::start(uint8_t next) {
+    task = next;
+    phase = 0;
+    item = 0;
+    offset = 0;
+    units = 0;
+    saveState();
+}
+
+void MaintenanceEngine::finish() {
+    if (task == MAINTENANCE_BACKUP && units > 0) {
+        LOGF_INFO("MAINT", "Backup de base de datos: %lu archivos", (unsigned long)units);
+    } else if (task == MAINTENANCE_COMPACTION && units > 0) {
+        LOGF_INFO("MAINT", "Compactación: %lu archivos borrados", (unsigned long)units);
+    } else if (task == MAINTENANCE_RETENTION && units > 0) {
+        LOGF_INFO("MAINT", "Retención: %lu segmentos de eventos borrados", (unsigned long)units);
+    }
+
+    uint8_t done = task;
+    completed[done]++;
+    lastRun[done] = millis();
+    pending &= ~(1 << done);
+    task = MAINTENANCE_IDLE;
+    phase = 0;
+    item = 0;
+    offset = 0;
+    dirOpen = false;
+    dir = Dir();
+    closeFiles();
+
+    // La rotación es frecuente y no deja nada a medias: no gasta flash
+    if (done != MAINTENANCE_ROTATION) saveState();
+}
+
+void MaintenanceEngine::loop(uint32_t budgetUs) {
+    if (task == MAINTENANCE_IDLE) {
+        unsigned long now = millis();
+        for (uint8_t i = 0; i < MAINTENANCE_TASK_COUNT; i++) {
+            if (now - lastRun[i] >= taskIntervals[i]) pending |= 1 << i;
+        }
+        if (pending == 0) return;
+
+        uint8_t next = 0;
+        while (!(pending & (1 << next))) next++;
+        if (next == MAINTENANCE_ROTATION) {
+            task = next;  // Un solo paso: no hace falta guardar el inicio
+            units = 0;
+        } else {
+            start(next);
+        }
+    }
+
+    // Pasos hasta agotar el presupuesto (al menos uno); un paso que empieza se termina
+    unsigned long begin = micros();
+    do {
+        unsigned long stepStart = micros();
+        bool more = step();
+        uint32_t elapsed = micros() - stepStart;
+
+        steps++;
+        if (elapsed > maxStepUs) maxStepUs = elapsed;
+        if (elapsed > budgetUs) overruns++;
+
+        if (!more) {
+            finish();
+        } else if (++unsavedSteps >= MAINTENANCE_SAVE_STEPS) {
+            saveState();
+        }
+    } while (task != MAINTENANCE_IDLE && micros() - begin < budgetUs);
+}
+
+// === PASOS ===
+
+bool MaintenanceEngine::step() {
+    switch (task) {
+        case MAINTENANCE_RETENTION:
+            // Un segmento por paso, del más viejo al más nuevo
+            if (!Database.expireEventSegment(MAINTENANCE_EVENT_DAYS)) return false;
+            units++;
+            return true;
+
+        case MAINTENANCE_COMPACTION:
+            if (phase == 0 && walkStep(DB_PATH, DB_PATH)) return true;
+            if (phase == 0) phase = 1;
+            return walkStep(EVENT_DIR, EVENT_DIR);
+
+        case MAINTENANCE_ROTATION:
+            if (Database.rotateEventsAhead()) units++;
+            return false;
+
+        case MAINTENANCE_BACKUP:
+            // Fase 0: copia; 1 y 2: borra de la copia lo que ya no existe
+            if (phase == 0) {
+                if (!copyStep()) {
+                    phase = 1;
+                    item = 0;
+                }
+                return true;
+            }
+            if (phase == 1 && walkStep(MAINTENANCE_BACKUP_DIR DB_PATH, DB_PATH)) return true;
+            if (phase == 1) phase = 2;
+            return walkStep(MAINTENANCE_BACKUP_DIR EVENT_DIR, EVENT_DIR);
+    }
+    return false;
+}
+
+// Una entrada del directorio 'path' por paso: se borra si DatabaseManager
+// la considera descartable en 'liveDir'. false al terminar el directorio.
+bool MaintenanceEngine::walkStep(const char* path, const char* liveDir) {
+    if (!dirOpen) {
+        // Al retomar se saltean las entradas ya vistas
+        dir = LittleFS.openDir(path);
+        dirOpen = true;
+        for (uint32_t i = 0; i < item && dir.next(); i++) {}
+    }
+
+    if (!dir.next()) {
+        dirOpen = false;
+        item = 0;
+        return false;
+    }
+    item++;
+
+    String entry = dir.fileName();
+    if (dir.isFile() && Database.isStaleFile(liveDir, entry.c_str())) {
+        char file[40];
+        const char* name = entry.c_str();
+        const char* slash = strrchr(name, '/');
+        size_t len = strlen(path);
+        snprintf(file, sizeof(file), "%s%s%s", path, len && path[len - 1] == '/' ? "" : "/",
+                 slash ? slash + 1 : name);
+        if (LittleFS.remove(file)) units++;
+    }
+    return true;
+}
+
+void MaintenanceEngine::closeFiles() {
+    if (source) source.close();
+    if (target) target.close();
+}
+
+// Copia MAINTENANCE_COPY_CHUNK bytes del archivo 'item' a MAINTENANCE_COPY_FILE
+// y lo renombra a su lugar en MAINTENANCE_BACKUP_DIR al terminarlo. false
+// cuando no quedan archivos.
+bool MaintenanceEngine::copyStep() {
+    char from[32];
+    bool immutable;
+    if (!Database.getBackupSource(item, from, sizeof(from), immutable)) {
+        closeFiles();
+        return false;
+    }
+
+    char to[40];
+    snprintf(to, sizeof(to), MAINTENANCE_BACKUP_DIR "%s", from);
+
+    if (!source) {
+        if (item == 0 && offset == 0) {
+            LittleFS.mkdir(MAINTENANCE_BACKUP_DIR);
+            LittleFS.mkdir(MAINTENANCE_BACKUP_DIR DB_PATH);
+            LittleFS.mkdir(MAINTENANCE_BACKUP_DIR EVENT_DIR);
+        }
+
+        source = LittleFS.open(from, "r");
+        if (!source) {
+            item++;
+            offset = 0;
+            return true;
+        }
+
+        // Los segmentos cerrados no cambian: si la copia tiene el mismo tamaño ya está
+        if (offset == 0 && immutable) {
+            File copy = LittleFS.open(to, "r");
+            bool same = copy && copy.size() == source.size();
+            if (copy) copy.close();
+            if (same) {
+                source.close();
+                item++;
+                return true;
+            }
+        }
+
+        // Al retomar se sigue detrás de lo copiado solo si coincide con el offset
+        if (offset > 0) {
+            target = LittleFS.open(MAINTENANCE_COPY_FILE, "a");
+            if (!target || target.size() != offset || offset > source.size()) {
+                if (target) target.close();
+                offset = 0;
+            }
+        }
+        if (offset == 0) target = LittleFS.open(MAINTENANCE_COPY_FILE, "w");
+        if (!target) {
+            source.close();
+            item++;
+            return true;
+        }
+        source.seek(offset);
+    }
+
+    uint8_t buffer[MAINTENANCE_COPY_CHUNK];
+    size_t n = source.read(buffer, sizeof(buffer));
+    if (n > 0 && target.write(buffer, n) != n) {
+        // Sin espacio: se descarta este archivo y se sigue con el próximo
+        closeFiles();
+        LittleFS.remove(MAINTENANCE_COPY_FILE);
+        item++;
+        offset = 0;
+        return true;
+    }
+    offset += n;
+
+    if (n < sizeof(buffer) || offset >= source.size()) {
+        closeFiles();
+        LittleFS.remove(to);
+        if (LittleFS.rename(MAINTENANCE_COPY_FILE, to)) units++;
+        item++;
+        offset = 0;
+    }
+    return true;
+}
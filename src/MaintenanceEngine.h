@@ -0,0 +1,91 @@
+#ifndef MAINTENANCE_ENGINE_H
+#define MAINTENANCE_ENGINE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "hal/Platform.h"
+#include "config.h"
+
+#define MAINTENANCE_STATE_FILE "/db/maintenance"  // "<tarea> <fase> <item> <offset> <pendientes>"
+#define MAINTENANCE_BACKUP_DIR "/backup"          // Copia de /db/... en /backup/db/...
+#define MAINTENANCE_BUDGET_US 2000      // Tiempo máximo por llamada a loop()
+#define MAINTENANCE_COPY_CHUNK 512      // Bytes copiados por paso de backup
+#define MAINTENANCE_SAVE_STEPS 32       // Pasos entre guardados del progreso
+#define MAINTENANCE_EVENT_DAYS 7        // Retención del log de eventos
+
+// Intervalos de cada tarea (ms)
+#define MAINTENANCE_RETENTION_INTERVAL 3600000UL    // 1 hora
+#define MAINTENANCE_COMPACTION_INTERVAL 21600000UL  // 6 horas
+#define MAINTENANCE_ROTATION_INTERVAL 10000UL       // 10 segundos
+#define MAINTENANCE_BACKUP_INTERVAL 86400000UL      // 24 horas
+
+enum MaintenanceTask {
+    MAINTENANCE_RETENTION = 0,   // Borra segmentos de eventos vencidos
+    MAINTENANCE_COMPACTION,      // Borra archivos huérfanos de /db
+    MAINTENANCE_ROTATION,        // Rota el log de eventos antes de que se llene
+    MAINTENANCE_BACKUP,          // Copia la base a MAINTENANCE_BACKUP_DIR
+    MAINTENANCE_TASK_COUNT,
+    MAINTENANCE_IDLE = 0xFF
+};
+
+// Mantenimiento de la base de datos en segundo plano.
+//
+// Cada tarea se parte en pasos cortos (un segmento, una entrada de
+// directorio, un bloque de MAINTENANCE_COPY_CHUNK bytes) y loop() ejecuta
+// pasos hasta agotar MAINTENANCE_BUDGET_US. Nunca se hace más de una tarea a
+// la vez; las demás quedan pendientes.
+//
+// El progreso (tarea, fase, item y offset) se guarda al empezar y terminar
+// cada tarea y cada MAINTENANCE_SAVE_STEPS pasos. Después de un reinicio la
+// tarea sigue desde el último guardado: los pasos se pueden repetir sin
+// efecto (borrar lo que ya no está, copiar de nuevo un bloque).
+class MaintenanceEngine {
+private:
+    uint8_t task;
+    uint8_t phase;
+    uint32_t item;      // Entrada de directorio o archivo dentro de la fase
+    uint32_t offset;    // Bytes copiados del archivo actual
+    uint8_t pending;    // Bit por tarea pedida o vencida
+    uint32_t units;     // Trabajo hecho en la tarea actual (segmentos, archivos)
+    unsigned long lastRun[MAINTENANCE_TASK_COUNT];
+
+    // Estado que no sobrevive a un reinicio: se vuelve a abrir al retomar
+    Dir dir;
+    bool dirOpen;
+    File source;
+    File target;
+
+    uint32_t steps;
+    uint32_t overruns;      // Pasos que solos pasaron el presupuesto
+    uint32_t maxStepUs;
+    uint32_t completed[MAINTENANCE_TASK_COUNT];
+    uint16_t unsavedSteps;
+
+    void loadState();
+    void saveState();
+    void start(uint8_t next);
+    void finish();
+    bool step();
+    bool walkStep(const char* path, const char* liveDir);
+    bool copyStep();
+    void closeFiles();
+
+public:
+    MaintenanceEngine();
+
+    void begin();
+    void loop(uint32_t budgetUs = MAINTENANCE_BUDGET_US);
+
+    // Pide la tarea lo antes posible; false si el índice no es válido
+    bool request(MaintenanceTask which);
+
+    bool isBusy() const { return task != MAINTENANCE_IDLE; }
+    uint8_t getBacklog() const;
+    void getStatus(JsonObject obj) const;
+
+    static const char* taskName(uint8_t which);
+};
+
+extern MaintenanceEngine Maintenance;
+
+#endif // MAINTENANCE_ENGINE_H
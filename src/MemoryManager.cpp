@@ -1,4 +1,5 @@
 #include "MemoryManager.h"
+#include "LuminariaRegistry.h"
 
 MemoryManager MemManager;
 
@@ -98,6 +99,14 @@ String MemoryManager::getMemoryStats() {
     doc["flash_chip_real_size"] = ESP.getFlashChipRealSize();
     doc["sdk_version"] = ESP.getSdkVersion();
     
+    // Tabla de luminarias (memoria estática, no consume heap)
+    JsonObject registry = doc.createNestedObject("luminarias");
+    registry["bytes"] = Luminarias.getMemoryFootprint();
+    registry["bytes_per_fixture"] = LuminariaRegistry::BYTES_PER_FIXTURE;
+    registry["used"] = Luminarias.size();
+    registry["capacity"] = Luminarias.capacity();
+    registry["zones"] = Luminarias.getZoneCount();
+    
     // Estados de memoria
     if (ESP.getFreeHeap() < CRITICAL_HEAP) {
         doc["status"] = "critical";
@@ -139,6 +148,7 @@ void MemoryManager::emergencyCleanup() {
     // Si aún es crítico, reiniciar
     if (ESP.getFreeHeap() < CRITICAL_HEAP / 2) {
         SystemLogger.error("Memoria insuficiente. Reiniciando sistema...", "MEMORY");
+        SystemLogger.flush();
         delay(1000);
         ESP.restart();
     }
@@ -2,7 +2,7 @@
 #define MEMORY_MANAGER_H
 
 #include <Arduino.h>
-#include <ESP8266WiFi.h>
+#include "hal/Platform.h"
 #include "config.h"
 #include "Logger.h"
 
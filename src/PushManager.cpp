@@ -0,0 +1,332 @@
+#include "PushManager.h"
+#include "LuminariaRegistry.h"
+#include "MemoryManager.h"
+
+PushManager Push;
+
+// Buffer de armado de mensajes; el contenido se copia a un
+// AsyncWebSocketMessageBuffer compartido antes de enviarlo
+static char pushMessage[PUSH_MESSAGE_MAX];
+
+PushManager::PushManager() : ws("/ws") {
+    for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++) {
+        clients[i].id = 0;
+    }
+    lastRevision = 0;
+    pendingAlertCount = 0;
+    droppedAlerts = 0;
+    pendingSceneId = 0;
+    pendingSceneName[0] = '\0';
+    scenePending = false;
+    lastPush = 0;
+    lastMemoryPush = 0;
+    messagesSent = 0;
+    messagesSkipped = 0;
+}
+
+void PushManager::begin(AsyncWebServer& server) {
+    ws.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                      AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        onEvent(client, type, arg, data, len);
+    });
+    server.addHandler(&ws);
+
+    lastRevision = Luminarias.getRevision();
+    SystemLogger.info("Canal push WebSocket iniciado en /ws", "PUSH");
+}
+
+// === EVENTOS WEBSOCKET ===
+
+void PushManager::onEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT: {
+            PushClient* slot = findClient(0);
+            if (!slot) {
+                client->close(1013, "Demasiados clientes");
+                return;
+            }
+            slot->id = client->id();
+            slot->role = ROLE_NONE;
+            slot->token[0] = '\0';
+            slot->connectedAt = millis();
+            slot->stalledSince = 0;
+            slot->needsResync = false;
+            break;
+        }
+
+        case WS_EVT_DISCONNECT: {
+            PushClient* slot = findClient(client->id());
+            if (slot) slot->id = 0;
+            break;
+        }
+
+        case WS_EVT_DATA: {
+            // Solo mensajes de texto en un único frame (el token es corto)
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+                handleMessage(client, data, len);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void PushManager::handleMessage(AsyncWebSocketClient* client, uint8_t* data, size_t len) {
+    PushClient* slot = findClient(client->id());
+    if (!slot || slot->role != ROLE_NONE) return;
+
+    StaticJsonDocument<128> doc;
+    if (deserializeJson(doc, (const char*)data, len)) {
+        client->close(1008, "Mensaje inválido");
+        return;
+    }
+
+    const char* token = doc["token"] | "";
+    if (strlen(token) > SESSION_TOKEN_MAX || !Auth.hasPermission(token, ROLE_VIEWER)) {
+        client->close(1008, "No autorizado");
+        return;
+    }
+
+    strncpy(slot->token, token, SESSION_TOKEN_MAX);
+    slot->token[SESSION_TOKEN_MAX] = '\0';
+    slot->role = Auth.getUserRole(token);
+
+    // Revisión actual: el cliente pide /estado-luces?since=<rev> si le falta algo
+    int msgLen = snprintf(pushMessage, sizeof(pushMessage),
+                        "{\"type\":\"hello\",\"rev\":%u}", Luminarias.getRevision());
+    client->text(pushMessage, msgLen);
+}
+
+PushClient* PushManager::findClient(uint32_t id) {
+    for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++) {
+        if (clients[i].id == id) return &clients[i];
+    }
+    return nullptr;
+}
+
+uint8_t PushManager::subscriberCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++) {
+        if (clients[i].id != 0 && clients[i].role != ROLE_NONE) count++;
+    }
+    return count;
+}
+
+// === FUENTES DE EVENTOS ===
+
+void PushManager::notifyAlert(const Alert& alert) {
+    if (pendingAlertCount >= PUSH_PENDING_ALERTS) {
+        droppedAlerts++;
+        return;
+    }
+
+    PendingAlert& pending = pendingAlerts[pendingAlertCount++];
+    pending.id = alert.id;
+    pending.type = alert.type;
+    pending.severity = alert.severity;
+    strncpy(pending.source, alert.source.c_str(), sizeof(pending.source) - 1);
+    pending.source[sizeof(pending.source) - 1] = '\0';
+    strncpy(pending.message, alert.message.c_str(), sizeof(pending.message) - 1);
+    pending.message[sizeof(pending.message) - 1] = '\0';
+}
+
+void PushManager::notifyScene(const Scene& scene) {
+    // Solo interesa la última escena activada dentro del intervalo
+    pendingSceneId = scene.id;
+    strncpy(pendingSceneName, scene.name.c_str(), sizeof(pendingSceneName) - 1);
+    pendingSceneName[sizeof(pendingSceneName) - 1] = '\0';
+    scenePending = true;
+}
+
+// === ENVÍO ===
+
+void PushManager::loop() {
+    if (millis() - lastPush < PUSH_INTERVAL) return;
+    lastPush = millis();
+
+    checkClients();
+    ws.cleanupClients(PUSH_MAX_CLIENTS);
+
+    if (subscriberCount() == 0) {
+        // Sin suscriptores: descartar lo acumulado sin serializar nada
+        lastRevision = Luminarias.getRevision();
+        pendingAlertCount = 0;
+        scenePending = false;
+        return;
+    }
+
+    pushLuminarias();
+    pushAlerts();
+    pushScene();
+
+    if (millis() - lastMemoryPush >= PUSH_MEMORY_INTERVAL) {
+        lastMemoryPush = millis();
+        pushMemory();
+    }
+}
+
+void PushManager::pushLuminarias() {
+    uint32_t revision = Luminarias.getRevision();
+    if (revision == lastRevision) return;
+
+    int len = snprintf(pushMessage, sizeof(pushMessage),
+                       "{\"type\":\"luces\",\"from\":%u,\"rev\":%u,\"luces\":[", lastRevision, revision);
+    size_t used = len;
+    bool first = true;
+    bool overflow = false;
+
+    LuminariaRecordSource source(lastRevision);
+    while (true) {
+        StaticJsonDocument<STREAM_RECORD_DOC_SIZE> doc;
+        JsonObject obj = doc.to<JsonObject>();
+        if (!source.next(obj)) break;
+
+        // Reservar lugar para la coma y el cierre "]}"
+        size_t needed = measureJson(doc) + 3;
+        if (used + needed >= sizeof(pushMessage)) {
+            overflow = true;
+            break;
+        }
+        if (!first) pushMessage[used++] = ',';
+        used += serializeJson(doc, pushMessage + used, sizeof(pushMessage) - used);
+        first = false;
+    }
+
+    if (overflow) {
+        // Demasiados cambios juntos: es más barato que los clientes pidan el delta por HTTP
+        used = snprintf(pushMessage, sizeof(pushMessage), "{\"type\":\"resync\",\"rev\":%u}", revision);
+    } else {
+        pushMessage[used++] = ']';
+        pushMessage[used++] = '}';
+    }
+
+    lastRevision = revision;
+    broadcast(pushMessage, used);
+}
+
+void PushManager::pushAlerts() {
+    for (uint8_t i = 0; i < pendingAlertCount; i++) {
+        const PendingAlert& alert = pendingAlerts[i];
+
+        StaticJsonDocument<256> doc;
+        doc["type"] = "alerta";
+        doc["id"] = alert.id;
+        doc["alert_type"] = alert.type;
+        doc["severity"] = alert.severity;
+        doc["source"] = (const char*)alert.source;
+        doc["message"] = (const char*)alert.message;
+
+        size_t len = serializeJson(doc, pushMessage, sizeof(pushMessage));
+        broadcast(pushMessage, len);
+    }
+    pendingAlertCount = 0;
+}
+
+void PushManager::pushScene() {
+    if (!scenePending) return;
+    scenePending = false;
+
+    StaticJsonDocument<128> doc;
+    doc["type"] = "escena";
+    doc["id"] = pendingSceneId;
+    doc["name"] = (const char*)pendingSceneName;
+
+    size_t len = serializeJson(doc, pushMessage, sizeof(pushMessage));
+    broadcast(pushMessage, len);
+}
+
+void PushManager::pushMemory() {
+    int len = snprintf(pushMessage, sizeof(pushMessage),
+                       "{\"type\":\"memoria\",\"free_heap\":%u,\"max_free_block\":%u,\"heap_fragmentation\":%u,\"uptime\":%lu}",
+                       MemManager.getFreeHeap(), MemManager.getMaxFreeBlockSize(),
+                       MemManager.getHeapFragmentation(), millis() / 1000);
+    broadcast(pushMessage, len);
+}
+
+void PushManager::broadcast(const char* json, size_t len) {
+    // El mensaje ya se serializó una sola vez en pushMessage; cada cliente
+    // recibe su copia y la libera al enviarla. La cola acotada por cliente
+    // limita esas copias a PUSH_MAX_QUEUED * PUSH_MAX_CLIENTS mensajes.
+    for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++) {
+        PushClient& slot = clients[i];
+        if (slot.id == 0 || slot.role == ROLE_NONE || slot.needsResync) continue;
+
+        AsyncWebSocketClient* client = ws.client(slot.id);
+        if (!client || client->status() != WS_CONNECTED) continue;
+
+        // Contrapresión: un cliente con la cola llena pierde este mensaje
+        // y se resincroniza por HTTP cuando se ponga al día
+        if (client->queueIsFull() || client->queueLength() >= PUSH_MAX_QUEUED) {
+            slot.needsResync = true;
+            slot.stalledSince = millis();
+            messagesSkipped++;
+            continue;
+        }
+
+        client->text(json, len);
+        messagesSent++;
+    }
+}
+
+void PushManager::sendResync(AsyncWebSocketClient* client) {
+    int len = snprintf(pushMessage, sizeof(pushMessage),
+                       "{\"type\":\"resync\",\"rev\":%u}", Luminarias.getRevision());
+    client->text(pushMessage, len);
+}
+
+void PushManager::checkClients() {
+    bool revalidate = millis() - lastMemoryPush >= PUSH_MEMORY_INTERVAL;
+
+    for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++) {
+        PushClient& slot = clients[i];
+        if (slot.id == 0) continue;
+
+        AsyncWebSocketClient* client = ws.client(slot.id);
+        if (!client) {
+            slot.id = 0;
+            continue;
+        }
+
+        // Sin token a tiempo
+        if (slot.role == ROLE_NONE) {
+            if (millis() - slot.connectedAt > PUSH_AUTH_TIMEOUT) {
+                client->close(1008, "No autorizado");
+                slot.id = 0;
+            }
+            continue;
+        }
+
+        // Sesión cerrada o expirada
+        if (revalidate && !Auth.validateToken(slot.token)) {
+            client->close(1008, "Sesión expirada");
+            slot.id = 0;
+            continue;
+        }
+
+        if (slot.needsResync) {
+            if (client->queueLength() == 0) {
+                slot.needsResync = false;
+                slot.stalledSince = 0;
+                sendResync(client);
+            } else if (millis() - slot.stalledSince > PUSH_STALL_TIMEOUT) {
+                SystemLogger.warning("Cliente push saturado, desconectando: " + client->remoteIP().toString(), "PUSH");
+                client->close();
+                slot.id = 0;
+            }
+        }
+    }
+}
+
+// === ESTADÍSTICAS ===
+
+void PushManager::getStatus(JsonObject obj) const {
+    obj["clients"] = subscriberCount();
+    obj["max_clients"] = PUSH_MAX_CLIENTS;
+    obj["messages_sent"] = messagesSent;
+    obj["messages_skipped"] = messagesSkipped;
+    obj["dropped_alerts"] = droppedAlerts;
+    obj["revision"] = lastRevision;
+}
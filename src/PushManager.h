@@ -0,0 +1,99 @@
+#ifndef PUSH_MANAGER_H
+#define PUSH_MANAGER_H
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "Logger.h"
+#include "AuthManager.h"
+#include "AlertManager.h"
+#include "SceneManager.h"
+
+// Configuración del canal push
+#define PUSH_MAX_CLIENTS 4              // Clientes WebSocket simultáneos
+#define PUSH_AUTH_TIMEOUT 5000          // Tiempo para enviar el token tras conectar (ms)
+#define PUSH_INTERVAL 500               // Agrupar cambios durante este intervalo (ms)
+#define PUSH_MEMORY_INTERVAL 10000      // Envío de estadísticas de memoria (ms)
+#define PUSH_MAX_QUEUED 4               // Mensajes pendientes por cliente antes de saltearlo
+#define PUSH_STALL_TIMEOUT 30000        // Cliente saturado durante este tiempo se desconecta
+#define PUSH_MESSAGE_MAX 1024           // Tamaño máximo de un mensaje de cambios
+#define PUSH_PENDING_ALERTS 4           // Alertas retenidas entre envíos
+
+// Cliente suscrito al canal
+struct PushClient {
+    uint32_t id;             // ID del AsyncWebSocketClient (0 = libre)
+    UserRole role;           // ROLE_NONE hasta autenticar
+    char token[SESSION_TOKEN_MAX + 1];  // Se revalida periódicamente contra Auth
+    uint32_t connectedAt;
+    uint32_t stalledSince;   // 0 si el cliente consume a tiempo
+    bool needsResync;        // Perdió mensajes: debe pedir el estado por HTTP
+};
+
+// Alerta pendiente de envío (copia acotada, sin String)
+struct PendingAlert {
+    uint32_t id;
+    uint8_t type;
+    uint8_t severity;
+    char source[24];
+    char message[64];
+};
+
+// Canal de actualizaciones en tiempo real sobre WebSocket (/ws).
+// El cliente envía {"token":"..."} al conectar; desde entonces recibe
+// mensajes de cambios agrupados cada PUSH_INTERVAL ms. Cada mensaje se
+// serializa una sola vez para todos los clientes; un cliente
+// lento se saltea (y luego se le pide resincronizar) en vez de acumular heap.
+class PushManager {
+private:
+    AsyncWebSocket ws;
+    PushClient clients[PUSH_MAX_CLIENTS];
+
+    // Cambios pendientes
+    uint32_t lastRevision;
+    PendingAlert pendingAlerts[PUSH_PENDING_ALERTS];
+    uint8_t pendingAlertCount;
+    uint32_t droppedAlerts;
+    uint32_t pendingSceneId;
+    char pendingSceneName[32];
+    bool scenePending;
+
+    unsigned long lastPush;
+    unsigned long lastMemoryPush;
+
+    // Estadísticas
+    uint32_t messagesSent;
+    uint32_t messagesSkipped;
+
+    // Funciones internas
+    void onEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void handleMessage(AsyncWebSocketClient* client, uint8_t* data, size_t len);
+    PushClient* findClient(uint32_t id);
+    uint8_t subscriberCount() const;
+
+    void pushLuminarias();
+    void pushAlerts();
+    void pushScene();
+    void pushMemory();
+    void checkClients();
+    void broadcast(const char* json, size_t len);
+    void sendResync(AsyncWebSocketClient* client);
+
+public:
+    PushManager();
+
+    void begin(AsyncWebServer& server);
+    void loop();
+
+    // Fuentes de eventos (solo copian datos; el envío se hace en loop)
+    void notifyAlert(const Alert& alert);
+    void notifyScene(const Scene& scene);
+
+    uint8_t getClientCount() { return subscriberCount(); }
+    void getStatus(JsonObject obj) const;
+};
+
+// Instancia global
+extern PushManager Push;
+
+#endif // PUSH_MANAGER_H
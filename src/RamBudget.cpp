@@ -0,0 +1,9 @@
+#include "RamBudget.h"
+
+// Se compila en todos los entornos (native incluido) para que el presupuesto
+// no dependa de la compilación del firmware. Con tamaños de simulación
+// (MAX_LUCES por -D) no aplica.
+#ifdef RAM_BUDGET_CHECK
+static_assert(APP_STATIC_RAM + WEB_STATIC_RAM_RESERVE <= STATIC_RAM_BUDGET,
+              "Las instancias globales exceden STATIC_RAM_BUDGET");
+#endif
@@ -0,0 +1,25 @@
+#ifndef RAM_BUDGET_H
+#define RAM_BUDGET_H
+
+#include "config.h"
+#include "AlertManager.h"
+#include "AuthManager.h"
+#include "BrightnessTable.h"
+#include "DatabaseManager.h"
+#include "DeferredQueue.h"
+#include "DimmingOutput.h"
+#include "Logger.h"
+#include "MQTTManager.h"
+#include "MaintenanceEngine.h"
+#include "SceneManager.h"
+#include "ScheduleManager.h"
+
+// RAM estática de las instancias globales que compilan todos los entornos
+// (ver STATIC_RAM_BUDGET en config.h). En native los punteros y String son
+// más grandes que en el ESP8266, así que la suma allá es menor.
+#define APP_STATIC_RAM                                                                                        \
+  (sizeof(Luminarias) + sizeof(Brightness) + sizeof(DimmingOut) + sizeof(Database) + sizeof(SystemLogger) +  \
+   sizeof(Auth) + sizeof(Scenes) + sizeof(Dimming) + sizeof(ZoneVisual) + sizeof(Scheduler) + sizeof(Time) + \
+   sizeof(Alerts) + sizeof(Notifications) + sizeof(MQTT) + sizeof(Deferred) + sizeof(Maintenance))
+
+#endif // RAM_BUDGET_H
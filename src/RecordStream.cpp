@@ -0,0 +1,330 @@
+#include "RecordStream.h"
+
+// Marcadores de MessagePack y CBOR usados fuera de los registros
+#define MSGPACK_NIL 0xC0
+#define MSGPACK_ARRAY16 0xDC
+#define MSGPACK_ARRAY32 0xDD
+#define CBOR_ARRAY_INDEFINITE 0x9F
+#define CBOR_BREAK 0xFF
+
+RecordStream::RecordStream(RecordSource* source, StreamFormat format)
+    : source(source), format(format), state(STREAM_OPEN), firstRecord(true),
+      pendingLen(0), pendingPos(0), announced(0), emitted(0), skipped(0) {}
+
+RecordStream::~RecordStream() {
+    delete source;
+}
+
+const char* RecordStream::contentType(StreamFormat format) {
+    switch (format) {
+        case STREAM_FORMAT_MSGPACK: return "application/msgpack";
+        case STREAM_FORMAT_CBOR: return "application/cbor";
+        case STREAM_FORMAT_CSV: return "text/csv";
+        default: return "application/json";
+    }
+}
+
+size_t RecordStream::encodeRecord(JsonDocument& doc) {
+    char* out = pending + pendingLen;
+    size_t available = sizeof(pending) - pendingLen;
+
+    switch (format) {
+        case STREAM_FORMAT_MSGPACK:
+            if (measureMsgPack(doc) > available) return 0;
+            return serializeMsgPack(doc, out, available);
+
+        case STREAM_FORMAT_CBOR:
+            return serializeCbor(doc.as<JsonVariantConst>(), (uint8_t*)out, available);
+
+        case STREAM_FORMAT_CSV:
+            return encodeCsv(doc.as<JsonObjectConst>(), out, available);
+
+        default:
+            // serializeJson agrega un terminador nulo que también debe entrar
+            if (measureJson(doc) >= available) return 0;
+            return serializeJson(doc, out, available);
+    }
+}
+
+bool RecordStream::loadRecord() {
+    // MessagePack: nunca emitir más elementos que los declarados
+    if (format == STREAM_FORMAT_MSGPACK && emitted >= announced) return false;
+
+    while (true) {
+        StaticJsonDocument<STREAM_RECORD_DOC_SIZE> doc;
+        JsonObject obj = doc.to<JsonObject>();
+        if (!(format == STREAM_FORMAT_CSV ? source->nextCsv(obj) : source->next(obj))) return false;
+
+        if (format == STREAM_FORMAT_JSON && !firstRecord) {
+            pending[pendingLen++] = ',';
+        }
+
+        // Un registro que no entra en el buffer se descarta entero:
+        // truncarlo rompería la codificación para el cliente
+        size_t written = doc.overflowed() ? 0 : encodeRecord(doc);
+        if (written == 0) {
+            skipped++;
+            pendingLen = 0;
+            if (format == STREAM_FORMAT_MSGPACK) {
+                // La longitud ya fue declarada: ocupar el lugar con nil
+                pending[pendingLen++] = (char)MSGPACK_NIL;
+                emitted++;
+                return true;
+            }
+            continue;
+        }
+
+        pendingLen += written;
+        firstRecord = false;
+        emitted++;
+        return true;
+    }
+}
+
+bool RecordStream::loadNext() {
+    pendingLen = 0;
+    pendingPos = 0;
+
+    switch (state) {
+        case STREAM_OPEN:
+            if (format == STREAM_FORMAT_MSGPACK) {
+                announced = source->count();
+                if (announced <= 15) {
+                    pending[pendingLen++] = (char)(0x90 | announced);
+                } else if (announced <= 0xFFFF) {
+                    pending[pendingLen++] = (char)MSGPACK_ARRAY16;
+                    pending[pendingLen++] = (char)(announced >> 8);
+                    pending[pendingLen++] = (char)announced;
+                } else {
+                    pending[pendingLen++] = (char)MSGPACK_ARRAY32;
+                    pending[pendingLen++] = (char)(announced >> 24);
+                    pending[pendingLen++] = (char)(announced >> 16);
+                    pending[pendingLen++] = (char)(announced >> 8);
+                    pending[pendingLen++] = (char)announced;
+                }
+            } else if (format == STREAM_FORMAT_CBOR) {
+                pending[pendingLen++] = (char)CBOR_ARRAY_INDEFINITE;
+            } else if (format == STREAM_FORMAT_CSV) {
+                // Sin encabezado la fuente no tiene CSV: la salida queda vacía
+                const char* header = source->csvHeader();
+                if (!header) {
+                    state = STREAM_DONE;
+                    return false;
+                }
+                pendingLen = snprintf(pending, sizeof(pending), "%s\n", header);
+                if (pendingLen >= sizeof(pending)) pendingLen = sizeof(pending) - 1;
+            } else {
+                pending[pendingLen++] = '[';
+            }
+            state = STREAM_RECORDS;
+            return true;
+
+        case STREAM_RECORDS:
+            if (loadRecord()) return true;
+            state = STREAM_PADDING;
+            // fallthrough
+
+        case STREAM_PADDING:
+            // Si la fuente entregó menos registros que los declarados
+            // (p. ej. se borraron durante el envío), completar con nil
+            if (format == STREAM_FORMAT_MSGPACK && emitted < announced) {
+                while (emitted < announced && pendingLen < sizeof(pending)) {
+                    pending[pendingLen++] = (char)MSGPACK_NIL;
+                    emitted++;
+                }
+                return true;
+            }
+            state = STREAM_CLOSE;
+            // fallthrough
+
+        case STREAM_CLOSE:
+            state = STREAM_DONE;
+            if (format == STREAM_FORMAT_CBOR) {
+                pending[pendingLen++] = (char)CBOR_BREAK;
+            } else if (format == STREAM_FORMAT_JSON) {
+                pending[pendingLen++] = ']';
+            } else {
+                return false;
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+size_t RecordStream::read(uint8_t* buffer, size_t maxLen) {
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (pendingPos >= pendingLen && !loadNext()) break;
+
+        size_t chunk = pendingLen - pendingPos;
+        if (chunk > maxLen - written) {
+            chunk = maxLen - written;
+        }
+        memcpy(buffer + written, pending + pendingPos, chunk);
+        pendingPos += chunk;
+        written += chunk;
+    }
+
+    return written;
+}
+
+// === CSV (RFC 4180) ===
+
+// Agrega text a out; entre comillas solo si tiene separadores, comillas o
+// saltos de línea, así los valores comunes quedan igual que antes
+static bool csvText(const char* text, char* out, size_t len, size_t& pos) {
+    bool quote = strpbrk(text, ",\"\r\n") != nullptr;
+    if (quote) {
+        if (pos + 1 > len) return false;
+        out[pos++] = '"';
+    }
+    for (const char* c = text; *c; c++) {
+        if (pos + (*c == '"' ? 2 : 1) > len) return false;
+        if (*c == '"') out[pos++] = '"';
+        out[pos++] = *c;
+    }
+    if (quote) {
+        if (pos + 1 > len) return false;
+        out[pos++] = '"';
+    }
+    return true;
+}
+
+size_t RecordStream::encodeCsv(JsonObjectConst obj, char* out, size_t len) {
+    size_t pos = 0;
+    char number[24];
+
+    for (JsonPairConst kv : obj) {
+        if (pos > 0) {
+            if (pos + 1 > len) return 0;
+            out[pos++] = ',';
+        }
+
+        // Mismo texto que String() de Arduino: bool como 1/0, float con 2 decimales
+        JsonVariantConst value = kv.value();
+        const char* text = number;
+        if (value.isNull()) {
+            number[0] = '\0';
+        } else if (value.is<bool>()) {
+            text = value.as<bool>() ? "1" : "0";
+        } else if (value.is<long>()) {
+            snprintf(number, sizeof(number), "%ld", value.as<long>());
+        } else if (value.is<unsigned long>()) {
+            snprintf(number, sizeof(number), "%lu", value.as<unsigned long>());
+        } else if (value.is<double>()) {
+            snprintf(number, sizeof(number), "%.2f", value.as<double>());
+        } else if (value.is<const char*>()) {
+            text = value.as<const char*>();
+        } else {
+            return 0;  // Arreglos y objetos no tienen columna
+        }
+        if (!csvText(text, out, len, pos)) return 0;
+    }
+
+    if (pos + 1 > len) return 0;
+    out[pos++] = '\n';
+    return pos;
+}
+
+// === CBOR (RFC 8949) ===
+
+// Cabecera de un elemento: tipo mayor + argumento en la forma más corta
+static bool cborHead(uint8_t major, uint64_t value, uint8_t* out, size_t len, size_t& pos) {
+    uint8_t extra = value < 24 ? 0 : value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFUL ? 4 : 8;
+    if (pos + 1 + extra > len) return false;
+
+    if (extra == 0) {
+        out[pos++] = (major << 5) | (uint8_t)value;
+        return true;
+    }
+    out[pos++] = (major << 5) | (extra == 1 ? 24 : extra == 2 ? 25 : extra == 4 ? 26 : 27);
+    for (int8_t shift = (extra - 1) * 8; shift >= 0; shift -= 8) {
+        out[pos++] = (uint8_t)(value >> shift);
+    }
+    return true;
+}
+
+static bool cborString(uint8_t major, const char* text, uint8_t* out, size_t len, size_t& pos) {
+    size_t textLen = strlen(text);
+    if (!cborHead(major, textLen, out, len, pos) || pos + textLen > len) return false;
+    memcpy(out + pos, text, textLen);
+    pos += textLen;
+    return true;
+}
+
+static bool cborValue(JsonVariantConst value, uint8_t* out, size_t len, size_t& pos) {
+    if (value.isNull()) {
+        if (pos + 1 > len) return false;
+        out[pos++] = 0xF6;
+        return true;
+    }
+
+    if (value.is<bool>()) {
+        if (pos + 1 > len) return false;
+        out[pos++] = value.as<bool>() ? 0xF5 : 0xF4;
+        return true;
+    }
+
+    if (value.is<long>()) {
+        long v = value.as<long>();
+        if (v < 0) return cborHead(1, (uint64_t)(-1 - v), out, len, pos);
+        return cborHead(0, (uint64_t)v, out, len, pos);
+    }
+
+    if (value.is<unsigned long>()) {
+        return cborHead(0, value.as<unsigned long>(), out, len, pos);
+    }
+
+    if (value.is<double>()) {
+        // float32 si no se pierde precisión (coordenadas de la tabla son float)
+        double d = value.as<double>();
+        float f = (float)d;
+        if ((double)f == d) {
+            if (pos + 5 > len) return false;
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            out[pos++] = 0xFA;
+            for (int8_t shift = 24; shift >= 0; shift -= 8) out[pos++] = (uint8_t)(bits >> shift);
+        } else {
+            if (pos + 9 > len) return false;
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            out[pos++] = 0xFB;
+            for (int8_t shift = 56; shift >= 0; shift -= 8) out[pos++] = (uint8_t)(bits >> shift);
+        }
+        return true;
+    }
+
+    if (value.is<const char*>()) {
+        return cborString(3, value.as<const char*>(), out, len, pos);
+    }
+
+    if (value.is<JsonArrayConst>()) {
+        JsonArrayConst arr = value.as<JsonArrayConst>();
+        if (!cborHead(4, arr.size(), out, len, pos)) return false;
+        for (JsonVariantConst item : arr) {
+            if (!cborValue(item, out, len, pos)) return false;
+        }
+        return true;
+    }
+
+    if (value.is<JsonObjectConst>()) {
+        JsonObjectConst obj = value.as<JsonObjectConst>();
+        if (!cborHead(5, obj.size(), out, len, pos)) return false;
+        for (JsonPairConst kv : obj) {
+            if (!cborString(3, kv.key().c_str(), out, len, pos)) return false;
+            if (!cborValue(kv.value(), out, len, pos)) return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+size_t RecordStream::serializeCbor(JsonVariantConst value, uint8_t* out, size_t len) {
+    size_t pos = 0;
+    return cborValue(value, out, len, pos) ? pos : 0;
+}
@@ -0,0 +1,90 @@
+#ifndef RECORD_STREAM_H
+#define RECORD_STREAM_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "config.h"
+
+// Configuración del streaming
+#define STREAM_RECORD_BUFFER 256  // Tamaño máximo de un registro serializado
+#define STREAM_RECORD_FIELDS 16   // Campos máximos por registro
+// Documento del registro: los slots dependen del tamaño de puntero (16 bytes
+// en el ESP8266, 32 en native_sim) y las cadenas copiadas no pasan de lo
+// que entra serializado
+#define STREAM_RECORD_DOC_SIZE (JSON_OBJECT_SIZE(STREAM_RECORD_FIELDS) + STREAM_RECORD_BUFFER)
+
+// Formatos de salida
+enum StreamFormat {
+    STREAM_FORMAT_JSON,     // Arreglo JSON
+    STREAM_FORMAT_MSGPACK,  // Arreglo MessagePack (longitud fija, requiere count())
+    STREAM_FORMAT_CBOR,     // Arreglo CBOR de longitud indefinida
+    STREAM_FORMAT_CSV       // Encabezado de la fuente y una fila por registro
+};
+
+// Fuente de registros para RecordStream.
+// Cada llamada a next() rellena un objeto JSON con el siguiente registro;
+// los const char* asignados al objeto deben seguir siendo válidos hasta la
+// siguiente llamada (ArduinoJson los guarda por referencia).
+class RecordSource {
+public:
+    virtual ~RecordSource() {}
+    virtual bool next(JsonObject obj) = 0;  // false al terminar
+
+    // Cantidad de registros que entregará next(); se consulta una sola vez
+    // antes del primer registro (MessagePack necesita la longitud por adelantado)
+    virtual size_t count() = 0;
+
+    // CSV: línea de encabezado (nullptr = la fuente no exporta CSV) y el
+    // registro con las columnas en ese orden. Por defecto es el mismo objeto
+    // que next(); las fuentes cuyas columnas difieren lo redefinen.
+    virtual const char* csvHeader() { return nullptr; }
+    virtual bool nextCsv(JsonObject obj) { return next(obj); }
+};
+
+// Serializador incremental: convierte una RecordSource en un arreglo
+// entregado por fragmentos. La memoria usada es constante (un registro a la
+// vez) sin importar cuántos registros tenga la fuente. Todos los formatos
+// codifican el mismo objeto que arma la fuente, así que los campos coinciden.
+class RecordStream {
+private:
+    enum StreamState {
+        STREAM_OPEN,
+        STREAM_RECORDS,
+        STREAM_PADDING,
+        STREAM_CLOSE,
+        STREAM_DONE
+    };
+
+    RecordSource* source;
+    StreamFormat format;
+    StreamState state;
+    bool firstRecord;
+    char pending[STREAM_RECORD_BUFFER];
+    size_t pendingLen;
+    size_t pendingPos;
+    size_t announced;   // Longitud declarada en la cabecera MessagePack
+    size_t emitted;     // Elementos emitidos
+    uint32_t skipped;
+
+    bool loadNext();
+    bool loadRecord();
+    size_t encodeRecord(JsonDocument& doc);
+    size_t encodeCsv(JsonObjectConst obj, char* out, size_t len);
+
+public:
+    // Toma posesión de source
+    explicit RecordStream(RecordSource* source, StreamFormat format = STREAM_FORMAT_JSON);
+    ~RecordStream();
+
+    // Copia hasta maxLen bytes en buffer; devuelve 0 al terminar
+    size_t read(uint8_t* buffer, size_t maxLen);
+
+    uint32_t getSkippedCount() const { return skipped; }
+
+    static const char* contentType(StreamFormat format);
+
+    // Codificación CBOR de un valor ArduinoJson; devuelve 0 si no entra en out
+    static size_t serializeCbor(JsonVariantConst value, uint8_t* out, size_t len);
+};
+
+#endif // RECORD_STREAM_H
@@ -6,10 +6,19 @@ ZoneVisualManager ZoneVisual;
 
 // === SCENE MANAGER ===
 
-SceneManager::SceneManager() {
+SceneManager::SceneManager() : transitions(Brightness) {
     activeScene = nullptr;
     transitioning = false;
     transitionStartTime = 0;
+    transitionEndTime = 0;
+    nextEffect = 0;
+    delayedSceneId = 0;
+    delayedStart = 0;
+    delayedNext = 0;
+    
+    transitions.setOutput([this](uint16_t target, uint8_t level) {
+        emitLevel(target, level);
+    });
 }
 
 bool SceneManager::begin() {
@@ -44,7 +53,7 @@ bool SceneManager::addActionToScene(uint32_t sceneId, const SceneAction& action)
     for (auto& scene : scenes) {
         if (scene.id == sceneId) {
             scene.actions.push_back(action);
-            SystemLogger.debug("Acción agregada a escena " + String(sceneId), "SCENE");
+            LOGF_DEBUG("SCENE", "Acción agregada a escena %u", (unsigned)sceneId);
             return true;
         }
     }
@@ -60,83 +69,130 @@ bool SceneManager::activateScene(uint32_t sceneId) {
     
     SystemLogger.info("Activando escena: " + scene->name, "SCENE");
     
+    uint32_t now = millis();
     activeScene = scene;
-    transitioning = true;
-    transitionStartTime = millis();
-    scene->lastActivated = millis();
+    transitionStartTime = now;
+    transitionEndTime = now;
+    scene->lastActivated = now;
     scene->activationCount++;
     
-    // Ejecutar todas las acciones
+    // Las acciones sin delay se programan ya; las demás quedan en la escena
+    // y loop() las programa a su hora (las pendientes de la escena anterior
+    // se descartan)
     for (const auto& action : scene->actions) {
-        if (action.delay > 0) {
-            // Programar ejecución con delay
-            // En producción usar un sistema de timers
-            delay(action.delay);
+        if (action.delay == 0) executeAction(action, now);
+        if (action.delay + action.transitionTime > transitionEndTime - now) {
+            transitionEndTime = now + action.delay + action.transitionTime;
         }
-        executeAction(action);
     }
+    delayedStart = now;
+    delayedSceneId = nextDelay(*scene, 0, delayedNext) ? scene->id : 0;
+    transitioning = transitions.isBusy() || delayedSceneId != 0;
     
     // Notificar callbacks
     for (const auto& callback : activationCallbacks) {
         callback(*scene);
     }
     
-    transitioning = false;
     return true;
 }
 
-void SceneManager::executeAction(const SceneAction& action) {
-    SystemLogger.debug("Ejecutando acción: " + action.targetId + " -> " + String(action.brightness) + "%", "SCENE");
+// Menor delay de la escena posterior a 'after'; false si no queda ninguno
+bool SceneManager::nextDelay(const Scene& scene, uint32_t after, uint32_t& next) {
+    bool found = false;
+    for (const auto& action : scene.actions) {
+        if (action.delay > after && (!found || action.delay < next)) {
+            next = action.delay;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Programa las acciones con delay cuya hora llegó, en orden de delay: una
+// acción posterior sobre las mismas luces reemplaza la transición anterior
+void SceneManager::runDelayedActions(uint32_t now) {
+    Scene* scene = getScene(delayedSceneId);
+    while (scene && (int32_t)(now - (delayedStart + delayedNext)) >= 0) {
+        for (const auto& action : scene->actions) {
+            if (action.delay == delayedNext) executeAction(action, delayedStart + action.delay);
+        }
+        if (!nextDelay(*scene, delayedNext, delayedNext)) scene = nullptr;
+    }
+    if (!scene) delayedSceneId = 0;
+}
+
+void SceneManager::executeAction(const SceneAction& action, uint32_t at) {
+    LOGF_DEBUG("SCENE", "Programando acción: %s -> %d%%", action.targetId.c_str(), (int)action.brightness);
     
     if (action.isZone) {
-        setZoneBrightness(action.targetId, action.brightness, action.transitionTime);
+        scheduleZone(action.targetId, action.brightness, at, action.transitionTime);
     } else {
-        setLightBrightness(action.targetId, action.brightness, action.transitionTime);
+        scheduleLight(action.targetId, action.brightness, at, action.transitionTime);
     }
 }
 
-bool SceneManager::setLightBrightness(const String& lightId, uint8_t brightness, uint32_t transitionTime) {
-    uint8_t currentBright = currentBrightness[lightId];
-    targetBrightness[lightId] = brightness;
+// La intensidad del registro es Brightness: cada nivel emitido es una
+// revisión nueva de la luminaria en /estado-luces
+void SceneManager::emitLevel(uint16_t pos, uint8_t brightness) {
+    Luminarias.notifyIntensidad(pos);
+    if (dimmingCallback) dimmingCallback(pos, brightness);
+}
+
+void SceneManager::setLevel(uint16_t pos, uint8_t brightness) {
+    bool changed = transitions.getLevel(pos) != brightness;
+    transitions.setLevel(pos, brightness);
+    // El nodo recibe el nivel igual; la revisión solo avanza si cambió
+    if (changed) {
+        emitLevel(pos, brightness);
+    } else if (dimmingCallback) {
+        dimmingCallback(pos, brightness);
+    }
+}
+
+bool SceneManager::fadeLevel(uint16_t pos, uint8_t brightness, uint32_t transitionTime) {
+    return scheduleSlot(pos, brightness, millis(), transitionTime);
+}
+
+bool SceneManager::scheduleLight(const String& lightId, uint8_t brightness, uint32_t at, uint32_t transitionTime) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(lightId));
+    if (pos == REGISTRY_NOT_FOUND) {
+        LOGF_DEBUG("SCENE", "Luz desconocida: %s", lightId.c_str());
+        return false;
+    }
+    scheduleSlot(pos, brightness, at, transitionTime);
+    return true;
+}
+
+bool SceneManager::scheduleSlot(uint16_t pos, uint8_t brightness, uint32_t at, uint32_t transitionTime) {
+    bool due = (int32_t)(at - millis()) <= 0;
     
-    if (transitionTime > 0) {
-        applyTransition(lightId, currentBright, brightness, TRANSITION_FADE, transitionTime);
-    } else {
-        currentBrightness[lightId] = brightness;
-        if (dimmingCallback) {
-            dimmingCallback(lightId, brightness);
-        }
+    // Cambio inmediato: se aplica ya (y cancela la transición de la luz)
+    if (transitionTime == 0 && due) {
+        setLevel(pos, brightness);
+        return true;
     }
     
+    if (!transitions.start(pos, brightness, at, transitionTime)) return false;
+    transitioning = true;
     return true;
 }
 
-bool SceneManager::setZoneBrightness(const String& zoneId, uint8_t brightness, uint32_t transitionTime) {
+void SceneManager::scheduleZone(const String& zoneId, uint8_t brightness, uint32_t at, uint32_t transitionTime) {
     auto lights = ZoneVisual.getZoneLights(zoneId);
     for (const auto& lightId : lights) {
-        setLightBrightness(lightId, brightness, transitionTime);
+        uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(lightId));
+        if (pos != REGISTRY_NOT_FOUND) scheduleSlot(pos, brightness, at, transitionTime);
     }
-    return true;
 }
 
-void SceneManager::applyTransition(const String& targetId, uint8_t fromBright, uint8_t toBright, 
-                                  TransitionType type, uint32_t duration) {
-    // Implementación simplificada de transición
-    // En producción usar interpolación más sofisticada
-    
-    uint32_t steps = duration / 50;  // Actualizar cada 50ms
-    float stepSize = (float)(toBright - fromBright) / steps;
-    
-    for (uint32_t i = 0; i <= steps; i++) {
-        uint8_t newBright = fromBright + (stepSize * i);
-        currentBrightness[targetId] = newBright;
-        
-        if (dimmingCallback) {
-            dimmingCallback(targetId, newBright);
-        }
-        
-        delay(50);  // En producción usar timers no bloqueantes
-    }
+bool SceneManager::setLightBrightness(const String& lightId, uint8_t brightness, uint32_t transitionTime) {
+    return scheduleLight(lightId, brightness, millis(), transitionTime);
+}
+
+bool SceneManager::setZoneBrightness(const String& zoneId, uint8_t brightness, uint32_t transitionTime) {
+    scheduleZone(zoneId, brightness, millis(), transitionTime);
+    return true;
 }
 
 void SceneManager::createDefaultPresets() {
@@ -212,7 +268,7 @@ void SceneManager::registerPreset(const String& name, SceneType type, std::funct
     preset.setupFunction = setup;
     presets[name] = preset;
     
-    SystemLogger.debug("Preset registrado: " + name, "SCENE");
+    LOGF_DEBUG("SCENE", "Preset registrado: %s", name.c_str());
 }
 
 bool SceneManager::activatePreset(const String& presetName) {
@@ -227,42 +283,112 @@ bool SceneManager::activatePreset(const String& presetName) {
 }
 
 // Efectos especiales
+
+// Canal libre o, si están todos ocupados, el siguiente en ronda (se corta)
+uint8_t SceneManager::prepareEffect() {
+    uint8_t channel = nextEffect;
+    for (uint8_t c = 0; c < EFFECT_MAX_ACTIVE; c++) {
+        if (!transitions.isPlaying(c)) {
+            channel = c;
+            break;
+        }
+    }
+    nextEffect = (channel + 1) % EFFECT_MAX_ACTIVE;
+    
+    transitions.stop(channel);
+    effects[channel].clear();
+    return channel;
+}
+
+void SceneManager::addEffectLight(EffectTimeline& timeline, const String& lightId) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(lightId));
+    if (pos != REGISTRY_NOT_FOUND) {
+        timeline.addFixture(pos);
+    }
+}
+
+// Zona visual o, si no existe, una sola luminaria
+void SceneManager::addEffectTarget(EffectTimeline& timeline, const String& targetId) {
+    auto lights = ZoneVisual.getZoneLights(targetId);
+    if (lights.empty()) {
+        addEffectLight(timeline, targetId);
+        return;
+    }
+    timeline.slots.reserve(lights.size());
+    timeline.phases.reserve(lights.size());
+    for (const auto& lightId : lights) {
+        addEffectLight(timeline, lightId);
+    }
+}
+
+void SceneManager::playEffect(uint8_t channel) {
+    const EffectTimeline& timeline = effects[channel];
+    if (timeline.size() == 0) return;
+    
+    LOGF_DEBUG("SCENE", "Efecto %d: %u luces, %u ms, %u bytes", (int)timeline.kind, (unsigned)timeline.size(),
+               (unsigned)timeline.duration, (unsigned)timeline.getMemoryFootprint());
+    transitions.play(channel, &timeline, millis());
+    transitioning = true;
+}
+
 void SceneManager::waveEffect(const String& zoneId, uint32_t duration) {
     SystemLogger.info("Aplicando efecto onda en zona: " + zoneId, "SCENE");
     
-    auto lights = ZoneVisual.getZoneLights(zoneId);
-    uint32_t delayPerLight = duration / lights.size();
-    
-    for (size_t i = 0; i < lights.size(); i++) {
-        setLightBrightness(lights[i], 100, 500);
-        delay(delayPerLight);
-        setLightBrightness(lights[i], 30, 500);
-    }
+    uint8_t channel = prepareEffect();
+    addEffectTarget(effects[channel], zoneId);
+    EffectCompiler::wave(effects[channel], duration);
+    playEffect(channel);
 }
 
 void SceneManager::randomEffect(const String& zoneId, uint32_t duration) {
     SystemLogger.info("Aplicando efecto aleatorio en zona: " + zoneId, "SCENE");
     
-    auto lights = ZoneVisual.getZoneLights(zoneId);
-    uint32_t endTime = millis() + duration;
+    uint8_t channel = prepareEffect();
+    addEffectTarget(effects[channel], zoneId);
+    EffectCompiler::randomLevels(effects[channel], duration, random(1, 0x7FFFFFFF));
+    playEffect(channel);
+}
+
+void SceneManager::sequenceEffect(const std::vector<String>& lightIds, uint32_t interval) {
+    SystemLogger.info("Aplicando efecto secuencia sobre " + String(lightIds.size()) + " luces", "SCENE");
     
-    while (millis() < endTime) {
-        int randomLight = random(0, lights.size());
-        uint8_t randomBrightness = random(20, 100);
-        setLightBrightness(lights[randomLight], randomBrightness, 200);
-        delay(100);
+    uint8_t channel = prepareEffect();
+    for (const auto& lightId : lightIds) {
+        addEffectLight(effects[channel], lightId);
     }
+    EffectCompiler::sequence(effects[channel], interval);
+    playEffect(channel);
+}
+
+void SceneManager::strobeEffect(const String& targetId, uint32_t duration, uint32_t frequency) {
+    SystemLogger.info("Aplicando efecto estroboscópico en: " + targetId, "SCENE");
+    
+    // Por debajo de dos ticks el encendido y el apagado caerían en el mismo tick
+    frequency = max(frequency, (uint32_t)(2 * TRANSITION_TICK_MS));
+    
+    uint8_t channel = prepareEffect();
+    addEffectTarget(effects[channel], targetId);
+    EffectCompiler::strobe(effects[channel], duration, frequency);
+    playEffect(channel);
+}
+
+void SceneManager::rainbowEffect(const String& zoneId, uint32_t duration) {
+    SystemLogger.info("Aplicando efecto arcoíris en zona: " + zoneId, "SCENE");
+    
+    uint8_t channel = prepareEffect();
+    addEffectTarget(effects[channel], zoneId);
+    EffectCompiler::rainbow(effects[channel], duration);
+    playEffect(channel);
 }
 
 void SceneManager::activateEmergencyLighting() {
     SystemLogger.warning("¡ILUMINACIÓN DE EMERGENCIA ACTIVADA!", "SCENE");
     
-    // Encender todas las luces al máximo instantáneamente
-    for (auto& pair : currentBrightness) {
-        currentBrightness[pair.first] = 100;
-        if (dimmingCallback) {
-            dimmingCallback(pair.first, 100);
-        }
+    // Encender todas las luces al máximo instantáneamente (corta los fades en curso)
+    uint16_t count = Luminarias.size();
+    transitions.setAll(count, 100);
+    for (uint16_t pos = 0; pos < count; pos++) {
+        emitLevel(pos, 100);
     }
 }
 
@@ -270,8 +396,9 @@ void SceneManager::activateEcoMode() {
     SystemLogger.info("Modo Eco activado", "SCENE");
     
     // Reducir brillo general al 60%
-    for (auto& pair : currentBrightness) {
-        setLightBrightness(pair.first, 60, 3000);
+    uint32_t now = millis();
+    for (uint16_t pos = 0; pos < Luminarias.size(); pos++) {
+        scheduleSlot(pos, 60, now, 3000);
     }
 }
 
@@ -279,8 +406,9 @@ void SceneManager::activateNightMode() {
     SystemLogger.info("Modo Nocturno activado", "SCENE");
     
     // Reducir brillo general al 30%
-    for (auto& pair : currentBrightness) {
-        setLightBrightness(pair.first, 30, 5000);
+    uint32_t now = millis();
+    for (uint16_t pos = 0; pos < Luminarias.size(); pos++) {
+        scheduleSlot(pos, 30, now, 5000);
     }
 }
 
@@ -293,11 +421,13 @@ void SceneManager::fadeOut(const String& targetId, uint32_t duration) {
 }
 
 void SceneManager::pulsate(const String& targetId, uint8_t minBright, uint8_t maxBright, uint32_t period) {
-    // Efecto de pulsación
-    uint32_t halfPeriod = period / 2;
-    setLightBrightness(targetId, maxBright, halfPeriod);
-    delay(halfPeriod);
-    setLightBrightness(targetId, minBright, halfPeriod);
+    SystemLogger.info("Aplicando efecto pulsación en: " + targetId, "SCENE");
+    
+    // Un ciclo de subida y bajada: como efecto no ocupa dos transiciones por luz
+    uint8_t channel = prepareEffect();
+    addEffectTarget(effects[channel], targetId);
+    EffectCompiler::pulse(effects[channel], minBright, maxBright, period);
+    playEffect(channel);
 }
 
 String SceneManager::getSceneStatistics() {
@@ -305,6 +435,12 @@ String SceneManager::getSceneStatistics() {
     doc["total_scenes"] = scenes.size();
     doc["active_scene"] = activeScene ? activeScene->name : "none";
     doc["transitioning"] = transitioning;
+    doc["transitions_active"] = transitions.getActiveCount();
+    doc["transitions_peak"] = transitions.getPeak();
+    doc["transitions_replaced"] = transitions.getReplaced();
+    doc["transitions_dropped"] = transitions.getDropped();
+    doc["actions_pending"] = delayedSceneId != 0;
+    doc["effects_playing"] = transitions.getPlayingCount();
     
     JsonArray sceneList = doc.createNestedArray("scenes");
     for (const auto& scene : scenes) {
@@ -329,20 +465,24 @@ void SceneManager::loop() {
         checkAutomaticTriggers();
     }
     
-    // Actualizar transiciones en progreso
+    // Programar las acciones con delay que llegaron y avanzar las
+    // transiciones en progreso (O(activas), cada TRANSITION_TICK_MS)
     if (transitioning) {
-        float progress = getTransitionProgress();
-        if (progress >= 1.0) {
-            transitioning = false;
-        }
+        uint32_t now = millis();
+        if (delayedSceneId) runDelayedActions(now);
+        transitions.update(now);
+        transitioning = transitions.isBusy() || delayedSceneId != 0;
     }
 }
 
 float SceneManager::getTransitionProgress() {
     if (!transitioning) return 1.0;
     
+    // Progreso de la última escena activada, hasta su última acción
+    uint32_t total = transitionEndTime - transitionStartTime;
+    if (total == 0) total = SCENE_TRANSITION_TIME;
     uint32_t elapsed = millis() - transitionStartTime;
-    return min(1.0f, (float)elapsed / SCENE_TRANSITION_TIME);
+    return min(1.0f, (float)elapsed / total);
 }
 
 void SceneManager::checkAutomaticTriggers() {
@@ -355,7 +495,7 @@ void SceneManager::checkAutomaticTriggers() {
     }
 }
 
-bool SceneManager::evaluateTriggerCondition(const String& condition) {
+bool SceneManager::evaluateTriggerCondition(const String& /* condition */) {
     // Implementar evaluación de condiciones
     // Por ejemplo: "time=18:00", "ambient_light<50", etc.
     return false;
@@ -402,10 +542,11 @@ void SceneManager::setDimmingCallback(DimmingCallback callback) {
 }
 
 uint8_t SceneManager::getLightBrightness(const String& lightId) {
-    if (currentBrightness.find(lightId) != currentBrightness.end()) {
-        return currentBrightness[lightId];
-    }
-    return 0;
+    return Brightness.getCurrent(Luminarias.find(LuminariaRegistry::parseId(lightId)));
+}
+
+float SceneManager::getAverageBrightness() {
+    return Brightness.average(Luminarias.size());
 }
 
 // === DIMMING CONTROLLER ===
@@ -423,16 +564,13 @@ void DimmingController::setLimits(uint8_t min, uint8_t max) {
 }
 
 void DimmingController::setBrightness(const String& id, uint8_t level) {
-    level = constrain(level, minBrightness, maxBrightness);
-    brightnessLevels[id] = level;
-    lastUpdateTime[id] = millis();
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(id));
+    if (pos == REGISTRY_NOT_FOUND) return;
+    Scenes.setLevel(pos, limit(level));
 }
 
 uint8_t DimmingController::getBrightness(const String& id) {
-    if (brightnessLevels.find(id) != brightnessLevels.end()) {
-        return brightnessLevels[id];
-    }
-    return 0;
+    return Brightness.getCurrent(Luminarias.find(LuminariaRegistry::parseId(id)));
 }
 
 void DimmingController::adjustBrightness(const String& id, int8_t delta) {
@@ -441,15 +579,14 @@ void DimmingController::adjustBrightness(const String& id, int8_t delta) {
 }
 
 void DimmingController::fadeTo(const String& id, uint8_t target, uint32_t duration) {
-    // Implementar fade con timers no bloqueantes
-    uint8_t current = getBrightness(id);
-    uint32_t steps = duration / dimmingSpeed;
-    float stepSize = (float)(target - current) / steps;
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(id));
+    if (pos == REGISTRY_NOT_FOUND) return;
     
-    // En producción usar Ticker o similar
-    for (uint32_t i = 0; i <= steps; i++) {
-        setBrightness(id, current + (stepSize * i));
-        delay(dimmingSpeed);
+    // El fade arranca del brillo actual en la tabla; Scenes.loop() lo avanza
+    if (!smoothDimming || duration == 0) {
+        Scenes.setLevel(pos, limit(target));
+    } else {
+        Scenes.fadeLevel(pos, limit(target), duration);
     }
 }
 
@@ -8,6 +8,9 @@
 #include "config.h"
 #include "Logger.h"
 #include "DatabaseManager.h"
+#include "TransitionEngine.h"
+#include "BrightnessTable.h"
+#include "LuminariaRegistry.h"
 
 // Configuración de escenas
 #define MAX_SCENES 20
@@ -55,7 +58,6 @@ struct Scene {
     String triggerCondition;  // Condición para activación automática
     uint32_t lastActivated;
     uint32_t activationCount;
-    JsonDocument metadata;
 };
 
 // Preset de escena
@@ -68,7 +70,8 @@ struct ScenePreset {
 
 // Callbacks
 typedef std::function<void(const Scene& scene)> SceneActivatedCallback;
-typedef std::function<void(const String& targetId, uint8_t brightness)> DimmingCallback;
+// Nivel nuevo de una luminaria, por su posición en el registro (Luminarias)
+typedef std::function<void(uint16_t pos, uint8_t brightness)> DimmingCallback;
 
 class SceneManager {
 private:
@@ -77,18 +80,42 @@ private:
     Scene* activeScene;
     bool transitioning;
     uint32_t transitionStartTime;
+    uint32_t transitionEndTime;
     
     // Callbacks
     std::vector<SceneActivatedCallback> activationCallbacks;
     DimmingCallback dimmingCallback;
     
-    // Control de dimming
-    std::map<String, uint8_t> currentBrightness;
-    std::map<String, uint8_t> targetBrightness;
+    // Control de dimming: el brillo de cada luz está en la tabla compartida
+    // (Brightness), indexada por su posición en el registro. Es el único
+    // motor: DimmingController también programa sus fades acá
+    TransitionEngine transitions;
+    
+    // Efectos compilados que reproduce 'transitions', uno por canal
+    EffectTimeline effects[EFFECT_MAX_ACTIVE];
+    uint8_t nextEffect;
+    
+    // Acciones con delay de la última escena activada: se programan en
+    // loop() cuando llega su hora, así el motor guarda una sola transición
+    // por luz. delayedNext es el próximo delay a ejecutar; delayedSceneId 0,
+    // ninguna pendiente
+    uint32_t delayedSceneId;
+    uint32_t delayedStart;
+    uint32_t delayedNext;
     
     // Métodos privados
-    void executeAction(const SceneAction& action);
-    void applyTransition(const String& targetId, uint8_t fromBright, uint8_t toBright, TransitionType type, uint32_t duration);
+    void emitLevel(uint16_t pos, uint8_t brightness);
+    bool nextDelay(const Scene& scene, uint32_t after, uint32_t& next);
+    void runDelayedActions(uint32_t now);
+    void executeAction(const SceneAction& action, uint32_t at);
+    bool scheduleLight(const String& lightId, uint8_t brightness, uint32_t at, uint32_t transitionTime);
+    // false si la posición no entra en la tabla
+    bool scheduleSlot(uint16_t pos, uint8_t brightness, uint32_t at, uint32_t transitionTime);
+    void scheduleZone(const String& zoneId, uint8_t brightness, uint32_t at, uint32_t transitionTime);
+    uint8_t prepareEffect();
+    void addEffectLight(EffectTimeline& timeline, const String& lightId);
+    void addEffectTarget(EffectTimeline& timeline, const String& targetId);
+    void playEffect(uint8_t channel);
     bool evaluateTriggerCondition(const String& condition);
     void loadPresetsFromFile();
     void saveScenesToFile();
@@ -136,7 +163,7 @@ public:
     void checkAutomaticTriggers();
     bool setSceneTrigger(uint32_t sceneId, const String& condition);
     
-    // Efectos especiales
+    // Efectos especiales: se compilan a un EffectTimeline y loop() los reproduce
     void waveEffect(const String& zoneId, uint32_t duration = 5000);
     void randomEffect(const String& zoneId, uint32_t duration = 10000);
     void sequenceEffect(const std::vector<String>& lightIds, uint32_t interval = 500);
@@ -162,10 +189,18 @@ public:
     float getAverageBrightness();
     String getSceneStatistics();
     
-    // Loop de actualización
+    // Loop de actualización: avanza las transiciones (nunca bloquea)
     void loop();
     bool isTransitioning() { return transitioning; }
     float getTransitionProgress();
+    const TransitionEngine& getTransitions() const { return transitions; }
+    
+    // Nivel de una luminaria por posición (Luminarias.find()), en el mismo
+    // motor que las escenas (los usa DimmingController); ambos pasan por el
+    // callback de dimming. Un nivel o un fade nuevo reemplaza la transición
+    // que tuviera la luz; fadeLevel() devuelve false si 'pos' no entra en la tabla
+    void setLevel(uint16_t pos, uint8_t brightness);
+    bool fadeLevel(uint16_t pos, uint8_t brightness, uint32_t transitionTime);
 };
 
 // Instancia global
@@ -180,8 +215,9 @@ private:
     bool smoothDimming;
     uint32_t dimmingSpeed;
     
-    std::map<String, uint8_t> brightnessLevels;
-    std::map<String, uint32_t> lastUpdateTime;
+    // Sin motor propio: los niveles y fades van al de SceneManager
+    // (Scenes.setLevel/fadeLevel), que los avanza en Scenes.loop()
+    uint8_t limit(uint8_t level) const { return constrain(level, minBrightness, maxBrightness); }
     
 public:
     DimmingController();
@@ -208,9 +244,6 @@ public:
     // Presets de brillo
     void applyPreset(const String& preset);
     void saveCurrentAsPreset(const String& name);
-    
-    // Loop de actualización
-    void update();
 };
 
 extern DimmingController Dimming;
@@ -226,7 +259,6 @@ private:
         String color;           // Color de la zona
         uint8_t defaultBrightness;
         bool active;
-        JsonDocument properties;
     };
     
     std::vector<VisualZone> zones;
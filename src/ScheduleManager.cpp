@@ -1,4 +1,5 @@
 #include "ScheduleManager.h"
+#include "DeferredQueue.h"
 
 ScheduleManager Scheduler;
 TimeManager Time;
@@ -40,7 +41,8 @@ void ScheduleManager::setCallback(ScheduleCallback callback) {
 void ScheduleManager::enable(bool state) {
     if (state && !enabled) {
         enabled = true;
-        scheduleTicker.attach_ms(SCHEDULE_CHECK_INTERVAL, checkSchedulesCallback);
+        // El chequeo lee la base de datos y dispara acciones: corre en loop()
+        scheduleTicker.attach_ms(SCHEDULE_CHECK_INTERVAL, []() { Deferred.post(checkSchedulesCallback); });
         SystemLogger.info("Scheduler habilitado", "SCHEDULE");
     } else if (!state && enabled) {
         enabled = false;
@@ -113,9 +115,8 @@ void ScheduleManager::executeSchedule(const Schedule& schedule) {
 
 void ScheduleManager::calculateSunTimes() {
     // Cálculo simplificado para San Luis, Argentina
-    // En una implementación real, usar librería de cálculo solar
-    float latitude = DEFAULT_LAT;
-    float longitude = DEFAULT_LNG;
+    // En una implementación real, usar librería de cálculo solar con
+    // DEFAULT_LAT / DEFAULT_LNG
     
     // Aproximación simple (ajustar según estación)
     uint8_t month = Time.getCurrentMonth();
@@ -133,7 +134,7 @@ void ScheduleManager::calculateSunTimes() {
 }
 
 uint32_t ScheduleManager::createSchedule(const String& name, TriggerType trigger,
-                                        ScheduleAction action, const String& target) {
+                                        ScheduleAction /* action */, const String& /* target */) {
     uint8_t hourOn = 18, minuteOn = 0;
     uint8_t hourOff = 6, minuteOff = 0;
     
@@ -282,14 +283,14 @@ uint8_t TimeManager::getCurrentDayOfWeek() {
 }
 
 String TimeManager::getTimeString() {
-    char buffer[10];
+    char buffer[12];
     snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", 
              getCurrentHour(), getCurrentMinute(), getCurrentSecond());
     return String(buffer);
 }
 
 String TimeManager::getDateString() {
-    char buffer[12];
+    char buffer[16];
     snprintf(buffer, sizeof(buffer), "%02d/%02d/%04d",
              getCurrentDay(), getCurrentMonth(), getCurrentYear());
     return String(buffer);
@@ -3,7 +3,7 @@
 
 #include <Arduino.h>
 #include <TimeLib.h>
-#include <Ticker.h>
+#include "hal/Platform.h"
 #include "config.h"
 #include "Logger.h"
 #include "DatabaseManager.h"
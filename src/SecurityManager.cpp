@@ -1,5 +1,5 @@
 #include "SecurityManager.h"
-#include <LittleFS.h>
+#include "DeferredQueue.h"
 #include <ArduinoJson.h>
 #include <SHA256.h>
 
@@ -49,8 +49,8 @@ void SecurityManager::checkWatchdog() {
     
     if (watchdogEnabled && (now - lastWatchdogFeed > WATCHDOG_TIMEOUT)) {
         watchdogResets++;
-        SystemLogger.error("Watchdog timeout! Sistema bloqueado por " + 
-                          String(now - lastWatchdogFeed) + "ms", "SECURITY");
+        LOGF_ERROR("SECURITY", "Watchdog timeout! Sistema bloqueado por %lums",
+                   (unsigned long)(now - lastWatchdogFeed));
         
         // Intentar recuperación suave primero
         ESP.wdtFeed();
@@ -68,6 +68,8 @@ void SecurityManager::enableWatchdog() {
     if (!watchdogEnabled) {
         watchdogEnabled = true;
         lastWatchdogFeed = millis();
+        // A diferencia del resto de los Ticker, no se difiere: tiene que
+        // detectar justamente que loop() dejó de correr
         watchdogTicker.attach_ms(WATCHDOG_CHECK_INTERVAL, watchdogCallback);
         SystemLogger.info("Watchdog habilitado con timeout de " + 
                          String(WATCHDOG_TIMEOUT) + "ms", "SECURITY");
@@ -423,7 +425,8 @@ String SecurityManager::getLastBackupTime() {
 }
 
 void SecurityManager::scheduleBackup(uint32_t interval) {
-    backupTicker.attach_ms(interval, backupCallback);
+    // El backup escribe en LittleFS: no puede correr en el contexto del Ticker
+    backupTicker.attach_ms(interval, []() { Deferred.post(backupCallback); });
     SystemLogger.info("Backup programado cada " + String(interval / 60000) + " minutos", "SECURITY");
 }
 
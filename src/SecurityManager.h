@@ -2,8 +2,7 @@
 #define SECURITY_MANAGER_H
 
 #include <Arduino.h>
-#include <ESP8266WiFi.h>
-#include <Ticker.h>
+#include "hal/Platform.h"
 #include "config.h"
 #include "Logger.h"
 #include <map>
@@ -0,0 +1,198 @@
+#include "TransitionEngine.h"
+
+static_assert(EFFECT_MAX_ACTIVE < TRANSITION_OWNER_FADE, "Los canales de efectos deben entrar en owners");
+static_assert(MAX_LUCES <= 0xFFFF, "MAX_LUCES debe entrar en 16 bits");
+
+TransitionEngine::TransitionEngine(BrightnessTable& levels) : table(levels) {
+    clear();
+}
+
+void TransitionEngine::clear() {
+    activeCount = 0;
+    memset(pending, 0, sizeof(pending));
+    memset(owners, TRANSITION_OWNER_NONE, sizeof(owners));
+    for (uint8_t c = 0; c < EFFECT_MAX_ACTIVE; c++) effects[c] = nullptr;
+    playing = 0;
+    lastTick = 0;
+    ticked = false;
+    started = 0;
+    completed = 0;
+    replaced = 0;
+    dropped = 0;
+    peak = 0;
+}
+
+bool TransitionEngine::start(uint16_t target, uint8_t to, uint32_t start, uint32_t duration) {
+    if (target >= table.capacity()) {
+        dropped++;
+        return false;
+    }
+
+    if (!hasTransition(target)) {
+        pending[target >> 5] |= 1UL << (target & 31);
+        if (++activeCount > peak) peak = activeCount;
+    } else {
+        // La anterior se descarta; el nivel queda donde la dejó
+        if (owners[target] == TRANSITION_OWNER_FADE) owners[target] = TRANSITION_OWNER_NONE;
+        replaced++;
+    }
+    starts[target] = start;
+    durations[target] = duration;
+    tos[target] = to;
+    started++;
+    return true;
+}
+
+void TransitionEngine::setLevel(uint16_t target, uint8_t level) {
+    if (target >= table.capacity()) return;
+    table.setLevel(target, level);
+    cancel(target);
+    owners[target] = TRANSITION_OWNER_NONE;
+}
+
+void TransitionEngine::setAll(uint16_t count, uint8_t level) {
+    if (count > table.capacity()) count = table.capacity();
+    table.fill(count, level);
+    for (uint16_t i = 0; i < count; i++) {
+        cancel(i);
+        owners[i] = TRANSITION_OWNER_NONE;
+    }
+}
+
+bool TransitionEngine::play(uint8_t channel, const EffectTimeline* timeline, uint32_t start) {
+    if (channel >= EFFECT_MAX_ACTIVE || !timeline) return false;
+    stop(channel);
+    effects[channel] = timeline;
+    effectStarts[channel] = start;
+    effectBegun[channel] = false;
+    playing++;
+    return true;
+}
+
+void TransitionEngine::stop(uint8_t channel) {
+    if (!isPlaying(channel)) return;
+    const EffectTimeline& timeline = *effects[channel];
+    for (uint16_t i = 0; i < timeline.size(); i++) {
+        uint16_t target = timeline.slots[i];
+        if (target < MAX_LUCES && owners[target] == channel) owners[target] = TRANSITION_OWNER_NONE;
+    }
+    effects[channel] = nullptr;
+    playing--;
+}
+
+// true si quien maneja el destino empezó después de 'start' (y lo conserva)
+bool TransitionEngine::outranks(uint16_t target, uint32_t start) const {
+    uint8_t owner = owners[target];
+    if (owner == TRANSITION_OWNER_NONE) return false;
+    uint32_t ownerStart = owner == TRANSITION_OWNER_FADE ? starts[target] : effectStarts[owner];
+    return (int32_t)(ownerStart - start) > 0;
+}
+
+// Descarta la transición del destino, si tenía
+void TransitionEngine::cancel(uint16_t target) {
+    if (!hasTransition(target)) return;
+    pending[target >> 5] &= ~(1UL << (target & 31));
+    activeCount--;
+}
+
+void TransitionEngine::update(uint32_t now) {
+    if (ticked && now - lastTick < TRANSITION_TICK_MS) return;
+    ticked = true;
+    lastTick = now;
+
+    // Copia de cada palabra: la salida puede empezar o cancelar otras
+    for (uint16_t word = 0; word < TRANSITION_WORDS && activeCount > 0; word++) {
+        for (uint32_t bits = pending[word]; bits; bits &= bits - 1) {
+            uint16_t target = word * 32 + __builtin_ctzl(bits);
+            if (hasTransition(target)) updateTransition(target, now);
+        }
+    }
+
+    for (uint8_t c = 0; c < EFFECT_MAX_ACTIVE; c++) {
+        if (effects[c]) updateEffect(c, now);
+    }
+}
+
+void TransitionEngine::updateTransition(uint16_t target, uint32_t now) {
+    uint32_t elapsed = now - starts[target];
+    if ((int32_t)elapsed < 0) return;  // Programada para más adelante
+
+    if (owners[target] != TRANSITION_OWNER_FADE) {
+        // Si arranca en el mismo tick que un efecto gana el de inicio más tardío
+        if (outranks(target, starts[target])) {
+            cancel(target);
+            return;
+        }
+        // Toma el destino desde donde esté ahora (queda como 'start' en la tabla)
+        table.beginTransition(target, tos[target]);
+        owners[target] = TRANSITION_OWNER_FADE;
+    }
+
+    uint8_t level = tos[target];
+    bool done = elapsed >= durations[target];
+    if (!done) {
+        uint8_t from = table.getStart(target);
+        int32_t delta = (int32_t)tos[target] - from;
+        level = from + (int32_t)((int64_t)delta * elapsed / durations[target]);
+    }
+
+    if (level != table.getCurrent(target)) {
+        table.setCurrent(target, level);
+        if (output) output(target, level);
+    }
+
+    if (done) {
+        owners[target] = TRANSITION_OWNER_NONE;
+        completed++;
+        cancel(target);
+    }
+}
+
+void TransitionEngine::updateEffect(uint8_t channel, uint32_t now) {
+    uint32_t elapsed = now - effectStarts[channel];
+    if ((int32_t)elapsed < 0) return;  // Programado para más adelante
+
+    const EffectTimeline& timeline = *effects[channel];
+    uint16_t count = timeline.size();
+
+    if (!effectBegun[channel]) {
+        // Toma sus luminarias; el nivel previo queda como 'start' en la tabla
+        effectBegun[channel] = true;
+        for (uint16_t i = 0; i < count; i++) {
+            uint16_t target = timeline.slots[i];
+            if (target >= table.capacity()) continue;
+            if (outranks(target, effectStarts[channel])) continue;
+            // Corta el fade en curso; una transición programada para más
+            // adelante sigue y se lo quita al efecto cuando empiece
+            if (owners[target] == TRANSITION_OWNER_FADE) cancel(target);
+            owners[target] = channel;
+            uint8_t final = timeline.finalLevel == EFFECT_RESTORE ? table.getCurrent(target) : timeline.finalLevel;
+            table.beginTransition(target, final);
+        }
+    }
+
+    bool done = elapsed >= timeline.duration;
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t target = timeline.slots[i];
+        if (target >= MAX_LUCES || owners[target] != channel) continue;
+
+        uint8_t current = table.getCurrent(target);
+        uint8_t level;
+        if (done) {
+            level = table.getTarget(target);  // Nivel final o el previo al efecto
+            owners[target] = TRANSITION_OWNER_NONE;
+        } else {
+            level = timeline.levelAt(i, elapsed, current);
+        }
+
+        if (level != current) {
+            table.setCurrent(target, level);
+            if (output) output(target, level);
+        }
+    }
+
+    if (done) {
+        effects[channel] = nullptr;
+        playing--;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef TRANSITION_ENGINE_H
+#define TRANSITION_ENGINE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "config.h"
+#include "BrightnessTable.h"
+#include "EffectTimeline.h"
+
+// Configuración del motor de transiciones
+#define TRANSITION_TICK_MS 50      // Intervalo mínimo entre avances
+#define TRANSITION_WORDS ((MAX_LUCES + 31) / 32)  // Palabras del bitmap de destinos con transición
+#define TRANSITION_OWNER_NONE 0xFF // Nadie maneja el destino
+#define TRANSITION_OWNER_FADE 0xFE // Lo maneja su propia transición (si no, el canal del efecto)
+
+// Nivel nuevo de un destino (el índice lo asigna quien usa el motor)
+typedef std::function<void(uint16_t target, uint8_t level)> TransitionOutput;
+
+// Transiciones de brillo cooperativas.
+//
+// Cada transición lleva un destino a 'to' en 'duration' ms a partir de
+// 'start', que puede estar en el futuro. update() recorre un bitmap de los
+// destinos con transición salteando las palabras vacías, interpola con el
+// reloj que recibe y emite el nivel únicamente cuando cambia: el costo por
+// tick es O(activas + MAX_LUCES / 32). Los niveles son brillo
+// percibido: la interpolación lineal da pasos parejos a la vista y la curva
+// de cada luminaria (DimmingCurve.h) se aplica recién al pasar a PWM.
+//
+// Los destinos son posiciones de una BrightnessTable: el motor lee y escribe
+// ahí el nivel actual, el de partida y el final (no guarda copias), así que
+// dos motores sobre la misma tabla comparten el estado de cada luminaria.
+//
+// Cada destino tiene a lo sumo una transición (en curso o programada), en
+// arrays indexados por destino: start() sobre un destino que ya tenía una
+// la reemplaza y la nueva arranca desde el nivel en que haya quedado. No hay
+// pool que se llene; los delays de varias acciones sobre el mismo destino
+// los encola quien usa el motor (SceneManager) y llegan acá a su hora.
+//
+// Además reproduce hasta EFFECT_MAX_ACTIVE efectos precompilados
+// (EffectTimeline) en canales: al empezar, el efecto toma todas sus
+// luminarias como si fuera una transición y en cada tick evalúa la curva de
+// cada una (O(luminarias del efecto), sin asignaciones). Una transición o un
+// setLevel() posterior sobre una luminaria se la quita al efecto.
+class TransitionEngine {
+private:
+    // Transición de cada destino: valen solo si su bit de 'pending' está
+    // puesto. El nivel de partida es el 'start' de la tabla
+    uint32_t starts[MAX_LUCES];
+    uint32_t durations[MAX_LUCES];
+    uint8_t tos[MAX_LUCES];
+
+    uint32_t pending[TRANSITION_WORDS];
+    uint16_t activeCount;
+
+    // Niveles por destino y, por destino, quién lo maneja
+    BrightnessTable& table;
+    uint8_t owners[MAX_LUCES];
+
+    // Canales de efectos: el dueño de sus luminarias es el número de canal
+    const EffectTimeline* effects[EFFECT_MAX_ACTIVE];
+    uint32_t effectStarts[EFFECT_MAX_ACTIVE];
+    bool effectBegun[EFFECT_MAX_ACTIVE];
+    uint8_t playing;
+
+    TransitionOutput output;
+    uint32_t lastTick;
+    bool ticked;
+
+    uint32_t started;
+    uint32_t completed;
+    uint32_t replaced;  // start() sobre un destino que ya tenía transición
+    uint32_t dropped;   // start() con un destino fuera de la tabla
+    uint16_t peak;
+
+    bool hasTransition(uint16_t target) const { return pending[target >> 5] & (1UL << (target & 31)); }
+    void cancel(uint16_t target);
+    bool outranks(uint16_t target, uint32_t start) const;
+    void updateTransition(uint16_t target, uint32_t now);
+    void updateEffect(uint8_t channel, uint32_t now);
+
+public:
+    explicit TransitionEngine(BrightnessTable& levels);
+
+    void setOutput(TransitionOutput callback) { output = callback; }
+    void clear();
+
+    // Programa la transición del destino (reemplaza la que tuviera); con
+    // duration 0 el nivel se aplica de golpe en 'start'.
+    // Devuelve false si el destino no entra en la tabla
+    bool start(uint16_t target, uint8_t to, uint32_t start, uint32_t duration);
+
+    // Nivel aplicado por fuera del motor: cancela la transición del destino
+    // (en curso o programada), se lo quita al efecto y no emite nada
+    void setLevel(uint16_t target, uint8_t level);
+    // Igual para los destinos [0, count), con un recorrido denso de la tabla
+    void setAll(uint16_t count, uint8_t level);
+    uint8_t getLevel(uint16_t target) const { return table.getCurrent(target); }
+    const BrightnessTable& getTable() const { return table; }
+
+    // Avanza las transiciones al instante 'now' (millis() o un reloj de prueba)
+    void update(uint32_t now);
+
+    // Reproduce 'timeline' desde 'start' en 'channel' (reemplaza lo que hubiera).
+    // El timeline no se copia: tiene que vivir hasta que el efecto termine
+    bool play(uint8_t channel, const EffectTimeline* timeline, uint32_t start);
+    void stop(uint8_t channel);
+    bool isPlaying(uint8_t channel) const { return channel < EFFECT_MAX_ACTIVE && effects[channel]; }
+    uint8_t getPlayingCount() const { return playing; }
+    bool isBusy() const { return activeCount > 0 || playing > 0; }
+
+    uint16_t getActiveCount() const { return activeCount; }
+    uint16_t getCapacity() const { return MAX_LUCES; }
+    uint16_t getPeak() const { return peak; }
+    uint32_t getStarted() const { return started; }
+    uint32_t getCompleted() const { return completed; }
+    uint32_t getReplaced() const { return replaced; }
+    uint32_t getDropped() const { return dropped; }
+};
+
+#endif // TRANSITION_ENGINE_H
@@ -0,0 +1,115 @@
+#include "WebAssets.h"
+
+WebAssets Assets;
+
+WebAssets::WebAssets() {
+    assetCount = 0;
+    served = 0;
+    notModified = 0;
+}
+
+bool WebAssets::begin() {
+    assetCount = 0;
+
+    File file = LittleFS.open(ASSETS_MANIFEST, "r");
+    if (!file) {
+        SystemLogger.warning("Sin manifiesto de archivos web: se sirven sin compresión ni caché", "WEB");
+        return false;
+    }
+
+    // Una línea por archivo: "<ruta> <hash>"
+    char line[ASSET_PATH_MAX + ASSET_HASH_LENGTH + 4];
+    while (file.available() && assetCount < MAX_WEB_ASSETS) {
+        size_t len = file.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[len] = '\0';
+
+        char* space = strchr(line, ' ');
+        if (!space || space - line >= ASSET_PATH_MAX || strlen(space + 1) != ASSET_HASH_LENGTH) continue;
+
+        WebAsset& asset = assets[assetCount++];
+        *space = '\0';
+        strcpy(asset.path, line);
+        strcpy(asset.hash, space + 1);
+    }
+    file.close();
+
+    SystemLogger.info("Archivos web en manifiesto: " + String(assetCount), "WEB");
+    return true;
+}
+
+const WebAsset* WebAssets::find(const char* path) const {
+    for (uint8_t i = 0; i < assetCount; i++) {
+        if (strcmp(assets[i].path, path) == 0) return &assets[i];
+    }
+    return nullptr;
+}
+
+const char* WebAssets::contentType(const char* path) {
+    const char* ext = strrchr(path, '.');
+    if (!ext) return "application/octet-stream";
+    if (strcmp(ext, ".html") == 0 || strcmp(ext, ".htm") == 0) return "text/html";
+    if (strcmp(ext, ".js") == 0) return "application/javascript";
+    if (strcmp(ext, ".css") == 0) return "text/css";
+    if (strcmp(ext, ".json") == 0) return "application/json";
+    if (strcmp(ext, ".png") == 0) return "image/png";
+    if (strcmp(ext, ".svg") == 0) return "image/svg+xml";
+    if (strcmp(ext, ".ico") == 0) return "image/x-icon";
+    return "application/octet-stream";
+}
+
+bool WebAssets::send(AsyncWebServerRequest* request, const char* path) {
+    const WebAsset* asset = find(path);
+
+    // Los archivos del manifiesto existen como .gz; el resto se verifica en flash
+    if (!asset && !LittleFS.exists(path) && !LittleFS.exists(String(path) + ".gz")) {
+        return false;
+    }
+
+    if (!asset) {
+        AsyncWebServerResponse* response = request->beginResponse(LittleFS, path, contentType(path));
+        response->addHeader("Cache-Control", ASSET_CACHE_REVALIDATE);
+        request->send(response);
+        served++;
+        return true;
+    }
+
+    char etag[ASSET_HASH_LENGTH + 3];
+    snprintf(etag, sizeof(etag), "\"%s\"", asset->hash);
+
+    // Con ?v=<hash> la URL identifica el contenido: puede cachearse para siempre
+    const char* cacheControl = ASSET_CACHE_REVALIDATE;
+    if (request->hasParam("v") && request->getParam("v")->value() == asset->hash) {
+        cacheControl = ASSET_CACHE_IMMUTABLE;
+    }
+
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag) {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        notModified++;
+        return true;
+    }
+
+    // AsyncFileResponse toma el .gz y agrega Content-Encoding: gzip
+    AsyncWebServerResponse* response = request->beginResponse(LittleFS, path, contentType(path));
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+    served++;
+    return true;
+}
+
+void WebAssets::serve(AsyncWebServer& server, const char* path) {
+    server.on(path, HTTP_GET, [this, path](AsyncWebServerRequest* request) {
+        if (!send(request, path)) {
+            request->send(404, "text/plain", "No encontrado");
+        }
+    });
+}
+
+void WebAssets::getStatus(JsonObject obj) const {
+    obj["assets"] = assetCount;
+    obj["served"] = served;
+    obj["not_modified"] = notModified;
+}
@@ -0,0 +1,58 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+#include "hal/Platform.h"
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include "config.h"
+#include "Logger.h"
+
+// Configuración de archivos web
+#define ASSETS_MANIFEST "/assets.manifest"  // Generado por scripts/build_web_assets.py
+#define MAX_WEB_ASSETS 24
+#define ASSET_PATH_MAX 32
+#define ASSET_HASH_LENGTH 8
+#define ASSET_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define ASSET_CACHE_REVALIDATE "no-cache"
+
+// Archivo web con su hash de contenido
+struct WebAsset {
+    char path[ASSET_PATH_MAX];
+    char hash[ASSET_HASH_LENGTH + 1];
+};
+
+// Sirve los archivos de data/ precomprimidos (.gz) con ETag fuerte.
+// Si la URL trae ?v=<hash> y coincide con el manifiesto, la respuesta se
+// marca como inmutable; si no, el navegador revalida y recibe 304.
+class WebAssets {
+private:
+    WebAsset assets[MAX_WEB_ASSETS];
+    uint8_t assetCount;
+
+    // Estadísticas
+    uint32_t served;
+    uint32_t notModified;
+
+    const WebAsset* find(const char* path) const;
+    static const char* contentType(const char* path);
+
+public:
+    WebAssets();
+
+    bool begin();  // Carga el manifiesto; sin él se sirven los archivos tal cual
+
+    // Responde con el archivo (o 304); false si no existe
+    bool send(AsyncWebServerRequest* request, const char* path);
+
+    // Ruta pública (sin autenticación) para un archivo
+    void serve(AsyncWebServer& server, const char* path);
+
+    uint8_t getAssetCount() const { return assetCount; }
+    void getStatus(JsonObject obj) const;
+};
+
+// Instancia global
+extern WebAssets Assets;
+
+#endif // WEB_ASSETS_H
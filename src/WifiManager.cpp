@@ -1,4 +1,5 @@
 #include "WifiManager.h"
+#include "DeferredQueue.h"
 
 WifiManager WiFiMgr;
 static WifiManager* wifiInstance = nullptr;
@@ -46,7 +47,7 @@ bool WifiManager::begin(const char* ssid, const char* password) {
         
         // Programar reconexión
         if (reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-            reconnectTimer.once(WIFI_RECONNECT_INTERVAL / 1000, reconnectTimerCallback);
+            reconnectTimer.once(WIFI_RECONNECT_INTERVAL / 1000, []() { Deferred.post(reconnectTimerCallback); });
         } else {
             SystemLogger.error("Máximo de intentos de reconexión alcanzado", "WIFI");
             currentState = WIFI_STATE_ERROR;
@@ -1,9 +1,8 @@
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
-#include <ESP8266WiFi.h>
+#include "hal/Platform.h"
 #include <ESP8266mDNS.h>
-#include <Ticker.h>
 #include "config.h"
 #include "Logger.h"
 
@@ -14,7 +14,10 @@
 // =============================
 #define WEB_SERVER_PORT 80
 #define JSON_BUFFER_SIZE 2048
-#define MAX_LUCES 100  // Máximo número de luminarias
+#ifndef MAX_LUCES
+#define MAX_LUCES 160  // Máximo número de luminarias (~57 bytes de RAM estática por luminaria)
+#define RAM_BUDGET_CHECK  // Tamaños del firmware: RamBudget.cpp los verifica al compilar
+#endif
 
 // =============================
 // CONFIGURACIÓN SERIAL
@@ -40,6 +43,7 @@
 #define DEFAULT_LAT -33.301726
 #define DEFAULT_LNG -66.337752
 #define DEFAULT_ZOOM 13
+#define NOMINAL_VOLTAGE 220.0  // Tensión de red para estimar corriente sin medición
 
 // =============================
 // CONFIGURACIÓN DE SEGURIDAD
@@ -63,6 +67,15 @@
 // =============================
 #define WATCHDOG_TIMEOUT 8000  // Watchdog timeout en ms
 #define FREE_HEAP_THRESHOLD 10000  // Umbral mínimo de heap libre
+// RAM estática (.data + .bss) de las instancias globales de la aplicación.
+// Con WiFi, lwIP y el core cargados el ESP8266 deja ~50 KB para las variables
+// globales y el heap: el presupuesto reserva al menos 14 KB de heap al arrancar
+// (FREE_HEAP_THRESHOLD más las conexiones HTTP y los documentos JSON).
+// RamBudget.cpp lo verifica al compilar en todos los entornos con los tamaños
+// del firmware; las del servidor web (solo las compila main.cpp) entran en
+// WEB_STATIC_RAM_RESERVE.
+#define STATIC_RAM_BUDGET 36864
+#define WEB_STATIC_RAM_RESERVE 5120
 
 // =============================
 // CONFIGURACIÓN OTA (Over-The-Air)
@@ -0,0 +1,35 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// =============================
+// CAPA DE ABSTRACCIÓN DE HARDWARE
+// =============================
+// Los managers incluyen este archivo en lugar de ESP8266WiFi.h, LittleFS.h,
+// ESP8266HTTPClient.h y Ticker.h. Solo deben usar de esas APIs lo que el
+// backend POSIX también implementa:
+//
+//   Núcleo:   millis/micros/delay/yield, random, String, Serial, ESP.getFreeHeap
+//   Archivos: LittleFS (open/exists/remove/rename/mkdir/openDir/info), File, Dir
+//   Red:      WiFi (status/localIP/macAddress/RSSI), WiFiClient, HTTPClient
+//   Timers:   Ticker (attach/attach_ms/once/once_ms/detach)
+//
+// En el ESP8266 se usan las bibliotecas del core. Con PLATFORM_POSIX
+// (env:native_sim) el sistema de archivos es un directorio, el tiempo es
+// CLOCK_MONOTONIC y la red son sockets; ver src/hal/posix/.
+
+#if defined(PLATFORM_POSIX)
+  #include <Arduino.h>             // src/hal/posix/Arduino.h
+  #include "posix/PosixFS.h"
+  #include "posix/PosixNet.h"
+  #include "posix/PosixTicker.h"
+  #define PLATFORM_NAME "posix"
+#else
+  #include <Arduino.h>
+  #include <LittleFS.h>
+  #include <ESP8266WiFi.h>
+  #include <ESP8266HTTPClient.h>
+  #include <Ticker.h>
+  #define PLATFORM_NAME "esp8266"
+#endif
+
+#endif // PLATFORM_H
@@ -0,0 +1,131 @@
+#ifndef POSIX_ARDUINO_H
+#define POSIX_ARDUINO_H
+
+// Núcleo Arduino mínimo para el backend POSIX. Cubre lo que usan los
+// managers y las bibliotecas de lib_deps (ArduinoJson, PubSubClient, Time,
+// Crypto); no pretende ser un core completo.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+// Memoria de programa: en POSIX todo es RAM
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef PGM_P
+#define PGM_P const char*
+#endif
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+#define pgm_read_word(addr) (*(const unsigned short*)(addr))
+#define pgm_read_dword(addr) (*(const unsigned long*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define strcpy_P(dest, src) strcpy((dest), (src))
+#define strlen_P(s) strlen(s)
+#define memcpy_P(dest, src, n) memcpy((dest), (src), (n))
+
+// Constantes y utilidades
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define sq(x) ((x) * (x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// Tiempo (CLOCK_MONOTONIC desde el arranque del proceso)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();  // Atiende los Ticker vencidos, como el SDK en el ESP8266
+
+// Números aleatorios
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t posixRandom32();
+#define RANDOM_REG32 (posixRandom32())
+
+// GPIO: sin efecto, solo para que compile el código de LEDs/botones
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define LOW 0x0
+#define HIGH 0x1
+#define LED_BUILTIN 2
+#define D3 0
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void analogWrite(uint8_t, int) {}
+inline int analogRead(uint8_t) { return 0; }
+
+// Consola: Serial escribe en stdout
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    void setDebugOutput(bool) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override;
+
+    using Print::write;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Equivalente de la clase ESP: el heap se reporta como un valor fijo
+// configurable para que las alertas de memoria se comporten como en placa
+class EspClass {
+private:
+    uint32_t simulatedHeap;
+
+public:
+    EspClass() : simulatedHeap(40960) {}
+
+    uint32_t getFreeHeap() { return simulatedHeap; }
+    uint32_t getMaxFreeBlockSize() { return simulatedHeap; }
+    uint8_t getHeapFragmentation() { return 0; }
+    void setSimulatedHeap(uint32_t bytes) { simulatedHeap = bytes; }
+
+    uint32_t getChipId();
+    uint8_t getCpuFreqMHz() { return 80; }
+    const char* getSdkVersion() { return "posix"; }
+    uint32_t getFlashChipSize() { return 4 * 1024 * 1024; }
+    uint32_t getFlashChipRealSize() { return 4 * 1024 * 1024; }
+    uint32_t getSketchSize() { return 0; }
+    uint32_t getFreeSketchSpace() { return 0; }
+
+    void wdtFeed() {}
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // POSIX_ARDUINO_H
@@ -0,0 +1,47 @@
+#ifndef POSIX_IPADDRESS_H
+#define POSIX_IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "WString.h"
+
+// Dirección IPv4 (octetos en orden de red)
+class IPAddress {
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress() { octets[0] = octets[1] = octets[2] = octets[3] = 0; }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        octets[0] = a; octets[1] = b; octets[2] = c; octets[3] = d;
+    }
+    IPAddress(uint32_t address) { memcpy(octets, &address, 4); }
+    IPAddress(const uint8_t* address) { memcpy(octets, address, 4); }
+
+    operator uint32_t() const { uint32_t v; memcpy(&v, octets, 4); return v; }
+    uint8_t operator[](int index) const { return octets[index]; }
+    uint8_t& operator[](int index) { return octets[index]; }
+    bool operator==(const IPAddress& other) const { return memcmp(octets, other.octets, 4) == 0; }
+    bool operator!=(const IPAddress& other) const { return !(*this == other); }
+
+    bool isSet() const { return (uint32_t)*this != 0; }
+
+    bool fromString(const char* address) {
+        unsigned int a, b, c, d;
+        char extra;
+        if (sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4) return false;
+        if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+        octets[0] = a; octets[1] = b; octets[2] = c; octets[3] = d;
+        return true;
+    }
+    bool fromString(const String& address) { return fromString(address.c_str()); }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(buf);
+    }
+};
+
+#endif // POSIX_IPADDRESS_H
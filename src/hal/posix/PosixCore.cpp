@@ -0,0 +1,325 @@
+#if defined(PLATFORM_POSIX)
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <random>
+#include "PosixTicker.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// === TIEMPO ===
+
+static uint64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Local a la función: los constructores globales pueden llamar a millis()
+static uint64_t bootMicros() {
+    static const uint64_t boot = monotonicMicros();
+    return boot;
+}
+
+// Se truncan a 32 bits como en el ESP8266: el desborde a los ~49 días
+// ejercita el mismo código de comparación por diferencia
+unsigned long millis() {
+    return (uint32_t)((monotonicMicros() - bootMicros()) / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t)(monotonicMicros() - bootMicros());
+}
+
+void delay(unsigned long ms) {
+    unsigned long start = millis();
+    yield();
+    while (millis() - start < ms) {
+        usleep(1000);
+        yield();
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+    usleep(us);
+}
+
+void yield() {
+    Ticker::poll();
+}
+
+// === ALEATORIOS ===
+
+static std::mt19937& generator() {
+    static std::mt19937 gen(std::random_device{}());
+    return gen;
+}
+
+long random(long max) {
+    if (max <= 0) return 0;
+    return std::uniform_int_distribution<long>(0, max - 1)(generator());
+}
+
+long random(long min, long max) {
+    if (min >= max) return min;
+    return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    generator().seed(seed);
+}
+
+uint32_t posixRandom32() {
+    return generator()();
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    if (inMax == inMin) return outMin;
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// === SERIAL / ESP ===
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+uint32_t EspClass::getChipId() {
+    // Estable por proceso para que los clientId MQTT no choquen entre instancias
+    return (uint32_t)getpid() & 0xFFFFFF;
+}
+
+void EspClass::restart() {
+    Serial.println("[SIM] ESP.restart(): fin del proceso");
+    Serial.flush();
+    exit(0);
+}
+
+// === PRINT / STREAM ===
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+    char stackBuffer[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(stackBuffer)) return write((const uint8_t*)stackBuffer, len);
+
+    std::string heapBuffer(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&heapBuffer[0], len + 1, format, args);
+    va_end(args);
+    return write((const uint8_t*)heapBuffer.data(), len);
+}
+
+int Stream::timedRead() {
+    unsigned long start = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        yield();
+    } while (millis() - start < timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0 || c == terminator) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    String result;
+    int c;
+    while ((c = timedRead()) >= 0) result += (char)c;
+    return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) result += (char)c;
+    return result;
+}
+
+// === STRING ===
+
+void String::assignNumber(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[66];
+    char* p = buf + sizeof(buf) - 1;
+    *p = '\0';
+    do {
+        unsigned digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value);
+    if (negative) *--p = '-';
+    buffer = p;
+}
+
+String::String(unsigned char value, unsigned char base) { assignNumber(value, false, base); }
+String::String(unsigned int value, unsigned char base) { assignNumber(value, false, base); }
+String::String(unsigned long value, unsigned char base) { assignNumber(value, false, base); }
+String::String(unsigned long long value, unsigned char base) { assignNumber(value, false, base); }
+
+// Como en Arduino, el signo solo se aplica en base 10
+String::String(int value, unsigned char base) : String((long long)value, base) {}
+String::String(long value, unsigned char base) : String((long long)value, base) {}
+String::String(long long value, unsigned char base) {
+    if (base == 10 && value < 0) assignNumber(0ULL - (unsigned long long)value, true, base);
+    else assignNumber((unsigned long long)value, false, base);
+}
+
+String::String(float value, unsigned char decimalPlaces) : String((double)value, decimalPlaces) {}
+String::String(double value, unsigned char decimalPlaces) {
+    if (isnan(value)) { buffer = "nan"; return; }
+    if (isinf(value)) { buffer = value < 0 ? "-inf" : "inf"; return; }
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    buffer = buf;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    if (buffer.length() != s.buffer.length()) return false;
+    for (size_t i = 0; i < buffer.length(); i++) {
+        if (tolower((unsigned char)buffer[i]) != tolower((unsigned char)s.buffer[i])) return false;
+    }
+    return true;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    if (offset > buffer.length() || prefix.buffer.length() > buffer.length() - offset) return false;
+    return buffer.compare(offset, prefix.buffer.length(), prefix.buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.buffer.length() > buffer.length()) return false;
+    return buffer.compare(buffer.length() - suffix.buffer.length(), suffix.buffer.length(), suffix.buffer) == 0;
+}
+
+char& String::operator[](unsigned int index) {
+    static char dummy;
+    if (index >= buffer.length()) {
+        dummy = 0;
+        return dummy;
+    }
+    return buffer[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+    if (!bufsize || !buf) return;
+    if (index >= buffer.length()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = std::min((size_t)bufsize - 1, buffer.length() - index);
+    memcpy(buf, buffer.data() + index, n);
+    buf[n] = 0;
+}
+
+int String::indexOf(char c, unsigned int fromIndex) const {
+    size_t pos = buffer.find(c, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& s, unsigned int fromIndex) const {
+    size_t pos = buffer.find(s.buffer, fromIndex);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t pos = buffer.rfind(c);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& s) const {
+    size_t pos = buffer.rfind(s.buffer);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+    if (beginIndex >= buffer.length()) return String();
+    if (endIndex > buffer.length()) endIndex = buffer.length();
+    return String(buffer.data() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replaceWith) {
+    std::replace(buffer.begin(), buffer.end(), find, replaceWith);
+}
+
+void String::replace(const String& find, const String& replaceWith) {
+    if (find.buffer.empty()) return;
+    size_t pos = 0;
+    while ((pos = buffer.find(find.buffer, pos)) != std::string::npos) {
+        buffer.replace(pos, find.buffer.length(), replaceWith.buffer);
+        pos += replaceWith.buffer.length();
+    }
+}
+
+void String::toLowerCase() {
+    for (char& c : buffer) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : buffer) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < buffer.length() && isspace((unsigned char)buffer[first])) first++;
+    size_t last = buffer.length();
+    while (last > first && isspace((unsigned char)buffer[last - 1])) last--;
+    buffer = buffer.substr(first, last - first);
+}
+
+String operator+(const String& lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, const char* rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const char* lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, char rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, float rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, double rhs) { String r(lhs); r.concat(rhs); return r; }
+
+#endif // PLATFORM_POSIX
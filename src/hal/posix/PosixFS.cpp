@@ -0,0 +1,240 @@
+#if defined(PLATFORM_POSIX)
+
+#include "PosixFS.h"
+#include <dirent.h>
+#include <errno.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Capacidad reportada por info(): la partición LittleFS de 2 MB del
+// layout eagle.flash.4m2m.ld
+#define POSIX_FS_CAPACITY (2 * 1024 * 1024)
+#define POSIX_FS_BLOCK_SIZE 8192
+#define POSIX_FS_PAGE_SIZE 256
+#define POSIX_FS_MAX_PATH 31
+
+fs::FS LittleFS;
+
+namespace fs {
+
+// === FILE ===
+
+File::File(FILE* f, const String& fullPath) : handle(f, fclose), path(fullPath), directory(false) {}
+
+size_t File::write(uint8_t c) {
+    return handle ? fwrite(&c, 1, 1, handle.get()) : 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    return handle ? fwrite(buffer, 1, size, handle.get()) : 0;
+}
+
+int File::available() {
+    if (!handle) return 0;
+    long remaining = (long)size() - (long)position();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+int File::read() {
+    if (!handle) return -1;
+    int c = fgetc(handle.get());
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!handle) return -1;
+    int c = fgetc(handle.get());
+    if (c == EOF) return -1;
+    ungetc(c, handle.get());
+    return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    return handle ? fread(buffer, 1, size, handle.get()) : 0;
+}
+
+void File::flush() {
+    if (handle) fflush(handle.get());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!handle) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+    return fseek(handle.get(), pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!handle) return 0;
+    long pos = ftell(handle.get());
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!handle) return 0;
+    fflush(handle.get());
+    struct stat st;
+    if (fstat(fileno(handle.get()), &st) != 0) return 0;
+    return st.st_size;
+}
+
+bool File::truncate(uint32_t size) {
+    if (!handle) return false;
+    fflush(handle.get());
+    return ftruncate(fileno(handle.get()), size) == 0;
+}
+
+void File::close() {
+    handle.reset();
+    directory = false;
+}
+
+const char* File::name() const {
+    int slash = path.lastIndexOf('/');
+    return slash < 0 ? path.c_str() : path.c_str() + slash + 1;
+}
+
+// === DIR ===
+
+Dir::Dir(const String& dirPath, const String& hostPath) : path(dirPath), hostDir(hostPath), index(0) {
+    DIR* d = opendir(hostPath.c_str());
+    if (!d) return;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        entries.push_back(String(entry->d_name));
+    }
+    closedir(d);
+}
+
+bool Dir::next() {
+    if (index >= entries.size()) return false;
+    current = entries[index++];
+    return true;
+}
+
+size_t Dir::fileSize() const {
+    struct stat st;
+    if (stat((hostDir + "/" + current).c_str(), &st) != 0) return 0;
+    return S_ISREG(st.st_mode) ? st.st_size : 0;
+}
+
+bool Dir::isFile() const {
+    struct stat st;
+    return stat((hostDir + "/" + current).c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool Dir::isDirectory() const {
+    struct stat st;
+    return stat((hostDir + "/" + current).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+File Dir::openFile(const char* mode) const {
+    String separator = path.endsWith("/") ? "" : "/";
+    return LittleFS.open(path + separator + current, mode);
+}
+
+// === FS ===
+
+FS::FS() : capacity(POSIX_FS_CAPACITY) {
+    const char* env = getenv("SIM_FS_ROOT");
+    root = env ? env : "./sim_fs";
+}
+
+String FS::hostPath(const char* path) const {
+    if (!path || !*path) return root;
+    return path[0] == '/' ? root + path : root + "/" + path;
+}
+
+static bool makeDirs(const String& hostPath) {
+    // mkdir -p: crea cada componente intermedio
+    for (int slash = hostPath.indexOf('/', 1); slash > 0; slash = hostPath.indexOf('/', slash + 1)) {
+        String partial = hostPath.substring(0, slash);
+        if (::mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    }
+    return ::mkdir(hostPath.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::begin() {
+    return makeDirs(root);
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+    return ::remove(path);
+}
+
+bool FS::format() {
+    nftw(root.c_str(), removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    return begin();
+}
+
+static size_t usedBytes;
+
+static int sumEntry(const char*, const struct stat* st, int type, struct FTW*) {
+    // LittleFS ocupa al menos un bloque por archivo
+    if (type == FTW_F) {
+        size_t blocks = (st->st_size + POSIX_FS_BLOCK_SIZE - 1) / POSIX_FS_BLOCK_SIZE;
+        usedBytes += (blocks ? blocks : 1) * POSIX_FS_BLOCK_SIZE;
+    }
+    return 0;
+}
+
+bool FS::info(FSInfo& info) {
+    usedBytes = 0;
+    nftw(root.c_str(), sumEntry, 16, FTW_PHYS);
+    info.totalBytes = capacity;
+    info.usedBytes = usedBytes;
+    info.blockSize = POSIX_FS_BLOCK_SIZE;
+    info.pageSize = POSIX_FS_PAGE_SIZE;
+    info.maxOpenFiles = 5;
+    info.maxPathLength = POSIX_FS_MAX_PATH;
+    return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+    String full = hostPath(path);
+
+    struct stat st;
+    if (stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        return File(String(path), true);
+    }
+
+    // Como LittleFS en el ESP8266: abrir para escritura crea los directorios
+    if (mode[0] == 'w' || mode[0] == 'a') {
+        int slash = full.lastIndexOf('/');
+        if (slash > 0) makeDirs(full.substring(0, slash));
+    }
+
+    FILE* f = fopen(full.c_str(), mode);
+    if (!f) return File();
+    return File(f, String(path));
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return makeDirs(hostPath(path));
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+Dir FS::openDir(const char* path) {
+    return Dir(String(path), hostPath(path));
+}
+
+} // namespace fs
+
+#endif // PLATFORM_POSIX
@@ -0,0 +1,131 @@
+#ifndef POSIX_FS_H
+#define POSIX_FS_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+// LittleFS sobre un directorio del host. Las rutas "/db/events.json" se
+// resuelven dentro de la raíz configurada con LittleFS.setRoot() (por
+// defecto ./sim_fs o la variable de entorno SIM_FS_ROOT).
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+struct FSInfo {
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+class File : public Stream {
+private:
+    std::shared_ptr<FILE> handle;  // Compartido entre copias, como en el core
+    String path;
+    bool directory;
+
+public:
+    File() : directory(false) {}
+    File(FILE* f, const String& fullPath);
+    File(const String& fullPath, bool isDir) : path(fullPath), directory(isDir) {}
+
+    // Print / Stream
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t readBytes(char* buffer, size_t length) override { return read((uint8_t*)buffer, length); }
+    using Print::write;
+
+    size_t read(uint8_t* buffer, size_t size);
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    bool truncate(uint32_t size);
+    void close();
+    operator bool() const { return handle != nullptr || directory; }
+
+    const char* name() const;
+    const char* fullName() const { return path.c_str(); }
+    bool isFile() const { return handle != nullptr; }
+    bool isDirectory() const { return directory; }
+};
+
+class Dir {
+private:
+    String path;      // Ruta dentro de LittleFS
+    String hostDir;   // Directorio real en el host
+    std::vector<String> entries;
+    size_t index;
+    String current;
+
+public:
+    Dir() : index(0) {}
+    Dir(const String& dirPath, const String& hostPath);
+
+    bool next();
+    String fileName() const { return current; }
+    size_t fileSize() const;
+    bool isFile() const;
+    bool isDirectory() const;
+    File openFile(const char* mode) const;
+};
+
+class FS {
+private:
+    String root;
+    size_t capacity;
+
+public:
+    FS();
+
+    void setRoot(const char* hostPath) { root = hostPath; }
+    const String& getRoot() const { return root; }
+    String hostPath(const char* path) const;
+
+    bool begin();
+    void end() {}
+    bool format();
+    bool info(FSInfo& info);
+
+    File open(const char* path, const char* mode);
+    File open(const String& path, const char* mode) { return open(path.c_str(), mode); }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path) { return rmdir(path.c_str()); }
+    Dir openDir(const char* path);
+    Dir openDir(const String& path) { return openDir(path.c_str()); }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::Dir;
+using fs::FS;
+using fs::FSInfo;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+extern fs::FS LittleFS;
+
+#endif // POSIX_FS_H
@@ -0,0 +1,255 @@
+#if defined(PLATFORM_POSIX)
+
+#include "PosixNet.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#define POSIX_CONNECT_TIMEOUT 3000  // ms
+#define HTTP_RESPONSE_MAX 4096
+
+WiFiClass WiFi;
+
+String WiFiClass::macAddress() {
+    uint32_t id = ESP.getChipId();
+    char mac[18];
+    snprintf(mac, sizeof(mac), "02:00:00:%02X:%02X:%02X",
+             (unsigned)(id >> 16) & 0xFF, (unsigned)(id >> 8) & 0xFF, (unsigned)id & 0xFF);
+    return String(mac);
+}
+
+// === WIFICLIENT ===
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host, service, &hints, &result) != 0 || !result) return 0;
+
+    int s = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (s < 0) {
+        freeaddrinfo(result);
+        return 0;
+    }
+
+    // Conexión no bloqueante con timeout, como lwIP en el ESP8266
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+    int rc = ::connect(s, result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+
+    if (rc != 0 && errno != EINPROGRESS) {
+        close(s);
+        return 0;
+    }
+
+    if (rc != 0) {
+        struct pollfd pfd = { s, POLLOUT, 0 };
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (poll(&pfd, 1, POSIX_CONNECT_TIMEOUT) <= 0 ||
+            getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &len) != 0 || error != 0) {
+            close(s);
+            return 0;
+        }
+    }
+
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd = s;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (fd < 0) return 0;
+
+    size_t sent = 0;
+    unsigned long start = millis();
+    while (sent < size) {
+        ssize_t n = send(fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && millis() - start < timeout) {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            poll(&pfd, 1, 10);
+            continue;
+        }
+        stop();
+        break;
+    }
+    return sent;
+}
+
+bool WiFiClient::fill() {
+    if (peeked >= 0) return true;
+    if (fd < 0) return false;
+
+    uint8_t c;
+    ssize_t n = recv(fd, &c, 1, 0);
+    if (n == 1) {
+        peeked = c;
+        return true;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) stop();
+    return false;
+}
+
+int WiFiClient::available() {
+    if (fd < 0) return peeked >= 0 ? 1 : 0;
+    int pending = 0;
+    if (ioctl(fd, FIONREAD, &pending) != 0) pending = 0;
+    if (pending == 0 && peeked < 0) {
+        // Sin datos: detectar si el otro extremo cerró
+        fill();
+    }
+    return pending + (peeked >= 0 ? 1 : 0);
+}
+
+int WiFiClient::read() {
+    if (!fill()) return -1;
+    int c = peeked;
+    peeked = -1;
+    return c;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    if (size == 0) return 0;
+
+    size_t count = 0;
+    if (peeked >= 0) {
+        buffer[count++] = peeked;
+        peeked = -1;
+    }
+    if (fd >= 0 && count < size) {
+        ssize_t n = recv(fd, buffer + count, size - count, 0);
+        if (n > 0) count += n;
+        else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) stop();
+    }
+    return count ? (int)count : -1;
+}
+
+int WiFiClient::peek() {
+    return fill() ? peeked : -1;
+}
+
+void WiFiClient::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+uint8_t WiFiClient::connected() {
+    if (peeked >= 0) return 1;
+    if (fd < 0) return 0;
+    available();
+    return fd >= 0 || peeked >= 0;
+}
+
+// === HTTPCLIENT ===
+
+bool HTTPClient::begin(WiFiClient& wifiClient, const String& url) {
+    client = &wifiClient;
+    headers = "";
+    response = "";
+    valid = false;
+
+    if (!url.startsWith("http://")) return false;  // Sin TLS en la simulación
+
+    String rest = url.substring(7);
+    int slash = rest.indexOf('/');
+    String hostPort = slash < 0 ? rest : rest.substring(0, slash);
+    path = slash < 0 ? String("/") : rest.substring(slash);
+
+    int colon = hostPort.indexOf(':');
+    host = colon < 0 ? hostPort : hostPort.substring(0, colon);
+    port = colon < 0 ? 80 : (uint16_t)hostPort.substring(colon + 1).toInt();
+    valid = host.length() > 0 && port > 0;
+    return valid;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+    headers += name + ": " + value + "\r\n";
+}
+
+int HTTPClient::sendRequest(const char* method, const String& payload) {
+    if (!valid || !client) return HTTPC_ERROR_CONNECTION_FAILED;
+    if (!client->connect(host.c_str(), port)) return HTTPC_ERROR_CONNECTION_FAILED;
+
+    String request = String(method) + " " + path + " HTTP/1.0\r\n" +
+                     "Host: " + host + "\r\n" +
+                     "Connection: close\r\n" +
+                     headers;
+    if (payload.length()) request += "Content-Length: " + String(payload.length()) + "\r\n";
+    request += "\r\n";
+
+    if (client->write((const uint8_t*)request.c_str(), request.length()) != request.length()) {
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+    if (payload.length() &&
+        client->write((const uint8_t*)payload.c_str(), payload.length()) != payload.length()) {
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+
+    // HTTP/1.0 con Connection: close -> leer hasta que el servidor cierre
+    String raw;
+    unsigned long start = millis();
+    while (client->connected() && raw.length() < HTTP_RESPONSE_MAX) {
+        int c = client->read();
+        if (c >= 0) {
+            raw += (char)c;
+            start = millis();
+        } else if (millis() - start > client->getTimeout()) {
+            client->stop();
+            return HTTPC_ERROR_READ_TIMEOUT;
+        } else {
+            delay(1);
+        }
+    }
+
+    int space = raw.indexOf(' ');
+    if (!raw.startsWith("HTTP/") || space < 0) return HTTPC_ERROR_CONNECTION_LOST;
+
+    int bodyStart = raw.indexOf("\r\n\r\n");
+    response = bodyStart < 0 ? String() : raw.substring(bodyStart + 4);
+    return (int)raw.substring(space + 1, space + 4).toInt();
+}
+
+void HTTPClient::end() {
+    if (client) client->stop();
+    client = nullptr;
+    valid = false;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_FAILED: return String("connection failed");
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return String("send header failed");
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return String("send payload failed");
+        case HTTPC_ERROR_NOT_CONNECTED: return String("not connected");
+        case HTTPC_ERROR_CONNECTION_LOST: return String("connection lost");
+        case HTTPC_ERROR_READ_TIMEOUT: return String("read Timeout");
+        default: return String();
+    }
+}
+
+#endif // PLATFORM_POSIX
@@ -0,0 +1,122 @@
+#ifndef POSIX_NET_H
+#define POSIX_NET_H
+
+#include <Arduino.h>
+#include "Client.h"
+
+// Red del backend POSIX: la "WiFi" siempre está conectada a la interfaz
+// de loopback y WiFiClient es un socket TCP no bloqueante del host.
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_WRONG_PASSWORD = 6,
+    WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+class WiFiClass {
+private:
+    wl_status_t currentStatus;
+    WiFiMode_t currentMode;
+    String hostName;
+
+public:
+    WiFiClass() : currentStatus(WL_CONNECTED), currentMode(WIFI_STA), hostName("sim") {}
+
+    wl_status_t begin(const char*, const char* = nullptr) { currentStatus = WL_CONNECTED; return currentStatus; }
+    wl_status_t status() { return currentStatus; }
+    bool isConnected() { return currentStatus == WL_CONNECTED; }
+    bool disconnect(bool = false) { currentStatus = WL_DISCONNECTED; return true; }
+    bool reconnect() { currentStatus = WL_CONNECTED; return true; }
+    bool mode(WiFiMode_t m) { currentMode = m; return true; }
+    WiFiMode_t getMode() { return currentMode; }
+    bool hostname(const char* name) { hostName = name; return true; }
+    String hostname() { return hostName; }
+
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+    String macAddress();
+    String SSID() { return String("posix-loopback"); }
+    int32_t RSSI() { return -50; }
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Client {
+private:
+    int fd;
+    int peeked;  // Byte leído por peek(), -1 si no hay
+
+    bool fill();
+
+public:
+    WiFiClient() : fd(-1), peeked(-1) {}
+    ~WiFiClient() override { stop(); }
+    WiFiClient(const WiFiClient&) = delete;
+    WiFiClient& operator=(const WiFiClient&) = delete;
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    int connect(const String& host, uint16_t port) { return connect(host.c_str(), port); }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+    using Print::write;
+};
+
+// Códigos de error de ESP8266HTTPClient
+#define HTTPC_ERROR_CONNECTION_FAILED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTP_CODE_OK 200
+
+// Cliente HTTP/1.0 mínimo (sin TLS): alcanza para los webhooks de alertas
+class HTTPClient {
+private:
+    WiFiClient* client;
+    String host;
+    uint16_t port;
+    String path;
+    String headers;
+    String response;
+    bool valid;
+
+    int sendRequest(const char* method, const String& payload);
+
+public:
+    HTTPClient() : client(nullptr), port(80), valid(false) {}
+
+    bool begin(WiFiClient& wifiClient, const String& url);
+    void addHeader(const String& name, const String& value);
+    int GET() { return sendRequest("GET", String()); }
+    int POST(const String& payload) { return sendRequest("POST", payload); }
+    const String& getString() { return response; }
+    void end();
+
+    static String errorToString(int error);
+};
+
+#endif // POSIX_NET_H
@@ -0,0 +1,66 @@
+#if defined(PLATFORM_POSIX)
+
+#include "PosixTicker.h"
+#include <vector>
+
+// Ticker vivos; el orden de registro define el orden de ejecución
+static std::vector<Ticker*>& registry() {
+    static std::vector<Ticker*> tickers;
+    return tickers;
+}
+
+Ticker::Ticker() : period(0), nextRun(0), repeat(false), armed(false) {
+    registry().push_back(this);
+}
+
+Ticker::~Ticker() {
+    std::vector<Ticker*>& tickers = registry();
+    for (size_t i = 0; i < tickers.size(); i++) {
+        if (tickers[i] == this) {
+            tickers.erase(tickers.begin() + i);
+            break;
+        }
+    }
+}
+
+void Ticker::arm(uint32_t milliseconds, bool repeating, callback_function_t cb) {
+    callback = cb;
+    period = milliseconds;
+    repeat = repeating;
+    nextRun = millis() + milliseconds;
+    armed = true;
+}
+
+void Ticker::detach() {
+    armed = false;
+    callback = nullptr;
+}
+
+void Ticker::poll() {
+    // Un callback que llama a delay() vuelve a entrar acá: no anidar
+    static bool running = false;
+    if (running) return;
+    running = true;
+
+    uint32_t now = millis();
+    std::vector<Ticker*>& tickers = registry();
+    for (size_t i = 0; i < tickers.size(); i++) {
+        Ticker* t = tickers[i];
+        if (!t->armed || (int32_t)(now - t->nextRun) < 0) continue;
+
+        // Copia: el callback puede hacer detach() o volver a armar el Ticker
+        callback_function_t cb = t->callback;
+        if (t->repeat) {
+            t->nextRun += t->period;
+            // Si el bucle estuvo bloqueado, no disparar en ráfaga
+            if ((int32_t)(now - t->nextRun) >= 0) t->nextRun = now + t->period;
+        } else {
+            t->armed = false;
+        }
+        if (cb) cb();
+    }
+
+    running = false;
+}
+
+#endif // PLATFORM_POSIX
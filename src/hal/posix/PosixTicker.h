@@ -0,0 +1,45 @@
+#ifndef POSIX_TICKER_H
+#define POSIX_TICKER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Ticker del backend POSIX. En el ESP8266 los callbacks corren en el
+// contexto del SDK entre iteraciones de loop(); acá los ejecuta yield()
+// (llamado por delay() y por el bucle principal de la simulación).
+class Ticker {
+public:
+    typedef std::function<void(void)> callback_function_t;
+
+    Ticker();
+    ~Ticker();
+    Ticker(const Ticker&) = delete;
+    Ticker& operator=(const Ticker&) = delete;
+
+    void attach(float seconds, callback_function_t callback) { arm((uint32_t)(seconds * 1000), true, callback); }
+    void attach_ms(uint32_t milliseconds, callback_function_t callback) { arm(milliseconds, true, callback); }
+    void once(float seconds, callback_function_t callback) { arm((uint32_t)(seconds * 1000), false, callback); }
+    void once_ms(uint32_t milliseconds, callback_function_t callback) { arm(milliseconds, false, callback); }
+
+    template <typename TArg>
+    void attach(float seconds, void (*callback)(TArg), TArg arg) { attach(seconds, std::bind(callback, arg)); }
+    template <typename TArg>
+    void attach_ms(uint32_t milliseconds, void (*callback)(TArg), TArg arg) { attach_ms(milliseconds, std::bind(callback, arg)); }
+
+    void detach();
+    bool active() const { return armed; }
+
+    // Ejecuta los Ticker vencidos (lo llama yield())
+    static void poll();
+
+private:
+    callback_function_t callback;
+    uint32_t period;
+    uint32_t nextRun;
+    bool repeat;
+    bool armed;
+
+    void arm(uint32_t milliseconds, bool repeating, callback_function_t cb);
+};
+
+#endif // POSIX_TICKER_H
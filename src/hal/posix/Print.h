@@ -0,0 +1,38 @@
+#ifndef POSIX_PRINT_H
+#define POSIX_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "WString.h"
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual void flush() {}
+
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(const char* str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print(String(value, base)); }
+    size_t print(int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String(value, base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int digits = 2) { return print(String(value, digits)); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(const T& value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+#endif // POSIX_PRINT_H
@@ -0,0 +1,31 @@
+#ifndef POSIX_STREAM_H
+#define POSIX_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+    unsigned long timeout;
+
+    int timedRead();
+
+public:
+    Stream() : timeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout = ms; }
+    unsigned long getTimeout() const { return timeout; }
+
+    // Esperan hasta `timeout` ms por cada byte, como en Arduino. Las
+    // clases con datos ya disponibles (File) las redefinen sin espera.
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+};
+
+#endif // POSIX_STREAM_H
@@ -0,0 +1,135 @@
+#ifndef POSIX_WSTRING_H
+#define POSIX_WSTRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// String de Arduino sobre std::string. Misma interfaz pública que el core
+// del ESP8266 (constructores numéricos explicit, índices unsigned int,
+// substring/indexOf con -1 como "no encontrado").
+class String {
+private:
+    std::string buffer;
+
+    void assignNumber(unsigned long long value, bool negative, unsigned char base);
+
+public:
+    String() {}
+    String(const char* cstr) { if (cstr) buffer = cstr; }
+    String(const char* cstr, unsigned int length) { if (cstr) buffer.assign(cstr, length); }
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : buffer(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned char decimalPlaces = 2);
+    explicit String(double value, unsigned char decimalPlaces = 2);
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* cstr) { if (cstr) buffer = cstr; else buffer.clear(); return *this; }
+
+    // Memoria
+    bool reserve(unsigned int size) { buffer.reserve(size); return true; }
+    unsigned int length() const { return buffer.length(); }
+    bool isEmpty() const { return buffer.empty(); }
+    const char* c_str() const { return buffer.c_str(); }
+    char* begin() { return &buffer[0]; }
+    char* end() { return &buffer[0] + buffer.length(); }
+    const char* begin() const { return c_str(); }
+    const char* end() const { return c_str() + buffer.length(); }
+
+    // Concatenación
+    bool concat(const String& s) { buffer += s.buffer; return true; }
+    bool concat(const char* cstr) { if (!cstr) return false; buffer += cstr; return true; }
+    bool concat(const char* cstr, unsigned int length) { if (!cstr) return false; buffer.append(cstr, length); return true; }
+    bool concat(char c) { buffer += c; return true; }
+    bool concat(unsigned char value) { return concat(String(value)); }
+    bool concat(int value) { return concat(String(value)); }
+    bool concat(unsigned int value) { return concat(String(value)); }
+    bool concat(long value) { return concat(String(value)); }
+    bool concat(unsigned long value) { return concat(String(value)); }
+    bool concat(long long value) { return concat(String(value)); }
+    bool concat(unsigned long long value) { return concat(String(value)); }
+    bool concat(float value) { return concat(String(value)); }
+    bool concat(double value) { return concat(String(value)); }
+
+    template <typename T>
+    String& operator+=(const T& value) { concat(value); return *this; }
+
+    // Comparación
+    int compareTo(const String& s) const { return buffer.compare(s.buffer); }
+    bool equals(const String& s) const { return buffer == s.buffer; }
+    bool equals(const char* cstr) const { return cstr ? buffer == cstr : buffer.empty(); }
+    bool equalsIgnoreCase(const String& s) const;
+    bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    bool operator==(const String& s) const { return equals(s); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& s) const { return !equals(s); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& s) const { return compareTo(s) < 0; }
+    bool operator>(const String& s) const { return compareTo(s) > 0; }
+    bool operator<=(const String& s) const { return compareTo(s) <= 0; }
+    bool operator>=(const String& s) const { return compareTo(s) >= 0; }
+
+    // Acceso a caracteres
+    char charAt(unsigned int index) const { return index < buffer.length() ? buffer[index] : 0; }
+    void setCharAt(unsigned int index, char c) { if (index < buffer.length()) buffer[index] = c; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index);
+    void getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int bufsize, unsigned int index = 0) const { getBytes((unsigned char*)buf, bufsize, index); }
+
+    // Búsqueda
+    int indexOf(char c, unsigned int fromIndex = 0) const;
+    int indexOf(const String& s, unsigned int fromIndex = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String& s) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, buffer.length()); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+    // Modificación
+    void replace(char find, char replaceWith);
+    void replace(const String& find, const String& replaceWith);
+    void remove(unsigned int index) { if (index < buffer.length()) buffer.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < buffer.length()) buffer.erase(index, count); }
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    // Conversión
+    long toInt() const { return atol(buffer.c_str()); }
+    float toFloat() const { return (float)atof(buffer.c_str()); }
+    double toDouble() const { return atof(buffer.c_str()); }
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+String operator+(const String& lhs, float rhs);
+String operator+(const String& lhs, double rhs);
+
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
+
+#endif // POSIX_WSTRING_H
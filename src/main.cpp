@@ -11,6 +11,7 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <Ticker.h>
+#include <memory>
 #include "config.h"
 #include "Logger.h"
 #include "MemoryManager.h"
@@ -22,6 +23,22 @@
 #include "AlertManager.h"
 #include "MQTTManager.h"
 #include "SceneManager.h"
+#include "LuminariaRegistry.h"
+#include "RecordStream.h"
+#include "PushManager.h"
+#include "WebAssets.h"
+#include "ApiRouter.h"
+#include "FixtureEvents.h"
+#include "DeferredQueue.h"
+#include "MaintenanceEngine.h"
+#include "DimmingOutput.h"
+#include "OTAManager.h"
+
+// Instancias globales del servidor web (el resto lo verifica RamBudget.cpp)
+static_assert(sizeof(Api) + sizeof(Push) + sizeof(Assets) + sizeof(Security) + sizeof(WiFiMgr) +
+              sizeof(MemManager) + sizeof(OTA) + sizeof(OTASecure) + sizeof(AsyncWebServer) +
+              PUSH_MESSAGE_MAX <= WEB_STATIC_RAM_RESERVE,
+              "Las instancias del servidor web exceden WEB_STATIC_RAM_RESERVE");
 
 // =============================
 // VARIABLES GLOBALES
@@ -30,20 +47,7 @@ AsyncWebServer server(WEB_SERVER_PORT);
 Ticker heartbeatTimer;
 Ticker sessionCheckTimer;
 unsigned long lastUpdate = 0;
-
-// Estructura para datos de luminaria
-struct Luminaria {
-  float lat;
-  float lng;
-  String estado;  // encendida, apagada, falla
-  uint32_t ultimaActualizacion;
-  uint8_t intensidad;  // 0-100% para dimming
-  String id;  // ID único de la luminaria
-  String zona;  // Zona a la que pertenece
-  bool dimeable;  // Si soporta dimming
-};
-
-std::vector<Luminaria> luminarias;
+uint32_t bootEpoch = 0;  // Distingue revisiones de distintos arranques en los ETag
 
 // =============================
 // DECLARACIÓN DE FUNCIONES
@@ -55,7 +59,8 @@ void setupMDNS();
 void setupSecurity();
 void sendHeartbeat();
 void checkSessions();
-String getLuminariasJson();
+AsyncWebServerResponse* beginRecordStream(AsyncWebServerRequest *request, StreamFormat format, RecordSource* source);
+StreamFormat negotiateFormat(AsyncWebServerRequest *request);
 void actualizarLuminaria(float lat, float lng, String estado);
 String getSystemInfo();
 String getClientIdentifier(AsyncWebServerRequest *request);
@@ -69,7 +74,7 @@ String getClientIdentifier(AsyncWebServerRequest *request) {
 }
 
 String getSystemInfo() {
-  StaticJsonDocument<512> doc;
+  StaticJsonDocument<1024> doc;
   doc["version"] = FIRMWARE_VERSION;
   doc["build_date"] = BUILD_DATE;
   doc["build_time"] = BUILD_TIME;
@@ -80,80 +85,91 @@ String getSystemInfo() {
   doc["wifi_status"] = WiFiMgr.isConnected() ? "connected" : "disconnected";
   doc["ip"] = WiFiMgr.getIP();
   doc["rssi"] = WiFiMgr.getRSSI();
-  doc["luminarias_count"] = luminarias.size();
+  doc["luminarias_count"] = Luminarias.size();
   doc["sessions_active"] = Auth.getActiveSessionCount();
+  doc["push_clients"] = Push.getClientCount();
+  doc["deferred_pending"] = Deferred.getPending();
+  doc["deferred_dropped"] = Deferred.getDropped();
   doc["security_enabled"] = true;
+  Maintenance.getStatus(doc.createNestedObject("maintenance"));
+  DimmingOut.getStatus(doc.createNestedObject("dimming"));
+  Push.getStatus(doc.createNestedObject("push"));
+  Assets.getStatus(doc.createNestedObject("assets"));
   
   String result;
   serializeJson(doc, result);
   return result;
 }
 
-String getLuminariasJson() {
-  StaticJsonDocument<JSON_BUFFER_SIZE> doc;
-  JsonArray arr = doc.to<JsonArray>();
+// Crea una respuesta chunked que serializa la fuente a medida que el TCP
+// tiene espacio, sin construir el documento completo en RAM
+AsyncWebServerResponse* beginRecordStream(AsyncWebServerRequest *request, StreamFormat format, RecordSource* source) {
+  std::shared_ptr<RecordStream> stream(new RecordStream(source, format));
+  AsyncWebServerResponse *response = request->beginChunkedResponse(RecordStream::contentType(format),
+    [stream](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      return stream->read(buffer, maxLen);
+    });
+  response->addHeader("Vary", "Accept");
+  return response;
+}
 
-  for (auto &luz : luminarias) {
-    if (arr.size() >= MAX_LUCES) break;
-    
-    JsonObject obj = arr.createNestedObject();
-    obj["id"] = luz.id;
-    obj["lat"] = luz.lat;
-    obj["lng"] = luz.lng;
-    obj["estado"] = luz.estado;
-    obj["intensidad"] = luz.intensidad;
-    obj["zona"] = luz.zona;
-    obj["dimeable"] = luz.dimeable;
-    obj["ultima_actualizacion"] = luz.ultimaActualizacion;
+// Formato de respuesta según ?format= o el encabezado Accept (JSON por defecto)
+StreamFormat negotiateFormat(AsyncWebServerRequest *request) {
+  String format = request->arg("format");
+  if (format == "msgpack") return STREAM_FORMAT_MSGPACK;
+  if (format == "cbor") return STREAM_FORMAT_CBOR;
+  if (format.length() > 0) return STREAM_FORMAT_JSON;
+  
+  if (request->hasHeader("Accept")) {
+    const String& accept = request->getHeader("Accept")->value();
+    if (accept.indexOf("application/cbor") >= 0) return STREAM_FORMAT_CBOR;
+    if (accept.indexOf("application/msgpack") >= 0 || accept.indexOf("application/x-msgpack") >= 0) {
+      return STREAM_FORMAT_MSGPACK;
+    }
   }
+  return STREAM_FORMAT_JSON;
+}
 
-  String result;
-  serializeJson(doc, result);
-  return result;
+// ETag del estado de luminarias: "<arranque>-<revisión>[-formato]"
+void formatEstadoEtag(char* out, size_t len, StreamFormat format) {
+  const char* suffix = format == STREAM_FORMAT_MSGPACK ? "-m" : format == STREAM_FORMAT_CBOR ? "-c" : "";
+  snprintf(out, len, "\"%08X-%u%s\"", bootEpoch, Luminarias.getRevision(), suffix);
 }
 
-String generateLuminariaId(float lat, float lng) {
-  char id[32];
-  snprintf(id, sizeof(id), "LUM_%08X", (uint32_t)(lat * 1000000) ^ (uint32_t)(lng * 1000000));
-  return String(id);
+uint32_t generateLuminariaId(float lat, float lng) {
+  uint32_t id = (uint32_t)(lat * 1000000) ^ (uint32_t)(lng * 1000000);
+  return id == LUMINARIA_ID_INVALID ? id - 1 : id;  // Valor reservado por el registro
 }
 
 void actualizarLuminaria(float lat, float lng, String estado) {
   // Validar entrada
-  if (!Security.validateInput(estado, INPUT_TYPE_ALPHANUM)) {
-    SystemLogger.warning("Estado de luminaria inválido: " + estado, "LUCES");
+  EstadoLuminaria nuevoEstado;
+  if (!Security.validateInput(estado, INPUT_TYPE_ALPHANUM) ||
+      !LuminariaRegistry::parseEstado(estado.c_str(), nuevoEstado)) {
+    LOGF_WARNING("LUCES", "Estado de luminaria inválido: %s", estado.c_str());
     return;
   }
   
-  bool actualizada = false;
-  String id = generateLuminariaId(lat, lng);
+  uint32_t id = generateLuminariaId(lat, lng);
   
-  for (auto &luz : luminarias) {
-    if (luz.id == id) {
-      luz.estado = estado;
-      luz.ultimaActualizacion = millis();
-      actualizada = true;
-      SystemLogger.info("Luminaria actualizada: " + id + " - " + estado, "LUCES");
-      break;
-    }
+  uint16_t pos = Luminarias.find(id);
+  if (pos != REGISTRY_NOT_FOUND) {
+    Luminarias.setEstado(pos, nuevoEstado);
+    Luminarias.touch(pos);
+    LOGF_INFO("LUCES", "Luminaria actualizada: " LUMINARIA_ID_PREFIX "%08X - %s", id, estado.c_str());
+    return;
   }
   
-  if (!actualizada && luminarias.size() < MAX_LUCES) {
-    if (!MemManager.requestMemory(sizeof(Luminaria))) {
-      SystemLogger.error("No hay memoria para agregar nueva luminaria", "LUCES");
-      return;
-    }
-    
-    Luminaria nuevaLuz;
-    nuevaLuz.id = id;
-    nuevaLuz.lat = lat;
-    nuevaLuz.lng = lng;
-    nuevaLuz.estado = estado;
-    nuevaLuz.ultimaActualizacion = millis();
-    nuevaLuz.intensidad = 100;
-    luminarias.push_back(nuevaLuz);
-    SystemLogger.info("Nueva luminaria agregada: " + id, "LUCES");
+  // La tabla tiene capacidad fija: agregar una luminaria no reserva memoria
+  pos = Luminarias.insert(id);
+  if (pos == REGISTRY_NOT_FOUND) {
+    LOGF_WARNING("LUCES", "Registro de luminarias lleno (%d)", MAX_LUCES);
+    return;
   }
+  
+  Luminarias.setPosicion(pos, lat, lng);
+  Luminarias.setEstado(pos, nuevoEstado);
+  LOGF_INFO("LUCES", "Nueva luminaria agregada: " LUMINARIA_ID_PREFIX "%08X", id);
 }
 
 // =============================
@@ -183,6 +199,9 @@ void setupFileSystem() {
     }
   }
   SystemLogger.info("Sistema de archivos LittleFS montado", "SYSTEM");
+  
+  // Manifiesto de archivos web precomprimidos
+  Assets.begin();
 }
 
 // =============================
@@ -208,7 +227,7 @@ void setupSecurity() {
   Security.begin();
   
   // Programar chequeo de sesiones
-  sessionCheckTimer.attach(30, checkSessions);  // Cada 30 segundos
+  sessionCheckTimer.attach(30, []() { Deferred.post(checkSessions); });  // Cada 30 segundos
   
   SystemLogger.info("Sistema de seguridad configurado", "SECURITY");
 }
@@ -223,12 +242,13 @@ void setupWebServer() {
       request->redirect("/login.html");
       return;
     }
-    request->send(LittleFS, "/index.html", "text/html");
+    Assets.send(request, "/index.html");
   });
   
   // Servir archivos estáticos (público)
-  server.serveStatic("/login.html", LittleFS, "/login.html");
-  server.serveStatic("/demo.html", LittleFS, "/demo.html");
+  Assets.serve(server, "/login.html");
+  Assets.serve(server, "/demo.html");
+  Assets.serve(server, "/push.js");
   
   // Servir páginas protegidas con autenticación
   server.on("/configuracion.html", HTTP_GET, [](AsyncWebServerRequest *request){
@@ -236,13 +256,13 @@ void setupWebServer() {
       request->redirect("/login.html");
       return;
     }
-    request->send(LittleFS, "/configuracion.html", "text/html");
+    Assets.send(request, "/configuracion.html");
   });
   
   // === APIs DE AUTENTICACIÓN (Públicas) ===
   
   // API: Login
-  server.on("/api/auth/login", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/auth/login", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       String clientId = getClientIdentifier(request);
@@ -292,7 +312,7 @@ void setupWebServer() {
     });
   
   // API: Logout
-  server.on("/api/auth/logout", HTTP_POST, [](AsyncWebServerRequest *request){
+  Api.on("/api/auth/logout", HTTP_POST, [](AsyncWebServerRequest *request){
     if (!request->hasHeader("Authorization")) {
       request->send(401, "application/json", "{\"error\":\"No autorizado\"}");
       return;
@@ -309,7 +329,7 @@ void setupWebServer() {
   });
   
   // API: Validar token
-  server.on("/api/auth/validate", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/auth/validate", HTTP_GET, [](AsyncWebServerRequest *request){
     if (!request->hasHeader("Authorization")) {
       request->send(401, "application/json", "{\"error\":\"No autorizado\"}");
       return;
@@ -337,22 +357,22 @@ void setupWebServer() {
   // Archivos estáticos protegidos
   server.on("/index.html", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
-    request->send(LittleFS, "/index.html", "text/html");
+    Assets.send(request, "/index.html");
   });
   
   server.on("/diagnostico.html", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
-    request->send(LittleFS, "/diagnostico.html", "text/html");
+    Assets.send(request, "/diagnostico.html");
   });
   
   // API: Información del sistema (requiere autenticación)
-  server.on("/api/system/info", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/system/info", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", getSystemInfo());
   });
   
   // API: Reiniciar sistema (solo admin)
-  server.on("/api/system/restart", HTTP_POST, [](AsyncWebServerRequest *request){
+  Api.on("/api/system/restart", HTTP_POST, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     SystemLogger.warning("Reinicio solicitado por: " + Auth.getCurrentUser(request->header("Authorization")), "SYSTEM");
     request->send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Reiniciando...\"}");
@@ -363,7 +383,39 @@ void setupWebServer() {
   // API: Estado de luminarias (requiere viewer)
   server.on("/estado-luces", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
-    request->send(200, "application/json", getLuminariasJson());
+    
+    StreamFormat format = negotiateFormat(request);
+    char etag[32];
+    formatEstadoEtag(etag, sizeof(etag), format);
+    
+    // Sin cambios desde la última consulta: 304 sin cuerpo
+    String clientEtag = request->hasHeader("If-None-Match") ? request->getHeader("If-None-Match")->value() : String();
+    if (clientEtag == etag) {
+      AsyncWebServerResponse *response = request->beginResponse(304);
+      response->addHeader("ETag", etag);
+      response->addHeader("Cache-Control", "no-cache");
+      response->addHeader("Vary", "Accept");
+      request->send(response);
+      return;
+    }
+    
+    // ?since=<rev> devuelve solo las luminarias modificadas. Si la revisión es
+    // de otro arranque (ETag con otro prefijo) o del futuro, se envía todo
+    uint32_t since = 0;
+    if (request->hasParam("since")) {
+      since = strtoul(request->getParam("since")->value().c_str(), NULL, 10);
+      bool mismoArranque = clientEtag.length() == 0 || strncmp(clientEtag.c_str(), etag, 9) == 0;
+      if (!mismoArranque || since > Luminarias.getRevision()) {
+        since = 0;
+      }
+    }
+    
+    AsyncWebServerResponse *response = beginRecordStream(request, format, new LuminariaRecordSource(since));
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("X-Revision", String(Luminarias.getRevision()));
+    response->addHeader("X-Delta", since > 0 ? "1" : "0");
+    request->send(response);
   });
   
   // API: Actualizar luminaria (requiere operator)
@@ -408,7 +460,7 @@ void setupWebServer() {
       
       // Log de auditoría
       String user = Auth.getCurrentUser(request->header("Authorization"));
-      SystemLogger.info("Luminaria actualizada por " + user + ": " + generateLuminariaId(lat, lng), "AUDIT");
+      LOGF_INFO("AUDIT", "Luminaria actualizada por %s: " LUMINARIA_ID_PREFIX "%08X", user.c_str(), generateLuminariaId(lat, lng));
       
       request->send(200, "application/json", "{\"status\":\"ok\"}");
     });
@@ -416,12 +468,12 @@ void setupWebServer() {
   // === APIs DE ADMINISTRACIÓN (Solo Admin) ===
   
   // API: Gestión de usuarios
-  server.on("/api/admin/users", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/admin/users", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     request->send(200, "application/json", Auth.getAuthStats());
   });
   
-  server.on("/api/admin/users/add", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/admin/users/add", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_ADMIN);
@@ -452,19 +504,19 @@ void setupWebServer() {
     });
   
   // API: Sesiones activas
-  server.on("/api/admin/sessions", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/admin/sessions", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     request->send(200, "application/json", Auth.getAllSessions());
   });
   
   // API: Estadísticas de seguridad
-  server.on("/api/admin/security/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/admin/security/stats", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     request->send(200, "application/json", Security.getSecurityStats());
   });
   
   // API: Crear backup
-  server.on("/api/admin/backup", HTTP_POST, [](AsyncWebServerRequest *request){
+  Api.on("/api/admin/backup", HTTP_POST, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     
     if (Security.createBackup()) {
@@ -475,7 +527,7 @@ void setupWebServer() {
   });
   
   // API: Restaurar backup
-  server.on("/api/admin/restore", HTTP_POST, [](AsyncWebServerRequest *request){
+  Api.on("/api/admin/restore", HTTP_POST, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_ADMIN);
     
     if (Security.restoreBackup()) {
@@ -488,32 +540,61 @@ void setupWebServer() {
   // === APIs DE MONITOREO (Operator+) ===
   
   // API: WiFi stats
-  server.on("/api/wifi/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/wifi/stats", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     request->send(200, "application/json", WiFiMgr.getWifiStats());
   });
   
   // API: Memory stats
-  server.on("/api/memory/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/memory/stats", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     request->send(200, "application/json", MemManager.getMemoryStats());
   });
   
   // API: Logs recientes
-  server.on("/api/logs/recent", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/logs/recent", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     request->send(200, "application/json", SystemLogger.getRecentLogs(50));
   });
   
+  // API: Consulta de logs (?level=&module=&from=&to=&cursor=&limit=)
+  Api.on("/api/logs/query", HTTP_GET, [](AsyncWebServerRequest *request){
+    REQUIRE_AUTH(request, ROLE_OPERATOR);
+    LogQuery query;
+    if (request->hasParam("level")) {
+      query.level = Logger::parseLevel(request->getParam("level")->value().c_str());
+      if (query.level == 0) {
+        request->send(400, "application/json", "{\"error\":\"Nivel inválido\"}");
+        return;
+      }
+    }
+    if (request->hasParam("module")) {
+      query.module = request->getParam("module")->value().c_str();
+    }
+    if (request->hasParam("from")) {
+      query.from = strtoul(request->getParam("from")->value().c_str(), NULL, 10);
+    }
+    if (request->hasParam("to")) {
+      query.to = strtoul(request->getParam("to")->value().c_str(), NULL, 10);
+    }
+    if (request->hasParam("cursor")) {
+      query.cursor = strtoul(request->getParam("cursor")->value().c_str(), NULL, 10);
+    }
+    if (request->hasParam("limit")) {
+      query.limit = constrain(request->getParam("limit")->value().toInt(), 1, LOG_QUERY_MAX_RESULTS);
+    }
+    request->send(200, "application/json", SystemLogger.queryLogs(query));
+  });
+  
   // === APIs FASE 3: CARACTERÍSTICAS AVANZADAS ===
   
   // API: Programaciones horarias
-  server.on("/api/schedules", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/schedules", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", Database.getSchedulesJson());
   });
   
-  server.on("/api/schedules/add", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/schedules/add", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -544,13 +625,12 @@ void setupWebServer() {
     });
   
   // API: Habilitar/deshabilitar programación
-  server.on("/api/schedules/*/enable", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/schedules/:id/enable", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
       
-      String path = request->url();
-      int id = path.substring(15, path.indexOf("/enable")).toInt();
+      uint32_t id = ApiRouter::paramId(request);
       
       StaticJsonDocument<128> doc;
       DeserializationError error = deserializeJson(doc, data);
@@ -566,11 +646,10 @@ void setupWebServer() {
     });
   
   // API: Eliminar programación
-  server.on("/api/schedules/*", HTTP_DELETE, [](AsyncWebServerRequest *request){
+  Api.on("/api/schedules/:id", HTTP_DELETE, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     
-    String path = request->url();
-    int id = path.substring(15).toInt();
+    uint32_t id = ApiRouter::paramId(request);
     
     if (Database.deleteSchedule(id)) {
       request->send(200, "application/json", "{\"status\":\"ok\"}");
@@ -580,12 +659,12 @@ void setupWebServer() {
   });
   
   // API: Zonas
-  server.on("/api/zones", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/zones", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", Database.getZonesJson());
   });
   
-  server.on("/api/zones/add", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/zones/add", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -612,20 +691,16 @@ void setupWebServer() {
     });
   
   // API: Alertas
-  server.on("/api/alerts", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/alerts", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", Alerts.getAlertsJson());
   });
   
-  server.on("/api/alerts/*/acknowledge", HTTP_POST, [](AsyncWebServerRequest *request){
+  Api.on("/api/alerts/:id/acknowledge", HTTP_POST, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     
-    String path = request->url();
-    int id = path.substring(12, path.indexOf("/acknowledge")).toInt();
-    
-    String token = request->header("Authorization");
-    token.replace("Bearer ", "");
-    String username = Auth.getUsernameFromToken(token);
+    uint32_t id = ApiRouter::paramId(request);
+    String username = Auth.getCurrentUser(request->header("Authorization"));
     
     if (Alerts.acknowledgeAlert(id, username)) {
       request->send(200, "application/json", "{\"status\":\"ok\"}");
@@ -634,67 +709,86 @@ void setupWebServer() {
     }
   });
   
-  // API: Estadísticas de consumo
-  server.on("/api/consumption/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+  // API: Eventos (?luminaria=&type=&from=&to=&cursor=&limit=), por los índices de EventLog
+  Api.on("/api/events", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
-    
-    StaticJsonDocument<512> doc;
-    float totalPower = 0;
-    float totalEnergy24h = 0;
-    
-    for (const auto& luz : luminarias) {
-      if (luz.estado == "encendida") {
-        totalPower += 50;  // 50W por luminaria (ejemplo)
+    EventQuery query;
+    String luminaria;
+    if (request->hasParam("luminaria")) {
+      luminaria = request->getParam("luminaria")->value();
+      query.luminaria = luminaria.c_str();
+    }
+    if (request->hasParam("type")) {
+      long type = request->getParam("type")->value().toInt();
+      if (type < EVENT_POWER_ON || type > EVENT_STATE_CHANGE) {
+        request->send(400, "application/json", "{\"error\":\"Tipo de evento inválido\"}");
+        return;
       }
+      query.type = type;
     }
-    
-    // Calcular energía últimas 24h (simplificado)
-    totalEnergy24h = (totalPower * 12) / 1000;  // kWh (asumiendo 12h encendidas)
-    
-    doc["total_power"] = totalPower;
-    doc["total_energy_24h"] = totalEnergy24h;
-    doc["luminarias_on"] = 0;
-    doc["luminarias_off"] = 0;
-    doc["luminarias_fault"] = 0;
-    
-    for (const auto& luz : luminarias) {
-      if (luz.estado == "encendida") doc["luminarias_on"] = doc["luminarias_on"].as<int>() + 1;
-      else if (luz.estado == "apagada") doc["luminarias_off"] = doc["luminarias_off"].as<int>() + 1;
-      else if (luz.estado == "falla") doc["luminarias_fault"] = doc["luminarias_fault"].as<int>() + 1;
+    if (request->hasParam("from")) {
+      query.from = strtoul(request->getParam("from")->value().c_str(), NULL, 10);
     }
-    
-    String result;
-    serializeJson(doc, result);
-    request->send(200, "application/json", result);
+    if (request->hasParam("to")) {
+      query.to = strtoul(request->getParam("to")->value().c_str(), NULL, 10);
+    }
+    if (request->hasParam("cursor")) {
+      query.cursor = strtoul(request->getParam("cursor")->value().c_str(), NULL, 10);
+    }
+    uint8_t limit = EVENT_QUERY_MAX_RESULTS;
+    if (request->hasParam("limit")) {
+      limit = constrain(request->getParam("limit")->value().toInt(), 1, EVENT_QUERY_MAX_RESULTS);
+    }
+    request->send(200, "application/json", Database.queryEventsJson(query, limit));
+  });
+  
+  // API: Estadísticas de consumo (desde los rollups de ConsumptionStore)
+  Api.on("/api/consumption/stats", HTTP_GET, [](AsyncWebServerRequest *request){
+    REQUIRE_AUTH(request, ROLE_VIEWER);
+    request->send(200, "application/json", Database.getConsumptionStats());
+  });
+  
+  // API: Serie de consumo agregada (?hours=1 por minuto, hasta 48 por hora, más por día)
+  Api.on("/api/consumption/history", HTTP_GET, [](AsyncWebServerRequest *request){
+    REQUIRE_AUTH(request, ROLE_VIEWER);
+    uint32_t hours = 24;
+    if (request->hasParam("hours")) {
+      hours = constrain(request->getParam("hours")->value().toInt(), 1, 24 * CONSUMPTION_DAY_BUCKETS);
+    }
+    request->send(200, "application/json", Database.getConsumptionJson(hours));
   });
   
   // API: Exportar datos
-  server.on("/api/export/*", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/export/*", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_OPERATOR);
     
-    String path = request->url();
-    String type = path.substring(12);
-    String format = request->arg("format");
+    String type = ApiRouter::paramTail(request);
     
-    if (format == "csv") {
-      String csv = Database.exportToCSV(type);
-      request->send(200, "text/csv", csv);
-    } else {
-      String json = Database.exportToJSON(type);
-      request->send(200, "application/json", json);
+    // Todos los formatos, CSV incluido, salen por fragmentos del mismo cursor:
+    // la memoria no depende de cuántos registros haya en flash
+    RecordSource* source = Database.createExportSource(type);
+    if (!source) {
+      request->send(404, "application/json", "{\"error\":\"Tipo de exportación desconocido\"}");
+      return;
+    }
+    StreamFormat format = request->arg("format") == "csv" ? STREAM_FORMAT_CSV : negotiateFormat(request);
+    AsyncWebServerResponse *response = beginRecordStream(request, format, source);
+    if (format == STREAM_FORMAT_CSV) {
+      response->addHeader("Content-Disposition", "attachment; filename=\"" + type + ".csv\"");
     }
+    request->send(response);
   });
   
   // === APIs FASE 5: ESCENAS Y DIMMING ===
   
   // API: Obtener escenas
-  server.on("/api/scenes", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/scenes", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", Scenes.getSceneStatistics());
   });
   
   // API: Activar escena
-  server.on("/api/scenes/activate", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/scenes/activate", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -717,7 +811,7 @@ void setupWebServer() {
     });
   
   // API: Activar preset
-  server.on("/api/scenes/preset", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/scenes/preset", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -749,7 +843,7 @@ void setupWebServer() {
     });
   
   // API: Control de dimming
-  server.on("/api/dimming", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/dimming", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -774,7 +868,7 @@ void setupWebServer() {
     });
   
   // API: Control de zona
-  server.on("/api/zones/control", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/zones/control", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -799,13 +893,13 @@ void setupWebServer() {
     });
   
   // API: Obtener zonas visuales
-  server.on("/api/zones/visual", HTTP_GET, [](AsyncWebServerRequest *request){
+  Api.on("/api/zones/visual", HTTP_GET, [](AsyncWebServerRequest *request){
     REQUIRE_AUTH(request, ROLE_VIEWER);
     request->send(200, "application/json", ZoneVisual.getZoneMapJSON());
   });
   
   // API: Efecto especial
-  server.on("/api/effects", HTTP_POST, [](AsyncWebServerRequest *request){},
+  Api.on("/api/effects", HTTP_POST, [](AsyncWebServerRequest *request){},
     NULL,
     [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
       REQUIRE_AUTH(request, ROLE_OPERATOR);
@@ -826,6 +920,10 @@ void setupWebServer() {
         Scenes.waveEffect(targetId, duration);
       } else if (effect == "random") {
         Scenes.randomEffect(targetId, duration);
+      } else if (effect == "strobe") {
+        Scenes.strobeEffect(targetId, duration, doc["frequency"] | 100);
+      } else if (effect == "rainbow") {
+        Scenes.rainbowEffect(targetId, duration);
       } else if (effect == "fadeIn") {
         Scenes.fadeIn(targetId, duration);
       } else if (effect == "fadeOut") {
@@ -849,7 +947,15 @@ void setupWebServer() {
   // CORS headers
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
   DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type, Authorization");
+  DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type, Authorization, If-None-Match");
+  DefaultHeaders::Instance().addHeader("Access-Control-Expose-Headers", "ETag, X-Revision, X-Delta");
+  
+  // Todas las rutas /api/* se resuelven con un único trie
+  server.addHandler(&Api);
+  SystemLogger.info("Rutas API registradas: " + String(Api.getRouteCount()), "WEB");
+  
+  // Canal push de actualizaciones (WebSocket /ws)
+  Push.begin(server);
   
   server.begin();
   SystemLogger.info("Servidor web iniciado en puerto " + String(WEB_SERVER_PORT) + " con seguridad habilitada", "WEB");
@@ -859,16 +965,12 @@ void setupWebServer() {
 // FUNCIONES DE MONITOREO
 // =============================
 void sendHeartbeat() {
-  SystemLogger.debug("Heartbeat - Luminarias: " + String(luminarias.size()) + 
-                    ", Heap: " + String(ESP.getFreeHeap()) + 
-                    ", Uptime: " + String(millis()/1000) + "s" +
-                    ", Sesiones: " + String(Auth.getActiveSessionCount()), "HEARTBEAT");
+  LOGF_DEBUG("HEARTBEAT", "Heartbeat - Luminarias: %u, Heap: %u, Uptime: %lus, Sesiones: %u",
+             (unsigned)Luminarias.size(), (unsigned)ESP.getFreeHeap(),
+             (unsigned long)(millis() / 1000), (unsigned)Auth.getActiveSessionCount());
   
   // Alimentar watchdog
   Security.feedWatchdog();
-  
-  // Flush logs
-  SystemLogger.flush();
 }
 
 void checkSessions() {
@@ -892,6 +994,11 @@ void onWiFiDisconnect() {
 // =============================
 void setup() {
   setupSerial();
+  bootEpoch = RANDOM_REG32;
+  
+  // Configurar sistema de archivos (antes que los logs: begin() ubica el
+  // segmento donde seguir escribiendo; lo registrado hasta ahí espera en el ring)
+  setupFileSystem();
   
   // Inicializar sistema de logs
   SystemLogger.begin();
@@ -900,9 +1007,6 @@ void setup() {
   // Inicializar gestor de memoria
   MemManager.begin();
   
-  // Configurar sistema de archivos
-  setupFileSystem();
-  
   // Inicializar seguridad
   setupSecurity();
   
@@ -910,6 +1014,7 @@ void setup() {
   
   // Inicializar base de datos
   Database.begin();
+  Maintenance.begin();  // Retoma la tarea que quedó a medias antes del reinicio
   SystemLogger.info("Base de datos inicializada", "SYSTEM");
   
   // Inicializar gestor de tiempo
@@ -917,26 +1022,9 @@ void setup() {
   
   // Inicializar scheduler
   Scheduler.begin();
-  Scheduler.setCallback([](ScheduleAction action, String target, int value) {
-    SystemLogger.info("Acción programada: " + String(action) + " en " + target, "SCHEDULE");
-    
-    // Ejecutar acción sobre luminarias
-    if (action == ACTION_TURN_ON) {
-      for (auto& luz : luminarias) {
-        if (target == "all" || luz.id == target) {
-          luz.estado = "encendida";
-          luz.intensidad = value;
-        }
-      }
-    } else if (action == ACTION_TURN_OFF) {
-      for (auto& luz : luminarias) {
-        if (target == "all" || luz.id == target) {
-          luz.estado = "apagada";
-          luz.intensidad = 0;
-        }
-      }
-    }
-  });
+  
+  // Handlers de luminarias (scheduler y MQTT), compartidos con la simulación nativa
+  registerFixtureHandlers();
   
   // Crear programaciones por defecto
   Scheduler.createDefaultSchedules();
@@ -945,6 +1033,7 @@ void setup() {
   Alerts.begin();
   Alerts.registerCallback([](const Alert& alert) {
     SystemLogger.info("Nueva alerta: " + alert.message, "ALERT");
+    Push.notifyAlert(alert);
   });
   
   // Configurar WiFi con callbacks
@@ -958,79 +1047,6 @@ void setup() {
   MQTT.setNodeInfo("CENTRAL_" + String(ESP.getChipId()), NODE_CENTRAL);
   MQTT.enableAutoDiscovery(true);
   
-  // Configurar callbacks MQTT
-  MQTT.onNodeDiscovered([](const NodeInfo& node) {
-    SystemLogger.info("Nuevo nodo descubierto: " + node.nodeId + " (" + node.ip + ")", "MQTT");
-    
-    // Agregar nodo a la base de datos
-    Database.logEvent(node.nodeId, EVENT_STATE_CHANGE, "Nodo descubierto", "DISCOVERY");
-    
-    // Si es una luminaria, agregarla al sistema
-    if (node.type == NODE_LUMINARIA) {
-      // Crear luminaria virtual para el nodo
-      Luminaria nuevaLuz;
-      nuevaLuz.id = node.nodeId;
-      nuevaLuz.lat = DEFAULT_LAT + (random(-100, 100) / 10000.0);  // Posición aleatoria cerca del centro
-      nuevaLuz.lng = DEFAULT_LNG + (random(-100, 100) / 10000.0);
-      nuevaLuz.estado = "apagada";
-      nuevaLuz.ultimaActualizacion = millis();
-      nuevaLuz.intensidad = 100;
-      luminarias.push_back(nuevaLuz);
-      
-      SystemLogger.info("Luminaria MQTT agregada: " + node.nodeId, "MQTT");
-    }
-  });
-  
-  // Callback para mensajes de estado
-  MQTT.onMessage("luces/status/+", [](const String& topic, const String& payload) {
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, payload);
-    if (!error) {
-      String nodeId = doc["nodeId"].as<String>();
-      bool online = doc["online"];
-      bool lightOn = doc["light"];
-      
-      // Actualizar estado de luminaria
-      for (auto& luz : luminarias) {
-        if (luz.id == nodeId) {
-          luz.estado = online ? (lightOn ? "encendida" : "apagada") : "offline";
-          luz.ultimaActualizacion = millis();
-          break;
-        }
-      }
-    }
-  });
-  
-  // Callback para telemetría
-  MQTT.onMessage("luces/telemetry/+", [](const String& topic, const String& payload) {
-    StaticJsonDocument<512> doc;
-    DeserializationError error = deserializeJson(doc, payload);
-    if (!error) {
-      String nodeId = doc["nodeId"].as<String>();
-      float power = doc["power"]["watts"];
-      
-      // Registrar consumo
-      Database.recordConsumption(nodeId, power, power * 0.001);
-      
-      // Verificar alertas de consumo
-      Alerts.checkConsumption(nodeId, power);
-    }
-  });
-  
-  // Callback para alertas de nodos
-  MQTT.onMessage("luces/alert/+", [](const String& topic, const String& payload) {
-    StaticJsonDocument<256> doc;
-    DeserializationError error = deserializeJson(doc, payload);
-    if (!error) {
-      String nodeId = doc["nodeId"].as<String>();
-      String type = doc["type"].as<String>();
-      String message = doc["message"].as<String>();
-      
-      // Crear alerta en el sistema
-      Alerts.createAlert(ALERT_FAILURE, SEVERITY_WARNING, nodeId, message, type);
-    }
-  });
-  
   // Conectar a broker MQTT (configurar IP del broker)
   if (WiFiMgr.isConnected()) {
     MQTT.begin(MQTT_BROKER_IP, MQTT_BROKER_PORT);
@@ -1040,35 +1056,37 @@ void setup() {
   if (Scenes.begin()) {
     SystemLogger.info("Scene Manager iniciado correctamente", "SYSTEM");
     
+    // Notificar activaciones a los clientes push
+    Scenes.onSceneActivated([](const Scene& scene) {
+      Push.notifyScene(scene);
+    });
+    
     // Registrar callback para control de dimming
-    Scenes.setDimmingCallback([](const String& lightId, uint8_t brightness) {
-      // Actualizar brillo de la luminaria
-      for (auto& luz : luminarias) {
-        if (luz.id == lightId) {
-          luz.intensidad = brightness;
-          luz.ultimaActualizacion = millis();
-          
-          // Si está apagada y el brillo es > 0, encenderla
-          if (brightness > 0 && luz.estado == "apagada") {
-            luz.estado = "encendida";
-          } else if (brightness == 0) {
-            luz.estado = "apagada";
-          }
-          
-          // Publicar cambio por MQTT si está habilitado
-          if (MQTT_ENABLE && MQTT.isConnected()) {
-            StaticJsonDocument<256> doc;
-            doc["id"] = luz.id;
-            doc["brightness"] = brightness;
-            doc["estado"] = luz.estado;
-            String payload;
-            serializeJson(doc, payload);
-            MQTT.publishTelemetry(luz.id, payload);
-          }
-          
-          SystemLogger.debug("Dimming - Luz: " + lightId + ", Brillo: " + String(brightness) + "%", "SCENE");
-          break;
-        }
+    Scenes.setDimmingCallback([](uint16_t pos, uint8_t brightness) {
+      // El brillo ya está en Brightness (la intensidad del registro); pos
+      // viene del registro
+      Luminarias.touch(pos);
+      
+      // Si está apagada y el brillo es > 0, encenderla
+      if (brightness > 0 && Luminarias.getEstado(pos) == ESTADO_APAGADA) {
+        Luminarias.setEstado(pos, ESTADO_ENCENDIDA);
+      } else if (brightness == 0) {
+        Luminarias.setEstado(pos, ESTADO_APAGADA);
+      }
+      
+      // Se publica en el frame de su zona al final de la iteración
+      DimmingOut.set(pos, brightness);
+      
+      LOGF_DEBUG("SCENE", "Dimming - Luz: %08lX, Brillo: %d%%", (unsigned long)Luminarias.getId(pos), (int)brightness);
+    });
+    
+    // Un frame por zona con todos los cambios de la iteración
+    DimmingOut.setSink([](const char* zone, const char* payload) {
+      if (!MQTT_ENABLE || !MQTT.isConnected()) return;
+      if (zone) {
+        MQTT.publishToZone(zone, payload);
+      } else {
+        MQTT.publish(String(MQTT_COMMAND_TOPIC) + "/all", payload);
       }
     });
     
@@ -1079,14 +1097,13 @@ void setup() {
     ZoneVisual.createZone("zona_este", "Zona Este");
     ZoneVisual.createZone("zona_oeste", "Zona Oeste");
     
-    // Asignar luminarias a zonas (ejemplo)
-    int zonaIndex = 0;
-    String zonas[] = {"zona_centro", "zona_norte", "zona_sur", "zona_este", "zona_oeste"};
-    for (auto& luz : luminarias) {
-      luz.zona = zonas[zonaIndex % 5];
-      luz.dimeable = true;  // Todas las luminarias soportan dimming
-      ZoneVisual.addLightToZone(luz.zona, luz.id);
-      zonaIndex++;
+    // Asignar luminarias a zonas visuales (ejemplo). La zona MQTT de cada
+    // luminaria (la de sus frames de dimming) la informa el nodo en el discovery
+    const char* zonas[] = {"zona_centro", "zona_norte", "zona_sur", "zona_este", "zona_oeste"};
+    for (uint16_t i = 0; i < Luminarias.size(); i++) {
+      const char* zona = zonas[i % 5];
+      Luminarias.setDimeable(i, true);  // Todas las luminarias soportan dimming
+      ZoneVisual.addLightToZone(zona, LuminariaRegistry::formatId(Luminarias.getId(i)));
     }
     
   } else {
@@ -1101,7 +1118,7 @@ void setup() {
   digitalWrite(LED_STATUS_PIN, LOW);
   
   // Configurar heartbeat
-  heartbeatTimer.attach_ms(HEARTBEAT_INTERVAL, sendHeartbeat);
+  heartbeatTimer.attach_ms(HEARTBEAT_INTERVAL, []() { Deferred.post(sendHeartbeat); });
   
   // Agregar algunas luminarias de ejemplo
   actualizarLuminaria(DEFAULT_LAT, DEFAULT_LNG, "encendida");
@@ -1109,8 +1126,9 @@ void setup() {
   actualizarLuminaria(DEFAULT_LAT - 0.001, DEFAULT_LNG - 0.001, "falla");
   
   // Registrar luminarias en base de datos
-  for (const auto& luz : luminarias) {
-    Database.logEvent(luz.id, EVENT_STATE_CHANGE, "Estado inicial: " + luz.estado, "SYSTEM");
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    Database.logEvent(LuminariaRegistry::formatId(Luminarias.getId(i)), EVENT_STATE_CHANGE,
+                      "Estado inicial: " + String(LuminariaRegistry::estadoToString(Luminarias.getEstado(i))), "SYSTEM");
   }
   
   SystemLogger.info("=== SISTEMA v" + String(FIRMWARE_VERSION) + " INICIADO ===", "SYSTEM");
@@ -1122,6 +1140,9 @@ void setup() {
   SystemLogger.info("Acceder a: http://" + WiFiMgr.getIP() + "/login.html", "SYSTEM");
   SystemLogger.warning("Usuarios por defecto: admin/admin123, operator/oper123, viewer/view123", "SECURITY");
   SystemLogger.warning("CAMBIAR CONTRASEÑAS EN PRODUCCIÓN", "SECURITY");
+  
+  // Los registros del arranque llegan a flash antes del primer loop()
+  SystemLogger.flush();
 }
 
 // =============================
@@ -1142,8 +1163,21 @@ void loop() {
   }
   
   // === FASE 5: Actualizar SceneManager ===
-  Scenes.loop();
-  Dimming.update();
+  Scenes.loop();  // También avanza los fades de Dimming
+  DimmingOut.flush();
+  
+  // Enviar cambios agrupados a los clientes push
+  Push.loop();
+  
+  // Tareas encoladas por los Ticker (heartbeat, sesiones, schedules, backup)
+  Deferred.run();
+  
+  // Escribir logs pendientes (un lote como máximo por iteración)
+  SystemLogger.loop();
+  
+  // Mantenimiento de la base de datos (retención, compactación, rotación,
+  // backup), acotado a MAINTENANCE_BUDGET_US por iteración
+  Maintenance.loop();
   
   // Verificar memoria y seguridad
   if (millis() - lastUpdate > UPDATE_INTERVAL) {
@@ -1163,26 +1197,30 @@ void loop() {
       lastAlertCheck = millis();
       
       // Verificar estado de luminarias
-      for (const auto& luz : luminarias) {
+      for (uint16_t i = 0; i < Luminarias.size(); i++) {
+        EstadoLuminaria estado = Luminarias.getEstado(i);
+        uint32_t ultimaActualizacion = Luminarias.getUltimaActualizacion(i);
+        String luzId = LuminariaRegistry::formatId(Luminarias.getId(i));
+        
         // Verificar fallas
-        if (luz.estado == "falla") {
-          Alerts.checkLuminariaFailure(luz.id, luz.estado);
+        if (estado == ESTADO_FALLA) {
+          Alerts.checkLuminariaFailure(luzId, LuminariaRegistry::estadoToString(estado));
         }
         
         // Verificar consumo (simulado)
-        if (luz.estado == "encendida") {
+        if (estado == ESTADO_ENCENDIDA) {
           float consumption = 50 + random(-10, 10);  // 50W ± 10W
-          Alerts.checkConsumption(luz.id, consumption);
+          Alerts.checkConsumption(luzId, consumption);
           
           // Registrar consumo en base de datos
-          Database.recordConsumption(luz.id, consumption, consumption * 0.001);  // kWh
+          Database.logConsumption(luzId, consumption, NOMINAL_VOLTAGE, consumption / NOMINAL_VOLTAGE);
         }
         
         // Verificar timeout (simulado)
-        if (millis() - luz.ultimaActualizacion > 300000) {  // 5 minutos
+        if (millis() - ultimaActualizacion > 300000) {  // 5 minutos
           Alerts.createAlert(ALERT_OFFLINE, SEVERITY_WARNING, 
-                           luz.id, "Luminaria sin respuesta", 
-                           "Última actualización hace " + String((millis() - luz.ultimaActualizacion)/1000) + " segundos");
+                           luzId, "Luminaria sin respuesta", 
+                           "Última actualización hace " + String((millis() - ultimaActualizacion)/1000) + " segundos");
         }
       }
       
@@ -1190,14 +1228,6 @@ void loop() {
       Alerts.checkSystemHealth();
     }
     
-    // Limpiar base de datos periódicamente
-    static unsigned long lastDbCleanup = 0;
-    if (millis() - lastDbCleanup > 3600000) {  // Cada hora
-      lastDbCleanup = millis();
-      Database.cleanOldEvents(7);  // Mantener 7 días
-      SystemLogger.info("Limpieza de base de datos completada", "DB");
-    }
-    
     // Parpadear LED
     digitalWrite(LED_STATUS_PIN, !digitalRead(LED_STATUS_PIN));
   }
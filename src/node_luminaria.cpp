@@ -9,6 +9,7 @@
 #include <ArduinoJson.h>
 #include <Ticker.h>
 #include <EEPROM.h>
+#include "DimmingCurve.h"
 
 // =============================
 // CONFIGURACIÓN
@@ -32,6 +33,7 @@ const char* FIRMWARE_VERSION = "0.6.0";
 // Pines
 #define LED_PIN LED_BUILTIN     // LED de estado
 #define RELAY_PIN D1            // Relé para control de luminaria
+#define DIMMER_PIN D5           // PWM del driver de la luminaria
 #define CURRENT_SENSOR_PIN A0   // Sensor de corriente (opcional)
 #define LIGHT_SENSOR_PIN D2     // Sensor de luz ambiental (opcional)
 
@@ -40,6 +42,7 @@ const char* FIRMWARE_VERSION = "0.6.0";
 #define TELEMETRY_INTERVAL 60000    // Enviar telemetría cada minuto
 #define DISCOVERY_INTERVAL 300000    // Broadcast discovery cada 5 minutos
 #define WATCHDOG_TIMEOUT 8000
+#define DIMMING_RAMP_MS 50           // Rampa entre niveles (un tick del nodo central)
 
 // =============================
 // VARIABLES GLOBALES
@@ -74,8 +77,16 @@ struct NodeStats {
     float totalEnergy;  // kWh acumulados
 } nodeStats;
 
-// Configuración persistente
+// Configuración persistente. 'magic' y 'version' identifican el formato:
+// al agregar o mover un campo se sube NODE_CONFIG_VERSION y loadConfig()
+// migra el formato anterior en lugar de perder la configuración
+#define NODE_CONFIG_MAGIC 0xA15C     // No coincide con "LU" del nodeId de NodeConfigV1
+#define NODE_CONFIG_VERSION 2
+
 struct NodeConfig {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t dimmingCurve;   // DimmingCurveType
     char nodeId[32];
     char zoneId[32];
     bool autoMode;
@@ -85,19 +96,62 @@ struct NodeConfig {
     uint32_t checksum;
 } nodeConfig;
 
+// Formato anterior a la curva de dimming: sin magic/versión, con el
+// checksum sobre todo lo anterior
+struct NodeConfigV1 {
+    char nodeId[32];
+    char zoneId[32];
+    bool autoMode;
+    uint16_t autoOnTime;
+    uint16_t autoOffTime;
+    uint8_t defaultBrightness;
+    uint32_t checksum;
+};
+
+// Salida PWM: el nivel pedido (0-100% percibido) se lleva a 10 bits y se
+// recorre en una rampa corta sobre la tabla fina de la curva, para que los
+// saltos de 1% entre frames no se vean como escalones
+struct DimmerRamp {
+    uint16_t from;
+    uint16_t to;
+    uint16_t level;       // 0-1023, índice en la tabla fina
+    unsigned long start;
+} dimmer;
+
 // =============================
 // FUNCIONES DE UTILIDAD
 // =============================
 
 String generateNodeId() {
-    return "LUM_" + String(ESP.getChipId());
+    // Mismo formato que LuminariaRegistry::formatId en el nodo central,
+    // para que el ID se traduzca sin pérdida a su clave numérica
+    char id[16];
+    snprintf(id, sizeof(id), "LUM_%08X", ESP.getChipId());
+    return String(id);
 }
 
-void saveConfig() {
-    nodeConfig.checksum = 0;
-    for (int i = 0; i < sizeof(NodeConfig) - sizeof(uint32_t); i++) {
-        nodeConfig.checksum += ((uint8_t*)&nodeConfig)[i];
+// "LUM_" + 8 dígitos hex en mayúscula, lo único que acepta el nodo central
+bool isCanonicalNodeId(const char* id) {
+    if (strncmp(id, "LUM_", 4) != 0) return false;
+    for (uint8_t i = 4; i < 12; i++) {
+        if (!isdigit(id[i]) && (id[i] < 'A' || id[i] > 'F')) return false;
     }
+    return id[12] == '\0';
+}
+
+// Suma de los bytes previos al checksum (el checksum es el último campo)
+uint32_t configChecksum(const void* config, size_t size) {
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < size - sizeof(uint32_t); i++) {
+        checksum += ((const uint8_t*)config)[i];
+    }
+    return checksum;
+}
+
+void saveConfig() {
+    nodeConfig.magic = NODE_CONFIG_MAGIC;
+    nodeConfig.version = NODE_CONFIG_VERSION;
+    nodeConfig.checksum = configChecksum(&nodeConfig, sizeof(NodeConfig));
     
     EEPROM.begin(sizeof(NodeConfig));
     EEPROM.put(0, nodeConfig);
@@ -105,17 +159,42 @@ void saveConfig() {
     Serial.println("Configuración guardada");
 }
 
+// Config guardada con NodeConfigV1: se copian los campos y la curva queda
+// en la de fábrica. Una EEPROM en cero (factory_reset) da un checksum
+// válido, por eso también se exige un nodeId
+bool migrateConfigV1() {
+    NodeConfigV1 old;
+    EEPROM.get(0, old);
+    if (configChecksum(&old, sizeof(NodeConfigV1)) != old.checksum || old.nodeId[0] == '\0') {
+        return false;
+    }
+    
+    memcpy(nodeConfig.nodeId, old.nodeId, sizeof(nodeConfig.nodeId));
+    memcpy(nodeConfig.zoneId, old.zoneId, sizeof(nodeConfig.zoneId));
+    nodeConfig.nodeId[sizeof(nodeConfig.nodeId) - 1] = '\0';
+    nodeConfig.zoneId[sizeof(nodeConfig.zoneId) - 1] = '\0';
+    nodeConfig.autoMode = old.autoMode;
+    nodeConfig.autoOnTime = old.autoOnTime;
+    nodeConfig.autoOffTime = old.autoOffTime;
+    nodeConfig.defaultBrightness = old.defaultBrightness;
+    nodeConfig.dimmingCurve = DIMMING_CURVE_CIE1931;
+    return true;
+}
+
 void loadConfig() {
+    static_assert(sizeof(NodeConfig) >= sizeof(NodeConfigV1), "EEPROM.begin() tiene que cubrir los dos formatos");
     EEPROM.begin(sizeof(NodeConfig));
     EEPROM.get(0, nodeConfig);
     
-    // Verificar checksum
-    uint32_t checksum = 0;
-    for (int i = 0; i < sizeof(NodeConfig) - sizeof(uint32_t); i++) {
-        checksum += ((uint8_t*)&nodeConfig)[i];
-    }
+    // Verificar formato y checksum
+    bool valid = nodeConfig.magic == NODE_CONFIG_MAGIC &&
+                 nodeConfig.version == NODE_CONFIG_VERSION &&
+                 configChecksum(&nodeConfig, sizeof(NodeConfig)) == nodeConfig.checksum;
     
-    if (checksum != nodeConfig.checksum) {
+    if (!valid && migrateConfigV1()) {
+        Serial.println("Config migrada al formato v" + String(NODE_CONFIG_VERSION));
+        saveConfig();
+    } else if (!valid) {
         Serial.println("Config inválida, usando valores por defecto");
         strcpy(nodeConfig.nodeId, generateNodeId().c_str());
         strcpy(nodeConfig.zoneId, "default");
@@ -123,9 +202,22 @@ void loadConfig() {
         nodeConfig.autoOnTime = 1800;   // 18:00
         nodeConfig.autoOffTime = 600;    // 06:00
         nodeConfig.defaultBrightness = 100;
+        nodeConfig.dimmingCurve = DIMMING_CURVE_CIE1931;
         saveConfig();
     }
     
+    // IDs guardados por firmwares anteriores ("LUM_" + chip ID en decimal):
+    // el nodo central ya no los acepta, se reemplazan por el formato actual
+    if (!isCanonicalNodeId(nodeConfig.nodeId)) {
+        Serial.printf("ID migrado: %s -> ", nodeConfig.nodeId);
+        strcpy(nodeConfig.nodeId, generateNodeId().c_str());
+        Serial.println(nodeConfig.nodeId);
+        saveConfig();
+    }
+    
+    if (nodeConfig.dimmingCurve >= DIMMING_CURVE_COUNT) {
+        nodeConfig.dimmingCurve = DIMMING_CURVE_CIE1931;
+    }
     NODE_ID = String(nodeConfig.nodeId);
     nodeState.zoneId = String(nodeConfig.zoneId);
     nodeState.autoMode = nodeConfig.autoMode;
@@ -138,13 +230,39 @@ void loadConfig() {
 // CONTROL DE LUMINARIA
 // =============================
 
+void writeDimmer() {
+    uint16_t duty = 0;
+    if (dimmer.level > 0) {
+        duty = dimmingDutyFine((DimmingCurveType)nodeConfig.dimmingCurve, dimmer.level);
+        if (duty == 0) duty = 1;  // Encendida nunca es apagada
+    }
+    analogWrite(DIMMER_PIN, duty);
+}
+
+// Avanza la rampa del PWM; se llama en cada loop()
+void updateDimmer() {
+    if (dimmer.level == dimmer.to) return;
+    
+    unsigned long elapsed = millis() - dimmer.start;
+    if (elapsed >= DIMMING_RAMP_MS) {
+        dimmer.level = dimmer.to;
+    } else {
+        int32_t delta = (int32_t)dimmer.to - dimmer.from;
+        dimmer.level = dimmer.from + delta * (int32_t)elapsed / DIMMING_RAMP_MS;
+    }
+    writeDimmer();
+}
+
 void setLight(bool on, uint8_t brightness = 100) {
     nodeState.lightOn = on;
     nodeState.brightness = constrain(brightness, 0, 100);
     
+    // Rampa desde donde esté el PWM hasta el nivel nuevo
+    dimmer.from = dimmer.level;
+    dimmer.to = on ? ((uint32_t)nodeState.brightness * (DIMMING_CURVE_FINE_STEPS - 1) + 50) / 100 : 0;
+    dimmer.start = millis();
+    
     if (on) {
-        // Si tuviéramos PWM, ajustaríamos el brillo
-        // Por ahora solo encender/apagar
         digitalWrite(RELAY_PIN, HIGH);
         digitalWrite(LED_PIN, LOW);  // LED invertido
         Serial.println("Luz encendida al " + String(brightness) + "%");
@@ -191,9 +309,10 @@ void onMqttMessage(char* topic, byte* payload, unsigned int length) {
     Serial.println("Mensaje recibido: " + topicStr);
     Serial.println("Payload: " + msg);
     
-    // Parsear JSON
-    StaticJsonDocument<512> doc;
-    DeserializationError error = deserializeJson(doc, msg);
+    // Parsear JSON sobre el buffer (sin copiar los textos): un frame
+    // set_levels del nodo central puede traer decenas de grupos
+    DynamicJsonDocument doc(1536);
+    DeserializationError error = deserializeJson(doc, message);
     
     if (error) {
         Serial.println("Error parseando JSON: " + String(error.c_str()));
@@ -214,10 +333,35 @@ void onMqttMessage(char* topic, byte* payload, unsigned int length) {
     }
 }
 
+// Frame set_levels del nodo central: [[nivel, "ID1ID2..."], ...] con los IDs
+// numéricos en 8 dígitos hexadecimales. Se busca el propio ID.
+void handleLevels(JsonDocument& doc) {
+    const char* ownId = NODE_ID.c_str() + 4;  // Sin el prefijo "LUM_"
+    
+    for (JsonArray group : doc["levels"].as<JsonArray>()) {
+        const char* ids = group[1];
+        if (!ids) continue;
+        for (size_t len = strlen(ids); len >= 8; len -= 8, ids += 8) {
+            if (strncmp(ids, ownId, 8) == 0) {
+                uint8_t brightness = group[0];
+                nodeStats.commandsReceived++;
+                nodeState.lastCommand = millis();
+                setLight(brightness > 0, brightness);
+                return;
+            }
+        }
+    }
+}
+
 void handleCommand(JsonDocument& doc) {
     String command = doc["command"].as<String>();
     JsonObject params = doc["params"];
     
+    if (command == "set_levels") {
+        handleLevels(doc);
+        return;
+    }
+    
     nodeStats.commandsReceived++;
     nodeState.lastCommand = millis();
     
@@ -241,15 +385,28 @@ void handleCommand(JsonDocument& doc) {
         setLight(nodeState.lightOn, brightness);
         sendStatus();
     }
+    else if (command == "set_curve") {
+        DimmingCurveType curve;
+        if (parseDimmingCurve(params["curve"] | "", curve)) {
+            nodeConfig.dimmingCurve = curve;
+            saveConfig();
+            writeDimmer();
+            sendDiscovery();  // El nodo central guarda la curva de cada luminaria
+        }
+        sendStatus();
+    }
     else if (command == "set_zone") {
         String newZone = params["zone"].as<String>();
+        if (newZone.length() == 0 || newZone.length() >= sizeof(nodeConfig.zoneId)) return;
+        
+        // Cambiar la suscripción a la nueva zona
+        mqttClient.unsubscribe(("luces/zone/" + nodeState.zoneId + "/#").c_str());
         nodeState.zoneId = newZone;
         strcpy(nodeConfig.zoneId, newZone.c_str());
         saveConfig();
+        mqttClient.subscribe(("luces/zone/" + newZone + "/#").c_str());
         
-        // Suscribirse a nueva zona
-        String zoneTopic = "luces/zone/" + newZone + "/#";
-        mqttClient.subscribe(zoneTopic.c_str());
+        sendDiscovery();  // El nodo central publica los frames de dimming en la zona del nodo
         sendStatus();
     }
     else if (command == "set_auto") {
@@ -298,6 +455,9 @@ void handleZoneCommand(JsonDocument& doc) {
         uint8_t brightness = doc["brightness"];
         setLight(nodeState.lightOn, brightness);
     }
+    else if (command == "set_levels") {
+        handleLevels(doc);
+    }
 }
 
 void handleOTARequest(JsonDocument& doc) {
@@ -325,7 +485,8 @@ void sendDiscovery() {
     doc["mac"] = WiFi.macAddress();
     doc["rssi"] = WiFi.RSSI();
     doc["zone"] = nodeState.zoneId;
-    doc["capabilities"]["dimming"] = false;  // Por ahora no tenemos PWM
+    doc["capabilities"]["dimming"] = true;
+    doc["capabilities"]["curve"] = dimmingCurveName((DimmingCurveType)nodeConfig.dimmingCurve);
     doc["capabilities"]["current_sensor"] = true;
     doc["capabilities"]["light_sensor"] = true;
     doc["capabilities"]["auto_mode"] = true;
@@ -534,9 +695,12 @@ void setup() {
     // Configurar pines
     pinMode(LED_PIN, OUTPUT);
     pinMode(RELAY_PIN, OUTPUT);
+    pinMode(DIMMER_PIN, OUTPUT);
     pinMode(LIGHT_SENSOR_PIN, INPUT);
     digitalWrite(LED_PIN, HIGH);  // LED apagado
     digitalWrite(RELAY_PIN, LOW);  // Luz apagada
+    analogWriteRange(DIMMING_PWM_MAX);
+    analogWrite(DIMMER_PIN, 0);
     
     // Cargar configuración
     loadConfig();
@@ -576,6 +740,7 @@ void loop() {
         connectMQTT();
     }
     mqttClient.loop();
+    updateDimmer();
     
     // Verificar modo automático cada minuto
     static unsigned long lastAutoCheck = 0;
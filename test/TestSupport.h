@@ -0,0 +1,60 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+// =============================
+// Soporte común de los tests (env:native)
+// =============================
+// Cada carpeta test/test_<componente>/ es un programa aparte con un solo
+// archivo: este header se incluye una vez por programa, así que puede
+// definir el contador de asignaciones y el operator new que lo incrementa.
+
+#include <Arduino.h>
+#include <new>
+#include <unity.h>
+#include "hal/Platform.h"
+#include "config.h"
+#include "LuminariaRegistry.h"
+
+#define TEST_FS_ROOT ".pio/test_fs"
+#define TEST_FIXTURE_BASE 0x5100000  // ID de la primera luminaria de prueba
+
+// Asignaciones de heap del proceso (String y los contenedores usan operator
+// new). Fuera de línea: con el inlining el compilador vería malloc() en un
+// lado y operator delete del otro
+uint32_t heapAllocations = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+  heapAllocations++;
+  void* p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+// LittleFS en un directorio propio y vacío
+inline void resetTestFs() {
+  LittleFS.setRoot(TEST_FS_ROOT);
+  LittleFS.format();
+}
+
+const char* const testZones[] = {"zona_centro", "zona_norte", "zona_sur", "zona_este", "zona_oeste"};
+
+// Registro vacío con count luminarias (hasta MAX_LUCES) repartidas en cinco
+// zonas, como las que anuncia la simulación
+inline uint16_t loadTestFixtures(uint32_t count) {
+  Luminarias.clear();
+  for (uint32_t i = 0; i < count && i < MAX_LUCES; i++) {
+    uint16_t pos = Luminarias.insert(TEST_FIXTURE_BASE + i);
+    if (pos == REGISTRY_NOT_FOUND) break;
+    Luminarias.setPosicion(pos, DEFAULT_LAT + (random(-500, 500) / 10000.0),
+                                DEFAULT_LNG + (random(-500, 500) / 10000.0));
+    Luminarias.setEstado(pos, ESTADO_APAGADA);
+    Luminarias.setZona(pos, Luminarias.internZone(testZones[i % 5]));
+    Luminarias.setDimeable(pos, true);
+  }
+  return Luminarias.size();
+}
+
+#endif // TEST_SUPPORT_H
@@ -0,0 +1,135 @@
+// Tests de ApiRouteTable: el trie de rutas /api/ que usa ApiRouter
+
+#include <TestSupport.h>
+#include "ApiRouteTable.h"
+
+// Mismos bits que WebRequestMethod de ESPAsyncWebServer
+#define TEST_HTTP_GET 0x01
+#define TEST_HTTP_POST 0x02
+#define TEST_HTTP_DELETE 0x04
+
+struct TestRoute {
+  const char* pattern;  // Como se registra en ApiRouter (main.cpp)
+  uint8_t method;
+};
+
+// Rutas de main.cpp, en el mismo orden
+const TestRoute routes[] = {
+  {"/api/auth/login", TEST_HTTP_POST},
+  {"/api/auth/logout", TEST_HTTP_POST},
+  {"/api/auth/validate", TEST_HTTP_GET},
+  {"/api/system/info", TEST_HTTP_GET},
+  {"/api/system/restart", TEST_HTTP_POST},
+  {"/api/admin/users", TEST_HTTP_GET},
+  {"/api/admin/users/add", TEST_HTTP_POST},
+  {"/api/admin/sessions", TEST_HTTP_GET},
+  {"/api/admin/security/stats", TEST_HTTP_GET},
+  {"/api/admin/backup", TEST_HTTP_POST},
+  {"/api/admin/restore", TEST_HTTP_POST},
+  {"/api/wifi/stats", TEST_HTTP_GET},
+  {"/api/memory/stats", TEST_HTTP_GET},
+  {"/api/logs/recent", TEST_HTTP_GET},
+  {"/api/logs/query", TEST_HTTP_GET},
+  {"/api/schedules", TEST_HTTP_GET},
+  {"/api/schedules/add", TEST_HTTP_POST},
+  {"/api/schedules/:id/enable", TEST_HTTP_POST},
+  {"/api/schedules/:id", TEST_HTTP_DELETE},
+  {"/api/zones", TEST_HTTP_GET},
+  {"/api/zones/add", TEST_HTTP_POST},
+  {"/api/alerts", TEST_HTTP_GET},
+  {"/api/alerts/:id/acknowledge", TEST_HTTP_POST},
+  {"/api/events", TEST_HTTP_GET},
+  {"/api/consumption/stats", TEST_HTTP_GET},
+  {"/api/consumption/history", TEST_HTTP_GET},
+  {"/api/export/*", TEST_HTTP_GET},
+  {"/api/scenes", TEST_HTTP_GET},
+  {"/api/scenes/activate", TEST_HTTP_POST},
+  {"/api/scenes/preset", TEST_HTTP_POST},
+  {"/api/dimming", TEST_HTTP_POST},
+  {"/api/zones/control", TEST_HTTP_POST},
+  {"/api/zones/visual", TEST_HTTP_GET},
+  {"/api/effects", TEST_HTTP_POST},
+};
+const uint8_t routeCount = sizeof(routes) / sizeof(routes[0]);
+
+struct TestRequest {
+  const char* url;
+  uint8_t method;
+  int8_t route;  // Índice en routes (-1 = 404)
+  uint32_t id;
+  const char* tail;
+};
+
+const TestRequest requests[] = {
+  {"/api/system/info", TEST_HTTP_GET, 3, 0, nullptr},
+  {"/api/auth/validate", TEST_HTTP_GET, 2, 0, nullptr},
+  {"/api/zones/visual", TEST_HTTP_GET, 32, 0, nullptr},
+  {"/api/zones", TEST_HTTP_GET, 19, 0, nullptr},
+  {"/api/dimming", TEST_HTTP_POST, 30, 0, nullptr},
+  {"/api/export/events.csv", TEST_HTTP_GET, 26, 0, "events.csv"},
+  {"/api/schedules/12/enable", TEST_HTTP_POST, 17, 12, nullptr},
+  {"/api/schedules/4294967295", TEST_HTTP_DELETE, 18, 4294967295UL, nullptr},
+  {"/api/alerts/345/acknowledge", TEST_HTTP_POST, 22, 345, nullptr},
+  {"/api/schedules/add", TEST_HTTP_POST, 16, 0, nullptr},
+  // Sin ruta: inexistente, id fuera de 32 bits, método que la ruta no acepta
+  {"/api/nope", TEST_HTTP_GET, -1, 0, nullptr},
+  {"/api/schedules/4294967296", TEST_HTTP_DELETE, -1, 0, nullptr},
+  {"/api/schedules/12/enable", TEST_HTTP_GET, -1, 0, nullptr},
+  {"/api/schedules/x1/enable", TEST_HTTP_POST, -1, 0, nullptr},
+};
+
+ApiRouteTable table;
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_routes_registered_in_order() {
+  for (uint8_t r = 0; r < routeCount; r++) {
+    TEST_ASSERT_EQUAL_UINT8(r, table.add(routes[r].pattern, routes[r].method));
+  }
+  TEST_ASSERT_EQUAL_UINT8(routeCount, table.getRouteCount());
+  TEST_ASSERT_LESS_OR_EQUAL(API_MAX_NODES, table.getNodeCount());
+}
+
+void test_invalid_patterns_rejected() {
+  // Fuera de /api/, "*" con segmentos después, segmento vacío
+  TEST_ASSERT_EQUAL_UINT8(API_NONE, table.add("/otra/ruta", TEST_HTTP_GET));
+  TEST_ASSERT_EQUAL_UINT8(API_NONE, table.add("/api/export/*/x", TEST_HTTP_GET));
+  TEST_ASSERT_EQUAL_UINT8(API_NONE, table.add("/api//x", TEST_HTTP_GET));
+  TEST_ASSERT_EQUAL_UINT8(routeCount, table.getRouteCount());
+}
+
+void test_requests_match_route_and_params() {
+  for (const TestRequest& req : requests) {
+    ApiMatch match;
+    bool found = table.match(req.url, req.method, match);
+    TEST_ASSERT_EQUAL_MESSAGE(req.route >= 0, found, req.url);
+    if (!found) continue;
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(req.route, match.route, req.url);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(req.id, match.id, req.url);
+    if (req.tail) {
+      TEST_ASSERT_EQUAL_UINT16(strlen(req.tail), match.tailLength);
+      TEST_ASSERT_EQUAL_MEMORY(req.tail, req.url + match.tailOffset, match.tailLength);
+    }
+  }
+}
+
+void test_match_does_not_allocate() {
+  ApiMatch match;
+  uint32_t allocsBefore = heapAllocations;
+  for (uint16_t i = 0; i < 1000; i++) {
+    const TestRequest& req = requests[i % (sizeof(requests) / sizeof(requests[0]))];
+    table.match(req.url, req.method, match);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_routes_registered_in_order);
+  RUN_TEST(test_invalid_patterns_rejected);
+  RUN_TEST(test_requests_match_route_and_params);
+  RUN_TEST(test_match_does_not_allocate);
+  return UNITY_END();
+}
@@ -0,0 +1,69 @@
+// Tests de AuthManager: tabla de sesiones por hash y Auth.authorize()
+// (lo que usa REQUIRE_AUTH en cada handler protegido)
+
+#include <TestSupport.h>
+#include "AuthManager.h"
+
+const char* users[][2] = {{"admin", "admin123"}, {"operator", "oper123"}, {"viewer", "view123"}};
+const UserRole roles[] = {ROLE_ADMIN, ROLE_OPERATOR, ROLE_VIEWER};
+
+String tokens[MAX_SESSIONS];
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_login_fills_sessions() {
+  for (uint8_t i = 0; i < MAX_SESSIONS; i++) {
+    tokens[i] = Auth.login(users[i % 3][0], users[i % 3][1], "10.0.0." + String(i));
+    TEST_ASSERT_EQUAL(TOKEN_LENGTH, tokens[i].indexOf('_'));
+    TEST_ASSERT_EQUAL(roles[i % 3], Auth.getUserRole(tokens[i]));
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, Auth.login("admin", "incorrecta", "10.0.0.99").length());
+}
+
+void test_authorize_by_role() {
+  for (uint8_t i = 0; i < MAX_SESSIONS; i++) {
+    String header = "Bearer " + tokens[i];
+    for (uint8_t r = ROLE_VIEWER; r <= ROLE_ADMIN; r++) {
+      TEST_ASSERT_EQUAL(roles[i % 3] >= r, Auth.authorize(header.c_str(), (UserRole)r));
+      // Sin el prefijo "Bearer " decide lo mismo, como el REQUIRE_AUTH anterior
+      TEST_ASSERT_EQUAL(roles[i % 3] >= r, Auth.authorize(tokens[i].c_str(), (UserRole)r));
+    }
+  }
+}
+
+void test_unknown_tokens_rejected() {
+  String unknown = "Bearer " + tokens[0].substring(0, TOKEN_LENGTH) + "_x";
+  TEST_ASSERT_FALSE(Auth.authorize(unknown.c_str(), ROLE_VIEWER));
+  TEST_ASSERT_FALSE(Auth.authorize("", ROLE_VIEWER));
+  TEST_ASSERT_FALSE(Auth.authorize("Bearer ", ROLE_VIEWER));
+}
+
+void test_authorize_does_not_allocate() {
+  String header = "Bearer " + tokens[1];
+  uint32_t allocsBefore = heapAllocations;
+  for (uint16_t i = 0; i < 1000; i++) Auth.authorize(header.c_str(), ROLE_OPERATOR);
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+}
+
+void test_logout_revokes() {
+  String header = "Bearer " + tokens[0];
+  TEST_ASSERT_TRUE(Auth.logout(tokens[0]));
+  TEST_ASSERT_FALSE(Auth.authorize(header.c_str(), ROLE_VIEWER));
+  // Las demás sesiones siguen
+  header = "Bearer " + tokens[3];
+  TEST_ASSERT_TRUE(Auth.authorize(header.c_str(), ROLE_ADMIN));
+}
+
+int main() {
+  resetTestFs();
+  Auth.begin();
+  UNITY_BEGIN();
+  RUN_TEST(test_login_fills_sessions);
+  RUN_TEST(test_authorize_by_role);
+  RUN_TEST(test_unknown_tokens_rejected);
+  RUN_TEST(test_authorize_does_not_allocate);
+  RUN_TEST(test_logout_revokes);
+  return UNITY_END();
+}
@@ -0,0 +1,170 @@
+// Tests de /api/export/* (DatabaseManager::createExportSource): CSV y JSON
+// por fragmentos de tamaño variable, el CSV igual al de la exportación
+// anterior armada en un String
+
+#include <TestSupport.h>
+#include <vector>
+#include "DatabaseManager.h"
+#include "EventLog.h"
+#include "RecordStream.h"
+
+#define TEST_EXPORT_EVENTS 2000
+
+std::vector<uint32_t> zoneIds;
+
+// Lee la exportación completa por fragmentos de tamaño variable, como los
+// pide AsyncWebServer según el espacio libre del socket
+String readExport(const char* type, StreamFormat format) {
+  RecordSource* source = Database.createExportSource(type);
+  TEST_ASSERT_NOT_NULL(source);
+  String out;
+  uint8_t chunk[97];
+  RecordStream stream(source, format);
+  while (true) {
+    size_t n = stream.read(chunk, random(1, sizeof(chunk) + 1));
+    if (n == 0) break;
+    for (size_t i = 0; i < n; i++) out += (char)chunk[i];
+  }
+  return out;
+}
+
+// Campo CSV como lo escribía exportToCSV(), más comillas RFC 4180 solo
+// cuando el texto tiene separadores
+String csvField(const String& text) {
+  if (text.indexOf(',') < 0 && text.indexOf('"') < 0 && text.indexOf('\n') < 0 && text.indexOf('\r') < 0) {
+    return text;
+  }
+  String quoted = "\"";
+  for (size_t i = 0; i < text.length(); i++) {
+    if (text[i] == '"') quoted += '"';
+    quoted += text[i];
+  }
+  return quoted + "\"";
+}
+
+// Formato de la exportación anterior, armado en un String
+String legacyCsv(const char* type) {
+  String csv;
+  if (strcmp(type, "events") == 0) {
+    csv = "ID,Timestamp,Luminaria,Type,Description,User\n";
+    std::vector<Event> events = Database.getEvents(EVENT_INDEX_SIZE);
+    for (size_t i = events.size(); i > 0; i--) {
+      const Event& e = events[i - 1];
+      csv += String(e.id) + "," + String(e.timestamp) + "," + csvField(e.luminariaId) + "," +
+             String(e.type) + "," + csvField(e.description) + "," + csvField(e.user) + "\n";
+    }
+  } else if (strcmp(type, "schedules") == 0) {
+    csv = "ID,Name,Enabled,OnTime,OffTime,Days\n";
+    for (const auto& s : Database.getAllSchedules()) {
+      csv += String(s.id) + "," + csvField(s.name) + "," + String(s.enabled) + "," +
+             String(s.hourOn) + ":" + String(s.minuteOn) + "," +
+             String(s.hourOff) + ":" + String(s.minuteOff) + "," +
+             String(s.daysOfWeek) + "\n";
+    }
+  } else if (strcmp(type, "zones") == 0) {
+    csv = "ID,Name,Description,Luminarias,Active\n";
+    for (uint32_t id : zoneIds) {
+      Zone z = Database.getZone(id);
+      csv += String(z.id) + "," + csvField(z.name) + "," + csvField(z.description) + "," +
+             String(z.luminarias.size()) + "," + String(z.active) + "\n";
+    }
+  }
+  return csv;
+}
+
+uint32_t countLines(const String& text) {
+  uint32_t lines = 0;
+  for (size_t i = 0; i < text.length(); i++) {
+    if (text[i] == '\n') lines++;
+  }
+  return lines;
+}
+
+// Registros del JSON exportado
+uint32_t jsonRecords(const String& json) {
+  // Cada valor ocupa un slot (32 bytes en 64 bits), más que su texto
+  DynamicJsonDocument parsed(json.length() * 4 + 1024);
+  TEST_ASSERT_FALSE(deserializeJson(parsed, json));
+  return parsed.as<JsonArray>().size();
+}
+
+// Base con eventos (con comas y comillas), schedules, zonas y consumo
+void fillDatabase() {
+  resetTestFs();
+  Database.begin();
+  loadTestFixtures(MAX_LUCES);
+
+  const char* descriptions[] = {"Encendido programado", "Falla de lámpara, fase 2", "Reparada por \"cuadrilla 3\"",
+                                "Cambio de estado", "Sensor de luz"};
+  for (uint32_t i = 0; i < TEST_EXPORT_EVENTS; i++) {
+    String id = LuminariaRegistry::formatId(Luminarias.getId(i % Luminarias.size()));
+    Database.logEvent(id, (EventType)(i % 8), descriptions[i % 5], i % 3 ? "SYSTEM" : "admin");
+  }
+  Database.addSchedule("Noche", 19, 30, 6, 0, 0x7F);
+  Database.addSchedule("Fin de semana, plazas", 20, 0, 2, 15, 0x41);
+
+  zoneIds.push_back(Database.createZone("Centro", "Casco histórico"));
+  zoneIds.push_back(Database.createZone("Norte", "Barrios, parque industrial"));
+  for (uint16_t i = 0; i < Luminarias.size() && i < 40; i++) {
+    Database.addLuminariaToZone(zoneIds[i % 2], LuminariaRegistry::formatId(Luminarias.getId(i)));
+  }
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    String id = LuminariaRegistry::formatId(Luminarias.getId(i));
+    for (uint8_t k = 0; k < 3; k++) Database.logConsumption(id, 40 + (i + k) % 30, 220, 0);
+  }
+}
+
+void verifyExport(const char* type) {
+  String csv = readExport(type, STREAM_FORMAT_CSV);
+  String json = readExport(type, STREAM_FORMAT_JSON);
+  uint32_t records = jsonRecords(json);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, records);
+  String legacy = legacyCsv(type);
+  TEST_ASSERT_EQUAL_STRING(legacy.c_str(), csv.c_str());
+  TEST_ASSERT_EQUAL_UINT32(records + 1, countLines(csv));
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_export_events() {
+  verifyExport("events");
+}
+
+void test_export_schedules() {
+  verifyExport("schedules");
+}
+
+void test_export_zones() {
+  verifyExport("zones");
+}
+
+void test_export_consumption() {
+  // Sin exportación CSV anterior: una fila por registro del JSON
+  String csv = readExport("consumption", STREAM_FORMAT_CSV);
+  String json = readExport("consumption", STREAM_FORMAT_JSON);
+  TEST_ASSERT_TRUE(csv.startsWith("Timestamp,Luminaria,Power,Voltage,Current\n"));
+  TEST_ASSERT_EQUAL_UINT32(jsonRecords(json) + 1, countLines(csv));
+
+  // Los rollups guardan mínimo y máximo en deciwatts, como las muestras
+  StaticJsonDocument<768> stats;
+  deserializeJson(stats, Database.getConsumptionStats());
+  TEST_ASSERT_EQUAL_FLOAT(40, stats["min_power_24h"]);
+  TEST_ASSERT_EQUAL_FLOAT(69, stats["max_power_24h"]);
+}
+
+void test_unknown_type() {
+  TEST_ASSERT_NULL(Database.createExportSource("nope"));
+}
+
+int main() {
+  fillDatabase();
+  UNITY_BEGIN();
+  RUN_TEST(test_export_events);
+  RUN_TEST(test_export_schedules);
+  RUN_TEST(test_export_zones);
+  RUN_TEST(test_export_consumption);
+  RUN_TEST(test_unknown_type);
+  return UNITY_END();
+}
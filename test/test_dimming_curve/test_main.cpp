@@ -0,0 +1,71 @@
+// Tests de las tablas de DimmingCurve: extremos, monotonía, diferencia con la
+// fórmula en punto flotante y ningún nivel encendido en duty 0
+
+#include <TestSupport.h>
+#include <math.h>
+#include "DimmingCurve.h"
+
+// Misma fórmula que DimmingCurve.h, con pow() de la libm
+double curveReference(DimmingCurveType curve, double x) {
+  if (curve == DIMMING_CURVE_CIE1931) return x * 100 <= 8 ? x * 100 / 903.3 : pow((x * 100 + 16) / 116, 3);
+  if (curve == DIMMING_CURVE_GAMMA22) return pow(x, 2.2);
+  return x;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_fine_table_matches_formula() {
+  for (uint8_t c = 0; c < DIMMING_CURVE_COUNT; c++) {
+    DimmingCurveType curve = (DimmingCurveType)c;
+    uint16_t previous = 0;
+    for (uint16_t i = 0; i < DIMMING_CURVE_FINE_STEPS; i++) {
+      uint16_t duty = dimmingDutyFine(curve, i);
+      TEST_ASSERT_GREATER_OR_EQUAL_UINT16(previous, duty);
+      previous = duty;
+      double expected = curveReference(curve, (double)i / (DIMMING_CURVE_FINE_STEPS - 1)) * DIMMING_PWM_MAX;
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(1, (uint32_t)lround(fabs(duty - expected)));
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, dimmingDutyFine(curve, 0));
+    TEST_ASSERT_EQUAL_UINT16(DIMMING_PWM_MAX, dimmingDutyFine(curve, DIMMING_CURVE_FINE_STEPS - 1));
+  }
+}
+
+void test_percent_table() {
+  for (uint8_t c = 0; c < DIMMING_CURVE_COUNT; c++) {
+    DimmingCurveType curve = (DimmingCurveType)c;
+    uint16_t previous = 0;
+    for (uint8_t p = 0; p <= 100; p++) {
+      uint16_t duty = dimmingDuty(curve, p);
+      TEST_ASSERT_GREATER_OR_EQUAL_UINT16(previous, duty);
+      previous = duty;
+      // Encendida nunca queda en duty 0
+      if (p > 0) {
+        TEST_ASSERT_NOT_EQUAL(0, duty);
+        TEST_ASSERT_NOT_EQUAL(0, dimmingLinearPercent(curve, p));
+      }
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, dimmingDuty(curve, 0));
+    TEST_ASSERT_EQUAL_UINT16(DIMMING_PWM_MAX, dimmingDuty(curve, 100));
+    TEST_ASSERT_EQUAL_UINT8(100, dimmingLinearPercent(curve, 100));
+  }
+}
+
+void test_names_round_trip() {
+  for (uint8_t c = 0; c < DIMMING_CURVE_COUNT; c++) {
+    DimmingCurveType parsed;
+    TEST_ASSERT_TRUE(parseDimmingCurve(dimmingCurveName((DimmingCurveType)c), parsed));
+    TEST_ASSERT_EQUAL_UINT8(c, parsed);
+  }
+  DimmingCurveType parsed;
+  TEST_ASSERT_FALSE(parseDimmingCurve("log", parsed));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fine_table_matches_formula);
+  RUN_TEST(test_percent_table);
+  RUN_TEST(test_names_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,135 @@
+// Tests de DimmingOutput: fades de zona, un efecto y un fade de
+// DimmingController salen en frames por zona que el nodo decodifica al mismo
+// nivel que tiene SceneManager; las luminarias de curva lineal reciben el
+// nivel corregido
+
+#include <TestSupport.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "SceneManager.h"
+#include "DimmingOutput.h"
+#include "DimmingCurve.h"
+
+// Recorre los grupos [nivel, "ids"] de un frame como handleLevels() del nodo
+template <typename F>
+bool forEachLevel(const char* payload, F callback) {
+  DynamicJsonDocument doc(4096);
+  if (deserializeJson(doc, payload) != DeserializationError::Ok || doc["command"] != DIMMING_COMMAND) return false;
+  for (JsonArray group : doc["levels"].as<JsonArray>()) {
+    uint8_t level = group[0];
+    const char* ids = group[1] | "";
+    size_t idsLen = strlen(ids);
+    if (idsLen % 8) return false;
+    for (size_t k = 0; k + 8 <= idsLen; k += 8) {
+      char hex[9];
+      memcpy(hex, ids + k, 8);
+      hex[8] = '\0';
+      if (!callback(Luminarias.find(strtoul(hex, nullptr, 16)), level)) return false;
+    }
+  }
+  return true;
+}
+
+void setUp() {
+  loadTestFixtures(MAX_LUCES);
+}
+
+void tearDown() {
+  DimmingOut.setSink(nullptr);
+}
+
+void test_scene_levels_reach_nodes() {
+  for (const char* zona : testZones) ZoneVisual.createZone(zona, zona);
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    ZoneVisual.addLightToZone(testZones[i % 5], LuminariaRegistry::formatId(Luminarias.getId(i)));
+  }
+
+  // Todas apagadas antes de los fades
+  for (uint16_t i = 0; i < Luminarias.size(); i++) Scenes.setLevel(i, 0);
+
+  // Mismo callback que main.cpp
+  uint32_t callbacks = 0;
+  Scenes.setDimmingCallback([&](uint16_t pos, uint8_t brightness) {
+    Luminarias.touch(pos);
+    Luminarias.setEstado(pos, brightness > 0 ? ESTADO_ENCENDIDA : ESTADO_APAGADA);
+    DimmingOut.set(pos, brightness);
+    callbacks++;
+  });
+
+  std::vector<int16_t> nodeLevels(Luminarias.size(), -1);
+  uint32_t frameErrors = 0;
+  uint32_t frames = 0;
+  DimmingOut.setSink([&](const char* zone, const char* payload) {
+    if (strlen(payload) > DIMMING_FRAME_SIZE) frameErrors++;
+    frames++;
+    bool ok = forEachLevel(payload, [&](uint16_t pos, uint8_t level) {
+      // Cada frame va solo a la zona de sus luminarias
+      if (pos == REGISTRY_NOT_FOUND) return false;
+      if (zone && strcmp(zone, Luminarias.getZoneName(Luminarias.getZona(pos))) != 0) return false;
+      nodeLevels[pos] = level;
+      return true;
+    });
+    if (!ok) frameErrors++;
+  });
+
+  // Fades de zona superpuestos y un efecto aleatorio
+  for (uint8_t z = 0; z < 5; z++) Scenes.setZoneBrightness(testZones[z], 100, 800 + z * 100);
+  Scenes.randomEffect("zona_norte", 1000);
+  Scenes.setZoneBrightness("zona_sur", 20, 600);
+
+  unsigned long start = millis();
+  bool dimmed = false;
+  while (Scenes.isTransitioning() && millis() - start < 10000) {
+    if (!dimmed && millis() - start >= 200) {
+      // Fade de DimmingController sobre una luz a mitad del fade de su zona:
+      // mismo motor, así que lo reemplaza y sale en los frames
+      Dimming.fadeTo(LuminariaRegistry::formatId(Luminarias.getId(0)), 60, 400);
+      dimmed = true;
+    }
+    Scenes.loop();
+    DimmingOut.flush();
+    delay(1);
+  }
+  TEST_ASSERT_FALSE(Scenes.isTransitioning());
+  TEST_ASSERT_EQUAL_UINT32(0, frameErrors);
+
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    String id = LuminariaRegistry::formatId(Luminarias.getId(i));
+    TEST_ASSERT_EQUAL_INT16(Scenes.getLightBrightness(id), nodeLevels[i]);
+  }
+  TEST_ASSERT_EQUAL_INT16(60, nodeLevels[0]);
+  // Los niveles de un tick comparten frame en lugar de un mensaje por luminaria
+  TEST_ASSERT_LESS_THAN_UINT32(callbacks, frames);
+}
+
+void test_linear_fixtures_get_corrected_level() {
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    Luminarias.setCurva(i, (DimmingCurveType)(i % DIMMING_CURVE_COUNT));
+  }
+  uint32_t frameErrors = 0;
+  uint32_t checked = 0;
+  uint8_t sent = 0;
+  DimmingOut.setSink([&](const char* /* zone */, const char* payload) {
+    bool ok = forEachLevel(payload, [&](uint16_t pos, uint8_t level) {
+      if (pos == REGISTRY_NOT_FOUND) return false;
+      uint8_t expected = Luminarias.getCurva(pos) == DIMMING_CURVE_LINEAR
+                           ? dimmingLinearPercent(DIMMING_CURVE_CIE1931, sent) : sent;
+      checked++;
+      return level == expected;
+    });
+    if (!ok) frameErrors++;
+  });
+  for (sent = 0; sent <= 100; sent += 5) {
+    for (uint16_t i = 0; i < Luminarias.size(); i++) DimmingOut.set(i, sent);
+    DimmingOut.flush();
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, frameErrors);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)Luminarias.size() * 21, checked);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_scene_levels_reach_nodes);
+  RUN_TEST(test_linear_fixtures_get_corrected_level);
+  return UNITY_END();
+}
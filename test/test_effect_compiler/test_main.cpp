@@ -0,0 +1,86 @@
+// Tests de EffectCompiler: cada efecto compilado sobre todas las luminarias
+// se reproduce en TransitionEngine con un reloj falso, termina solo, sin
+// asignaciones durante la reproducción y en el nivel final esperado
+
+#include <TestSupport.h>
+#include "BrightnessTable.h"
+#include "EffectTimeline.h"
+#include "TransitionEngine.h"
+
+#define TEST_EFFECT_LEVEL 50  // Nivel de todas antes del efecto
+
+BrightnessTable* table;
+TransitionEngine* engine;
+EffectTimeline timeline;  // El mismo para todos: clear() conserva la capacidad
+
+void setUp() {
+  table = new BrightnessTable();
+  engine = new TransitionEngine(*table);
+  table->fill(MAX_LUCES, TEST_EFFECT_LEVEL);
+  timeline.clear();
+  for (uint16_t i = 0; i < MAX_LUCES; i++) timeline.addFixture(i);
+}
+
+void tearDown() {
+  delete engine;
+  delete table;
+}
+
+// Reproduce el timeline hasta que termina y verifica el nivel final
+void playAndVerify(uint8_t expected) {
+  uint32_t outputs = 0;
+  engine->setOutput([&](uint16_t, uint8_t) { outputs++; });
+  engine->play(0, &timeline, 0);
+
+  uint32_t ticks = timeline.duration / TRANSITION_TICK_MS + 1;
+  uint32_t allocsBefore = heapAllocations;
+  uint32_t tick = 0;
+  for (uint32_t t = 0; engine->getPlayingCount() && tick < ticks + 10; t += TRANSITION_TICK_MS, tick++) {
+    engine->update(t);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+  TEST_ASSERT_EQUAL_UINT8(0, engine->getPlayingCount());
+  TEST_ASSERT_GREATER_THAN_UINT32(0, outputs);
+  for (uint16_t i = 0; i < MAX_LUCES; i++) TEST_ASSERT_EQUAL_UINT8(expected, table->getCurrent(i));
+}
+
+void test_wave() {
+  EffectCompiler::wave(timeline, 5000);
+  playAndVerify(30);
+}
+
+void test_random() {
+  EffectCompiler::randomLevels(timeline, 5000, 12345);
+  playAndVerify(TEST_EFFECT_LEVEL);
+}
+
+void test_sequence() {
+  EffectCompiler::sequence(timeline, 500);
+  playAndVerify(100);
+}
+
+void test_strobe() {
+  EffectCompiler::strobe(timeline, 2000, 2 * TRANSITION_TICK_MS);
+  playAndVerify(TEST_EFFECT_LEVEL);
+}
+
+void test_rainbow() {
+  EffectCompiler::rainbow(timeline, 5000);
+  playAndVerify(TEST_EFFECT_LEVEL);
+}
+
+void test_pulse() {
+  EffectCompiler::pulse(timeline, 20, 100, 3000);
+  playAndVerify(20);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_wave);
+  RUN_TEST(test_random);
+  RUN_TEST(test_sequence);
+  RUN_TEST(test_strobe);
+  RUN_TEST(test_rainbow);
+  RUN_TEST(test_pulse);
+  return UNITY_END();
+}
@@ -0,0 +1,220 @@
+// Tests de EventLog: log binario de eventos en segmentos, consultas por
+// índice y recuperación después de un corte de energía a mitad de escritura
+
+#include <TestSupport.h>
+#include <vector>
+#include "EventLog.h"
+
+#define TEST_EVENTS 3000
+#define TEST_EVENT_CUTS 60
+
+struct ExpectedEvent {
+  EventEntry entry;
+  uint32_t end;  // Posición donde termina el registro
+};
+
+EventLog* eventLog = nullptr;
+std::vector<ExpectedEvent> expected;
+uint32_t firstPosition = 0;
+uint32_t nextEvent = 0;
+uint32_t minRetained = 0xFFFFFFFF;  // Registros vivos, una vez lleno el índice
+
+void fillEvent(EventEntry& e, uint32_t n) {
+  char text[EVENT_DESCRIPTION_SIZE];
+  e.id = 0;
+  // El uptime vuelve a cero cada 500 eventos, como después de un reinicio
+  e.timestamp = (n % 500) * 60;
+  e.type = n % 8;
+  snprintf(text, sizeof(text), "LUM_%08lX", (unsigned long)(TEST_FIXTURE_BASE + n % 37));
+  EventLog::copyText(e.luminaria, sizeof(e.luminaria), text);
+  // Descripciones de largo variable para que los registros no queden alineados
+  int pad = n % 40;
+  snprintf(text, sizeof(text), "Evento %lu %.*s", (unsigned long)n, pad, "........................................");
+  EventLog::copyText(e.description, sizeof(e.description), text);
+  EventLog::copyText(e.user, sizeof(e.user), n % 3 ? "system" : "admin");
+}
+
+void appendEvents(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++, nextEvent++) {
+    ExpectedEvent ev;
+    fillEvent(ev.entry, nextEvent);
+    uint32_t lastId = expected.empty() ? 0 : expected.back().entry.id;
+    eventLog->append(ev.entry);
+    ev.end = eventLog->getEndPosition();
+    // Los ids no se repiten aunque se haya perdido el registro que los tenía
+    TEST_ASSERT_GREATER_THAN_UINT32(lastId, ev.entry.id);
+    expected.push_back(ev);
+    if (nextEvent >= 2 * EVENT_INDEX_SIZE) minRetained = min(minRetained, eventLog->getRecordCount());
+  }
+}
+
+bool sameEvent(const EventEntry& a, const EventEntry& b) {
+  return a.id == b.id && a.timestamp == b.timestamp && a.position == b.position && a.type == b.type &&
+         strcmp(a.luminaria, b.luminaria) == 0 && strcmp(a.description, b.description) == 0 &&
+         strcmp(a.user, b.user) == 0;
+}
+
+// El log completo tiene que ser lo esperado, sin los segmentos ya rotados
+void verifyEvents() {
+  size_t i = 0;
+  EventCursor cursor(firstPosition);
+  EventEntry e;
+  while (i < expected.size() && expected[i].entry.position < eventLog->getFirstPosition()) i++;
+  size_t kept = expected.size() - i;
+  while (eventLog->next(cursor, e)) {
+    TEST_ASSERT_TRUE(i < expected.size());
+    TEST_ASSERT_TRUE(sameEvent(e, expected[i].entry));
+    i++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(expected.size(), i);
+  TEST_ASSERT_EQUAL_UINT32(kept, eventLog->getRecordCount());
+}
+
+// Una consulta por índice, por páginas y continuando desde la posición del
+// último recibido, devuelve lo mismo que recorrer todo el log
+void verifyQuery(EventQuery query, uint8_t pageSize) {
+  std::vector<EventEntry> all;
+  EventCursor cursor;
+  EventEntry e;
+  while (eventLog->next(cursor, e)) {
+    if ((!query.luminaria || strcmp(e.luminaria, query.luminaria) == 0) &&
+        (query.type < 0 || e.type == query.type) && e.timestamp >= query.from && e.timestamp <= query.to) {
+      all.push_back(e);
+    }
+  }
+
+  size_t i = all.size();
+  while (true) {
+    EventQuery page = query;
+    uint8_t n = 0;
+    while (n < pageSize && eventLog->next(page, e)) {
+      TEST_ASSERT_TRUE(i > 0);
+      TEST_ASSERT_TRUE(sameEvent(e, all[i - 1]));
+      i--;
+      query.cursor = e.position;
+      n++;
+    }
+    if (n < pageSize) break;
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, i);
+}
+
+void verifyQueries() {
+  char luminaria[EVENT_LUMINARIA_SIZE];
+  for (uint32_t k = 0; k < 4; k++) {
+    EventQuery query;
+    snprintf(luminaria, sizeof(luminaria), "LUM_%08lX", (unsigned long)(TEST_FIXTURE_BASE + k * 11));
+    query.luminaria = luminaria;
+    verifyQuery(query, 7);
+    query.type = k % 8;
+    verifyQuery(query, 50);
+  }
+  for (int16_t type = 0; type < 8; type++) {
+    EventQuery query;
+    query.type = type;
+    verifyQuery(query, 13);
+  }
+  EventQuery range;
+  range.from = 3000;
+  range.to = 9000;
+  verifyQuery(range, 20);
+  range.type = 3;
+  verifyQuery(range, 20);
+  verifyQuery(EventQuery(), 50);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_append_and_read_back() {
+  eventLog = new EventLog();
+  eventLog->begin();
+  eventLog->clear();
+  firstPosition = eventLog->getFirstPosition();
+  appendEvents(TEST_EVENTS);
+  verifyEvents();
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(EVENT_INDEX_SIZE, eventLog->getRecordCount());
+  // Liberar un segmento con el índice lleno no vacía el log
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(EVENT_INDEX_SIZE * 2 / 3, minRetained);
+}
+
+void test_indexed_queries_match_scan() {
+  verifyQueries();
+}
+
+void test_recovery_after_power_cut() {
+  uint32_t cuts = 0;
+  for (uint32_t k = 0; k < TEST_EVENT_CUTS && !expected.empty(); k++) {
+    uint32_t end = eventLog->getEndPosition();
+    uint32_t segmentStart = end - end % EVENT_SEGMENT_SIZE;
+    uint32_t lastStart = expected.back().entry.position;
+    uint32_t validEnd = end;
+    if (lastStart < segmentStart) {
+      // Solo se recupera el último segmento: uno más para empezar otro
+      appendEvents(1);
+      continue;
+    }
+
+    char path[32];
+    EventLog::segmentPath(end / EVENT_SEGMENT_SIZE, path, sizeof(path));
+    delete eventLog;  // Corte de energía: no se cierra nada más
+
+    switch (k % 3) {
+      case 0: {
+        // Escritura interrumpida: el segmento termina dentro de un registro
+        uint32_t cut = lastStart + random(0, end - lastStart);
+        File f = LittleFS.open(path, "a");
+        f.truncate(cut - segmentStart);
+        f.close();
+        validEnd = lastStart;
+        break;
+      }
+      case 1: {
+        // Basura después del último registro (página a medio programar)
+        uint8_t garbage[EVENT_RECORD_MAX];
+        size_t length = random(1, sizeof(garbage));
+        for (size_t i = 0; i < length; i++) garbage[i] = random(0, 256);
+        File f = LittleFS.open(path, "a");
+        f.write(garbage, length);
+        f.close();
+        break;
+      }
+      default: {
+        // Registro completo pero con un byte alterado: falla el CRC
+        File f = LittleFS.open(path, "r+");
+        uint32_t at = lastStart + random(0, end - lastStart) - segmentStart;
+        f.seek(at);
+        uint8_t b = f.read();
+        f.seek(at);
+        f.write((uint8_t)(b ^ 0x5A));
+        f.close();
+        validEnd = lastStart;
+        break;
+      }
+    }
+    while (!expected.empty() && expected.back().end > validEnd) expected.pop_back();
+    cuts++;
+
+    eventLog = new EventLog();
+    eventLog->begin();
+    TEST_ASSERT_EQUAL_UINT32(validEnd, eventLog->getEndPosition());
+    verifyEvents();
+
+    // Después de recuperar se sigue agregando detrás del último registro válido
+    appendEvents(1 + k % 4);
+    verifyEvents();
+    if (k % 10 == 0) verifyQueries();
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(TEST_EVENT_CUTS / 2, cuts);
+}
+
+int main() {
+  resetTestFs();
+  UNITY_BEGIN();
+  RUN_TEST(test_append_and_read_back);
+  RUN_TEST(test_indexed_queries_match_scan);
+  RUN_TEST(test_recovery_after_power_cut);
+  delete eventLog;
+  return UNITY_END();
+}
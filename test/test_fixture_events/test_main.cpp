@@ -0,0 +1,181 @@
+// Tests de los handlers de FixtureEvents con nodos anunciados por discovery:
+// cada frame de dimming llega solo a los nodos suscriptos a su topic, también
+// después de un set_zone, y el registro guarda la zona, el dimming y la curva
+// que anunció cada nodo. Las acciones programadas pasan por Scenes
+
+#include <TestSupport.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "DatabaseManager.h"
+#include "DimmingOutput.h"
+#include "FixtureEvents.h"
+#include "MQTTManager.h"
+#include "SceneManager.h"
+
+#define TEST_ZONE_LONG "zona_con_nombre_muy_largo"  // No entra en REGISTRY_ZONE_NAME_MAX
+
+// Nodo simulado: la zona a la que está suscripto y el último nivel recibido
+struct TestNode {
+  String id;
+  String zone;
+  int16_t level;
+};
+
+std::vector<TestNode> nodes;
+uint32_t discoveryCallbacks = 0;
+uint32_t frameErrors = 0;
+
+// Discovery como sendDiscovery() de node_luminaria.cpp
+void sendDiscovery(const TestNode& node) {
+  StaticJsonDocument<512> doc;
+  doc["nodeId"] = node.id;
+  doc["type"] = NODE_LUMINARIA;
+  doc["version"] = "0.6.0";
+  doc["ip"] = "10.0.0.2";
+  doc["mac"] = "5C:CF:7F:00:00:02";
+  doc["rssi"] = -60;
+  doc["zone"] = node.zone;
+  doc["capabilities"]["dimming"] = true;
+  doc["capabilities"]["curve"] = "cie1931";
+  doc["capabilities"]["current_sensor"] = true;
+  doc["capabilities"]["light_sensor"] = true;
+  doc["capabilities"]["auto_mode"] = true;
+  String payload;
+  serializeJson(doc, payload);
+  MQTT.processDiscoveryMessage(payload);
+}
+
+// Publica un nivel distinto por luminaria y entrega cada frame solo a los
+// nodos suscriptos a su topic; devuelve los nodos que no quedaron en su nivel
+uint32_t deliverLevels(uint8_t round) {
+  DimmingOut.setSink([&](const char* zone, const char* payload) {
+    // Mismo topic que el sink de main.cpp
+    String topic = zone ? String(MQTT_BASE_TOPIC "/zone/") + zone : String(MQTT_COMMAND_TOPIC "/all");
+    DynamicJsonDocument doc(4096);
+    if (deserializeJson(doc, payload) != DeserializationError::Ok) {
+      frameErrors++;
+      return;
+    }
+    for (TestNode& node : nodes) {
+      // Suscripciones de connectMQTT(): luces/cmd/all/# y luces/zone/<zona>/#
+      if (topic != MQTT_COMMAND_TOPIC "/all" && topic != String(MQTT_BASE_TOPIC "/zone/") + node.zone) continue;
+      // handleLevels(): busca el propio ID en los grupos
+      const char* ownId = node.id.c_str() + strlen(LUMINARIA_ID_PREFIX);
+      for (JsonArray group : doc["levels"].as<JsonArray>()) {
+        const char* ids = group[1] | "";
+        for (size_t len = strlen(ids); len >= 8; len -= 8, ids += 8) {
+          if (strncmp(ids, ownId, 8) == 0) node.level = group[0];
+        }
+      }
+    }
+  });
+
+  for (TestNode& node : nodes) node.level = -1;
+  for (uint16_t i = 0; i < nodes.size(); i++) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(nodes[i].id));
+    if (pos != REGISTRY_NOT_FOUND) DimmingOut.set(pos, (i * 7 + round * 13) % 101);
+  }
+  DimmingOut.flush();
+
+  uint32_t missed = 0;
+  for (uint16_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i].level != (int16_t)((i * 7 + round * 13) % 101)) missed++;
+  }
+  return missed;
+}
+
+// Zona y capacidades (dimming, curva) tal como las anunció cada nodo
+void verifyRegistry() {
+  for (const TestNode& node : nodes) {
+    uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(node.id));
+    TEST_ASSERT_NOT_EQUAL(REGISTRY_NOT_FOUND, pos);
+    const char* expected = node.zone == TEST_ZONE_LONG ? "" : node.zone.c_str();
+    TEST_ASSERT_EQUAL_STRING(expected, Luminarias.getZoneName(Luminarias.getZona(pos)));
+    TEST_ASSERT_TRUE(Luminarias.isDimeable(pos));
+    TEST_ASSERT_EQUAL_UINT8(DIMMING_CURVE_CIE1931, Luminarias.getCurva(pos));
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_discovery_registers_nodes() {
+  // Uno de cada 11 se anuncia con un nombre que el registro no puede guardar
+  // entero (sus frames van por luces/cmd/all)
+  nodes.resize(MAX_LUCES);
+  for (uint16_t i = 0; i < nodes.size(); i++) {
+    nodes[i].id = LuminariaRegistry::formatId(TEST_FIXTURE_BASE + i);
+    nodes[i].zone = i % 11 == 10 ? TEST_ZONE_LONG : testZones[i % 5];
+    sendDiscovery(nodes[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT16(nodes.size(), Luminarias.size());
+  TEST_ASSERT_EQUAL_UINT32(nodes.size(), discoveryCallbacks);
+  verifyRegistry();
+}
+
+void test_frames_reach_subscribed_nodes() {
+  TEST_ASSERT_EQUAL_UINT32(0, deliverLevels(0));
+  TEST_ASSERT_EQUAL_UINT32(0, frameErrors);
+}
+
+void test_set_zone_resubscribes() {
+  // set_zone en un tercio de los nodos: se resuscriben y repiten el
+  // discovery; el resto lo repite sin cambios (el periódico)
+  uint32_t rezoned = 0;
+  for (uint16_t i = 0; i < nodes.size(); i++) {
+    if (i % 3 == 0) {
+      nodes[i].zone = i % 2 ? "zona_nueva" : testZones[(i + 1) % 5];
+      rezoned++;
+    }
+    sendDiscovery(nodes[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(nodes.size() + rezoned, discoveryCallbacks);
+  TEST_ASSERT_EQUAL_UINT32(0, deliverLevels(1));
+  TEST_ASSERT_EQUAL_UINT32(0, frameErrors);
+  verifyRegistry();
+}
+
+void test_schedule_action_goes_through_scenes() {
+  // Un fade en curso y una acción programada que lo pisa: el nivel queda en
+  // Brightness (lo que informan el registro y el promedio) y no se retoma
+  uint16_t pos = Luminarias.find(LuminariaRegistry::parseId(nodes[0].id));
+  Scenes.setLevel(pos, 0);
+  Scenes.fadeLevel(pos, 100, 1000);
+  delay(TRANSITION_TICK_MS + 10);
+  Scenes.loop();
+  TEST_ASSERT_GREATER_THAN_UINT8(0, Luminarias.getIntensidad(pos));
+  uint32_t revision = Luminarias.getRevision();
+  onScheduleAction(ACTION_TURN_ON, nodes[0].id, 60);
+  TEST_ASSERT_EQUAL_UINT8(60, Brightness.getCurrent(pos));
+  TEST_ASSERT_EQUAL_UINT8(60, Luminarias.getIntensidad(pos));
+  TEST_ASSERT_EQUAL(ESTADO_ENCENDIDA, Luminarias.getEstado(pos));
+  TEST_ASSERT_GREATER_THAN_UINT32(revision, Luminarias.getRevisionOf(pos));
+
+  unsigned long start = millis();
+  while (millis() - start < 1200) {
+    Scenes.loop();
+    delay(1);
+  }
+  TEST_ASSERT_EQUAL_UINT8(60, Luminarias.getIntensidad(pos));
+
+  onScheduleAction(ACTION_TURN_OFF, "all", 0);
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT8(0, Luminarias.getIntensidad(i));
+    TEST_ASSERT_EQUAL(ESTADO_APAGADA, Luminarias.getEstado(i));
+  }
+  TEST_ASSERT_EQUAL_FLOAT(0, Scenes.getAverageBrightness());
+}
+
+int main() {
+  resetTestFs();
+  Database.begin();
+  registerFixtureHandlers();
+  MQTT.onNodeDiscovered([](const NodeInfo&) { discoveryCallbacks++; });
+  UNITY_BEGIN();
+  RUN_TEST(test_discovery_registers_nodes);
+  RUN_TEST(test_frames_reach_subscribed_nodes);
+  RUN_TEST(test_set_zone_resubscribes);
+  RUN_TEST(test_schedule_action_goes_through_scenes);
+  return UNITY_END();
+}
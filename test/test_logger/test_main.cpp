@@ -0,0 +1,91 @@
+// Tests de Logger: registros de tamaño fijo sin heap, segmentos en LittleFS
+// (también los que llenan el ring antes del primer loop()) y consultas de
+// /api/logs/*
+
+#include <TestSupport.h>
+#include "Logger.h"
+
+// Estadística de getLogStats()
+uint32_t logStat(const char* name) {
+  StaticJsonDocument<512> doc;
+  deserializeJson(doc, SystemLogger.getLogStats());
+  return doc[name];
+}
+
+// Registros que devuelven las páginas de /api/logs/query para el módulo
+uint32_t queryCount(const char* module) {
+  LogQuery query;
+  query.module = module;
+  DynamicJsonDocument doc(2 * LOG_QUERY_DOC_SIZE);  // Al deserializar se copian los textos
+  uint32_t total = 0;
+  do {
+    deserializeJson(doc, SystemLogger.queryLogs(query));
+    total += doc["logs"].size();
+    query.cursor = doc["next_cursor"];
+  } while (doc["more"]);
+  return total;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_logf_does_not_allocate() {
+  // Dentro del ring: con el ring lleno log() escribe a disco (abre segmentos)
+  const char* estado = "encendida";
+  SystemLogger.flush();
+  uint32_t allocsBefore = heapAllocations;
+  for (uint32_t i = 0; i < MAX_LOG_ENTRIES / 2; i++) {
+    SystemLogger.info("Luminaria actualizada", "TEST");
+    LOGF_INFO("TEST", "Luminaria %08X - %s (%u)", TEST_FIXTURE_BASE + i, estado, i);
+    LOGF_DEBUG("TEST", "Filtrado: %u", i);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+}
+
+void test_flush_reaches_segments() {
+  SystemLogger.clearLogs();
+  for (uint8_t i = 0; i < 10; i++) LOGF_INFO("FLUSH", "Registro %u", i);
+  SystemLogger.flush();
+  TEST_ASSERT_EQUAL_UINT32(0, logStat("unflushed"));
+  TEST_ASSERT_EQUAL_UINT32(10, queryCount("FLUSH"));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, SystemLogger.getLogFileSize());
+}
+
+void test_burst_without_loop_reaches_segments() {
+  // Como setup(): más registros que el ring sin pasar por loop()
+  SystemLogger.clearLogs();
+  uint32_t dropped = logStat("dropped");
+  for (uint16_t i = 0; i < 3 * MAX_LOG_ENTRIES; i++) LOGF_INFO("BURST", "Registro de arranque %u", i);
+  TEST_ASSERT_EQUAL_UINT32(dropped, logStat("dropped"));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, logStat("sync_staged"));
+  SystemLogger.flush();
+  TEST_ASSERT_EQUAL_UINT32(3 * MAX_LOG_ENTRIES, queryCount("BURST"));
+}
+
+void test_recent_logs_limited_by_ring() {
+  for (uint8_t i = 0; i < MAX_LOG_ENTRIES + 5; i++) LOGF_INFO("RECENT", "Registro %u", i);
+  DynamicJsonDocument doc(MAX_LOG_ENTRIES * 256);
+  deserializeJson(doc, SystemLogger.getRecentLogs(MAX_LOG_ENTRIES + 20));
+  TEST_ASSERT_EQUAL_UINT32(MAX_LOG_ENTRIES, doc.size());
+  // Lo que pide /api/logs/recent, del más viejo al más nuevo
+  deserializeJson(doc, SystemLogger.getRecentLogs(50));
+  TEST_ASSERT_EQUAL_UINT32(50, doc.size());
+  char last[24];
+  snprintf(last, sizeof(last), "Registro %u", MAX_LOG_ENTRIES + 4);
+  TEST_ASSERT_EQUAL_STRING(last, doc[49]["message"]);
+  TEST_ASSERT_EQUAL_STRING("RECENT", doc[49]["module"]);
+  deserializeJson(doc, SystemLogger.getRecentLogs(3));
+  TEST_ASSERT_EQUAL_UINT32(3, doc.size());
+}
+
+int main() {
+  resetTestFs();
+  SystemLogger.begin();
+  UNITY_BEGIN();
+  RUN_TEST(test_logf_does_not_allocate);
+  RUN_TEST(test_flush_reaches_segments);
+  RUN_TEST(test_burst_without_loop_reaches_segments);
+  RUN_TEST(test_recent_logs_limited_by_ring);
+  return UNITY_END();
+}
@@ -0,0 +1,121 @@
+// Tests de LuminariaRegistry: IDs canónicos, búsqueda por índice hash,
+// zonas internadas y revisiones (ETag y ?since= de /estado-luces)
+
+#include <TestSupport.h>
+
+void setUp() {
+  Luminarias.clear();
+}
+
+void tearDown() {}
+
+void test_ids_round_trip() {
+  // IDs dispersos, como los que salen del chip ID o de lat ^ lng
+  for (uint32_t i = 0; i < MAX_LUCES; i++) {
+    uint32_t id = (TEST_FIXTURE_BASE + i) * 2654435761u;
+    if (id == LUMINARIA_ID_INVALID) continue;
+    TEST_ASSERT_NOT_EQUAL(REGISTRY_NOT_FOUND, Luminarias.insert(id));
+  }
+  for (uint16_t pos = 0; pos < Luminarias.size(); pos++) {
+    String text = LuminariaRegistry::formatId(Luminarias.getId(pos));
+    TEST_ASSERT_EQUAL_UINT32(Luminarias.getId(pos), LuminariaRegistry::parseId(text));
+    TEST_ASSERT_EQUAL_UINT16(pos, Luminarias.find(LuminariaRegistry::parseId(text)));
+  }
+  TEST_ASSERT_TRUE(Luminarias.isFull());
+  TEST_ASSERT_EQUAL_UINT16(REGISTRY_NOT_FOUND, Luminarias.insert(0xA0000000u));
+}
+
+void test_non_canonical_ids_rejected() {
+  const char* nonCanonical[] = {"LUM_1234567", "LUM_12345678_", "LUM_abcdef01", "LUM_ABCDEF0", "lum_ABCDEF01",
+                                "LUM_FFFFFFFF", "", "LUM_"};
+  for (const char* text : nonCanonical) {
+    uint32_t id = LuminariaRegistry::parseId(text);
+    TEST_ASSERT_EQUAL_HEX32(LUMINARIA_ID_INVALID, id);
+    TEST_ASSERT_EQUAL_UINT16(REGISTRY_NOT_FOUND, Luminarias.insert(id));
+  }
+  TEST_ASSERT_EQUAL_UINT16(0, Luminarias.size());
+}
+
+void test_find_does_not_allocate() {
+  uint16_t count = loadTestFixtures(MAX_LUCES);
+  char text[16];
+  uint32_t found = 0;
+  uint32_t allocsBefore = heapAllocations;
+  for (uint32_t i = 0; i < 20u * count; i++) {
+    // 1 de cada 10 de una luminaria que no existe
+    uint32_t id = i % 10 == 9 ? 0xA0000000u + i : TEST_FIXTURE_BASE + i % count;
+    LuminariaRegistry::formatId(id, text, sizeof(text));
+    if (Luminarias.find(LuminariaRegistry::parseId(text)) != REGISTRY_NOT_FOUND) found++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+  TEST_ASSERT_EQUAL_UINT32(18u * count, found);
+}
+
+void test_zones_interned() {
+  loadTestFixtures(10);
+  TEST_ASSERT_EQUAL_UINT8(5, Luminarias.getZoneCount());
+  TEST_ASSERT_EQUAL_STRING("zona_norte", Luminarias.getZoneName(Luminarias.getZona(6)));
+  TEST_ASSERT_EQUAL_UINT8(Luminarias.findZone("zona_sur"), Luminarias.internZone("zona_sur"));
+
+  // Un nombre que no entra no se trunca: la luminaria queda sin zona
+  char longName[REGISTRY_ZONE_NAME_MAX + 1];
+  memset(longName, 'z', REGISTRY_ZONE_NAME_MAX);
+  longName[REGISTRY_ZONE_NAME_MAX] = '\0';
+  TEST_ASSERT_EQUAL_UINT8(ZONA_NINGUNA, Luminarias.internZone(longName));
+  TEST_ASSERT_EQUAL_STRING("", Luminarias.getZoneName(ZONA_NINGUNA));
+}
+
+void test_setters_bump_revision_only_on_change() {
+  loadTestFixtures(4);
+  uint32_t revision = Luminarias.getRevision();
+  Luminarias.setEstado(1, ESTADO_APAGADA);
+  Luminarias.setZona(1, Luminarias.getZona(1));
+  Luminarias.setDimeable(1, true);
+  TEST_ASSERT_EQUAL_UINT32(revision, Luminarias.getRevision());
+
+  Luminarias.setEstado(1, ESTADO_ENCENDIDA);
+  TEST_ASSERT_EQUAL_UINT32(revision + 1, Luminarias.getRevision());
+  TEST_ASSERT_EQUAL_UINT32(revision + 1, Luminarias.getRevisionOf(1));
+  Luminarias.setCurva(2, DIMMING_CURVE_GAMMA22);
+  TEST_ASSERT_EQUAL_UINT32(revision + 2, Luminarias.getRevisionOf(2));
+  TEST_ASSERT_EQUAL(DIMMING_CURVE_GAMMA22, Luminarias.getCurva(2));
+  TEST_ASSERT_TRUE(Luminarias.isDimeable(2));
+}
+
+void test_touch_keeps_revision() {
+  loadTestFixtures(4);
+  uint32_t revision = Luminarias.getRevision();
+  uint32_t before = Luminarias.getRevisionOf(3);
+  delay(2);
+  // Heartbeats y pasos de fade: vivacidad, sin revisión nueva (el ETag sigue
+  // coincidiendo)
+  Luminarias.touch(3);
+  TEST_ASSERT_EQUAL_UINT32(revision, Luminarias.getRevision());
+  TEST_ASSERT_EQUAL_UINT32(before, Luminarias.getRevisionOf(3));
+  TEST_ASSERT_UINT32_WITHIN(5, millis(), Luminarias.getUltimaActualizacion(3));
+}
+
+void test_intensidad_is_brightness() {
+  loadTestFixtures(4);
+  // insert() deja la luminaria al 100% en la única tabla de brillo
+  TEST_ASSERT_EQUAL_UINT8(100, Brightness.getCurrent(2));
+  TEST_ASSERT_EQUAL_UINT8(100, Luminarias.getIntensidad(2));
+
+  uint32_t revision = Luminarias.getRevision();
+  Brightness.setLevel(2, 35);
+  TEST_ASSERT_EQUAL_UINT8(35, Luminarias.getIntensidad(2));
+  Luminarias.notifyIntensidad(2);
+  TEST_ASSERT_EQUAL_UINT32(revision + 1, Luminarias.getRevisionOf(2));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ids_round_trip);
+  RUN_TEST(test_non_canonical_ids_rejected);
+  RUN_TEST(test_find_does_not_allocate);
+  RUN_TEST(test_zones_interned);
+  RUN_TEST(test_setters_bump_revision_only_on_change);
+  RUN_TEST(test_touch_keeps_revision);
+  RUN_TEST(test_intensidad_is_brightness);
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+// Tests de MaintenanceEngine: retención, compactación y backup incrementales,
+// reiniciando el motor a mitad de tarea (el estado en flash alcanza para
+// seguir)
+
+#include <TestSupport.h>
+#include <vector>
+#include "DatabaseManager.h"
+#include "EventLog.h"
+#include "MaintenanceEngine.h"
+
+#define TEST_MAINTENANCE_EVENTS 3000
+
+char orphanSegment[32];
+const char* orphans[4];
+
+std::vector<uint8_t> readFile(const char* path) {
+  std::vector<uint8_t> data;
+  File f = LittleFS.open(path, "r");
+  if (!f) return data;
+  data.resize(f.size());
+  if (!data.empty()) data.resize(f.read(data.data(), data.size()));
+  f.close();
+  return data;
+}
+
+void touchFile(const char* path) {
+  File f = LittleFS.open(path, "w");
+  TEST_ASSERT_TRUE(f);
+  f.print("huerfano");
+  f.close();
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_runs_across_restarts() {
+  resetTestFs();
+  Database.begin();
+  loadTestFixtures(MAX_LUCES);
+  for (uint32_t i = 0; i < TEST_MAINTENANCE_EVENTS; i++) {
+    String id = LuminariaRegistry::formatId(Luminarias.getId(i % Luminarias.size()));
+    Database.logEvent(id, (EventType)(i % 8), "Cambio de estado", "SYSTEM");
+  }
+  Database.addSchedule("Noche", 19, 30, 6, 0, 0x7F);
+  Database.createZone("Centro", "Casco histórico");
+
+  // Huérfanos: consumo viejo, copia a medio hacer, segmento fuera del
+  // manifiesto y un segmento en el backup que ya no existe
+  EventLog::segmentPath(99999, orphanSegment, sizeof(orphanSegment));
+  orphans[0] = DB_CONSUMPTION_FILE;
+  orphans[1] = DB_PATH "zones.db.tmp";
+  orphans[2] = orphanSegment;
+  orphans[3] = MAINTENANCE_BACKUP_DIR EVENT_SEGMENT_PREFIX "99999.bin";
+  LittleFS.mkdir(MAINTENANCE_BACKUP_DIR);
+  LittleFS.mkdir(MAINTENANCE_BACKUP_DIR DB_PATH);
+  LittleFS.mkdir(MAINTENANCE_BACKUP_DIR EVENT_DIR);
+  for (const char* path : orphans) touchFile(path);
+
+  MaintenanceEngine* engine = new MaintenanceEngine();
+  engine->begin();
+  engine->request(MAINTENANCE_RETENTION);
+  engine->request(MAINTENANCE_COMPACTION);
+  engine->request(MAINTENANCE_BACKUP);
+
+  uint32_t calls = 0;
+  uint32_t untilRestart = random(1, 4);
+  while ((engine->isBusy() || engine->getBacklog() > 0) && calls < 100000) {
+    engine->loop(random(0, 300));  // Presupuesto chico: muchos cortes a mitad de tarea
+    calls++;
+    if (--untilRestart == 0) {
+      delete engine;
+      engine = new MaintenanceEngine();
+      engine->begin();
+      untilRestart = random(1, 4);
+    }
+  }
+  bool done = !engine->isBusy() && engine->getBacklog() == 0;
+  delete engine;
+  TEST_ASSERT_TRUE(done);
+}
+
+void test_orphans_removed() {
+  for (const char* path : orphans) TEST_ASSERT_FALSE_MESSAGE(LittleFS.exists(path), "huérfano sin borrar");
+}
+
+void test_backup_matches_originals() {
+  // Cada archivo de la base tiene que estar igual en la copia
+  uint32_t files = 0;
+  char path[32];
+  bool immutable;
+  for (uint32_t i = 0; Database.getBackupSource(i, path, sizeof(path), immutable); i++) {
+    if (!LittleFS.exists(path)) continue;
+    std::vector<uint8_t> original = readFile(path);
+    std::vector<uint8_t> copy = readFile((String(MAINTENANCE_BACKUP_DIR) + path).c_str());
+    TEST_ASSERT_EQUAL_UINT32(original.size(), copy.size());
+    TEST_ASSERT_TRUE(original == copy);
+    files++;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, files);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_runs_across_restarts);
+  RUN_TEST(test_orphans_removed);
+  RUN_TEST(test_backup_matches_originals);
+  return UNITY_END();
+}
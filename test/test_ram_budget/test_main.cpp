@@ -0,0 +1,28 @@
+// Test del presupuesto de RAM estática: las instancias globales que compila
+// env:native (.data + .bss de la aplicación) más WEB_STATIC_RAM_RESERVE
+// entran en STATIC_RAM_BUDGET. Las tablas son arreglos de tipos de ancho
+// fijo, así que los tamaños coinciden con los del ESP8266 salvo punteros y
+// String (4 y 12 bytes allá). RamBudget.cpp verifica lo mismo al compilar;
+// aquí se informa el margen.
+
+#include <TestSupport.h>
+#include "RamBudget.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_globals_fit_budget() {
+  size_t total = APP_STATIC_RAM + WEB_STATIC_RAM_RESERVE;
+  char message[80];
+  snprintf(message, sizeof(message), "%u bytes (%u del servidor web) de %u", (unsigned)total,
+           (unsigned)WEB_STATIC_RAM_RESERVE, (unsigned)STATIC_RAM_BUDGET);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(STATIC_RAM_BUDGET, total);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_globals_fit_budget);
+  return UNITY_END();
+}
@@ -0,0 +1,296 @@
+// Tests de RecordStream sobre /estado-luces: JSON y MessagePack byte a byte
+// iguales al documento completo que se armaba antes, delta por revisión e
+// ida y vuelta en JSON, MessagePack y CBOR
+
+#include <TestSupport.h>
+#include <vector>
+#include "RecordStream.h"
+#include "SceneManager.h"
+
+// Documento completo como lo armaba getLuminariasJson() antes de
+// RecordStream (los IDs se copian: la fuente reutiliza su buffer)
+void buildLuminariasDocument(JsonArray arr, uint32_t since) {
+  for (uint16_t pos = 0; pos < Luminarias.size(); pos++) {
+    if (Luminarias.getRevisionOf(pos) <= since) continue;
+    JsonObject obj = arr.createNestedObject();
+    obj["id"] = LuminariaRegistry::formatId(Luminarias.getId(pos));
+    obj["lat"] = Luminarias.getLat(pos);
+    obj["lng"] = Luminarias.getLng(pos);
+    obj["estado"] = LuminariaRegistry::estadoToString(Luminarias.getEstado(pos));
+    obj["intensidad"] = Luminarias.getIntensidad(pos);
+    obj["zona"] = Luminarias.getZoneName(Luminarias.getZona(pos));
+    obj["dimeable"] = Luminarias.isDimeable(pos);
+    obj["curva"] = dimmingCurveName(Luminarias.getCurva(pos));
+    obj["ultima_actualizacion"] = Luminarias.getUltimaActualizacion(pos);
+  }
+}
+
+// Lee el stream completo por fragmentos de 1 a 97 bytes, como los pide
+// AsyncWebServer según el espacio libre del socket
+std::vector<uint8_t> readStream(RecordStream& stream) {
+  std::vector<uint8_t> out;
+  uint8_t chunk[97];
+  while (true) {
+    size_t n = stream.read(chunk, random(1, sizeof(chunk) + 1));
+    if (n == 0) break;
+    out.insert(out.end(), chunk, chunk + n);
+  }
+  return out;
+}
+
+// Decodificador CBOR mínimo para los tipos que emite RecordStream::serializeCbor
+// (enteros, cadenas de texto, arreglos definidos e indefinidos, mapas,
+// bool, null, float32/float64). Las cadenas se copian al documento.
+char* cborText(std::vector<char>& text, const uint8_t* p, uint64_t length) {
+  text.assign(p, p + length);
+  text.push_back('\0');
+  return text.data();
+}
+
+bool cborArgument(const uint8_t*& p, const uint8_t* end, uint8_t info, uint64_t& value) {
+  if (info < 24) {
+    value = info;
+    return true;
+  }
+  uint8_t bytes = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+  if (bytes == 0 || end - p < bytes) return false;
+  value = 0;
+  while (bytes--) value = (value << 8) | *p++;
+  return true;
+}
+
+bool cborDecode(const uint8_t*& p, const uint8_t* end, JsonVariant out, uint8_t depth = 0) {
+  if (p >= end || depth > 8) return false;
+  uint8_t major = *p >> 5;
+  uint8_t info = *p++ & 0x1F;
+  uint64_t value = 0;
+
+  if (major == 4 && info == 31) {
+    JsonArray arr = out.to<JsonArray>();
+    while (p < end && *p != 0xFF) {
+      if (!cborDecode(p, end, arr.add(), depth + 1)) return false;
+    }
+    return p++ < end;
+  }
+  if (major == 7) {
+    if (info == 20 || info == 21) return out.set(info == 21);
+    if (info == 22) return out.set(nullptr);
+    if (!cborArgument(p, end, info, value)) return false;
+    if (info == 26) {
+      uint32_t bits = (uint32_t)value;
+      float f;
+      memcpy(&f, &bits, sizeof(f));
+      return out.set(f);
+    }
+    if (info == 27) {
+      double d;
+      memcpy(&d, &value, sizeof(d));
+      return out.set(d);
+    }
+    return false;
+  }
+  if (!cborArgument(p, end, info, value)) return false;
+
+  switch (major) {
+    case 0: return out.set(value);
+    case 1: return out.set(-1 - (int64_t)value);
+    case 3: {
+      if ((uint64_t)(end - p) < value) return false;
+      std::vector<char> text;
+      bool ok = out.set(cborText(text, p, value));
+      p += value;
+      return ok;
+    }
+    case 4: {
+      JsonArray arr = out.to<JsonArray>();
+      for (uint64_t i = 0; i < value; i++) {
+        if (!cborDecode(p, end, arr.add(), depth + 1)) return false;
+      }
+      return true;
+    }
+    case 5: {
+      JsonObject obj = out.to<JsonObject>();
+      for (uint64_t i = 0; i < value; i++) {
+        if (p >= end || (*p >> 5) != 3) return false;
+        uint64_t keyLen;
+        const uint8_t* key = p + 1;
+        if (!cborArgument(key, end, *p & 0x1F, keyLen) || (uint64_t)(end - key) < keyLen) return false;
+        p = key + keyLen;
+        std::vector<char> text;
+        JsonVariant member = obj[cborText(text, key, keyLen)].to<JsonVariant>();
+        if (member.isUnbound() || !cborDecode(p, end, member, depth + 1)) return false;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Luminarias con todos los estados y curvas; el último tercio cambia
+// después de 'since' y el primer décimo solo reporta estado (touch)
+uint32_t since = 0;
+
+void loadStreamFixtures() {
+  uint16_t count = loadTestFixtures(MAX_LUCES);
+  for (uint16_t i = 0; i < count; i++) {
+    Luminarias.setEstado(i, (EstadoLuminaria)(i % 4));
+    Scenes.setLevel(i, i % 101);
+    Luminarias.setCurva(i, (DimmingCurveType)(i % DIMMING_CURVE_COUNT));
+    Luminarias.setDimeable(i, i % 7 != 0);
+  }
+  since = Luminarias.getRevision();
+  for (uint16_t i = count - count / 3; i < count; i++) Scenes.setLevel(i, (i + 50) % 101);
+}
+
+size_t countChanged(uint32_t revision) {
+  size_t n = 0;
+  for (uint16_t pos = 0; pos < Luminarias.size(); pos++) {
+    if (Luminarias.getRevisionOf(pos) > revision) n++;
+  }
+  return n;
+}
+
+// JSON y MessagePack de RecordStream iguales byte a byte al documento completo
+void verifyIdentical(uint32_t revision) {
+  size_t n = countChanged(revision);
+  DynamicJsonDocument doc(JSON_ARRAY_SIZE(n) + n * (JSON_OBJECT_SIZE(9) + 16) + 64);
+  buildLuminariasDocument(doc.to<JsonArray>(), revision);
+  TEST_ASSERT_FALSE(doc.overflowed());
+
+  String json;
+  serializeJson(doc, json);
+  std::vector<uint8_t> msgpack(measureMsgPack(doc));
+  serializeMsgPack(doc, msgpack.data(), msgpack.size());
+
+  RecordStream jsonStream(new LuminariaRecordSource(revision), STREAM_FORMAT_JSON);
+  std::vector<uint8_t> streamedJson = readStream(jsonStream);
+  RecordStream msgpackStream(new LuminariaRecordSource(revision), STREAM_FORMAT_MSGPACK);
+  std::vector<uint8_t> streamedMsgpack = readStream(msgpackStream);
+
+  TEST_ASSERT_EQUAL_UINT32(json.length(), streamedJson.size());
+  TEST_ASSERT_EQUAL_MEMORY(json.c_str(), streamedJson.data(), json.length());
+  TEST_ASSERT_EQUAL_UINT32(msgpack.size(), streamedMsgpack.size());
+  TEST_ASSERT_TRUE(msgpack == streamedMsgpack);
+  TEST_ASSERT_EQUAL_UINT32(0, jsonStream.getSkippedCount() + msgpackStream.getSkippedCount());
+}
+
+// Cada formato decodificado da el mismo documento (en su forma JSON) que
+// el armado desde el registro
+void verifyRoundTrip(uint32_t revision, size_t expected) {
+  DynamicJsonDocument source(JSON_ARRAY_SIZE(expected) + expected * (JSON_OBJECT_SIZE(9) + 16) + 64);
+  buildLuminariasDocument(source.to<JsonArray>(), revision);
+  TEST_ASSERT_FALSE(source.overflowed());
+  TEST_ASSERT_EQUAL_UINT32(expected, source.size());
+  String canonical;
+  serializeJson(source, canonical);
+
+  const StreamFormat formats[] = {STREAM_FORMAT_JSON, STREAM_FORMAT_MSGPACK, STREAM_FORMAT_CBOR};
+  for (StreamFormat format : formats) {
+    RecordStream stream(new LuminariaRecordSource(revision), format);
+    std::vector<uint8_t> bytes = readStream(stream);
+    TEST_ASSERT_EQUAL_UINT32(0, stream.getSkippedCount());
+
+    // Las cadenas decodificadas se copian: el documento necesita lugar para ellas
+    DynamicJsonDocument decoded(source.capacity() + bytes.size() * 2 + 1024);
+    if (format == STREAM_FORMAT_JSON) {
+      TEST_ASSERT_FALSE(deserializeJson(decoded, (const char*)bytes.data(), bytes.size()));
+    } else if (format == STREAM_FORMAT_MSGPACK) {
+      TEST_ASSERT_FALSE(deserializeMsgPack(decoded, (const char*)bytes.data(), bytes.size()));
+    } else {
+      const uint8_t* p = bytes.data();
+      TEST_ASSERT_TRUE(cborDecode(p, p + bytes.size(), decoded.to<JsonVariant>()));
+      TEST_ASSERT_TRUE(p == bytes.data() + bytes.size());
+      TEST_ASSERT_FALSE(decoded.overflowed());
+    }
+    String roundTrip;
+    serializeJson(decoded, roundTrip);
+    TEST_ASSERT_EQUAL_STRING(canonical.c_str(), roundTrip.c_str());
+  }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_full_stream_identical() {
+  verifyIdentical(0);
+}
+
+void test_delta_stream_identical() {
+  TEST_ASSERT_EQUAL_UINT32(Luminarias.size() / 3, countChanged(since));
+  verifyIdentical(since);
+}
+
+void test_touch_leaves_delta_and_etag() {
+  // touch() es vivacidad: no entra en el delta ni cambia el ETag
+  uint32_t revision = Luminarias.getRevision();
+  for (uint16_t i = 0; i < Luminarias.size() / 10; i++) Luminarias.touch(i);
+  TEST_ASSERT_EQUAL_UINT32(revision, Luminarias.getRevision());
+  TEST_ASSERT_EQUAL_UINT32(Luminarias.size() / 3, countChanged(since));
+  TEST_ASSERT_EQUAL_UINT32(0, countChanged(revision));
+}
+
+void test_formats_round_trip() {
+  verifyRoundTrip(0, Luminarias.size());
+  verifyRoundTrip(since, Luminarias.size() / 3);
+  verifyRoundTrip(Luminarias.getRevision(), 0);
+}
+
+// Valores que el registro no produce: negativos, enteros grandes, double
+// que no entra en float32, cadenas largas y colecciones anidadas
+void test_cbor_types_round_trip() {
+  StaticJsonDocument<1024> source;
+  String text;
+  for (uint16_t i = 0; i < 300; i++) text += (char)('a' + i % 26);
+  source["neg"] = -1;
+  source["neg_big"] = -100000;
+  source["u32"] = 4294967295UL;
+  source["half"] = 0.5;
+  source["pi"] = 3.141592653589793;
+  source["lat"] = (float)DEFAULT_LAT;
+  source["null"] = nullptr;
+  source["yes"] = true;
+  source["no"] = false;
+  source["text"] = text;
+  source["utf8"] = "Iluminación ñandú";
+  JsonArray arr = source.createNestedArray("arr");
+  arr.add(1);
+  arr.add("a");
+  arr.createNestedArray().add(2);
+  source.createNestedObject("obj")["k"] = "v";
+  String canonical;
+  serializeJson(source, canonical);
+
+  uint8_t cbor[512];
+  size_t cborLen = RecordStream::serializeCbor(source.as<JsonVariantConst>(), cbor, sizeof(cbor));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, cborLen);
+  StaticJsonDocument<1536> decoded;
+  const uint8_t* p = cbor;
+  TEST_ASSERT_TRUE(cborDecode(p, cbor + cborLen, decoded.to<JsonVariant>()));
+  TEST_ASSERT_TRUE(p == cbor + cborLen);
+  String cborTrip;
+  serializeJson(decoded, cborTrip);
+  TEST_ASSERT_EQUAL_STRING(canonical.c_str(), cborTrip.c_str());
+  // Sin lugar para el valor completo, serializeCbor no entrega nada a medias
+  TEST_ASSERT_EQUAL_UINT32(0, RecordStream::serializeCbor(source.as<JsonVariantConst>(), cbor, cborLen - 1));
+
+  uint8_t msgpack[512];
+  size_t msgpackLen = serializeMsgPack(source, msgpack, sizeof(msgpack));
+  decoded.clear();
+  TEST_ASSERT_FALSE(deserializeMsgPack(decoded, (const char*)msgpack, msgpackLen));
+  String msgpackTrip;
+  serializeJson(decoded, msgpackTrip);
+  TEST_ASSERT_EQUAL_STRING(canonical.c_str(), msgpackTrip.c_str());
+}
+
+int main() {
+  loadStreamFixtures();
+  UNITY_BEGIN();
+  RUN_TEST(test_full_stream_identical);
+  RUN_TEST(test_delta_stream_identical);
+  RUN_TEST(test_touch_leaves_delta_and_etag);
+  RUN_TEST(test_formats_round_trip);
+  RUN_TEST(test_cbor_types_round_trip);
+  return UNITY_END();
+}
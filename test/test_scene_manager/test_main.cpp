@@ -0,0 +1,71 @@
+// Tests de SceneManager con el reloj real: una escena con dos acciones con
+// delay sobre una zona con todas las luminarias vuelve enseguida, no
+// adelanta ningún nivel, no descarta ninguna acción y termina sola desde loop()
+
+#include <TestSupport.h>
+#include "BrightnessTable.h"
+#include "SceneManager.h"
+
+#define TEST_FADE_MS 2000
+#define TEST_SCENE_ZONE "zona_prueba"
+
+uint32_t sceneId = 0;
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_activate_does_not_block() {
+  loadTestFixtures(MAX_LUCES);
+  for (uint16_t i = 0; i < Luminarias.size(); i++) Scenes.setLevel(i, 0);
+  ZoneVisual.createZone(TEST_SCENE_ZONE, "Prueba");
+  for (uint16_t i = 0; i < Luminarias.size(); i++) {
+    ZoneVisual.addLightToZone(TEST_SCENE_ZONE, LuminariaRegistry::formatId(Luminarias.getId(i)));
+  }
+  sceneId = Scenes.createScene("Fade de prueba");
+  SceneAction action;
+  action.targetId = TEST_SCENE_ZONE;
+  action.isZone = true;
+  action.brightness = 100;
+  action.delay = 300;
+  action.transition = TRANSITION_FADE;
+  action.transitionTime = TEST_FADE_MS;
+  Scenes.addActionToScene(sceneId, action);
+  // La segunda acción se superpone a la primera
+  action.brightness = 40;
+  action.delay = 300 + TEST_FADE_MS / 2;
+  Scenes.addActionToScene(sceneId, action);
+
+  unsigned long start = micros();
+  TEST_ASSERT_TRUE(Scenes.activateScene(sceneId));
+  TEST_ASSERT_LESS_THAN_UINT32(50000, micros() - start);
+  TEST_ASSERT_TRUE(Scenes.isTransitioning());
+
+  // Ningún nivel antes de su delay
+  for (uint16_t i = 0; i < Luminarias.size(); i++) TEST_ASSERT_EQUAL_UINT8(0, Brightness.getCurrent(i));
+}
+
+void test_scene_finishes_from_loop() {
+  unsigned long start = millis();
+  while (Scenes.isTransitioning() && millis() - start < 10000) {
+    Scenes.loop();
+    delay(1);
+  }
+  TEST_ASSERT_FALSE(Scenes.isTransitioning());
+
+  // La segunda acción reemplaza a la primera en todas las luces, sin
+  // descartar ninguna: una transición por luz como máximo
+  const TransitionEngine& engine = Scenes.getTransitions();
+  uint16_t count = Luminarias.size();
+  for (uint16_t i = 0; i < count; i++) TEST_ASSERT_EQUAL_UINT8(40, Brightness.getCurrent(i));
+  TEST_ASSERT_EQUAL_UINT32(0, engine.getDropped());
+  TEST_ASSERT_EQUAL_UINT32(count, engine.getReplaced());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT16(count, engine.getPeak());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_activate_does_not_block);
+  RUN_TEST(test_scene_finishes_from_loop);
+  return UNITY_END();
+}
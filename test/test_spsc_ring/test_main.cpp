@@ -0,0 +1,86 @@
+// Tests de SpscRingBuffer (lib/CircularBuffer): capacidad, lotes y un
+// productor y un consumidor en hilos distintos (como Ticker/ISR y loop())
+
+#include <TestSupport.h>
+#include <thread>
+#include <SpscRingBuffer.h>
+
+#define TEST_RING_SIZE 64
+#define TEST_RING_BATCH 16
+#define TEST_RING_ITEMS 2000000
+
+struct RingItem {
+  uint32_t seq;
+  uint32_t check;  // Derivado de seq: detecta lecturas a medio escribir
+
+  RingItem() : seq(0), check(0) {}
+  explicit RingItem(uint32_t n) : seq(n), check(n * 2654435761u) {}
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_capacity_and_order() {
+  SpscRingBuffer<RingItem, TEST_RING_SIZE> ring;
+  uint32_t n = 0;
+  while (ring.push(RingItem(n))) n++;
+  TEST_ASSERT_EQUAL_UINT32(ring.capacity(), n);
+  TEST_ASSERT_FALSE(ring.emplace(n));
+
+  RingItem batch[TEST_RING_BATCH];
+  uint32_t received = 0;
+  size_t count;
+  while ((count = ring.popN(batch, TEST_RING_BATCH)) > 0) {
+    for (size_t j = 0; j < count; j++) TEST_ASSERT_EQUAL_UINT32(received++, batch[j].seq);
+  }
+  TEST_ASSERT_EQUAL_UINT32(n, received);
+  TEST_ASSERT_TRUE(ring.isEmpty());
+}
+
+void test_two_threads_keep_order() {
+  static SpscRingBuffer<RingItem, TEST_RING_SIZE> ring;
+  std::thread producer([]() {
+    RingItem batch[TEST_RING_BATCH];
+    uint32_t n = 0;
+    while (n < TEST_RING_ITEMS) {
+      size_t sent;
+      if (n % 3 == 0) {
+        sent = ring.push(RingItem(n)) ? 1 : 0;
+      } else if (n % 3 == 1) {
+        sent = ring.emplace(n) ? 1 : 0;
+      } else {
+        size_t count = min((uint32_t)TEST_RING_BATCH, (uint32_t)TEST_RING_ITEMS - n);
+        for (size_t j = 0; j < count; j++) batch[j] = RingItem(n + j);
+        sent = ring.pushN(batch, count);
+      }
+      if (sent == 0) std::this_thread::yield();
+      n += sent;
+    }
+  });
+
+  uint32_t errors = 0;
+  uint32_t received = 0;
+  RingItem batch[TEST_RING_BATCH];
+  while (received < TEST_RING_ITEMS) {
+    size_t count = (received & 1) ? ring.popN(batch, TEST_RING_BATCH) : (ring.pop(batch[0]) ? 1 : 0);
+    if (count == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t j = 0; j < count; j++) {
+      if (batch[j].seq != received || batch[j].check != received * 2654435761u) errors++;
+      received++;
+    }
+  }
+  producer.join();
+  TEST_ASSERT_EQUAL_UINT32(0, errors);
+  TEST_ASSERT_TRUE(ring.isEmpty());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_capacity_and_order);
+  RUN_TEST(test_two_threads_keep_order);
+  return UNITY_END();
+}
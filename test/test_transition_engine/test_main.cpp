@@ -0,0 +1,124 @@
+// Tests de TransitionEngine con un reloj falso: fades escalonados (que
+// además cruzan la vuelta de millis() a 32 bits), reemplazo entre
+// transiciones de un destino, setLevel() que cancela la programada y costo
+// acotado por tick
+
+#include <TestSupport.h>
+#include <vector>
+#include "BrightnessTable.h"
+#include "TransitionEngine.h"
+
+#define TEST_FADE_MS 2000
+#define TEST_FADE_STAGGER 100   // Inicio de cada fade: (i % 20) * TEST_FADE_STAGGER
+#define TEST_CLOCK_STEP 10
+
+BrightnessTable* table;
+TransitionEngine* engine;
+
+void setUp() {
+  table = new BrightnessTable();
+  engine = new TransitionEngine(*table);
+}
+
+void tearDown() {
+  delete engine;
+  delete table;
+}
+
+void test_staggered_fades() {
+  uint16_t fades = engine->getCapacity() - 3;
+  uint16_t replaced = fades;      // Fade reemplazado por un cambio programado
+  uint16_t resumed = fades + 1;   // Fade que arranca desde un nivel puesto a mano
+
+  std::vector<uint8_t> lastLevels(fades + 2, 0);
+  std::vector<uint32_t> outputs(fades + 2, 0);
+  uint32_t monotonicErrors = 0;
+  engine->setOutput([&](uint16_t target, uint8_t level) {
+    // Los fades de subida nunca bajan y el reanudado nunca sube
+    if (target < fades && level < lastLevels[target]) monotonicErrors++;
+    if (target == resumed && level > lastLevels[target]) monotonicErrors++;
+    lastLevels[target] = level;
+    outputs[target]++;
+  });
+
+  // Reloj falso que da la vuelta a 32 bits a mitad de la prueba
+  uint32_t base = 0xFFFFFFFFUL - 1000;
+  for (uint16_t i = 0; i < fades; i++) {
+    TEST_ASSERT_TRUE(engine->start(i, 100, base + (i % 20) * TEST_FADE_STAGGER, TEST_FADE_MS));
+  }
+  engine->start(replaced, 100, base, 1000);
+  engine->start(replaced, 0, base + 500, 0);
+  engine->setLevel(resumed, 80);
+  lastLevels[resumed] = 80;
+  engine->start(resumed, 20, base + 200, 400);
+
+  uint32_t levelErrors = 0;
+  uint32_t last = 19 * TEST_FADE_STAGGER + TEST_FADE_MS + 500;
+  for (uint32_t t = 0; t <= last; t += TEST_CLOCK_STEP) {
+    engine->update(base + t);
+    if (t % TRANSITION_TICK_MS) continue;  // Entre ticks update() no hace nada
+
+    for (uint16_t i = 0; i < fades; i++) {
+      uint32_t begin = (i % 20) * TEST_FADE_STAGGER;
+      uint8_t level = engine->getLevel(i);
+      if (t <= begin && level != 0) levelErrors++;
+      if (t >= begin + TEST_FADE_MS && level != 100) levelErrors++;
+    }
+    if (t >= 500 && engine->getLevel(replaced) != 0) levelErrors++;
+    if (t < 200 && engine->getLevel(resumed) != 80) levelErrors++;
+    if (t >= 600 && engine->getLevel(resumed) != 20) levelErrors++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, levelErrors);
+  TEST_ASSERT_EQUAL_UINT32(0, monotonicErrors);
+  TEST_ASSERT_EQUAL_UINT16(0, engine->getActiveCount());
+
+  // Un fade de 0 a 100 cambia de nivel a lo sumo una vez por tick
+  for (uint16_t i = 0; i < fades; i++) {
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_FADE_MS / TRANSITION_TICK_MS, outputs[i]);
+  }
+}
+
+void test_update_does_not_allocate() {
+  engine->setOutput([](uint16_t, uint8_t) {});
+  for (uint16_t i = 0; i < engine->getCapacity(); i++) engine->start(i, 100, 0, TEST_FADE_MS);
+  uint32_t allocsBefore = heapAllocations;
+  for (uint32_t t = 0; t <= TEST_FADE_MS; t += TRANSITION_TICK_MS) engine->update(t);
+  TEST_ASSERT_EQUAL_UINT32(0, heapAllocations - allocsBefore);
+  TEST_ASSERT_EQUAL_UINT16(0, engine->getActiveCount());
+  for (uint16_t i = 0; i < engine->getCapacity(); i++) TEST_ASSERT_EQUAL_UINT8(100, table->getCurrent(i));
+}
+
+void test_one_transition_per_target() {
+  // Cada start() sobre el mismo destino reemplaza al anterior: nunca se llena
+  for (uint16_t k = 0; k < 1000; k++) TEST_ASSERT_TRUE(engine->start(0, k % 100, 1000, 100));
+  engine->start(0, 50, 1000, 100);
+  TEST_ASSERT_EQUAL_UINT16(1, engine->getActiveCount());
+  TEST_ASSERT_EQUAL_UINT32(1000, engine->getReplaced());
+  TEST_ASSERT_FALSE(engine->start(engine->getCapacity(), 50, 0, 100));
+  TEST_ASSERT_EQUAL_UINT32(1, engine->getDropped());
+  engine->update(1200);
+  TEST_ASSERT_EQUAL_UINT8(50, engine->getLevel(0));
+  TEST_ASSERT_EQUAL_UINT16(0, engine->getActiveCount());
+}
+
+void test_set_level_cancels_pending() {
+  // Un fade programado para más adelante no pisa un nivel puesto después
+  engine->start(0, 100, 500, 1000);
+  engine->start(1, 100, 0, 1000);
+  engine->update(0);
+  engine->setLevel(0, 60);
+  engine->setLevel(1, 30);
+  TEST_ASSERT_EQUAL_UINT16(0, engine->getActiveCount());
+  for (uint32_t t = 0; t <= 2000; t += TRANSITION_TICK_MS) engine->update(t);
+  TEST_ASSERT_EQUAL_UINT8(60, engine->getLevel(0));
+  TEST_ASSERT_EQUAL_UINT8(30, engine->getLevel(1));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_staggered_fades);
+  RUN_TEST(test_update_does_not_allocate);
+  RUN_TEST(test_one_transition_per_target);
+  RUN_TEST(test_set_level_cancels_pending);
+  return UNITY_END();
+}